@@ -0,0 +1,49 @@
+'use strict';
+const common = require('../common.js');
+const { AsyncLocalStorage } = require('async_hooks');
+
+// Measures the overhead of an active AsyncLocalStorage on promise-heavy code
+// and on timers. Run it with
+// NODE_BENCHMARK_FLAGS=--experimental-async-context-frame to compare the
+// native context frame with the propagation through async_hooks.
+const bench = common.createBenchmark(main, {
+  type: ['await', 'immediate'],
+  storage: ['none', 'active'],
+  n: [1e5],
+});
+
+async function runAwait(als, n) {
+  let sum = 0;
+  for (let i = 0; i < n; i++) {
+    sum += await new Promise((resolve) => resolve(i));
+    if (als !== undefined && als.getStore() === undefined)
+      throw new Error('The store was lost');
+  }
+  return sum;
+}
+
+function runImmediate(als, n) {
+  return new Promise((resolve) => {
+    let remaining = n;
+    function next() {
+      if (als !== undefined && als.getStore() === undefined)
+        throw new Error('The store was lost');
+      if (--remaining === 0)
+        resolve();
+      else
+        setImmediate(next);
+    }
+    setImmediate(next);
+  });
+}
+
+function main({ type, storage, n }) {
+  const run = type === 'await' ? runAwait : runImmediate;
+  const als = storage === 'active' ? new AsyncLocalStorage() : undefined;
+  bench.start();
+  const done = () => bench.end(n);
+  if (als === undefined)
+    run(als, n).then(done);
+  else
+    als.run({}, () => run(als, n).then(done));
+}
@@ -24,6 +24,12 @@ const tests = {
     hook = createHook({
       init() {}
     }).enable();
+  },
+  enabledWithBeforeAfter() {
+    hook = createHook({
+      before() {},
+      after() {}
+    }).enable();
   }
 };
 
@@ -33,6 +39,7 @@ const bench = common.createBenchmark(main, {
     'enabled',
     'enabledWithDestroy',
     'enabledWithInitOnly',
+    'enabledWithBeforeAfter',
     'disabled',
   ]
 });
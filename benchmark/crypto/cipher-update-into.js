@@ -0,0 +1,42 @@
+'use strict';
+const common = require('../common.js');
+const crypto = require('crypto');
+const bench = common.createBenchmark(main, {
+  n: [500],
+  cipher: ['aes-256-gcm', 'chacha20-poly1305'],
+  method: ['update', 'updateInto', 'updateAsync'],
+  len: [16 * 1024, 256 * 1024, 1024 * 1024]
+});
+
+function main({ n, len, cipher, method }) {
+  const message = Buffer.alloc(len, 'b');
+  const key = crypto.randomBytes(32);
+  const iv = crypto.randomBytes(12);
+  const mbits = n * len * 8 / (1024 * 1024);
+  const alice = crypto.createCipheriv(cipher, key, iv);
+
+  bench.start();
+  switch (method) {
+    case 'update':
+      for (let i = 0; i < n; i++)
+        alice.update(message);
+      bench.end(mbits);
+      break;
+    case 'updateInto':
+      for (let i = 0; i < n; i++)
+        alice.updateInto(message, message);
+      bench.end(mbits);
+      break;
+    case 'updateAsync': {
+      let pending = n;
+      for (let i = 0; i < n; i++) {
+        alice.updateAsync(message, message, (err) => {
+          if (err) throw err;
+          if (--pending === 0)
+            bench.end(mbits);
+        });
+      }
+      break;
+    }
+  }
+}
@@ -0,0 +1,42 @@
+// Hashes many small messages, either one at a time or as a single batch.
+'use strict';
+
+const common = require('../common.js');
+const crypto = require('crypto');
+
+const bench = common.createBenchmark(main, {
+  api: ['createHash', 'hash', 'hashBatchSync', 'createHmac', 'hmacBatchSync'],
+  algo: ['sha256', 'sha512'],
+  len: [32, 256, 4096],
+  count: [1e4],
+});
+
+function main({ api, algo, len, count }) {
+  const messages = [];
+  for (let i = 0; i < count; i++)
+    messages.push(Buffer.alloc(len, i));
+  const key = 'secret';
+
+  bench.start();
+  switch (api) {
+    case 'createHash':
+      for (const message of messages)
+        crypto.createHash(algo).update(message).digest();
+      break;
+    case 'hash':
+      for (const message of messages)
+        crypto.hash(algo, message, 'buffer');
+      break;
+    case 'hashBatchSync':
+      crypto.hashBatchSync(algo, messages);
+      break;
+    case 'createHmac':
+      for (const message of messages)
+        crypto.createHmac(algo, key).update(message).digest();
+      break;
+    case 'hmacBatchSync':
+      crypto.hmacBatchSync(algo, key, messages);
+      break;
+  }
+  bench.end(count);
+}
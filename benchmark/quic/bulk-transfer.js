@@ -0,0 +1,63 @@
+'use strict';
+const common = require('../common.js');
+const bench = common.createBenchmark(main, {
+  size: [16 * 1024 * 1024],
+  chunk: [64 * 1024],
+  n: [4]
+}, { flags: ['--no-warnings'] });
+
+const { createQuicSocket } = require('net');
+const fixtures = require('../../test/common/fixtures');
+
+// Sends `n` streams of `size` bytes each over loopback. `quicsocket.sendCalls`
+// shows how many packets were sent per system call.
+function main({ size, chunk, n }) {
+  const options = {
+    key: fixtures.readKey('agent1-key.pem', 'binary'),
+    cert: fixtures.readKey('agent1-cert.pem', 'binary'),
+    ca: fixtures.readKey('ca1-cert.pem', 'binary'),
+    alpn: 'bench',
+  };
+  const data = Buffer.alloc(chunk, 'q');
+  const server = createQuicSocket({ server: options });
+  const client = createQuicSocket({ client: options });
+
+  server.on('session', (session) => {
+    session.on('stream', (stream) => {
+      stream.resume();
+      stream.on('end', () => stream.end());
+    });
+  });
+
+  (async function() {
+    await server.listen();
+    const session = await client.connect({
+      address: 'localhost',
+      port: server.endpoints[0].address.port,
+    });
+
+    let remaining = n;
+    bench.start();
+    for (let i = 0; i < n; i++) {
+      const stream = await session.openStream();
+      let written = 0;
+      const write = () => {
+        while (written < size) {
+          written += chunk;
+          if (!stream.write(data))
+            return stream.once('drain', write);
+        }
+        stream.end();
+      };
+      stream.on('close', () => {
+        if (--remaining > 0)
+          return;
+        bench.end((n * size * 8) / (1024 * 1024 * 1024));
+        client.close();
+        server.close();
+      });
+      stream.resume();
+      write();
+    }
+  })();
+}
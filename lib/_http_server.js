@@ -75,6 +75,10 @@ const {
   validateInteger,
   validateBoolean
 } = require('internal/validators');
+const {
+  createLatencyHistogram,
+  kHandle: kHistogramHandle,
+} = require('internal/histogram');
 const Buffer = require('buffer').Buffer;
 const {
   DTRACE_HTTP_SERVER_REQUEST,
@@ -367,7 +371,12 @@ function Server(options, requestListener) {
     validateBoolean(insecureHTTPParser, 'options.insecureHTTPParser');
   this.insecureHTTPParser = insecureHTTPParser;
 
-  net.Server.call(this, { allowHalfOpen: true });
+  net.Server.call(this, {
+    allowHalfOpen: true,
+    latencyHistograms: options.latencyHistograms,
+  });
+  if (this.latencyHistograms !== undefined)
+    this.latencyHistograms.request = createLatencyHistogram();
 
   if (requestListener) {
     this.on('request', requestListener);
@@ -450,6 +459,7 @@ function connectionListenerInternal(server, socket) {
     server.insecureHTTPParser === undefined ?
       isLenient() : server.insecureHTTPParser,
     server.headersTimeout || 0,
+    requestHistogramHandle(server),
   );
   parser.socket = socket;
   socket.parser = parser;
@@ -774,7 +784,19 @@ function clearRequestTimeout(req) {
   req[kRequestTimeout] = undefined;
 }
 
+// The native handle of the histogram that the time between the parsing of
+// the headers of a request and the end of its response is recorded into.
+function requestHistogramHandle(server) {
+  const histograms = server.latencyHistograms;
+  if (histograms === undefined || histograms.request === undefined)
+    return undefined;
+  return histograms.request[kHistogramHandle];
+}
+
 function resOnFinish(req, res, socket, state, server) {
+  if (server.latencyHistograms !== undefined && socket.parser)
+    socket.parser.recordResponse();
+
   // Usually the first incoming element should be our request.  it may
   // be that in the case abortIncoming() was called that the incoming
   // array will be empty.
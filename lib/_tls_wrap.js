@@ -81,6 +81,10 @@ const {
   validateBuffer,
   validateUint32
 } = require('internal/validators');
+const {
+  createLatencyHistogram,
+  kHandle: kHistogramHandle,
+} = require('internal/histogram');
 const traceTls = getOptionValue('--trace-tls');
 const tlsKeylog = getOptionValue('--tls-keylog');
 const { appendFile } = require('fs');
@@ -698,6 +702,9 @@ TLSSocket.prototype._init = function(socket, wrap) {
       }
       if (this.server.listenerCount('OCSPRequest') > 0)
         ssl.enableCertCb();
+      const histograms = this.server.latencyHistograms;
+      if (histograms !== undefined && histograms.handshake !== undefined)
+        ssl.setHandshakeHistogram(histograms.handshake[kHistogramHandle]);
     }
   } else {
     ssl.onhandshakestart = noop;
@@ -1210,6 +1217,9 @@ function Server(options, listener) {
   // constructor call
   net.Server.call(this, options, tlsConnectionListener);
 
+  if (this.latencyHistograms !== undefined)
+    this.latencyHistograms.handshake = createLatencyHistogram();
+
   if (listener) {
     this.on('secureConnection', listener);
   }
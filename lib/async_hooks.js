@@ -47,8 +47,9 @@ const {
 const {
   async_id_symbol, trigger_async_id_symbol,
   init_symbol, before_symbol, after_symbol, destroy_symbol,
-  promise_resolve_symbol
+  promise_resolve_symbol, async_context_frame
 } = internal_async_hooks.symbols;
+const AsyncContextFrame = require('internal/async_context_frame');
 
 // Get constants
 const {
@@ -166,6 +167,7 @@ class AsyncResource {
     const asyncId = newAsyncId();
     this[async_id_symbol] = asyncId;
     this[trigger_async_id_symbol] = triggerAsyncId;
+    this[async_context_frame] = AsyncContextFrame.current();
 
     if (initHooksExist()) {
       if (enabledHooksExist() && type.length === 0) {
@@ -184,6 +186,8 @@ class AsyncResource {
   }
 
   runInAsyncScope(fn, thisArg, ...args) {
+    const priorContextFrame =
+      AsyncContextFrame.exchange(this[async_context_frame]);
     const asyncId = this[async_id_symbol];
     emitBefore(asyncId, this[trigger_async_id_symbol], this);
 
@@ -196,6 +200,7 @@ class AsyncResource {
     } finally {
       if (hasAsyncIdStack())
         emitAfter(asyncId);
+      AsyncContextFrame.enter(priorContextFrame);
     }
   }
 
@@ -328,7 +333,10 @@ class AsyncLocalStorage {
 // otherwise.
 module.exports = {
   // Public API
-  AsyncLocalStorage,
+  // This module is not loaded before the options are known, see
+  // setupAsyncContextFrame().
+  AsyncLocalStorage: AsyncContextFrame.enabled ?
+    require('internal/async_local_storage') : AsyncLocalStorage,
   createHook,
   executionAsyncId,
   triggerAsyncId,
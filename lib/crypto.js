@@ -104,7 +104,12 @@ const {
 } = require('internal/crypto/sig');
 const {
   Hash,
-  Hmac
+  Hmac,
+  hash,
+  hashBatch,
+  hashBatchSync,
+  hmacBatch,
+  hmacBatchSync,
 } = require('internal/crypto/hash');
 const {
   getCiphers,
@@ -183,8 +188,13 @@ module.exports = {
   getCurves,
   getDiffieHellman: createDiffieHellmanGroup,
   getHashes,
+  hash,
+  hashBatch,
+  hashBatchSync,
   hkdf,
   hkdfSync,
+  hmacBatch,
+  hmacBatchSync,
   pbkdf2,
   pbkdf2Sync,
   generateKeyPair,
@@ -42,6 +42,7 @@ let debug = require('internal/util/debuglog').debuglog('https', (fn) => {
 });
 const { URL, urlToOptions, searchParamsSymbol } = require('internal/url');
 const { IncomingMessage, ServerResponse } = require('http');
+const { createLatencyHistogram } = require('internal/histogram');
 const { kIncomingMessage } = require('_http_common');
 
 function Server(opts, requestListener) {
@@ -65,6 +66,9 @@ function Server(opts, requestListener) {
 
   tls.Server.call(this, opts, _connectionListener);
 
+  if (this.latencyHistograms !== undefined)
+    this.latencyHistograms.request = createLatencyHistogram();
+
   this.httpAllowHalfOpen = false;
 
   if (requestListener) {
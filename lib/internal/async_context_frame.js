@@ -0,0 +1,63 @@
+'use strict';
+
+const {
+  SafeMap,
+} = primordials;
+
+const {
+  getContextFrame,
+  setContextFrame,
+} = internalBinding('async_wrap');
+
+let enabled = false;
+
+// An async context frame maps each AsyncLocalStorage to its store. The
+// current frame is kept in the continuation-preserved embedder data of the
+// context: V8 captures it for promise reactions, native resources capture
+// it in AsyncReset() and restore it in InternalCallbackScope, and the
+// JavaScript resources (timers, immediates, ticks and AsyncResources) store
+// it in their `async_context_frame` property. Frames are never modified
+// once they have been entered, as they are shared by all the continuations
+// that captured them.
+class AsyncContextFrame extends SafeMap {
+  constructor(store, data) {
+    super(getContextFrame());
+    this.set(store, data);
+  }
+
+  static get enabled() {
+    return enabled;
+  }
+
+  // Set up in prepareMainThreadExecution() and in workers, once the options
+  // of the process are known.
+  static setup(value) {
+    enabled = value;
+  }
+
+  static current() {
+    if (enabled)
+      return getContextFrame();
+  }
+
+  static enter(frame) {
+    if (enabled)
+      setContextFrame(frame);
+  }
+
+  static exchange(frame) {
+    if (enabled) {
+      const prior = getContextFrame();
+      setContextFrame(frame);
+      return prior;
+    }
+  }
+
+  static disable(store) {
+    const frame = AsyncContextFrame.current();
+    if (frame !== undefined && frame.get(store) !== undefined)
+      setContextFrame(new AsyncContextFrame(store, undefined));
+  }
+}
+
+module.exports = AsyncContextFrame;
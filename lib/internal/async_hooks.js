@@ -103,6 +103,9 @@ const before_symbol = Symbol('before');
 const after_symbol = Symbol('after');
 const destroy_symbol = Symbol('destroy');
 const promise_resolve_symbol = Symbol('promiseResolve');
+// Used by the JavaScript async resources to store their context frame, see
+// internal/async_context_frame.
+const async_context_frame = Symbol('asyncContextFrame');
 const emitBeforeNative = emitHookFactory(before_symbol, 'emitBeforeNative');
 const emitAfterNative = emitHookFactory(after_symbol, 'emitAfterNative');
 const emitDestroyNative = emitHookFactory(destroy_symbol, 'emitDestroyNative');
@@ -303,9 +306,14 @@ function trackPromise(promise, parent, silent) {
   promise[trigger_async_id_symbol] = parent ? getOrSetAsyncId(parent) :
     getDefaultTriggerAsyncId();
 
-  if (!silent && initHooksExist()) {
-    const triggerId = promise[trigger_async_id_symbol];
-    emitInitScript(asyncId, 'PROMISE', triggerId, promise);
+  if (!silent) {
+    if (initHooksExist()) {
+      const triggerId = promise[trigger_async_id_symbol];
+      emitInitScript(asyncId, 'PROMISE', triggerId, promise);
+    }
+    // The destroy hook is emitted once the promise is garbage collected.
+    if (destroyHooksExist())
+      registerDestroyHook(promise, asyncId);
   }
 }
 
@@ -351,16 +359,11 @@ function enableHooks() {
   async_hook_fields[kCheck] += 1;
 }
 
-let promiseHookMode = -1;
+let promiseHookEnabled = false;
 function updatePromiseHookMode() {
   wantPromiseHook = true;
-  if (destroyHooksExist()) {
-    if (promiseHookMode !== 1) {
-      promiseHookMode = 1;
-      enablePromiseHook();
-    }
-  } else if (promiseHookMode !== 0) {
-    promiseHookMode = 0;
+  if (!promiseHookEnabled) {
+    promiseHookEnabled = true;
     enablePromiseHook(fastPromiseHook);
   }
 }
@@ -377,7 +380,7 @@ function disableHooks() {
 
 function disablePromiseHookIfNecessary() {
   if (!wantPromiseHook) {
-    promiseHookMode = -1;
+    promiseHookEnabled = false;
     disablePromiseHook();
   }
 }
@@ -546,7 +549,7 @@ module.exports = {
   symbols: {
     async_id_symbol, trigger_async_id_symbol,
     init_symbol, before_symbol, after_symbol, destroy_symbol,
-    promise_resolve_symbol, owner_symbol
+    promise_resolve_symbol, owner_symbol, async_context_frame
   },
   constants: {
     kInit, kBefore, kAfter, kDestroy, kTotals, kPromiseResolve
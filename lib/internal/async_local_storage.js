@@ -0,0 +1,42 @@
+'use strict';
+
+const {
+  ReflectApply,
+} = primordials;
+
+const AsyncContextFrame = require('internal/async_context_frame');
+
+// The AsyncLocalStorage used with --experimental-async-context-frame. The
+// stores are propagated natively with the async context frame, so that no
+// async hook needs to be enabled.
+class AsyncLocalStorage {
+  disable() {
+    AsyncContextFrame.disable(this);
+  }
+
+  enterWith(store) {
+    AsyncContextFrame.enter(new AsyncContextFrame(this, store));
+  }
+
+  run(store, callback, ...args) {
+    const frame = new AsyncContextFrame(this, store);
+    const prior = AsyncContextFrame.exchange(frame);
+    try {
+      return ReflectApply(callback, null, args);
+    } finally {
+      AsyncContextFrame.enter(prior);
+    }
+  }
+
+  exit(callback, ...args) {
+    return this.run(undefined, callback, ...args);
+  }
+
+  getStore() {
+    const frame = AsyncContextFrame.current();
+    if (frame !== undefined)
+      return frame.get(this);
+  }
+}
+
+module.exports = AsyncLocalStorage;
@@ -9,6 +9,7 @@ const {
 
 const {
   getOptionValue,
+  refreshOptions,
   shouldNotRegisterESMLoader
 } = require('internal/options');
 const { reconnectZeroFillToggle } = require('internal/buffer');
@@ -17,7 +18,22 @@ const { Buffer } = require('buffer');
 const { ERR_MANIFEST_ASSERT_INTEGRITY } = require('internal/errors').codes;
 const assert = require('internal/assert');
 
+// Set by internal/main/mksnapshot right before the heap is serialized into a
+// user-land snapshot, in which case prepareMainThreadExecution() has already
+// been run once, with the options of the process that built the snapshot.
+let deserializingUserlandSnapshot = false;
+
+function prepareUserlandSnapshot() {
+  deserializingUserlandSnapshot = true;
+}
+
 function prepareMainThreadExecution(expandArgv1 = false) {
+  const fromUserlandSnapshot = deserializingUserlandSnapshot;
+  deserializingUserlandSnapshot = false;
+  if (fromUserlandSnapshot) {
+    refreshOptions();
+  }
+
   // TODO(joyeecheung): this is also necessary for workers when they deserialize
   // this toggle from the snapshot.
   reconnectZeroFillToggle();
@@ -26,6 +42,10 @@ function prepareMainThreadExecution(expandArgv1 = false) {
   patchProcessObject(expandArgv1);
   setupTraceCategoryState();
   setupInspectorHooks();
+  if (fromUserlandSnapshot) {
+    const { onWarning } = require('internal/process/warning');
+    process.removeListener('warning', onWarning);
+  }
   setupWarningHandler();
 
   // Resolve the coverage directory to an absolute path, and
@@ -38,6 +58,7 @@ function prepareMainThreadExecution(expandArgv1 = false) {
 
 
   setupDebugEnv();
+  setupAsyncContextFrame();
 
   // Print stack trace on `SIGINT` if option `--trace-sigint` presents.
   setupStacktracePrinterOnSigint();
@@ -47,6 +68,7 @@ function prepareMainThreadExecution(expandArgv1 = false) {
   initializeReportSignalHandlers();  // Main-thread-only.
 
   initializeHeapSnapshotSignalHandlers();
+  initializeContinuousCpuProfiler();
 
   // If the process is spawned with env NODE_CHANNEL_FD, it's probably
   // spawned by our child_process module, then initialize IPC.
@@ -63,13 +85,19 @@ function prepareMainThreadExecution(expandArgv1 = false) {
   // (including preload modules).
   initializeClusterIPC();
 
-  initializeDeprecations();
+  if (!fromUserlandSnapshot) {
+    initializeDeprecations();
+  }
   initializeWASI();
   initializeCJSLoader();
   initializeESMLoader();
 
-  const CJSLoader = require('internal/modules/cjs/loader');
-  assert(!CJSLoader.hasLoadedAnyUserCJSModule);
+  if (fromUserlandSnapshot) {
+    require('internal/v8/startup_snapshot').runDeserializeCallbacks();
+  } else {
+    const CJSLoader = require('internal/modules/cjs/loader');
+    assert(!CJSLoader.hasLoadedAnyUserCJSModule);
+  }
   loadPreloadModules();
   initializeFrozenIntrinsics();
 }
@@ -91,7 +119,9 @@ function patchProcessObject(expandArgv1) {
 
   ObjectDefineProperty(process, 'argv0', {
     enumerable: true,
-    configurable: false,
+    // Only set it to true when building a snapshot, so that it can be
+    // redefined when the snapshot is deserialized.
+    configurable: getOptionValue('--build-snapshot'),
     value: process.argv[0]
   });
   process.argv[0] = process.execPath;
@@ -192,6 +222,11 @@ function setupDebugEnv() {
   }
 }
 
+function setupAsyncContextFrame() {
+  require('internal/async_context_frame')
+    .setup(getOptionValue('--experimental-async-context-frame'));
+}
+
 // This has to be called after initializeReport() is called
 function initializeReportSignalHandlers() {
   const { addSignalHandler } = require('internal/process/report');
@@ -206,10 +241,35 @@ function initializeHeapSnapshotSignalHandlers() {
     return;
 
   require('internal/validators').validateSignalName(signal);
+  const compression =
+    getOptionValue('--heapsnapshot-compression') || undefined;
+
+  // Write the snapshots from native code where the signal can be watched on
+  // a separate thread, so that they are written even while JavaScript code
+  // is busy.
+  const { signals } = internalBinding('constants').os;
+  const { startHeapSnapshotSignalWatcher } = internalBinding('heap_utils');
+  if (startHeapSnapshotSignalWatcher(signals[signal], compression) === 0)
+    return;
+
   const { writeHeapSnapshot } = require('v8');
+  process.on(signal, () => {
+    writeHeapSnapshot(undefined, { compression });
+  });
+}
+
+function initializeContinuousCpuProfiler() {
+  const signal = getOptionValue('--cpu-prof-continuous-signal');
 
+  if (!signal)
+    return;
+
+  require('internal/validators').validateSignalName(signal);
+  require('v8').startContinuousCpuProfiler();
+
+  const { writeProfile } = internalBinding('continuous_profiler');
   process.on(signal, () => {
-    writeHeapSnapshot();
+    writeProfile();
   });
 }
 
@@ -418,7 +478,12 @@ function initializeCJSLoader() {
 
 function initializeESMLoader() {
   // Create this WeakMap in js-land because V8 has no C++ API for WeakMap.
-  internalBinding('module_wrap').callbackMap = new SafeWeakMap();
+  // It is kept when the process is started from a user-land snapshot, as it
+  // holds the callbacks of the functions compiled in it.
+  const moduleWrap = internalBinding('module_wrap');
+  if (moduleWrap.callbackMap === undefined) {
+    moduleWrap.callbackMap = new SafeWeakMap();
+  }
 
   if (shouldNotRegisterESMLoader) return;
 
@@ -459,7 +524,9 @@ module.exports = {
   setupCoverageHooks,
   setupWarningHandler,
   setupDebugEnv,
+  setupAsyncContextFrame,
   prepareMainThreadExecution,
+  prepareUserlandSnapshot,
   initializeDeprecations,
   initializeESMLoader,
   initializeFrozenIntrinsics,
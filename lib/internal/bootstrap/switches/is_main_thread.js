@@ -124,11 +124,15 @@ function getStdout() {
   // Override _destroy so that the fd is never actually closed.
   stdout._destroy = dummyDestroy;
   if (stdout.isTTY) {
-    process.on('SIGWINCH', () => stdout._refreshSize());
+    process.on('SIGWINCH', refreshStdoutOnSigWinch);
   }
   return stdout;
 }
 
+function refreshStdoutOnSigWinch() {
+  stdout._refreshSize();
+}
+
 function getStderr() {
   if (stderr) return stderr;
   stderr = createWritableStdioStream(2);
@@ -136,11 +140,15 @@ function getStderr() {
   // Override _destroy so that the fd is never actually closed.
   stderr._destroy = dummyDestroy;
   if (stderr.isTTY) {
-    process.on('SIGWINCH', () => stderr._refreshSize());
+    process.on('SIGWINCH', refreshStderrOnSigWinch);
   }
   return stderr;
 }
 
+function refreshStderrOnSigWinch() {
+  stderr._refreshSize();
+}
+
 function getStdin() {
   if (stdin) return stdin;
   const fd = 0;
@@ -233,3 +241,18 @@ rawMethods.resetStdioForTesting = function() {
   stdout = undefined;
   stderr = undefined;
 };
+
+// Used by internal/main/mksnapshot. The handles of the streams cannot be
+// serialized into a user-land snapshot, so they are closed, and the streams
+// are created again when they are accessed after deserialization.
+rawMethods.resetStdioForSnapshot = function() {
+  process.removeListener('SIGWINCH', refreshStdoutOnSigWinch);
+  process.removeListener('SIGWINCH', refreshStderrOnSigWinch);
+  for (const stream of [stdin, stdout, stderr]) {
+    if (stream !== undefined && stream._handle && stream._handle.close) {
+      stream._handle.close();
+      stream._handle = null;
+    }
+  }
+  rawMethods.resetStdioForTesting();
+};
@@ -1,11 +1,17 @@
 'use strict';
 
 const {
+  ArrayPrototypePush,
+  ArrayPrototypeShift,
+  FunctionPrototypeCall,
   ObjectSetPrototypeOf,
+  Symbol,
 } = primordials;
 
 const {
   CipherBase,
+  CipherUpdateJob,
+  kCryptoJobAsync,
   privateDecrypt: _privateDecrypt,
   privateEncrypt: _privateEncrypt,
   publicDecrypt: _publicDecrypt,
@@ -25,14 +31,18 @@ const {
     ERR_CRYPTO_INVALID_STATE,
     ERR_INVALID_ARG_TYPE,
     ERR_INVALID_ARG_VALUE,
+    ERR_OUT_OF_RANGE,
   }
 } = require('internal/errors');
 
 const {
+  validateBoolean,
+  validateCallback,
   validateEncoding,
   validateInt32,
   validateObject,
   validateString,
+  validateUint32,
 } = require('internal/validators');
 
 const {
@@ -58,9 +68,20 @@ const LazyTransform = require('internal/streams/lazy_transform');
 
 const { normalizeEncoding } = require('internal/util');
 
+const { Buffer } = require('buffer');
+
 // Lazy loaded for startup performance.
 let StringDecoder;
 
+const kUpdateQueue = Symbol('kUpdateQueue');
+const kThreadpool = Symbol('kThreadpool');
+const kPendingTransform = Symbol('kPendingTransform');
+const kPendingFlush = Symbol('kPendingFlush');
+
+// The maximum number of chunks a threadpool cipher stream accepts before the
+// previous ones have been processed.
+const kMaxPipelinedUpdates = 4;
+
 function rsaFunctionFor(method, defaultPadding, keyType) {
   return (options, buffer) => {
     const { format, type, data, passphrase } =
@@ -110,6 +131,11 @@ function getUIntOption(options, key) {
 
 function createCipherBase(cipher, credential, options, decipher, iv) {
   const authTagLength = getUIntOption(options, 'authTagLength');
+  let threadpool = false;
+  if (options != null && options.threadpool !== undefined) {
+    validateBoolean(options.threadpool, 'options.threadpool');
+    threadpool = options.threadpool;
+  }
   this[kHandle] = new CipherBase(decipher);
   if (iv === undefined) {
     this[kHandle].init(cipher, credential, authTagLength);
@@ -117,10 +143,97 @@ function createCipherBase(cipher, credential, options, decipher, iv) {
     this[kHandle].initiv(cipher, credential, iv, authTagLength);
   }
   this._decoder = null;
+  this[kThreadpool] = threadpool;
+  this[kUpdateQueue] = [];
+  this[kPendingTransform] = null;
+  this[kPendingFlush] = null;
 
   LazyTransform.call(this, options);
 }
 
+// Calls of the synchronous methods would interleave with the updates that are
+// being processed on the threadpool, which use the same OpenSSL context.
+function checkNoPendingUpdates(cipher, method) {
+  if (cipher[kUpdateQueue].length > 0)
+    throw new ERR_CRYPTO_INVALID_STATE(method);
+}
+
+function getOutputOffset(output, outputOffset) {
+  if (outputOffset === undefined)
+    return 0;
+  validateUint32(outputOffset, 'outputOffset');
+  if (outputOffset > output.byteLength) {
+    throw new ERR_OUT_OF_RANGE(
+      'outputOffset', `<= ${output.byteLength}`, outputOffset);
+  }
+  return outputOffset;
+}
+
+// Runs the first queued update. Updates of the same cipher are processed one
+// at a time, in order, because each of them depends on the state that the
+// previous one left behind.
+function runNextUpdate(cipher) {
+  const queue = cipher[kUpdateQueue];
+  const { data, output, outputOffset, callback } = queue[0];
+  let job;
+  try {
+    job = new CipherUpdateJob(
+      kCryptoJobAsync, cipher[kHandle], data, output, outputOffset);
+  } catch (err) {
+    ArrayPrototypeShift(queue);
+    if (queue.length > 0)
+      runNextUpdate(cipher);
+    process.nextTick(callback, err);
+    return;
+  }
+  job.ondone = (err, result) => {
+    ArrayPrototypeShift(queue);
+    if (queue.length > 0)
+      runNextUpdate(cipher);
+    if (err !== undefined)
+      return FunctionPrototypeCall(callback, cipher, err);
+    FunctionPrototypeCall(callback, cipher, null,
+                          output === undefined ? Buffer.from(result) : result);
+  };
+  job.run();
+}
+
+function enqueueUpdate(cipher, data, output, outputOffset, callback) {
+  const queue = cipher[kUpdateQueue];
+  ArrayPrototypePush(queue, { data, output, outputOffset, callback });
+  if (queue.length === 1)
+    runNextUpdate(cipher);
+}
+
+function transformOnThreadpool(cipher, chunk, encoding, callback) {
+  if (typeof chunk === 'string')
+    chunk = Buffer.from(chunk, encoding);
+  enqueueUpdate(cipher, chunk, undefined, 0, (err, result) => {
+    if (err) {
+      cipher.destroy(err);
+      return;
+    }
+    cipher.push(result);
+    const queue = cipher[kUpdateQueue];
+    const pendingTransform = cipher[kPendingTransform];
+    if (pendingTransform !== null && queue.length < kMaxPipelinedUpdates) {
+      cipher[kPendingTransform] = null;
+      pendingTransform();
+    }
+    const pendingFlush = cipher[kPendingFlush];
+    if (pendingFlush !== null && queue.length === 0) {
+      cipher[kPendingFlush] = null;
+      FunctionPrototypeCall(Cipher.prototype._flush, cipher, pendingFlush);
+    }
+  });
+  // Accept more chunks while the pipeline is not full, so that the next chunk
+  // is already queued when the threadpool finishes the current one.
+  if (cipher[kUpdateQueue].length < kMaxPipelinedUpdates)
+    callback();
+  else
+    cipher[kPendingTransform] = callback;
+}
+
 function createCipher(cipher, password, options, decipher) {
   validateString(cipher, 'cipher');
   password = getArrayBufferOrView(password, 'password');
@@ -152,11 +265,19 @@ ObjectSetPrototypeOf(Cipher.prototype, LazyTransform.prototype);
 ObjectSetPrototypeOf(Cipher, LazyTransform);
 
 Cipher.prototype._transform = function _transform(chunk, encoding, callback) {
+  if (this[kThreadpool]) {
+    transformOnThreadpool(this, chunk, encoding, callback);
+    return;
+  }
   this.push(this[kHandle].update(chunk, encoding));
   callback();
 };
 
 Cipher.prototype._flush = function _flush(callback) {
+  if (this[kUpdateQueue].length > 0) {
+    this[kPendingFlush] = callback;
+    return;
+  }
   try {
     this.push(this[kHandle].final());
   } catch (e) {
@@ -171,6 +292,8 @@ Cipher.prototype.update = function update(data, inputEncoding, outputEncoding) {
   inputEncoding = inputEncoding || encoding;
   outputEncoding = outputEncoding || encoding;
 
+  checkNoPendingUpdates(this, 'update');
+
   if (typeof data === 'string') {
     validateEncoding(data, inputEncoding);
   } else if (!isArrayBufferView(data)) {
@@ -188,8 +311,47 @@ Cipher.prototype.update = function update(data, inputEncoding, outputEncoding) {
   return ret;
 };
 
+Cipher.prototype.updateInto = function updateInto(data, output, outputOffset) {
+  checkNoPendingUpdates(this, 'updateInto');
+  if (!isArrayBufferView(data)) {
+    throw new ERR_INVALID_ARG_TYPE(
+      'data', ['Buffer', 'TypedArray', 'DataView'], data);
+  }
+  if (!isArrayBufferView(output)) {
+    throw new ERR_INVALID_ARG_TYPE(
+      'output', ['Buffer', 'TypedArray', 'DataView'], output);
+  }
+  outputOffset = getOutputOffset(output, outputOffset);
+  return this[kHandle].updateInto(data, output, outputOffset);
+};
+
+Cipher.prototype.updateAsync = function updateAsync(data, output,
+                                                    outputOffset, callback) {
+  if (typeof output === 'function') {
+    callback = output;
+    output = undefined;
+    outputOffset = 0;
+  } else if (typeof outputOffset === 'function') {
+    callback = outputOffset;
+    outputOffset = 0;
+  }
+  validateCallback(callback);
+  if (!isArrayBufferView(data)) {
+    throw new ERR_INVALID_ARG_TYPE(
+      'data', ['Buffer', 'TypedArray', 'DataView'], data);
+  }
+  if (output !== undefined) {
+    if (!isArrayBufferView(output)) {
+      throw new ERR_INVALID_ARG_TYPE(
+        'output', ['Buffer', 'TypedArray', 'DataView'], output);
+    }
+    outputOffset = getOutputOffset(output, outputOffset);
+  }
+  enqueueUpdate(this, data, output, outputOffset, callback);
+};
 
 Cipher.prototype.final = function final(outputEncoding) {
+  checkNoPendingUpdates(this, 'final');
   outputEncoding = outputEncoding || getDefaultEncoding();
   const ret = this[kHandle].final();
 
@@ -203,12 +365,14 @@ Cipher.prototype.final = function final(outputEncoding) {
 
 
 Cipher.prototype.setAutoPadding = function setAutoPadding(ap) {
+  checkNoPendingUpdates(this, 'setAutoPadding');
   if (!this[kHandle].setAutoPadding(!!ap))
     throw new ERR_CRYPTO_INVALID_STATE('setAutoPadding');
   return this;
 };
 
 Cipher.prototype.getAuthTag = function getAuthTag() {
+  checkNoPendingUpdates(this, 'getAuthTag');
   const ret = this[kHandle].getAuthTag();
   if (ret === undefined)
     throw new ERR_CRYPTO_INVALID_STATE('getAuthTag');
@@ -217,6 +381,7 @@ Cipher.prototype.getAuthTag = function getAuthTag() {
 
 
 function setAuthTag(tagbuf, encoding) {
+  checkNoPendingUpdates(this, 'setAuthTag');
   tagbuf = getArrayBufferOrView(tagbuf, 'buffer', encoding);
   if (!this[kHandle].setAuthTag(tagbuf))
     throw new ERR_CRYPTO_INVALID_STATE('setAuthTag');
@@ -224,6 +389,7 @@ function setAuthTag(tagbuf, encoding) {
 }
 
 Cipher.prototype.setAAD = function setAAD(aadbuf, options) {
+  checkNoPendingUpdates(this, 'setAAD');
   const encoding = getStringOption(options, 'encoding');
   const plaintextLength = getUIntOption(options, 'plaintextLength');
   aadbuf = getArrayBufferOrView(aadbuf, 'aadbuf', encoding);
@@ -248,6 +414,8 @@ function addCipherPrototypeFunctions(constructor) {
   constructor.prototype._transform = Cipher.prototype._transform;
   constructor.prototype._flush = Cipher.prototype._flush;
   constructor.prototype.update = Cipher.prototype.update;
+  constructor.prototype.updateInto = Cipher.prototype.updateInto;
+  constructor.prototype.updateAsync = Cipher.prototype.updateAsync;
   constructor.prototype.final = Cipher.prototype.final;
   constructor.prototype.setAutoPadding = Cipher.prototype.setAutoPadding;
   if (constructor === Cipheriv) {
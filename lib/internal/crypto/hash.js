@@ -1,15 +1,22 @@
 'use strict';
 
 const {
+  ArrayIsArray,
+  ArrayPrototypeMap,
+  FunctionPrototypeCall,
   ObjectSetPrototypeOf,
   Symbol,
+  Uint32Array,
 } = primordials;
 
 const {
   Hash: _Hash,
+  HashBatchJob,
   HashJob,
   Hmac: _Hmac,
   kCryptoJobAsync,
+  kCryptoJobSync,
+  oneShotDigest,
 } = internalBinding('crypto');
 
 const {
@@ -36,11 +43,13 @@ const {
     ERR_CRYPTO_HASH_FINALIZED,
     ERR_CRYPTO_HASH_UPDATE_FAILED,
     ERR_INVALID_ARG_TYPE,
+    ERR_INVALID_CALLBACK,
   }
 } = require('internal/errors');
 
 const {
   validateEncoding,
+  validateObject,
   validateString,
   validateUint32,
 } = require('internal/validators');
@@ -177,8 +186,122 @@ async function asyncDigest(algorithm, data) {
     algorithm.length));
 }
 
+// One-shot and batch hashing. These skip the Hash object (and its
+// EVP_MD_CTX) entirely, which matters when hashing many small inputs.
+
+function hash(algorithm, data, outputEncoding = 'hex') {
+  validateString(algorithm, 'algorithm');
+  if (typeof data !== 'string' && !isArrayBufferView(data)) {
+    throw new ERR_INVALID_ARG_TYPE(
+      'data', ['string', 'Buffer', 'TypedArray', 'DataView'], data);
+  }
+  validateString(outputEncoding, 'outputEncoding');
+  return oneShotDigest(algorithm, data, outputEncoding);
+}
+
+function toBatchInput(data) {
+  if (typeof data === 'string')
+    return Buffer.from(data, 'utf8');
+  if (!isArrayBufferView(data)) {
+    throw new ERR_INVALID_ARG_TYPE(
+      'data', ['string', 'Buffer', 'TypedArray', 'DataView'], data);
+  }
+  return data;
+}
+
+// `key` is undefined for plain digests and the prepared secret for HMAC.
+function prepareBatch(mode, algorithm, key, data, options) {
+  validateString(algorithm, 'algorithm');
+  if (options !== undefined)
+    validateObject(options, 'options');
+  const offsets = options?.offsets;
+
+  if (offsets === undefined) {
+    if (!ArrayIsArray(data)) {
+      throw new ERR_INVALID_ARG_TYPE(
+        'data', ['Array', 'Buffer', 'TypedArray', 'DataView'], data);
+    }
+    return new HashBatchJob(
+      mode, algorithm, key, ArrayPrototypeMap(data, toBatchInput));
+  }
+
+  if (!isArrayBufferView(data)) {
+    throw new ERR_INVALID_ARG_TYPE(
+      'data', ['Buffer', 'TypedArray', 'DataView'], data);
+  }
+  let boundaries = offsets;
+  if (ArrayIsArray(boundaries)) {
+    for (let n = 0; n < boundaries.length; n++)
+      validateUint32(boundaries[n], `options.offsets[${n}]`);
+    boundaries = new Uint32Array(boundaries);
+  } else if (!(boundaries instanceof Uint32Array)) {
+    throw new ERR_INVALID_ARG_TYPE(
+      'options.offsets', ['Array', 'Uint32Array'], offsets);
+  }
+  if (boundaries.length === 0)
+    boundaries = new Uint32Array(1);
+  return new HashBatchJob(mode, algorithm, key, data, boundaries);
+}
+
+function runBatch(job, callback) {
+  job.ondone = (err, result) => {
+    if (err !== undefined)
+      return FunctionPrototypeCall(callback, job, err);
+    FunctionPrototypeCall(callback, job, null, Buffer.from(result));
+  };
+  job.run();
+}
+
+function runBatchSync(job) {
+  const { 0: err, 1: result } = job.run();
+  if (err !== undefined)
+    throw err;
+  return Buffer.from(result);
+}
+
+function hashBatch(algorithm, data, options, callback) {
+  if (typeof options === 'function') {
+    callback = options;
+    options = undefined;
+  }
+  if (typeof callback !== 'function')
+    throw new ERR_INVALID_CALLBACK(callback);
+  runBatch(
+    prepareBatch(kCryptoJobAsync, algorithm, undefined, data, options),
+    callback);
+}
+
+function hashBatchSync(algorithm, data, options) {
+  return runBatchSync(
+    prepareBatch(kCryptoJobSync, algorithm, undefined, data, options));
+}
+
+function hmacBatch(algorithm, key, data, options, callback) {
+  if (typeof options === 'function') {
+    callback = options;
+    options = undefined;
+  }
+  if (typeof callback !== 'function')
+    throw new ERR_INVALID_CALLBACK(callback);
+  key = prepareSecretKey(key);
+  runBatch(
+    prepareBatch(kCryptoJobAsync, algorithm, key, data, options),
+    callback);
+}
+
+function hmacBatchSync(algorithm, key, data, options) {
+  key = prepareSecretKey(key);
+  return runBatchSync(
+    prepareBatch(kCryptoJobSync, algorithm, key, data, options));
+}
+
 module.exports = {
   Hash,
   Hmac,
   asyncDigest,
+  hash,
+  hashBatch,
+  hashBatchSync,
+  hmacBatch,
+  hmacBatchSync,
 };
@@ -12,6 +12,8 @@ const {
   RandomBytesJob,
   kCryptoJobAsync,
   kCryptoJobSync,
+  kRandomPoolMaxRequestSize,
+  randomFillFromPool,
 } = internalBinding('crypto');
 
 const {
@@ -111,6 +113,12 @@ function randomFillSync(buf, offset = 0, size) {
   if (size === 0)
     return buf;
 
+  // Small requests are served from a pool of pre-generated bytes.
+  if (size <= kRandomPoolMaxRequestSize &&
+      randomFillFromPool(buf, offset, size)) {
+    return buf;
+  }
+
   const job = new RandomBytesJob(
     kCryptoJobSync,
     buf.buffer || buf,
@@ -158,6 +166,14 @@ function randomFill(buf, offset, size, callback) {
     return;
   }
 
+  // Small requests are served from a pool of pre-generated bytes, without a
+  // round trip through the threadpool.
+  if (size <= kRandomPoolMaxRequestSize &&
+      randomFillFromPool(buf, offset, size)) {
+    process.nextTick(callback, null, buf);
+    return;
+  }
+
   // TODO(@jasnell): This is not yet handling byte offsets right
   const job = new RandomBytesJob(
     kCryptoJobAsync,
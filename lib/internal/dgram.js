@@ -11,6 +11,10 @@ const { isInt32 } = require('internal/validators');
 const { UV_EINVAL } = internalBinding('uv');
 const { ERR_INVALID_ARG_TYPE, ERR_SOCKET_BAD_TYPE } = codes;
 const kStateSymbol = Symbol('state symbol');
+// Internal option that makes the socket read multiple datagrams at once
+// using recvmmsg() where available. The `message` event handler does not
+// benefit from it, so it is only used for native consumers such as QUIC.
+const kUseRecvMmsg = Symbol('kUseRecvMmsg');
 let dns;  // Lazy load for startup performance.
 
 
@@ -23,7 +27,7 @@ function lookup6(lookup, address, callback) {
   return lookup(address || '::1', 6, callback);
 }
 
-function newHandle(type, lookup) {
+function newHandle(type, lookup, recvmmsg = false) {
   if (lookup === undefined) {
     if (dns === undefined) {
       dns = require('dns');
@@ -35,14 +39,14 @@ function newHandle(type, lookup) {
   }
 
   if (type === 'udp4') {
-    const handle = new UDP();
+    const handle = new UDP(recvmmsg);
 
     handle.lookup = lookup4.bind(handle, lookup);
     return handle;
   }
 
   if (type === 'udp6') {
-    const handle = new UDP();
+    const handle = new UDP(recvmmsg);
 
     handle.lookup = lookup6.bind(handle, lookup);
     handle.bind = handle.bind6;
@@ -81,6 +85,7 @@ function _createSocketHandle(address, port, addressType, fd, flags) {
 
 module.exports = {
   kStateSymbol,
+  kUseRecvMmsg,
   _createSocketHandle,
   newHandle
 };
@@ -5,13 +5,24 @@ const {
 } = require('internal/util');
 
 const { format } = require('util');
-const { Map, Symbol } = primordials;
+const { Map, NumberMAX_SAFE_INTEGER, Symbol } = primordials;
+
+const {
+  RecordableHistogram: _RecordableHistogram,
+  createLatencyHistogram: _createLatencyHistogram,
+} = internalBinding('performance');
 
 const {
   ERR_INVALID_ARG_TYPE,
   ERR_INVALID_ARG_VALUE,
 } = require('internal/errors').codes;
 
+const {
+  validateBoolean,
+  validateInteger,
+  validateObject,
+} = require('internal/validators');
+
 const kDestroy = Symbol('kDestroy');
 const kHandle = Symbol('kHandle');
 
@@ -87,8 +98,56 @@ class Histogram {
   get [kHandle]() { return this.#handle; }
 }
 
+// A Histogram that values can be recorded into, from JavaScript and from
+// native threads. The values are recorded into per-thread shards, which are
+// merged when the histogram is read.
+class RecordableHistogram extends Histogram {
+  record(val) {
+    validateInteger(val, 'val', 1);
+    if (this[kHandle])
+      this[kHandle].record(val);
+  }
+
+  recordDelta() {
+    if (this[kHandle])
+      this[kHandle].recordDelta();
+  }
+
+  snapshot(options = {}) {
+    validateObject(options, 'options');
+    const { reset = false } = options;
+    validateBoolean(reset, 'options.reset');
+    if (!this[kHandle])
+      return undefined;
+    return new Histogram(this[kHandle].snapshot(reset));
+  }
+}
+
+function createHistogram(options = {}) {
+  validateObject(options, 'options');
+  const {
+    lowest = 1,
+    highest = NumberMAX_SAFE_INTEGER,
+    figures = 3,
+  } = options;
+  validateInteger(lowest, 'options.lowest', 1);
+  validateInteger(highest, 'options.highest', 2 * lowest);
+  validateInteger(figures, 'options.figures', 1, 5);
+  return new RecordableHistogram(
+    new _RecordableHistogram(lowest, highest, figures));
+}
+
+// Creates a Histogram of latencies in nanoseconds that is recorded into by
+// native code. Values greater than one hour are counted in `exceeds`.
+function createLatencyHistogram() {
+  return new Histogram(_createLatencyHistogram());
+}
+
 module.exports = {
   Histogram,
+  RecordableHistogram,
+  createHistogram,
+  createLatencyHistogram,
   kDestroy,
   kHandle,
 };
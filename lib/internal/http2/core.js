@@ -159,9 +159,8 @@ const {
   kReadBytesOrError,
   streamBaseState
 } = internalBinding('stream_wrap');
-const { UV_EOF } = internalBinding('uv');
+const { UV_EOF, UV_ECANCELED } = internalBinding('uv');
 
-const { StreamPipe } = internalBinding('stream_pipe');
 const { _connectionListener: httpConnectionListener } = http;
 let debug = require('internal/util/debuglog').debuglog('http2', (fn) => {
   debug = fn;
@@ -2318,21 +2317,21 @@ function processHeaders(oldHeaders, options) {
 }
 
 
-function onFileUnpipe() {
-  const stream = this.sink[kOwner];
+// The data is read by the Http2Stream itself, so this is only called for
+// End-of-File and errors, or with UV_ECANCELED when the Http2Stream has been
+// destroyed before the end of the file. Either way, the file is no longer
+// needed.
+function onPulledFileHandleRead() {
+  const err = streamBaseState[kReadBytesOrError];
+  if (err >= 0)
+    return;
+  const stream = this.stream;
   if (stream.ownsFd)
-    this.source.close().catch(stream.destroy.bind(stream));
+    this.close().catch(stream.destroy.bind(stream));
   else
-    this.source.releaseFD();
-}
-
-// This is only called once the pipe has returned back control, so
-// it only has to handle errors and End-of-File.
-function onPipedFileHandleRead() {
-  const err = streamBaseState[kReadBytesOrError];
-  if (err < 0 && err !== UV_EOF) {
-    this.stream.close(NGHTTP2_INTERNAL_ERROR);
-  }
+    this.releaseFD();
+  if (err !== UV_EOF && err !== UV_ECANCELED)
+    stream.close(NGHTTP2_INTERNAL_ERROR);
 }
 
 function processRespondWithFD(self, fd, headers, offset = 0, length = -1,
@@ -2367,12 +2366,11 @@ function processRespondWithFD(self, fd, headers, offset = 0, length = -1,
 
 function startFilePipe(self, fd, offset, length) {
   const handle = new FileHandle(fd, offset, length);
-  handle.onread = onPipedFileHandleRead;
+  handle.onread = onPulledFileHandleRead;
   handle.stream = self;
 
-  const pipe = new StreamPipe(handle, self[kHandle]);
-  pipe.onunpipe = onFileUnpipe;
-  pipe.start();
+  // The file is read ahead into memory that is handed to nghttp2 as is.
+  self[kHandle].pullFrom(handle);
 
   // Exact length of the file doesn't matter here, since the
   // stream is closing anyway - just use 1 to signify that
@@ -2615,10 +2613,18 @@ class ServerHttp2Stream extends Http2Stream {
     assertIsObject(options, 'options');
     options = { ...options };
 
+    const { body } = options;
+    if (body !== undefined && !isArrayBufferView(body)) {
+      throw new ERR_INVALID_ARG_TYPE('options.body',
+                                     ['Buffer', 'TypedArray', 'DataView'],
+                                     body);
+    }
+
     debugStreamObj(this, 'initiating response');
     this[kUpdateTimer]();
 
-    options.endStream = !!options.endStream;
+    // The stream ends after the body, if there is one.
+    options.endStream = !!options.endStream && body === undefined;
 
     let streamOptions = 0;
     if (options.endStream)
@@ -2631,25 +2637,43 @@ class ServerHttp2Stream extends Http2Stream {
 
     headers = processHeaders(headers, options);
     const headersList = mapToHeaders(headers, assertValidPseudoHeaderResponse);
+
+    const statusCode = headers[HTTP2_HEADER_STATUS] | 0;
+    const payloadForbidden = statusCode === HTTP_STATUS_NO_CONTENT ||
+                             statusCode === HTTP_STATUS_RESET_CONTENT ||
+                             statusCode === HTTP_STATUS_NOT_MODIFIED ||
+                             this.headRequest === true;
+    if (payloadForbidden && body !== undefined)
+      throw new ERR_HTTP2_PAYLOAD_FORBIDDEN(statusCode);
+
     this[kSentHeaders] = headers;
 
     state.flags |= STREAM_FLAGS_HEADERS_SENT;
 
     // Close the writable side if the endStream option is set or status
     // is one of known codes with no payload, or it's a head request
-    const statusCode = headers[HTTP2_HEADER_STATUS] | 0;
-    if (!!options.endStream ||
-        statusCode === HTTP_STATUS_NO_CONTENT ||
-        statusCode === HTTP_STATUS_RESET_CONTENT ||
-        statusCode === HTTP_STATUS_NOT_MODIFIED ||
-        this.headRequest === true) {
+    if (!!options.endStream || payloadForbidden) {
       options.endStream = true;
       this.end();
+    } else if (body !== undefined) {
+      // Close the writable side of the stream, but only as far as the
+      // writable stream implementation is concerned. The native side ends
+      // the stream once the body has been queued.
+      this._final = null;
+      this.end();
     }
 
     const ret = this[kHandle].respond(headersList, streamOptions);
-    if (ret < 0)
+    if (ret < 0) {
       this.destroy(new NghttpError(ret));
+      return;
+    }
+
+    if (body !== undefined) {
+      // The memory of the body is handed to nghttp2 as is.
+      this[kHandle].sendBody(body);
+      trackWriteState(this, 1);
+    }
   }
 
   // Initiate a response using an open FD. Note that there are fewer
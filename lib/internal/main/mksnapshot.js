@@ -0,0 +1,32 @@
+'use strict';
+
+// Runs the entry point passed to `node --build-snapshot`. Once the event loop
+// is empty, the heap is serialized into a user-land snapshot by
+// SnapshotBuilder in C++.
+
+const {
+  prepareMainThreadExecution,
+  prepareUserlandSnapshot
+} = require('internal/bootstrap/pre_execution');
+
+prepareMainThreadExecution(true);
+
+process.once('beforeExit', function prepareForSerialization() {
+  const {
+    runSerializeCallbacks
+  } = require('internal/v8/startup_snapshot');
+  runSerializeCallbacks();
+
+  // The stdio streams hold on to handles, which cannot be serialized. They
+  // are created again on first use after the snapshot is deserialized.
+  internalBinding('process_methods').resetStdioForSnapshot();
+  const console = require('internal/console/global');
+  console._stdout = undefined;
+  console._stderr = undefined;
+
+  prepareUserlandSnapshot();
+});
+
+markBootstrapComplete();
+
+require('internal/modules/cjs/loader').Module.runMain(process.argv[1]);
@@ -13,6 +13,7 @@ const {
   setupInspectorHooks,
   setupWarningHandler,
   setupDebugEnv,
+  setupAsyncContextFrame,
   initializeDeprecations,
   initializeWASI,
   initializeCJSLoader,
@@ -58,6 +59,7 @@ const assert = require('internal/assert');
 patchProcessObject();
 setupInspectorHooks();
 setupDebugEnv();
+setupAsyncContextFrame();
 
 setupWarningHandler();
 
@@ -24,6 +24,7 @@
 const {
   ArrayIsArray,
   ArrayPrototypeJoin,
+  ArrayPrototypePush,
   Error,
   JSONParse,
   Map,
@@ -72,7 +73,12 @@ const fs = require('fs');
 const internalFS = require('internal/fs/utils');
 const path = require('path');
 const { sep } = path;
-const { internalModuleStat } = internalBinding('fs');
+const {
+  clearModuleStatCache,
+  internalModuleStat,
+  lookupModuleResolution,
+  recordModuleResolution,
+} = internalBinding('fs');
 const packageJsonReader = require('internal/modules/package_json_reader');
 const { safeGetenv } = internalBinding('credentials');
 const {
@@ -89,6 +95,16 @@ const preserveSymlinksMain = getOptionValue('--preserve-symlinks-main');
 const policy = getOptionValue('--experimental-policy') ?
   require('internal/process/policy') :
   null;
+// With --compile-cache-dir, the results of Module._findPath() are stored on
+// disk along with the paths they depend on, and are reused by subsequent
+// runs. Policies need the package.json files to be read, so that their
+// integrity can be checked.
+const useResolutionCache =
+  getOptionValue('--compile-cache-dir') !== '' && policy === null;
+const resolutionKeyPrefix = useResolutionCache ?
+  `${preserveSymlinks}\x00${preserveSymlinksMain}\x00` +
+  `${getOptionValue('--conditions')}\x00` :
+  undefined;
 const { compileFunction } = internalBinding('contextify');
 
 // Whether any user-provided CJS modules had been loaded (executed).
@@ -127,17 +143,20 @@ const isWindows = process.platform === 'win32';
 const relativeResolveCache = ObjectCreate(null);
 
 let requireDepth = 0;
-let statCache = null;
+let statCacheEnabled = false;
+// The paths and package.json files that the resolution in progress has
+// looked at, when it is going to be recorded in the resolution cache.
+let resolutionPaths = null;
+let resolutionFiles = null;
 
 function stat(filename) {
   filename = path.toNamespacedPath(filename);
-  if (statCache !== null) {
-    const result = statCache.get(filename);
-    if (result !== undefined) return result;
-  }
-  const result = internalModuleStat(filename);
-  if (statCache !== null) statCache.set(filename, result);
-  return result;
+  if (resolutionPaths !== null) ArrayPrototypePush(resolutionPaths, filename);
+  return internalModuleStat(filename, statCacheEnabled);
+}
+
+function recordResolution(key, filename) {
+  recordModuleResolution(key, filename, resolutionPaths, resolutionFiles);
 }
 
 function updateChildren(parent, child, scan) {
@@ -263,11 +282,26 @@ const packageJsonCache = new SafeMap();
 
 function readPackage(requestPath) {
   const jsonPath = path.resolve(requestPath, 'package.json');
+  if (resolutionFiles !== null)
+    ArrayPrototypePush(resolutionFiles, path.toNamespacedPath(jsonPath));
 
   const existing = packageJsonCache.get(jsonPath);
   if (existing !== undefined) return existing;
 
   const result = packageJsonReader.read(jsonPath);
+  if (result.fields !== undefined) {
+    const { fields } = result;
+    const filtered = {
+      name: fields.name,
+      main: fields.main,
+      exports: fields.exports,
+      imports: fields.imports,
+      type: fields.type
+    };
+    packageJsonCache.set(jsonPath, filtered);
+    return filtered;
+  }
+
   const json = result.containsKeys === false ? '{}' : result.string;
   if (json === undefined) {
     packageJsonCache.set(jsonPath, false);
@@ -479,6 +513,32 @@ Module._findPath = function(request, paths, isMain) {
   if (entry)
     return entry;
 
+  let resolutionKey;
+  if (useResolutionCache) {
+    resolutionKey = `${resolutionKeyPrefix}${isMain ? 1 : 0}\x00` +
+                    `${ObjectKeys(Module._extensions)}\x00${cacheKey}`;
+    const filename = lookupModuleResolution(resolutionKey);
+    if (filename !== undefined) {
+      Module._pathCache[cacheKey] = filename;
+      return filename;
+    }
+    resolutionPaths = [];
+    resolutionFiles = [];
+    try {
+      return findPath(request, paths, isMain, cacheKey, resolutionKey);
+    } finally {
+      // Also when the resolution throws, so that the next one does not
+      // record into stale arrays.
+      resolutionPaths = null;
+      resolutionFiles = null;
+    }
+  }
+
+  return findPath(request, paths, isMain, cacheKey);
+};
+
+function findPath(request, paths, isMain, cacheKey, resolutionKey) {
+  const absoluteRequest = path.isAbsolute(request);
   let exts;
   let trailingSlash = request.length > 0 &&
     request.charCodeAt(request.length - 1) === CHAR_FORWARD_SLASH;
@@ -494,8 +554,11 @@ Module._findPath = function(request, paths, isMain) {
 
     if (!absoluteRequest) {
       const exportsResolved = resolveExports(curPath, request);
-      if (exportsResolved)
+      if (exportsResolved) {
+        if (resolutionKey !== undefined)
+          recordResolution(resolutionKey, exportsResolved);
         return exportsResolved;
+      }
     }
 
     const basePath = path.resolve(curPath, request);
@@ -542,12 +605,14 @@ Module._findPath = function(request, paths, isMain) {
 
     if (filename) {
       Module._pathCache[cacheKey] = filename;
+      if (resolutionKey !== undefined)
+        recordResolution(resolutionKey, filename);
       return filename;
     }
   }
 
   return false;
-};
+}
 
 // 'node_modules' character codes reversed
 const nmChars = [ 115, 101, 108, 117, 100, 111, 109, 95, 101, 100, 111, 110 ];
@@ -1011,7 +1076,8 @@ function wrapSafe(filename, content, cjsModuleInstance) {
         'module',
         '__filename',
         '__dirname',
-      ]
+      ],
+      true // Use the compile cache, if enabled.
     );
   } catch (err) {
     if (process.mainModule === cjsModuleInstance)
@@ -1075,7 +1141,10 @@ Module.prototype._compile = function(content, filename) {
   const exports = this.exports;
   const thisValue = exports;
   const module = this;
-  if (requireDepth === 0) statCache = new Map();
+  if (requireDepth === 0) {
+    clearModuleStatCache();
+    statCacheEnabled = true;
+  }
   if (inspectorWrapper) {
     result = inspectorWrapper(compiledWrapper, thisValue, exports,
                               require, module, filename, dirname);
@@ -1084,7 +1153,10 @@ Module.prototype._compile = function(content, filename) {
                                   filename, dirname);
   }
   hasLoadedAnyUserCJSModule = true;
-  if (requireDepth === 0) statCache = null;
+  if (requireDepth === 0) {
+    statCacheEnabled = false;
+    clearModuleStatCache();
+  }
   return result;
 };
 
@@ -87,8 +87,8 @@ function getPackageConfig(path, specifier, base) {
   if (existing !== undefined) {
     return existing;
   }
-  const source = packageJsonReader.read(path).string;
-  if (source === undefined) {
+  const { string: source, fields } = packageJsonReader.read(path);
+  if (source === undefined && fields === undefined) {
     const packageConfig = {
       pjsonPath: path,
       exists: false,
@@ -102,15 +102,17 @@ function getPackageConfig(path, specifier, base) {
     return packageConfig;
   }
 
-  let packageJSON;
-  try {
-    packageJSON = JSONParse(source);
-  } catch (error) {
-    throw new ERR_INVALID_PACKAGE_CONFIG(
-      path,
-      (base ? `"${specifier}" from ` : '') + fileURLToPath(base || specifier),
-      error.message
-    );
+  let packageJSON = fields;
+  if (packageJSON === undefined) {
+    try {
+      packageJSON = JSONParse(source);
+    } catch (error) {
+      throw new ERR_INVALID_PACKAGE_CONFIG(
+        path,
+        (base ? `"${specifier}" from ` : '') + fileURLToPath(base || specifier),
+        error.message
+      );
+    }
   }
 
   let { imports, main, name, type } = packageJSON;
@@ -138,7 +138,8 @@ translators.set('module', async function moduleStrategy(url) {
   source = stringify(source);
   maybeCacheSourceMap(url, source);
   debug(`Translating StandardModule ${url}`);
-  const module = new ModuleWrap(url, undefined, source, 0, 0);
+  const module = new ModuleWrap(url, undefined, source, 0, 0, undefined,
+                                StringPrototypeStartsWith(url, 'file:'));
   moduleWrap.callbackMap.set(module, {
     initializeImportMeta,
     importModuleDynamically,
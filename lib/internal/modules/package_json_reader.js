@@ -1,7 +1,10 @@
 'use strict';
 
-const { SafeMap } = primordials;
-const { internalModuleReadJSON } = internalBinding('fs');
+const { ArrayIsArray, SafeMap } = primordials;
+const {
+  internalModuleReadJSON,
+  internalModuleReadPackageJSON,
+} = internalBinding('fs');
 const { pathToFileURL } = require('url');
 const { toNamespacedPath } = require('path');
 
@@ -10,7 +13,10 @@ const cache = new SafeMap();
 let manifest;
 
 /**
- *
+ * Reads a package.json file. Unless a policy manifest needs to check the
+ * integrity of the whole file, the fields used by the module loaders are
+ * extracted natively and returned as `fields`. Otherwise, and if the file
+ * is not valid JSON, its source is returned as `string`.
  * @param {string} jsonPath
  */
 function read(jsonPath) {
@@ -18,21 +24,33 @@ function read(jsonPath) {
     return cache.get(jsonPath);
   }
 
+  if (manifest === undefined) {
+    const { getOptionValue } = require('internal/options');
+    manifest = getOptionValue('--experimental-policy') ?
+      require('internal/process/policy').manifest :
+      null;
+  }
+
+  if (manifest === null) {
+    const fields = internalModuleReadPackageJSON(toNamespacedPath(jsonPath));
+    let result;
+    if (ArrayIsArray(fields)) {
+      const { 0: string, 1: containsKeys } = fields;
+      result = { string, containsKeys, fields: undefined };
+    } else {
+      result = { string: undefined, containsKeys: undefined, fields };
+    }
+    cache.set(jsonPath, result);
+    return result;
+  }
+
   const [string, containsKeys] = internalModuleReadJSON(
     toNamespacedPath(jsonPath)
   );
-  const result = { string, containsKeys };
-  const { getOptionValue } = require('internal/options');
+  const result = { string, containsKeys, fields: undefined };
   if (string !== undefined) {
-    if (manifest === undefined) {
-      manifest = getOptionValue('--experimental-policy') ?
-        require('internal/process/policy').manifest :
-        null;
-    }
-    if (manifest !== null) {
-      const jsonURL = pathToFileURL(jsonPath);
-      manifest.assertIntegrity(jsonURL, string);
-    }
+    const jsonURL = pathToFileURL(jsonPath);
+    manifest.assertIntegrity(jsonURL, string);
   }
   cache.set(jsonPath, result);
   return result;
@@ -1,12 +1,29 @@
 'use strict';
 
 const { getOptions, shouldNotRegisterESMLoader } = internalBinding('options');
-const { options, aliases } = getOptions();
 
 let warnOnAllowUnauthorized = true;
 
+let optionsMap;
+let aliasesMap;
+
+// The options are copied from C++ the first time they are queried.
+function getOptionsFromBinding() {
+  if (!optionsMap) {
+    ({ options: optionsMap } = getOptions());
+  }
+  return optionsMap;
+}
+
+function getAliasesFromBinding() {
+  if (!aliasesMap) {
+    ({ aliases: aliasesMap } = getOptions());
+  }
+  return aliasesMap;
+}
+
 function getOptionValue(option) {
-  const result = options.get(option);
+  const result = getOptionsFromBinding().get(option);
   if (!result) {
     return undefined;
   }
@@ -27,10 +44,22 @@ function getAllowUnauthorized() {
   return allowUnauthorized;
 }
 
+// The options are cached, so they need to be read again when the process is
+// started from a user-land snapshot that was built with different options.
+function refreshOptions() {
+  optionsMap = undefined;
+  aliasesMap = undefined;
+}
+
 module.exports = {
-  options,
-  aliases,
+  get options() {
+    return getOptionsFromBinding();
+  },
+  get aliases() {
+    return getAliasesFromBinding();
+  },
   getOptionValue,
   getAllowUnauthorized,
+  refreshOptions,
   shouldNotRegisterESMLoader
 };
@@ -31,8 +31,9 @@ const {
   emitBefore,
   emitAfter,
   emitDestroy,
-  symbols: { async_id_symbol, trigger_async_id_symbol }
+  symbols: { async_id_symbol, trigger_async_id_symbol, async_context_frame }
 } = require('internal/async_hooks');
+const AsyncContextFrame = require('internal/async_context_frame');
 const {
   ERR_INVALID_CALLBACK,
   ERR_INVALID_ARG_TYPE
@@ -66,6 +67,8 @@ function processTicksAndRejections() {
   let tock;
   do {
     while (tock = queue.shift()) {
+      const priorContextFrame =
+        AsyncContextFrame.exchange(tock[async_context_frame]);
       const asyncId = tock[async_id_symbol];
       emitBefore(asyncId, tock[trigger_async_id_symbol], tock);
 
@@ -84,6 +87,7 @@ function processTicksAndRejections() {
           }
         }
       } finally {
+        AsyncContextFrame.enter(priorContextFrame);
         if (destroyHooksExist())
           emitDestroy(asyncId);
       }
@@ -124,6 +128,7 @@ function nextTick(callback) {
   const tickObject = {
     [async_id_symbol]: asyncId,
     [trigger_async_id_symbol]: triggerAsyncId,
+    [async_context_frame]: AsyncContextFrame.current(),
     callback,
     args
   };
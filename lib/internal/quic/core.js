@@ -78,6 +78,7 @@ const {
   constants: {
     UV_UDP_IPV6ONLY,
     UV_UDP_REUSEADDR,
+    UDP_REUSEPORT,
   }
 } = internalBinding('udp_wrap');
 
@@ -115,8 +116,7 @@ const {
 } = require('internal/errors');
 
 const { FileHandle } = internalBinding('fs');
-const { StreamPipe } = internalBinding('stream_pipe');
-const { UV_EOF } = internalBinding('uv');
+const { UV_EOF, UV_ECANCELED } = internalBinding('uv');
 
 const {
   QuicSocket: QuicSocketHandle,
@@ -169,6 +169,8 @@ const {
     IDX_QUIC_SOCKET_STATS_CLIENT_SESSIONS,
     IDX_QUIC_SOCKET_STATS_STATELESS_RESET_COUNT,
     IDX_QUIC_SOCKET_STATS_SERVER_BUSY_COUNT,
+    IDX_QUIC_SOCKET_STATS_SEND_CALLS,
+    IDX_QUIC_SOCKET_STATS_PACKETS_MISROUTED,
     ERR_FAILED_TO_CREATE_SESSION,
     ERR_INVALID_REMOTE_TRANSPORT_PARAMS,
     ERR_INVALID_TLS_SESSION_TICKET,
@@ -179,6 +181,7 @@ const {
     QUICSERVERSESSION_OPTION_REQUEST_CERT,
     QUICCLIENTSESSION_OPTION_REQUEST_OCSP,
     QUICCLIENTSESSION_OPTION_VERIFY_HOSTNAME_IDENTITY,
+    QUICSOCKET_OPTIONS_TRACK_SEND_REQUESTS,
     QUICSOCKET_OPTIONS_VALIDATE_ADDRESS,
     QUICSTREAM_HEADERS_KIND_NONE,
     QUICSTREAM_HEADERS_KIND_INFORMATIONAL,
@@ -222,8 +225,7 @@ const kInternalServerState = Symbol('kInternalServerState');
 const kListen = Symbol('kListen');
 const kMaybeBind = Symbol('kMaybeBind');
 const kOnFileOpened = Symbol('kOnFileOpened');
-const kOnFileUnpipe = Symbol('kOnFileUnpipe');
-const kOnPipedFileHandleRead = Symbol('kOnPipedFileHandleRead');
+const kOnPulledFileHandleRead = Symbol('kOnPulledFileHandleRead');
 const kReady = Symbol('kReady');
 const kRemoveFromSocket = Symbol('kRemoveFromSocket');
 const kRemoveSession = Symbol('kRemove');
@@ -584,6 +586,7 @@ class QuicEndpoint {
     lookup: undefined,
     port: undefined,
     reuseAddr: undefined,
+    reusePort: undefined,
     type: undefined,
     fd: undefined
   };
@@ -595,6 +598,7 @@ class QuicEndpoint {
       lookup,
       port = 0,
       reuseAddr,
+      reusePort,
       type,
       preferred,
     } = validateQuicEndpointOptions(options);
@@ -605,8 +609,13 @@ class QuicEndpoint {
     state.ipv6Only = ipv6Only;
     state.port = port;
     state.reuseAddr = reuseAddr;
+    state.reusePort = reusePort;
     state.type = type;
-    state.udpSocket = dgram.createSocket(type === AF_INET6 ? 'udp6' : 'udp4');
+    state.udpSocket = dgram.createSocket({
+      type: type === AF_INET6 ? 'udp6' : 'udp4',
+      // Incoming packets are handled natively, so read them in batches.
+      [internalDgram.kUseRecvMmsg]: true,
+    });
 
     // kUDPHandleForTesting is only used in the Node.js test suite to
     // artificially test the endpoint. This code path should never be
@@ -700,6 +709,7 @@ class QuicEndpoint {
 
       const flags =
         (state.reuseAddr ? UV_UDP_REUSEADDR : 0) |
+        (state.reusePort ? UDP_REUSEPORT : 0) |
         (state.ipv6Only ? UV_UDP_IPV6ONLY : 0);
 
       const ret = udpHandle.bind(ip, state.port, flags);
@@ -906,6 +916,7 @@ class QuicSocket extends EventEmitter {
     ocspHandler: undefined,
     clientHelloHandler: undefined,
     server: undefined,
+    serverId: undefined,
     serverSecureContext: undefined,
     sessions: new Set(),
     state: kSocketUnbound,
@@ -949,6 +960,16 @@ class QuicSocket extends EventEmitter {
 
       // When true, stateless resets will not be sent (default false)
       disableStatelessReset,
+
+      // When true, every outgoing packet is sent using a SendWrap that is
+      // visible to async_hooks (default false)
+      trackSendRequests,
+
+      // Retry token secret (16 byte buffer)
+      retryTokenSecret,
+
+      // First byte of the connection IDs issued by sessions of this socket
+      serverId,
     } = validateQuicSocketOptions(options);
     super({ captureRejections: true });
 
@@ -956,11 +977,14 @@ class QuicSocket extends EventEmitter {
 
     state.client = client;
     state.server = server;
+    state.serverId = serverId;
     state.lookup = lookup;
 
     let socketOptions = 0;
     if (validateAddress)
       socketOptions |= (1 << QUICSOCKET_OPTIONS_VALIDATE_ADDRESS);
+    if (trackSendRequests)
+      socketOptions |= (1 << QUICSOCKET_OPTIONS_TRACK_SEND_REQUESTS);
 
     this[kSetHandle](
       new QuicSocketHandle(
@@ -971,7 +995,9 @@ class QuicSocket extends EventEmitter {
         maxStatelessResetsPerHost,
         qlog,
         statelessResetSecret,
-        disableStatelessReset));
+        disableStatelessReset,
+        retryTokenSecret,
+        serverId));
 
     this.addEndpoint({ ...endpoint, preferred: true });
   }
@@ -1588,6 +1614,14 @@ class QuicSocket extends EventEmitter {
     return Number(getStats(this, IDX_QUIC_SOCKET_STATS_SERVER_BUSY_COUNT));
   }
 
+  get sendCalls() {
+    return Number(getStats(this, IDX_QUIC_SOCKET_STATS_SEND_CALLS));
+  }
+
+  get packetsMisrouted() {
+    return Number(getStats(this, IDX_QUIC_SOCKET_STATS_PACKETS_MISROUTED));
+  }
+
   // Diagnostic packet loss is a testing mechanism that allows simulating
   // pseudo-random packet loss for rx or tx. The value specified for each
   // option is a number between 0 and 1 that identifies the possibility of
@@ -2497,6 +2531,7 @@ class QuicStream extends Duplex {
     didRead: false,
     id: undefined,
     highWaterMark: undefined,
+    pendingBody: undefined,
     push_id: undefined,
     resetCode: undefined,
     session: undefined,
@@ -2791,6 +2826,12 @@ class QuicStream extends Duplex {
       if (state.sharedState?.finSent)
         return cb();
       const handle = this[kHandle];
+      // Passed on only now, after the writes that were queued before
+      // sendBuffer() was called.
+      if (state.pendingBody !== undefined) {
+        handle.sendBody(state.pendingBody);
+        state.pendingBody = undefined;
+      }
       const req = new ShutdownWrap();
       req.oncomplete = () => {
         req.handle = undefined;
@@ -2806,7 +2847,8 @@ class QuicStream extends Duplex {
 
   end(...args) {
     if (!this.destroyed) {
-      if (!this.detached)
+      // After sendBuffer(), the queued writes are not the last ones.
+      if (!this.detached && this[kInternalState].pendingBody === undefined)
         this[kInternalState].sharedState.writeEnded = true;
       super.end.apply(this, args);
     }
@@ -2853,6 +2895,32 @@ class QuicStream extends Duplex {
     this.sendFD(fd, options, true);
   }
 
+  sendBuffer(data) {
+    if (this.destroyed || this[kInternalState].closed)
+      return;
+
+    if (this.detached)
+      throw new ERR_INVALID_STATE('Unable to send buffer');
+
+    if (!isArrayBufferView(data)) {
+      throw new ERR_INVALID_ARG_TYPE('data',
+                                     ['Buffer', 'TypedArray', 'DataView'],
+                                     data);
+    }
+
+    if (this.writableEnded)
+      throw new ERR_INVALID_STATE('Unable to send buffer after end()');
+
+    this[kUpdateTimer]();
+    // The memory of data is kept in the QuicBuffer of the handle until it
+    // has been acknowledged, rather than through a write request. It is
+    // passed on from _final(), so that it follows the writes that are still
+    // queued.
+    this[kInternalState].pendingBody = data;
+    this[kTrackWriteState](this, data.byteLength);
+    super.end();
+  }
+
   sendFD(fd, { offset = -1, length = -1 } = {}, ownsFd = false) {
     if (this.destroyed || this[kInternalState].closed)
       return;
@@ -2878,12 +2946,12 @@ class QuicStream extends Duplex {
 
   static [kStartFilePipe](stream, fd, offset, length) {
     const handle = new FileHandle(fd, offset, length);
-    handle.onread = QuicStream[kOnPipedFileHandleRead];
+    handle.onread = QuicStream[kOnPulledFileHandleRead];
     handle.stream = stream;
 
-    const pipe = new StreamPipe(handle, stream[kHandle]);
-    pipe.onunpipe = QuicStream[kOnFileUnpipe];
-    pipe.start();
+    // The file is read ahead of the acknowledgements from the peer, rather
+    // than one chunk per round trip.
+    stream[kHandle].pullFrom(handle);
 
     // Exact length of the file doesn't matter here, since the
     // stream is closing anyway - just use 1 to signify that
@@ -2891,20 +2959,22 @@ class QuicStream extends Duplex {
     stream[kTrackWriteState](stream, 1);
   }
 
-  static [kOnFileUnpipe]() {  // Called on the StreamPipe instance.
-    const stream = this.sink[owner_symbol];
+  // Called on the FileHandle for End-of-File and errors only, as the data
+  // is read by the QuicStream itself, or with UV_ECANCELED when the
+  // QuicStream has been destroyed before the end of the file.
+  static [kOnPulledFileHandleRead]() {
+    const err = streamBaseState[kReadBytesOrError];
+    if (err >= 0)
+      return;
+    const stream = this.stream;
     if (stream.ownsFd)
-      this.source.close().catch(stream.destroy.bind(stream));
+      this.close().catch(stream.destroy.bind(stream));
     else
-      this.source.releaseFD();
-    stream.end();
-  }
-
-  static [kOnPipedFileHandleRead]() {
-    const err = streamBaseState[kReadBytesOrError];
-    if (err < 0 && err !== UV_EOF) {
-      this.stream.destroy(errnoException(err, 'sendFD'));
-    }
+      this.releaseFD();
+    if (err === UV_EOF)
+      stream.end();
+    else if (err !== UV_ECANCELED)
+      stream.destroy(errnoException(err, 'sendFD'));
   }
 
   get resetReceived() {
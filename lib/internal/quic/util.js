@@ -502,6 +502,7 @@ function validateQuicEndpointOptions(options = {}, name = 'options') {
     lookup,
     port = 0,
     reuseAddr = false,
+    reusePort = false,
     type = 'udp4',
     preferred = false,
   } = options;
@@ -511,6 +512,7 @@ function validateQuicEndpointOptions(options = {}, name = 'options') {
   validateString(type, 'options.type');
   validateLookup(lookup);
   validateBoolean(reuseAddr, 'options.reuseAddr');
+  validateBoolean(reusePort, 'options.reusePort');
   validateBoolean(preferred, 'options.preferred');
   const [typeVal, ipv6Only] = getSocketType(type);
   return {
@@ -521,6 +523,7 @@ function validateQuicEndpointOptions(options = {}, name = 'options') {
     port,
     preferred,
     reuseAddr,
+    reusePort,
   };
 }
 
@@ -536,9 +539,12 @@ function validateQuicSocketOptions(options = {}) {
     maxConnectionsPerHost = DEFAULT_MAX_CONNECTIONS_PER_HOST,
     maxStatelessResetsPerHost = DEFAULT_MAX_STATELESS_RESETS_PER_HOST,
     qlog = false,
+    retryTokenSecret,
     retryTokenTimeout = DEFAULT_RETRYTOKEN_EXPIRATION,
     server = {},
+    serverId,
     statelessResetSecret,
+    trackSendRequests = false,
     validateAddress = false,
   } = options;
 
@@ -549,6 +555,7 @@ function validateQuicSocketOptions(options = {}) {
   validateBoolean(validateAddress, 'options.validateAddress');
   validateBoolean(qlog, 'options.qlog');
   validateBoolean(disableStatelessReset, 'options.disableStatelessReset');
+  validateBoolean(trackSendRequests, 'options.trackSendRequests');
 
   if (retryTokenTimeout !== undefined) {
     validateInteger(
@@ -576,6 +583,18 @@ function validateQuicSocketOptions(options = {}) {
       /* min */ 1);
   }
 
+  if (serverId !== undefined)
+    validateInteger(serverId, 'options.serverId', /* min */ 0, /* max */ 255);
+
+  if (retryTokenSecret !== undefined) {
+    validateBuffer(retryTokenSecret, 'options.retryTokenSecret');
+    if (retryTokenSecret.length !== 16)
+      throw new ERR_INVALID_ARG_VALUE(
+        'options.retryTokenSecret',
+        retryTokenSecret,
+        'must be exactly 16 bytes in length');
+  }
+
   if (statelessResetSecret !== undefined) {
     validateBuffer(statelessResetSecret, 'options.statelessResetSecret');
     if (statelessResetSecret.length !== 16)
@@ -592,12 +611,15 @@ function validateQuicSocketOptions(options = {}) {
     maxConnections,
     maxConnectionsPerHost,
     maxStatelessResetsPerHost,
+    retryTokenSecret,
     retryTokenTimeout,
     server,
+    serverId,
     type,
     validateAddress,
     qlog,
     statelessResetSecret,
+    trackSendRequests,
     disableStatelessReset,
   };
 }
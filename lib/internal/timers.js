@@ -9,11 +9,6 @@
 // Therefore, it is very important that the timers implementation is performant
 // and efficient.
 //
-// Note: It is suggested you first read through the lib/internal/linkedlist.js
-// linked list implementation, since timers depend on it extensively. It can be
-// somewhat counter-intuitive at first, as it is not actually a class. Instead,
-// it is a set of helpers that operate on an existing object.
-//
 // In order to be as performant as possible, the architecture and data
 // structures are designed so that they are optimized to handle the following
 // use cases as efficiently as possible:
@@ -22,66 +17,34 @@
 // - Removing an existing timer. (remove)
 // - Handling a timer timing out. (timeout)
 //
-// Whenever possible, the implementation tries to make the complexity of these
-// operations as close to constant-time as possible.
-// (So that performance is not impacted by the number of scheduled timers.)
-//
-// Object maps are kept which contain linked lists keyed by their duration in
-// milliseconds.
-//
-/* eslint-disable node-core/non-ascii-character */
+// All of these are constant-time operations, so that performance is not
+// impacted by the number of scheduled timers.
 //
-// ╔════ > Object Map
-// ║
-// ╠══
-// ║ lists: { '40': { }, '320': { etc } } (keys of millisecond duration)
-// ╚══          ┌────┘
-//              │
-// ╔══          │
-// ║ TimersList { _idleNext: { }, _idlePrev: (self) }
-// ║         ┌────────────────┘
-// ║    ╔══  │                              ^
-// ║    ║    { _idleNext: { },  _idlePrev: { }, _onTimeout: (callback) }
-// ║    ║      ┌───────────┘
-// ║    ║      │                                  ^
-// ║    ║      { _idleNext: { etc },  _idlePrev: { }, _onTimeout: (callback) }
-// ╠══  ╠══
-// ║    ║
-// ║    ╚════ >  Actual JavaScript timeouts
-// ║
-// ╚════ > Linked List
+// Timers are stored in a hierarchical timing wheel that is implemented in C++
+// (see src/timer_wheel.h) and owned by the Environment, which native code can
+// schedule its own timers in as well. Each timer that is scheduled in the
+// wheel is given an integer id, under which it is stored in `timerSlots`.
+// Scheduling, rescheduling (through `refresh()`) and cancelling a timer are
+// each a single call into the binding, that only relinks the timer within the
+// wheel, however many timers there are.
 //
-/* eslint-enable node-core/non-ascii-character */
-//
-// With this, virtually constant-time insertion (append), removal, and timeout
-// is possible in the JavaScript layer. Any one list of timers is able to be
-// sorted by just appending to it because all timers within share the same
-// duration. Therefore, any timer added later will always have been scheduled to
-// timeout later, thus only needing to be appended.
-// Removal from an object-property linked list is also virtually constant-time
-// as can be seen in the lib/internal/linkedlist.js implementation.
-// Timeouts only need to process any timers currently due to expire, which will
-// always be at the beginning of the list for reasons stated above. Any timers
-// after the first one encountered that does not yet need to timeout will also
-// always be due to timeout at a later time.
-//
-// Less-than constant time operations are thus contained in two places:
-// The PriorityQueue — an efficient binary heap implementation that does all
-// operations in worst-case O(log n) time — which manages the order of expiring
-// Timeout lists and the object map lookup of a specific list by the duration of
-// timers within (or creation of a new list). However, these operations combined
-// have shown to be trivial in comparison to other timers architectures.
+// When the timer handle of the Environment fires, the wheel is moved forward
+// to the current time, and the ids of all the timers that have expired are
+// passed to processTimers() as a single batch, in the order in which they
+// expired. Timers that expire at the same time run in the order in which they
+// were scheduled. The ids of the timers that have run are reused for the
+// timers that are scheduled afterwards.
 
 const {
-  MathMax,
+  ArrayPrototypePop,
+  ArrayPrototypePush,
   MathTrunc,
-  NumberMIN_SAFE_INTEGER,
-  ObjectCreate,
   Symbol,
 } = primordials;
 
 const {
   scheduleTimer,
+  cancelTimer,
   toggleTimerRef,
   getLibuvNow,
   immediateInfo,
@@ -98,7 +61,9 @@ const {
   emitBefore,
   emitAfter,
   emitDestroy,
+  symbols: { async_context_frame },
 } = require('internal/async_hooks');
+const AsyncContextFrame = require('internal/async_context_frame');
 
 // Symbols for storing async id state.
 const async_id_symbol = Symbol('asyncId');
@@ -112,9 +77,6 @@ const {
 } = require('internal/errors').codes;
 const { validateNumber } = require('internal/validators');
 
-const L = require('internal/linkedlist');
-const PriorityQueue = require('internal/priority_queue');
-
 const { inspect } = require('internal/util/inspect');
 let debug = require('internal/util/debuglog').debuglog('timer', (fn) => {
   debug = fn;
@@ -128,32 +90,29 @@ const kHasOutstanding = 2;
 // Timeout values > TIMEOUT_MAX are set to 1.
 const TIMEOUT_MAX = 2 ** 31 - 1;
 
-let timerListId = NumberMIN_SAFE_INTEGER;
-
 const kRefed = Symbol('refed');
 
+// The id of a timer in the timer wheel, or kUnscheduled.
+const kTimerId = Symbol('timerId');
+const kUnscheduled = -1;
+// The timer has expired and is waiting for its turn in processTimers().
+const kExpired = -2;
+
 // Create a single linked list instance only once at startup
 const immediateQueue = new ImmediateList();
 
-let nextExpiry = Infinity;
 let refCount = 0;
 
-// This is a priority queue with a custom sorting function that first compares
-// the expiry times of two lists and if they're the same then compares their
-// individual IDs to determine which list was created first.
-const timerListQueue = new PriorityQueue(compareTimersLists, setPosition);
-
-// Object map containing linked lists of timers, keyed and sorted by their
-// duration in milliseconds.
-//
-// - key = time in milliseconds
-// - value = linked list
-const timerListMap = ObjectCreate(null);
+// The timers that are scheduled in the timer wheel, indexed by their id, and
+// the ids that can be reused.
+const timerSlots = [];
+const freeTimerIds = [];
 
 function initAsyncResource(resource, type) {
   const asyncId = resource[async_id_symbol] = newAsyncId();
   const triggerAsyncId =
     resource[trigger_async_id_symbol] = getDefaultTriggerAsyncId();
+  resource[async_context_frame] = AsyncContextFrame.current();
   if (initHooksExist())
     emitInit(asyncId, type, triggerAsyncId, resource);
 }
@@ -173,8 +132,6 @@ function Timeout(callback, after, args, isRepeat, isRefed) {
   }
 
   this._idleTimeout = after;
-  this._idlePrev = this;
-  this._idleNext = this;
   this._idleStart = null;
   // This must be set to null first to avoid function tracking
   // on the hidden class, revisit in V8 versions after 6.2
@@ -188,11 +145,12 @@ function Timeout(callback, after, args, isRepeat, isRefed) {
     incRefCount();
   this[kRefed] = isRefed;
   this[kHasPrimitive] = false;
+  this[kTimerId] = kUnscheduled;
 
   initAsyncResource(this, 'Timeout');
 }
 
-// Make sure the linked list only shows the minimal necessary information.
+// Only show the minimal necessary information.
 Timeout.prototype[inspect.custom] = function(_, options) {
   return inspect(this, {
     ...options,
@@ -234,26 +192,6 @@ Timeout.prototype.hasRef = function() {
   return this[kRefed];
 };
 
-function TimersList(expiry, msecs) {
-  this._idleNext = this; // Create the list with the linkedlist properties to
-  this._idlePrev = this; // Prevent any unnecessary hidden class changes.
-  this.expiry = expiry;
-  this.id = timerListId++;
-  this.msecs = msecs;
-  this.priorityQueuePosition = null;
-}
-
-// Make sure the linked list only shows the minimal necessary information.
-TimersList.prototype[inspect.custom] = function(_, options) {
-  return inspect(this, {
-    ...options,
-    // Only inspect one level.
-    depth: 0,
-    // It should not recurse.
-    customInspect: false
-  });
-};
-
 // A linked list for storing `setImmediate()` requests
 function ImmediateList() {
   this.head = null;
@@ -315,9 +253,6 @@ function unrefActive(item) {
 }
 
 // The underlying logic for scheduling or re-scheduling a timer.
-//
-// Appends a timer onto the end of an existing timers list, or creates a new
-// list if one does not already exist for the specified timeout duration.
 function insertGuarded(item, refed, start) {
   const msecs = item._idleTimeout;
   if (msecs < 0 || msecs === undefined)
@@ -343,26 +278,39 @@ function insertGuarded(item, refed, start) {
   item[kRefed] = refed;
 }
 
+// Schedules the timer in the timer wheel, or moves it to its new expiry if
+// it is already scheduled.
 function insert(item, msecs, start = getLibuvNow()) {
   // Truncate so that accuracy of sub-millisecond timers is not assumed.
   msecs = MathTrunc(msecs);
   item._idleStart = start;
 
-  // Use an existing list if there is one, otherwise we need to make a new one.
-  let list = timerListMap[msecs];
-  if (list === undefined) {
-    debug('no %d list was found in insert, creating a new one', msecs);
-    const expiry = start + msecs;
-    timerListMap[msecs] = list = new TimersList(expiry, msecs);
-    timerListQueue.insert(list);
-
-    if (nextExpiry > expiry) {
-      scheduleTimer(msecs);
-      nextExpiry = expiry;
-    }
+  let id = item[kTimerId];
+  if (id === undefined || id < 0) {
+    id = freeTimerIds.length > 0 ?
+      ArrayPrototypePop(freeTimerIds) : timerSlots.length;
+    timerSlots[id] = item;
+    item[kTimerId] = id;
   }
+  scheduleTimer(id, start + msecs);
+}
+
+// Releases the id of a timer that is not scheduled in the timer wheel
+// anymore.
+function releaseTimerId(item) {
+  const id = item[kTimerId];
+  timerSlots[id] = undefined;
+  ArrayPrototypePush(freeTimerIds, id);
+}
 
-  L.append(list, item);
+// Cancels the timer if it is scheduled.
+function remove(item) {
+  const id = item[kTimerId];
+  if (id >= 0) {
+    cancelTimer(id);
+    releaseTimerId(item);
+  }
+  item[kTimerId] = kUnscheduled;
 }
 
 function setUnrefTimeout(callback, after) {
@@ -395,21 +343,6 @@ function getTimerDuration(msecs, name) {
   return msecs;
 }
 
-function compareTimersLists(a, b) {
-  const expiryDiff = a.expiry - b.expiry;
-  if (expiryDiff === 0) {
-    if (a.id < b.id)
-      return -1;
-    if (a.id > b.id)
-      return 1;
-  }
-  return expiryDiff;
-}
-
-function setPosition(node, pos) {
-  node.priorityQueuePosition = pos;
-}
-
 function getTimerCallbacks(runNextTicks) {
   // If an uncaught exception was thrown during execution of immediateQueue,
   // this queue will store all remaining Immediates that need to run upon
@@ -453,6 +386,8 @@ function getTimerCallbacks(runNextTicks) {
 
       prevImmediate = immediate;
 
+      const priorContextFrame =
+        AsyncContextFrame.exchange(immediate[async_context_frame]);
       const asyncId = immediate[async_id_symbol];
       emitBefore(asyncId, immediate[trigger_async_id_symbol], immediate);
 
@@ -464,6 +399,7 @@ function getTimerCallbacks(runNextTicks) {
           immediate._onImmediate(...argv);
       } finally {
         immediate._onImmediate = null;
+        AsyncContextFrame.enter(priorContextFrame);
 
         if (destroyHooksExist())
           emitDestroy(asyncId);
@@ -480,53 +416,47 @@ function getTimerCallbacks(runNextTicks) {
   }
 
 
-  function processTimers(now) {
-    debug('process timer lists %d', now);
-    nextExpiry = Infinity;
+  // The timers of the current batch, from `expiredIndex` on, that have not
+  // run yet. If one of them throws, processTimers() is called again without
+  // a new batch to run the rest.
+  let expiredTimers = [];
+  let expiredIndex = 0;
+
+  function processTimers(now, expiredIds) {
+    debug('process timers %d', now);
 
-    let list;
-    let ranAtLeastOneList = false;
-    while (list = timerListQueue.peek()) {
-      if (list.expiry > now) {
-        nextExpiry = list.expiry;
-        return refCount > 0 ? nextExpiry : -nextExpiry;
+    if (expiredIds !== undefined) {
+      expiredTimers = [];
+      expiredIndex = 0;
+      for (let i = 0; i < expiredIds.length; i++) {
+        const timer = timerSlots[expiredIds[i]];
+        releaseTimerId(timer);
+        timer[kTimerId] = kExpired;
+        expiredTimers[i] = timer;
       }
-      if (ranAtLeastOneList)
-        runNextTicks();
-      else
-        ranAtLeastOneList = true;
-      listOnTimeout(list, now);
     }
-    return 0;
-  }
-
-  function listOnTimeout(list, now) {
-    const msecs = list.msecs;
-
-    debug('timeout callback %d', msecs);
 
     let ranAtLeastOneTimer = false;
-    let timer;
-    while (timer = L.peek(list)) {
-      const diff = now - timer._idleStart;
-
-      // Check if this loop iteration is too early for the next timer.
-      // This happens if there are more timers scheduled for later in the list.
-      if (diff < msecs) {
-        list.expiry = MathMax(timer._idleStart + msecs, now + 1);
-        list.id = timerListId++;
-        timerListQueue.percolateDown(1);
-        debug('%d list wait because diff is %d', msecs, diff);
-        return;
-      }
+    while (expiredIndex < expiredTimers.length) {
+      const timer = expiredTimers[expiredIndex];
+      expiredTimers[expiredIndex++] = undefined;
+
+      // The timer may have been removed or rescheduled by one of the timers
+      // that ran before it.
+      if (timer[kTimerId] !== kExpired)
+        continue;
 
       if (ranAtLeastOneTimer)
         runNextTicks();
       else
         ranAtLeastOneTimer = true;
 
+      // Or by the next tick queue that has just been processed.
+      if (timer[kTimerId] !== kExpired)
+        continue;
+
       // The actual logic for when a timeout happens.
-      L.remove(timer);
+      timer[kTimerId] = kUnscheduled;
 
       const asyncId = timer[async_id_symbol];
 
@@ -543,6 +473,8 @@ function getTimerCallbacks(runNextTicks) {
         continue;
       }
 
+      const priorContextFrame =
+        AsyncContextFrame.exchange(timer[async_context_frame]);
       emitBefore(asyncId, timer[trigger_async_id_symbol], timer);
 
       let start;
@@ -556,10 +488,11 @@ function getTimerCallbacks(runNextTicks) {
         else
           timer._onTimeout(...args);
       } finally {
+        AsyncContextFrame.enter(priorContextFrame);
         if (timer._repeat && timer._idleTimeout !== -1) {
           timer._idleTimeout = timer._repeat;
           insert(timer, timer._idleTimeout, start);
-        } else if (!timer._idleNext && !timer._idlePrev && !timer._destroyed) {
+        } else if (timer[kTimerId] === kUnscheduled && !timer._destroyed) {
           timer._destroyed = true;
 
           if (timer[kRefed])
@@ -573,19 +506,9 @@ function getTimerCallbacks(runNextTicks) {
       emitAfter(asyncId);
     }
 
-    // If `L.peek(list)` returned nothing, the list was either empty or we have
-    // called all of the timer timeouts.
-    // As such, we can remove the list from the object map and
-    // the PriorityQueue.
-    debug('%d list empty', msecs);
-
-    // The current list may have been removed and recreated since the reference
-    // to `list` was created. Make sure they're the same instance of the list
-    // before destroying.
-    if (list === timerListMap[msecs]) {
-      delete timerListMap[msecs];
-      timerListQueue.shift();
-    }
+    expiredTimers = [];
+    expiredIndex = 0;
+    return refCount > 0;
   }
 
   return {
@@ -656,8 +579,9 @@ module.exports = {
   active,
   unrefActive,
   insert,
-  timerListMap,
-  timerListQueue,
+  remove,
+  kTimerId,
+  kUnscheduled,
   decRefCount,
   incRefCount
 };
@@ -30,6 +30,9 @@ const kEnabled = Symbol('enabled');
 // emitted using the JavaScript API. To prevent emitting the same event
 // twice the async_wrap.Providers list is used to filter the events.
 const nativeProviders = new SafeSet(ObjectKeys(async_wrap.Providers));
+// Promises are tracked by the promise hook without an AsyncWrap, so their
+// events are emitted from here as well.
+nativeProviders.delete('PROMISE');
 const typeMemory = new SafeMap();
 
 function createHook() {
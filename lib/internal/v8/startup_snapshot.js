@@ -0,0 +1,128 @@
+'use strict';
+
+const {
+  ArrayPrototypePush,
+  ArrayPrototypeShift,
+  SafeMap,
+} = primordials;
+
+const {
+  codes: {
+    ERR_INVALID_ARG_VALUE,
+    ERR_NOT_BUILDING_SNAPSHOT,
+    ERR_DUPLICATE_STARTUP_SNAPSHOT_MAIN_FUNCTION
+  }
+} = require('internal/errors');
+
+const {
+  validateCallback,
+  validateString,
+} = require('internal/validators');
+
+const {
+  setDeserializeMainFunction: _setDeserializeMainFunction,
+  addContextTemplate: _addContextTemplate
+} = internalBinding('mksnapshot');
+
+const { getOptionValue } = require('internal/options');
+
+function isBuildingSnapshot() {
+  return getOptionValue('--build-snapshot');
+}
+
+function throwIfNotBuildingSnapshot() {
+  if (!isBuildingSnapshot()) {
+    throw new ERR_NOT_BUILDING_SNAPSHOT();
+  }
+}
+
+function runCallbacks(callbacks) {
+  while (callbacks.length > 0) {
+    const { 0: callback, 1: data } = ArrayPrototypeShift(callbacks);
+    callback(data);
+  }
+}
+
+const serializeCallbacks = [];
+function addSerializeCallback(callback, data) {
+  throwIfNotBuildingSnapshot();
+  validateCallback(callback);
+  ArrayPrototypePush(serializeCallbacks, [callback, data]);
+}
+
+function runSerializeCallbacks() {
+  runCallbacks(serializeCallbacks);
+}
+
+const deserializeCallbacks = [];
+function addDeserializeCallback(callback, data) {
+  throwIfNotBuildingSnapshot();
+  validateCallback(callback);
+  ArrayPrototypePush(deserializeCallbacks, [callback, data]);
+}
+
+function runDeserializeCallbacks() {
+  runCallbacks(deserializeCallbacks);
+}
+
+let deserializeMainIsSet = false;
+function setDeserializeMainFunction(callback, data) {
+  throwIfNotBuildingSnapshot();
+  if (deserializeMainIsSet) {
+    throw new ERR_DUPLICATE_STARTUP_SNAPSHOT_MAIN_FUNCTION();
+  }
+  validateCallback(callback);
+  deserializeMainIsSet = true;
+
+  _setDeserializeMainFunction(function deserializeMain(markBootstrapComplete) {
+    const {
+      prepareMainThreadExecution
+    } = require('internal/bootstrap/pre_execution');
+
+    prepareMainThreadExecution(false);
+    markBootstrapComplete();
+    return callback(data);
+  });
+}
+
+// Maps the names of the context templates to their position in the snapshot.
+// It is part of the heap, so it is deserialized along with the contexts.
+const contextTemplates = new SafeMap();
+function addContextTemplate(name, code) {
+  throwIfNotBuildingSnapshot();
+  validateString(name, 'name');
+  validateString(code, 'code');
+  if (contextTemplates.has(name)) {
+    throw new ERR_INVALID_ARG_VALUE('name', name,
+                                    'is already used by a context template');
+  }
+  const index = _addContextTemplate(code, `evalmachine.<${name}>`);
+  contextTemplates.set(name, index);
+}
+
+// Used by vm.createContext().
+function getContextTemplate(name) {
+  // The contexts are only added to the snapshot once the entry point has
+  // finished running.
+  const index = isBuildingSnapshot() ? undefined : contextTemplates.get(name);
+  if (index === undefined) {
+    throw new ERR_INVALID_ARG_VALUE('options.contextTemplate', name,
+                                    'is not a context template of the ' +
+                                    'startup snapshot');
+  }
+  return index;
+}
+
+module.exports = {
+  runSerializeCallbacks,
+  runDeserializeCallbacks,
+  getContextTemplate,
+  // Exposed to users via v8.startupSnapshot.
+  namespace: {
+    addSerializeCallback,
+    addDeserializeCallback,
+    setDeserializeMainFunction,
+    addContextTemplate,
+    isBuildingSnapshot
+  }
+};
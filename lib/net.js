@@ -103,6 +103,7 @@ const {
 } = require('internal/errors');
 const { isUint8Array } = require('internal/util/types');
 const {
+  validateBoolean,
   validateInt32,
   validatePort,
   validateString
@@ -1174,6 +1175,14 @@ function Server(options, connectionListener) {
 
   this.allowHalfOpen = options.allowHalfOpen || false;
   this.pauseOnConnect = !!options.pauseOnConnect;
+
+  const { latencyHistograms = false } = options;
+  validateBoolean(latencyHistograms, 'options.latencyHistograms');
+  this.latencyHistograms = undefined;
+  if (latencyHistograms) {
+    const { createLatencyHistogram } = require('internal/histogram');
+    this.latencyHistograms = { firstByte: createLatencyHistogram() };
+  }
 }
 ObjectSetPrototypeOf(Server.prototype, EventEmitter.prototype);
 ObjectSetPrototypeOf(Server, EventEmitter);
@@ -1281,6 +1290,15 @@ function setupListenHandle(address, port, addressType, backlog, fd, flags) {
   this._handle.onconnection = onconnection;
   this._handle[owner_symbol] = this;
 
+  // The handles of cluster workers in round-robin mode do not accept the
+  // connections themselves.
+  if (this.latencyHistograms !== undefined &&
+      typeof this._handle.setFirstByteHistogram === 'function') {
+    const { kHandle: kHistogramHandle } = require('internal/histogram');
+    this._handle.setFirstByteHistogram(
+      this.latencyHistograms.firstByte[kHistogramHandle]);
+  }
+
   // Use a backlog of 512 entries. We pass 511 to the listen() call because
   // the kernel does: backlogsize = roundup_pow_of_two(backlogsize + 1);
   // which will thus give us a backlog of 512 entries.
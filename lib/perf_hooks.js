@@ -60,6 +60,7 @@ const {
 
 const {
   Histogram,
+  createHistogram,
   kHandle,
 } = require('internal/histogram');
 
@@ -616,7 +617,8 @@ function monitorEventLoopDelay(options = {}) {
 module.exports = {
   performance,
   PerformanceObserver,
-  monitorEventLoopDelay
+  monitorEventLoopDelay,
+  createHistogram,
 };
 
 ObjectDefineProperty(module.exports, 'constants', {
@@ -22,7 +22,6 @@
 'use strict';
 
 const {
-  MathTrunc,
   ObjectCreate,
   ObjectDefineProperty,
   SymbolToPrimitive
@@ -32,7 +31,6 @@ const {
   immediateInfo,
   toggleImmediateRef
 } = internalBinding('timers');
-const L = require('internal/linkedlist');
 const {
   async_id_symbol,
   Timeout,
@@ -45,20 +43,18 @@ const {
   kRefed,
   kHasPrimitive,
   getTimerDuration,
-  timerListMap,
-  timerListQueue,
   immediateQueue,
   active,
   unrefActive,
-  insert
+  insert,
+  remove,
+  kTimerId,
+  kUnscheduled
 } = require('internal/timers');
 const {
   promisify: { custom: customPromisify },
   deprecate
 } = require('internal/util');
-let debug = require('internal/util/debuglog').debuglog('timer', (fn) => {
-  debug = fn;
-});
 const { validateCallback } = require('internal/validators');
 
 let timersPromises;
@@ -88,25 +84,10 @@ function unenroll(item) {
   if (destroyHooksExist() && item[async_id_symbol] !== undefined)
     emitDestroy(item[async_id_symbol]);
 
-  L.remove(item);
-
-  // We only delete refed lists because unrefed ones are incredibly likely
-  // to come from http and be recreated shortly after.
-  // TODO: Long-term this could instead be handled by creating an internal
-  // clearTimeout that makes it clear that the list should not be deleted.
-  // That function could then be used by http and other similar modules.
-  if (item[kRefed]) {
-    // Compliment truncation during insert().
-    const msecs = MathTrunc(item._idleTimeout);
-    const list = timerListMap[msecs];
-    if (list !== undefined && L.isEmpty(list)) {
-      debug('unenroll: list empty');
-      timerListQueue.removeAt(list.priorityQueuePosition);
-      delete timerListMap[list.msecs];
-    }
+  remove(item);
 
+  if (item[kRefed])
     decRefCount();
-  }
 
   // If active is called later, then we want to make sure not to insert again
   item._idleTimeout = -1;
@@ -118,11 +99,10 @@ function unenroll(item) {
 function enroll(item, msecs) {
   msecs = getTimerDuration(msecs, 'msecs');
 
-  // If this item was already in a list somewhere
-  // then we should unenroll it from that
-  if (item._idleNext) unenroll(item);
+  // If this item was already enrolled then we should unenroll it first
+  if (item[kTimerId] !== undefined) unenroll(item);
 
-  L.init(item);
+  item[kTimerId] = kUnscheduled;
   item._idleTimeout = msecs;
 }
 
@@ -15,15 +15,26 @@ const kMaxTracingCount = 10;
 
 const {
   ERR_TRACE_EVENTS_CATEGORY_REQUIRED,
+  ERR_TRACE_EVENTS_FLIGHT_RECORDER_DISABLED,
   ERR_TRACE_EVENTS_UNAVAILABLE,
   ERR_INVALID_ARG_TYPE
 } = require('internal/errors').codes;
+const {
+  validateInteger,
+  validateObject,
+  validateString,
+} = require('internal/validators');
 
 const { ownsProcessState } = require('internal/worker');
 if (!hasTracing || !ownsProcessState)
   throw new ERR_TRACE_EVENTS_UNAVAILABLE();
 
-const { CategorySet, getEnabledCategories } = internalBinding('trace_events');
+const {
+  CategorySet,
+  getEnabledCategories,
+  isFlightRecorderEnabled,
+  dumpFlightRecorder: _dumpFlightRecorder,
+} = internalBinding('trace_events');
 const { customInspectSymbol } = require('internal/util');
 const { format } = require('internal/util/inspect');
 
@@ -93,7 +104,24 @@ function createTracing(options) {
   return new Tracing(options.categories);
 }
 
+function dumpFlightRecorder(filename, options = {}) {
+  if (typeof filename === 'object' && filename !== null) {
+    options = filename;
+    filename = undefined;
+  }
+  if (filename !== undefined)
+    validateString(filename, 'filename');
+  validateObject(options, 'options');
+  const { duration = 0 } = options;
+  validateInteger(duration, 'options.duration', 0);
+
+  if (!isFlightRecorderEnabled())
+    throw new ERR_TRACE_EVENTS_FLIGHT_RECORDER_DISABLED();
+  return _dumpFlightRecorder(filename, duration);
+}
+
 module.exports = {
   createTracing,
+  dumpFlightRecorder,
   getEnabledCategories
 };
@@ -24,6 +24,7 @@ const {
   Int32Array,
   Int8Array,
   Map,
+  MathRound,
   ObjectPrototypeToString,
   Uint16Array,
   Uint32Array,
@@ -32,7 +33,17 @@ const {
 } = primordials;
 
 const { Buffer } = require('buffer');
-const { validateString } = require('internal/validators');
+const {
+  codes: {
+    ERR_INVALID_STATE,
+  },
+} = require('internal/errors');
+const {
+  validateInteger,
+  validateObject,
+  validateOneOf,
+  validateString,
+} = require('internal/validators');
 const {
   Serializer: _Serializer,
   Deserializer: _Deserializer
@@ -48,13 +59,54 @@ const {
   triggerHeapSnapshot
 } = internalBinding('heap_utils');
 const { HeapSnapshotStream } = require('internal/heap_utils');
+const {
+  start: startContinuousProfiler,
+  stop: stopContinuousProfiler,
+  getProfile: getContinuousProfile,
+} = internalBinding('continuous_profiler');
+const {
+  namespace: startupSnapshot
+} = require('internal/v8/startup_snapshot');
 
-function writeHeapSnapshot(filename) {
+function writeHeapSnapshot(filename, options = {}) {
   if (filename !== undefined) {
     filename = getValidatedPath(filename);
     filename = toNamespacedPath(filename);
   }
-  return triggerHeapSnapshot(filename);
+  validateObject(options, 'options');
+  const { compression } = options;
+  if (compression !== undefined)
+    validateOneOf(compression, 'options.compression', ['gzip', 'zstd']);
+  return triggerHeapSnapshot(filename, compression);
+}
+
+function startContinuousCpuProfiler(options = {}) {
+  validateObject(options, 'options');
+  const {
+    frequency = 100,
+    windowDuration = 10000,
+    retention = 60000,
+  } = options;
+  validateInteger(frequency, 'options.frequency', 1, 1000);
+  validateInteger(windowDuration, 'options.windowDuration', 1);
+  validateInteger(retention, 'options.retention', 0);
+  const interval = MathRound(1e6 / frequency);
+  if (!startContinuousProfiler(interval, windowDuration, retention)) {
+    throw new ERR_INVALID_STATE(
+      'The continuous CPU profiler is already running');
+  }
+}
+
+function stopContinuousCpuProfiler() {
+  stopContinuousProfiler();
+}
+
+function getContinuousCpuProfile() {
+  const profile = getContinuousProfile();
+  if (profile === undefined) {
+    throw new ERR_INVALID_STATE('The continuous CPU profiler is not running');
+  }
+  return profile;
 }
 
 function getHeapSnapshot() {
@@ -265,11 +317,14 @@ function deserialize(buffer) {
 
 module.exports = {
   cachedDataVersionTag,
+  getContinuousCpuProfile,
   getHeapSnapshot,
   getHeapStatistics,
   getHeapSpaceStatistics,
   getHeapCodeStatistics,
   setFlagsFromString,
+  startContinuousCpuProfiler,
+  stopContinuousCpuProfiler,
   Serializer,
   Deserializer,
   DefaultSerializer,
@@ -277,4 +332,5 @@ module.exports = {
   deserialize,
   serialize,
   writeHeapSnapshot,
+  startupSnapshot,
 };
@@ -227,7 +227,8 @@ function createContext(contextObject = {}, options = {}) {
     name = `VM Context ${defaultContextNameIndex++}`,
     origin,
     codeGeneration,
-    microtaskMode
+    microtaskMode,
+    contextTemplate
   } = options;
 
   validateString(name, 'options.name');
@@ -253,7 +254,15 @@ function createContext(contextObject = {}, options = {}) {
       microtaskQueue = new MicrotaskQueue();
   }
 
-  makeContext(contextObject, name, origin, strings, wasm, microtaskQueue);
+  let contextTemplateIndex;
+  if (contextTemplate !== undefined) {
+    validateString(contextTemplate, 'options.contextTemplate');
+    const { getContextTemplate } = require('internal/v8/startup_snapshot');
+    contextTemplateIndex = getContextTemplate(contextTemplate);
+  }
+
+  makeContext(contextObject, name, origin, strings, wasm, microtaskQueue,
+              contextTemplateIndex);
   return contextObject;
 }
 
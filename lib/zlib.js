@@ -24,9 +24,11 @@
 const {
   ArrayBuffer,
   Error,
+  Int32Array,
   MathMax,
   NumberIsFinite,
   NumberIsNaN,
+  NumberMAX_SAFE_INTEGER,
   ObjectDefineProperties,
   ObjectDefineProperty,
   ObjectFreeze,
@@ -44,6 +46,7 @@ const {
     ERR_INVALID_ARG_TYPE,
     ERR_OUT_OF_RANGE,
     ERR_ZLIB_INITIALIZATION_FAILED,
+    ERR_ZSTD_INVALID_PARAM,
   },
   hideStackFrames
 } = require('internal/errors');
@@ -77,10 +80,12 @@ const {
   Z_DEFAULT_STRATEGY, Z_DEFAULT_WINDOWBITS, Z_DEFAULT_MEMLEVEL, Z_FIXED,
   // Node's compression stream modes (node_zlib_mode)
   DEFLATE, DEFLATERAW, INFLATE, INFLATERAW, GZIP, GUNZIP, UNZIP,
-  BROTLI_DECODE, BROTLI_ENCODE,
+  BROTLI_DECODE, BROTLI_ENCODE, ZSTD_COMPRESS, ZSTD_DECOMPRESS,
   // Brotli operations (~flush levels)
   BROTLI_OPERATION_PROCESS, BROTLI_OPERATION_FLUSH,
-  BROTLI_OPERATION_FINISH
+  BROTLI_OPERATION_FINISH,
+  // Zstd end directives (~flush levels)
+  ZSTD_e_continue, ZSTD_e_flush, ZSTD_e_end
 } = constants;
 
 // Translation table for return codes.
@@ -237,7 +242,7 @@ function ZlibBase(opts, mode, handle, { flush, finishFlush, fullFlush }) {
   // The ZlibBase class is not exported to user land, the mode should only be
   // passed in by us.
   assert(typeof mode === 'number');
-  assert(mode >= DEFLATE && mode <= BROTLI_ENCODE);
+  assert(mode >= DEFLATE && mode <= ZSTD_DECOMPRESS);
 
   if (opts) {
     chunkSize = opts.chunkSize;
@@ -846,6 +851,112 @@ ObjectSetPrototypeOf(BrotliDecompress.prototype, Brotli.prototype);
 ObjectSetPrototypeOf(BrotliDecompress, Brotli);
 
 
+const kMaxZstdCParam = MathMax(...ObjectKeys(constants).map((key) => {
+  return key.startsWith('ZSTD_c_') ? constants[key] : 0;
+}));
+const kMaxZstdDParam = MathMax(...ObjectKeys(constants).map((key) => {
+  return key.startsWith('ZSTD_d_') ? constants[key] : 0;
+}));
+
+// The parameters are passed to the binding as key/value pairs, since every
+// value, including -1, is valid for some of them.
+const zstdInitParamsArray =
+  new Int32Array(2 * (MathMax(kMaxZstdCParam, kMaxZstdDParam) + 1));
+
+const zstdDefaultOpts = {
+  flush: ZSTD_e_continue,
+  finishFlush: ZSTD_e_end,
+  fullFlush: ZSTD_e_flush
+};
+
+function hasZstdParam(paramCount, key) {
+  for (let i = 0; i < paramCount; i++) {
+    if (zstdInitParamsArray[2 * i] === key)
+      return true;
+  }
+  return false;
+}
+
+function Zstd(opts, mode) {
+  assert(mode === ZSTD_COMPRESS || mode === ZSTD_DECOMPRESS);
+
+  const maxParam = mode === ZSTD_COMPRESS ? kMaxZstdCParam : kMaxZstdDParam;
+
+  let paramCount = 0;
+  let pledgedSrcSize;
+  let dictionary;
+  if (opts) {
+    if (opts.params) {
+      for (const origKey of ObjectKeys(opts.params)) {
+        const key = +origKey;
+        if (NumberIsNaN(key) || key < 0 || key > maxParam ||
+            hasZstdParam(paramCount, key)) {
+          throw new ERR_ZSTD_INVALID_PARAM(origKey);
+        }
+
+        const value = opts.params[origKey];
+        if (typeof value !== 'number' && typeof value !== 'boolean') {
+          throw new ERR_INVALID_ARG_TYPE('options.params[key]',
+                                         'number', opts.params[origKey]);
+        }
+        zstdInitParamsArray[2 * paramCount] = key;
+        zstdInitParamsArray[2 * paramCount + 1] = value;
+        paramCount++;
+      }
+    }
+
+    pledgedSrcSize = checkRangesOrGetDefault(
+      opts.pledgedSrcSize, 'options.pledgedSrcSize',
+      0, NumberMAX_SAFE_INTEGER, undefined);
+
+    dictionary = opts.dictionary;
+    if (dictionary !== undefined && !isArrayBufferView(dictionary)) {
+      if (isAnyArrayBuffer(dictionary)) {
+        dictionary = Buffer.from(dictionary);
+      } else {
+        throw new ERR_INVALID_ARG_TYPE(
+          'options.dictionary',
+          ['Buffer', 'TypedArray', 'DataView', 'ArrayBuffer'],
+          dictionary
+        );
+      }
+    }
+  }
+
+  const handle = mode === ZSTD_COMPRESS ?
+    new binding.ZstdCompress(mode) : new binding.ZstdDecompress(mode);
+
+  this._writeState = new Uint32Array(2);
+  if (!handle.init(zstdInitParamsArray.subarray(0, 2 * paramCount),
+                   pledgedSrcSize,
+                   this._writeState,
+                   processCallback,
+                   dictionary)) {
+    throw new ERR_ZLIB_INITIALIZATION_FAILED();
+  }
+
+  ZlibBase.call(this, opts, mode, handle, zstdDefaultOpts);
+}
+ObjectSetPrototypeOf(Zstd.prototype, ZlibBase.prototype);
+ObjectSetPrototypeOf(Zstd, ZlibBase);
+
+function ZstdCompress(opts) {
+  if (!(this instanceof ZstdCompress))
+    return new ZstdCompress(opts);
+  Zstd.call(this, opts, ZSTD_COMPRESS);
+}
+ObjectSetPrototypeOf(ZstdCompress.prototype, Zstd.prototype);
+ObjectSetPrototypeOf(ZstdCompress, Zstd);
+
+function ZstdDecompress(opts) {
+  if (!(this instanceof ZstdDecompress))
+    return new ZstdDecompress(opts);
+  Zstd.call(this, opts, ZSTD_DECOMPRESS);
+}
+ObjectSetPrototypeOf(ZstdDecompress.prototype, Zstd.prototype);
+ObjectSetPrototypeOf(ZstdDecompress, Zstd);
+
+
 function createProperty(ctor) {
   return {
     configurable: true,
@@ -873,6 +984,8 @@ module.exports = {
   Unzip,
   BrotliCompress,
   BrotliDecompress,
+  ZstdCompress,
+  ZstdDecompress,
 
   // Convenience methods.
   // compress/decompress a string or buffer in one step.
@@ -894,6 +1007,10 @@ module.exports = {
   brotliCompressSync: createConvenienceMethod(BrotliCompress, true),
   brotliDecompress: createConvenienceMethod(BrotliDecompress, false),
   brotliDecompressSync: createConvenienceMethod(BrotliDecompress, true),
+  zstdCompress: createConvenienceMethod(ZstdCompress, false),
+  zstdCompressSync: createConvenienceMethod(ZstdCompress, true),
+  zstdDecompress: createConvenienceMethod(ZstdDecompress, false),
+  zstdDecompressSync: createConvenienceMethod(ZstdDecompress, true),
 };
 
 ObjectDefineProperties(module.exports, {
@@ -906,6 +1023,8 @@ ObjectDefineProperties(module.exports, {
   createUnzip: createProperty(Unzip),
   createBrotliCompress: createProperty(BrotliCompress),
   createBrotliDecompress: createProperty(BrotliDecompress),
+  createZstdCompress: createProperty(ZstdCompress),
+  createZstdDecompress: createProperty(ZstdDecompress),
   constants: {
     configurable: false,
     enumerable: true,
@@ -921,7 +1040,7 @@ ObjectDefineProperties(module.exports, {
 // These should be considered deprecated
 // expose all the zlib constants
 for (const bkey of ObjectKeys(constants)) {
-  if (bkey.startsWith('BROTLI')) continue;
+  if (bkey.startsWith('BROTLI') || bkey.startsWith('ZSTD')) continue;
   ObjectDefineProperty(module.exports, bkey, {
     enumerable: false, value: constants[bkey], writable: false
   });
@@ -16,6 +16,7 @@
     'ossfuzz' : 'false',
     'node_module_version%': '',
     'node_shared_brotli%': 'false',
+    'node_shared_zstd%': 'false',
     'node_shared_zlib%': 'false',
     'node_shared_http_parser%': 'false',
     'node_shared_cares%': 'false',
@@ -106,7 +107,9 @@
       'lib/internal/assert.js',
       'lib/internal/assert/assertion_error.js',
       'lib/internal/assert/calltracker.js',
+      'lib/internal/async_context_frame.js',
       'lib/internal/async_hooks.js',
+      'lib/internal/async_local_storage.js',
       'lib/internal/blocklist.js',
       'lib/internal/buffer.js',
       'lib/internal/cli_table.js',
@@ -170,6 +173,7 @@
       'lib/internal/main/eval_string.js',
       'lib/internal/main/eval_stdin.js',
       'lib/internal/main/inspect.js',
+      'lib/internal/main/mksnapshot.js',
       'lib/internal/main/print_help.js',
       'lib/internal/main/prof_process.js',
       'lib/internal/main/repl.js',
@@ -230,6 +234,7 @@
       'lib/internal/http2/core.js',
       'lib/internal/http2/compat.js',
       'lib/internal/http2/util.js',
+      'lib/internal/v8/startup_snapshot.js',
       'lib/internal/v8_prof_polyfill.js',
       'lib/internal/v8_prof_processor.js',
       'lib/internal/validators.js',
@@ -583,6 +588,7 @@
         'src/api/utils.cc',
         'src/async_wrap.cc',
         'src/cares_wrap.cc',
+        'src/compile_cache.cc',
         'src/connect_wrap.cc',
         'src/connection_wrap.cc',
         'src/debug_utils.cc',
@@ -607,6 +613,7 @@
         'src/node_config.cc',
         'src/node_constants.cc',
         'src/node_contextify.cc',
+        'src/node_continuous_profiler.cc',
         'src/node_credentials.cc',
         'src/node_dir.cc',
         'src/node_env_var.cc',
@@ -633,6 +640,7 @@
         'src/node_report_module.cc',
         'src/node_report_utils.cc',
         'src/node_serdes.cc',
+        'src/node_snapshotable.cc',
         'src/node_sockaddr.cc',
         'src/node_stat_watcher.cc',
         'src/node_symbols.cc',
@@ -652,15 +660,18 @@
         'src/spawn_sync.cc',
         'src/stream_base.cc',
         'src/stream_pipe.cc',
+        'src/stream_source.cc',
         'src/stream_wrap.cc',
         'src/string_bytes.cc',
         'src/string_decoder.cc',
         'src/tcp_wrap.cc',
         'src/timers.cc',
+        'src/timer_wheel.cc',
         'src/timer_wrap.cc',
         'src/tracing/agent.cc',
         'src/tracing/node_trace_buffer.cc',
         'src/tracing/node_trace_writer.cc',
+        'src/tracing/proto_trace_writer.cc',
         'src/tracing/trace_event.cc',
         'src/tracing/traced_value.cc',
         'src/tty_wrap.cc',
@@ -681,6 +692,7 @@
         'src/base64-inl.h',
         'src/callback_queue.h',
         'src/callback_queue-inl.h',
+        'src/compile_cache.h',
         'src/connect_wrap.h',
         'src/connection_wrap.h',
         'src/debug_utils.h',
@@ -705,6 +717,7 @@
         'src/node_constants.h',
         'src/node_context_data.h',
         'src/node_contextify.h',
+        'src/node_continuous_profiler.h',
         'src/node_dir.h',
         'src/node_errors.h',
         'src/node_external_reference.h',
@@ -734,12 +747,14 @@
         'src/node_report.h',
         'src/node_revert.h',
         'src/node_root_certs.h',
+        'src/node_snapshotable.h',
         'src/node_sockaddr.h',
         'src/node_sockaddr-inl.h',
         'src/node_stat_watcher.h',
         'src/node_union_bytes.h',
         'src/node_url.h',
         'src/node_version.h',
+        'src/node_v8.h',
         'src/node_v8_platform-inl.h',
         'src/node_wasi.h',
         'src/node_watchdog.h',
@@ -751,6 +766,7 @@
         'src/stream_base.h',
         'src/stream_base-inl.h',
         'src/stream_pipe.h',
+        'src/stream_source.h',
         'src/stream_wrap.h',
         'src/string_bytes.h',
         'src/string_decoder.h',
@@ -760,9 +776,11 @@
         'src/tracing/agent.h',
         'src/tracing/node_trace_buffer.h',
         'src/tracing/node_trace_writer.h',
+        'src/tracing/proto_trace_writer.h',
         'src/tracing/trace_event.h',
         'src/tracing/trace_event_common.h',
         'src/tracing/traced_value.h',
+        'src/timer_wheel.h',
         'src/timer_wrap.h',
         'src/tty_wrap.h',
         'src/udp_wrap.h',
@@ -934,6 +952,7 @@
             'src/crypto/crypto_keys.cc',
             'src/crypto/crypto_keygen.cc',
             'src/crypto/crypto_scrypt.cc',
+            'src/crypto/crypto_sha256_mb.cc',
             'src/crypto/crypto_tls.cc',
             'src/crypto/crypto_aes.cc',
             'src/crypto/crypto_bio.h',
@@ -951,6 +970,7 @@
             'src/crypto/crypto_keys.h',
             'src/crypto/crypto_keygen.h',
             'src/crypto/crypto_scrypt.h',
+            'src/crypto/crypto_sha256_mb.h',
             'src/crypto/crypto_tls.h',
             'src/crypto/crypto_clienthello.h',
             'src/crypto/crypto_context.h',
@@ -1345,11 +1365,13 @@
         'test/cctest/test_base_object_ptr.cc',
         'test/cctest/test_node_postmortem_metadata.cc',
         'test/cctest/test_environment.cc',
+        'test/cctest/test_histogram.cc',
         'test/cctest/test_linked_binding.cc',
         'test/cctest/test_per_process.cc',
         'test/cctest/test_platform.cc',
         'test/cctest/test_json_utils.cc',
         'test/cctest/test_sockaddr.cc',
+        'test/cctest/test_timer_wheel.cc',
         'test/cctest/test_traced_value.cc',
         'test/cctest/test_util.cc',
         'test/cctest/test_url.cc',
@@ -1556,8 +1578,6 @@
         'src/node_snapshot_stub.cc',
         'src/node_code_cache_stub.cc',
         'tools/snapshot/node_mksnapshot.cc',
-        'tools/snapshot/snapshot_builder.cc',
-        'tools/snapshot/snapshot_builder.h',
       ],
 
       'conditions': [
@@ -38,12 +38,14 @@ InternalCallbackScope::InternalCallbackScope(AsyncWrap* async_wrap, int flags)
                             async_wrap->object(),
                             { async_wrap->get_async_id(),
                               async_wrap->get_trigger_async_id() },
-                            flags) {}
+                            flags,
+                            async_wrap->context_frame()) {}
 
 InternalCallbackScope::InternalCallbackScope(Environment* env,
                                              Local<Object> object,
                                              const async_context& asyncContext,
-                                             int flags)
+                                             int flags,
+                                             Local<Value> context_frame)
   : env_(env),
     async_context_(asyncContext),
     object_(object),
@@ -52,11 +54,22 @@ InternalCallbackScope::InternalCallbackScope(Environment* env,
   CHECK_NOT_NULL(env);
   env->PushAsyncCallbackScope();
 
+  if (env->async_callback_scope_depth() == 1) {
+    env->loop_phase_tracer()->CountCallback();
+    TRACE_EVENT_BEGIN0(TRACING_CATEGORY_NODE1(loop), "InternalCallbackScope");
+  }
+
   if (!env->can_call_into_js()) {
     failed_ = true;
     return;
   }
 
+  if (!context_frame.IsEmpty()) {
+    Local<Context> context = env->context();
+    prior_context_frame_ = context->GetContinuationPreservedEmbedderData();
+    context->SetContinuationPreservedEmbedderData(context_frame);
+  }
+
   HandleScope handle_scope(env->isolate());
   // If you hit this assertion, you forgot to enter the v8::Context first.
   CHECK_EQ(Environment::GetCurrent(env->isolate()), env);
@@ -75,6 +88,8 @@ InternalCallbackScope::InternalCallbackScope(Environment* env,
 
 InternalCallbackScope::~InternalCallbackScope() {
   Close();
+  if (env_->async_callback_scope_depth() == 1)
+    TRACE_EVENT_END0(TRACING_CATEGORY_NODE1(loop), "InternalCallbackScope");
   env_->PopAsyncCallbackScope();
 }
 
@@ -98,6 +113,11 @@ void InternalCallbackScope::Close() {
   if (pushed_ids_)
     env_->async_hooks()->pop_async_context(async_context_.async_id);
 
+  if (!prior_context_frame_.IsEmpty()) {
+    env_->context()->SetContinuationPreservedEmbedderData(
+        prior_context_frame_);
+  }
+
   if (failed_) return;
 
   if (env_->async_callback_scope_depth() > 1 || skip_task_queues_) {
@@ -111,6 +131,7 @@ void InternalCallbackScope::Close() {
   auto weakref_cleanup = OnScopeLeave([&]() { env_->RunWeakRefCleanup(); });
 
   if (!tick_info->has_tick_scheduled()) {
+    TRACE_EVENT0(TRACING_CATEGORY_NODE1(loop), "PerformCheckpoint");
     MicrotasksScope::PerformCheckpoint(env_->isolate());
 
     perform_stopping_check();
@@ -138,6 +159,7 @@ void InternalCallbackScope::Close() {
   // to initializes the tick callback during bootstrap.
   CHECK(!tick_callback.IsEmpty());
 
+  TRACE_EVENT0(TRACING_CATEGORY_NODE1(loop), "ProcessTicksAndRejections");
   if (tick_callback->Call(env_->context(), process, 0, nullptr).IsEmpty()) {
     failed_ = true;
   }
@@ -150,7 +172,8 @@ MaybeLocal<Value> InternalMakeCallback(Environment* env,
                                        const Local<Function> callback,
                                        int argc,
                                        Local<Value> argv[],
-                                       async_context asyncContext) {
+                                       async_context asyncContext,
+                                       Local<Value> context_frame) {
   CHECK(!recv.IsEmpty());
 #ifdef DEBUG
   for (int i = 0; i < argc; i++)
@@ -171,7 +194,8 @@ MaybeLocal<Value> InternalMakeCallback(Environment* env,
         async_hooks->fields()[AsyncHooks::kUsesExecutionAsyncResource] > 0;
   }
 
-  InternalCallbackScope scope(env, resource, asyncContext, flags);
+  InternalCallbackScope scope(
+      env, resource, asyncContext, flags, context_frame);
   if (scope.Failed()) {
     return MaybeLocal<Value>();
   }
@@ -50,6 +50,11 @@ inline double AsyncWrap::get_trigger_async_id() const {
 }
 
 
+inline v8::Local<v8::Value> AsyncWrap::context_frame() const {
+  return PersistentToLocal::Strong(context_frame_);
+}
+
+
 inline v8::MaybeLocal<v8::Value> AsyncWrap::MakeCallback(
     const v8::Local<v8::String> symbol,
     int argc,
@@ -22,6 +22,7 @@
 #include "async_wrap.h"  // NOLINT(build/include_inline)
 #include "async_wrap-inl.h"
 #include "env-inl.h"
+#include "node_continuous_profiler.h"
 #include "node_errors.h"
 #include "node_external_reference.h"
 #include "tracing/traced_value.h"
@@ -43,15 +44,12 @@ using v8::Just;
 using v8::Local;
 using v8::Maybe;
 using v8::MaybeLocal;
-using v8::Name;
 using v8::Nothing;
 using v8::Number;
 using v8::Object;
-using v8::ObjectTemplate;
 using v8::Promise;
 using v8::PromiseHookType;
 using v8::PropertyAttribute;
-using v8::PropertyCallbackInfo;
 using v8::ReadOnly;
 using v8::String;
 using v8::Undefined;
@@ -173,116 +171,58 @@ static Maybe<double> GetAssignedPromiseAsyncId(Environment* env,
       : Just(AsyncWrap::kInvalidAsyncId);
 }
 
-class PromiseWrap : public AsyncWrap {
- public:
-  PromiseWrap(Environment* env, Local<Object> object, bool silent)
-      : AsyncWrap(env, object, PROVIDER_PROMISE, kInvalidAsyncId, silent) {
-    MakeWeak();
+// When no init or destroy hook is enabled, the async ids of a promise are only
+// assigned once a hook observes it. Until then, its internal field holds the
+// parent promise, or the trigger async id it was created with.
+static void DeferPromiseAsyncIds(Environment* env,
+                                 Local<Promise> promise,
+                                 Local<Value> parent) {
+  if (parent->IsPromise()) {
+    promise->SetInternalField(0, parent);
+  } else {
+    promise->SetInternalField(
+        0, Number::New(env->isolate(), env->get_default_trigger_async_id()));
   }
+}
 
-  PromiseWrap(Environment* env, Local<Object> object, double asyncId,
-    double triggerAsyncId)
-      : AsyncWrap(env, object, PROVIDER_PROMISE, asyncId, triggerAsyncId) {
-    MakeWeak();
+static Maybe<double> AssignPromiseAsyncIds(Environment* env,
+                                           Local<Promise> promise,
+                                           bool assign_parent = true) {
+  double async_id;
+  if (!GetAssignedPromiseAsyncId(env, promise, env->async_id_symbol())
+          .To(&async_id)) return Nothing<double>();
+  if (async_id != AsyncWrap::kInvalidAsyncId)
+    return Just(async_id);
+
+  Local<Value> field = promise->GetInternalField(0);
+  double trigger_async_id = 0;
+  if (field->IsPromise() && assign_parent) {
+    // Only look one level up, the ancestors of a promise are usually
+    // observed before the promise itself.
+    if (!AssignPromiseAsyncIds(env, field.As<Promise>(), false)
+            .To(&trigger_async_id)) return Nothing<double>();
+  } else if (field->IsNumber()) {
+    trigger_async_id = field.As<Number>()->Value();
   }
+  // Promises that were created before the hooks were enabled have no
+  // trigger.
+  if (trigger_async_id <= 0)
+    trigger_async_id = env->get_default_trigger_async_id();
 
-  SET_NO_MEMORY_INFO()
-  SET_MEMORY_INFO_NAME(PromiseWrap)
-  SET_SELF_SIZE(PromiseWrap)
-
-  static PromiseWrap* New(Environment* env,
-                          Local<Promise> promise,
-                          bool silent);
-  static void GetAsyncId(Local<Name> property,
-                         const PropertyCallbackInfo<Value>& args);
-  static void GetTriggerAsyncId(Local<Name> property,
-                                const PropertyCallbackInfo<Value>& args);
-
-  static void Initialize(Environment* env);
-};
-
-PromiseWrap* PromiseWrap::New(Environment* env,
-                              Local<Promise> promise,
-                              bool silent) {
+  Isolate* isolate = env->isolate();
   Local<Context> context = env->context();
-
-  Local<Object> obj;
-  if (!env->promise_wrap_template()->NewInstance(context).ToLocal(&obj))
-    return nullptr;
-
-  CHECK_NULL(promise->GetAlignedPointerFromInternalField(0));
-  promise->SetInternalField(0, obj);
-
-  // Skip for init events
-  if (silent) {
-    double async_id;
-    double trigger_async_id;
-    if (!GetAssignedPromiseAsyncId(env, promise, env->async_id_symbol())
-            .To(&async_id)) return nullptr;
-    if (!GetAssignedPromiseAsyncId(env, promise, env->trigger_async_id_symbol())
-            .To(&trigger_async_id)) return nullptr;
-
-    if (async_id != AsyncWrap::kInvalidAsyncId &&
-        trigger_async_id != AsyncWrap::kInvalidAsyncId) {
-      return new PromiseWrap(
-          env, obj, async_id, trigger_async_id);
-    }
+  async_id = env->new_async_id();
+  if (promise->Set(context,
+                   env->async_id_symbol(),
+                   Number::New(isolate, async_id)).IsNothing() ||
+      promise->Set(context,
+                   env->trigger_async_id_symbol(),
+                   Number::New(isolate, trigger_async_id)).IsNothing()) {
+    return Nothing<double>();
   }
-
-  return new PromiseWrap(env, obj, silent);
-}
-
-void PromiseWrap::GetAsyncId(Local<Name> property,
-                             const PropertyCallbackInfo<Value>& info) {
-  Isolate* isolate = info.GetIsolate();
-  HandleScope scope(isolate);
-
-  PromiseWrap* wrap = Unwrap<PromiseWrap>(info.Holder());
-  double value = wrap->get_async_id();
-
-  info.GetReturnValue().Set(Number::New(isolate, value));
-}
-
-void PromiseWrap::GetTriggerAsyncId(Local<Name> property,
-                                    const PropertyCallbackInfo<Value>& info) {
-  Isolate* isolate = info.GetIsolate();
-  HandleScope scope(isolate);
-
-  PromiseWrap* wrap = Unwrap<PromiseWrap>(info.Holder());
-  double value = wrap->get_trigger_async_id();
-
-  info.GetReturnValue().Set(Number::New(isolate, value));
-}
-
-void PromiseWrap::Initialize(Environment* env) {
-  Isolate* isolate = env->isolate();
-  HandleScope scope(isolate);
-
-  Local<FunctionTemplate> ctor = FunctionTemplate::New(isolate);
-  ctor->SetClassName(FIXED_ONE_BYTE_STRING(isolate, "PromiseWrap"));
-
-  Local<ObjectTemplate> promise_wrap_template = ctor->InstanceTemplate();
-  env->set_promise_wrap_template(promise_wrap_template);
-
-  promise_wrap_template->SetInternalFieldCount(
-      PromiseWrap::kInternalFieldCount);
-
-  promise_wrap_template->SetAccessor(
-      env->async_id_symbol(),
-      PromiseWrap::GetAsyncId);
-
-  promise_wrap_template->SetAccessor(
-      env->trigger_async_id_symbol(),
-      PromiseWrap::GetTriggerAsyncId);
-}
-
-static PromiseWrap* extractPromiseWrap(Local<Promise> promise) {
-  // This check is imperfect. If the internal field is set, it should
-  // be an object. If it's not, we just ignore it. Ideally v8 would
-  // have had GetInternalField returning a MaybeLocal but this works
-  // for now.
-  Local<Value> obj = promise->GetInternalField(0);
-  return obj->IsObject() ? Unwrap<PromiseWrap>(obj.As<Object>()) : nullptr;
+  // Do not keep the parent promise alive any longer.
+  promise->SetInternalField(0, Number::New(isolate, trigger_async_id));
+  return Just(async_id);
 }
 
 static uint16_t ToAsyncHooksType(PromiseHookType type) {
@@ -295,13 +235,29 @@ static uint16_t ToAsyncHooksType(PromiseHookType type) {
   UNREACHABLE();
 }
 
-// Simplified JavaScript hook fast-path for when there is no destroy hook
+// Promises are not wrapped in AsyncWraps. Their async ids are stored on the
+// promise itself, and the promise is the resource passed to the JS hooks.
 static void FastPromiseHook(PromiseHookType type, Local<Promise> promise,
                             Local<Value> parent) {
   Local<Context> context = promise->CreationContext();
   Environment* env = Environment::GetCurrent(context);
   if (env == nullptr) return;
 
+  if (type == PromiseHookType::kResolve &&
+      env->async_hooks()->fields()[AsyncHooks::kPromiseResolve] == 0) {
+    return;
+  }
+
+  if (type == PromiseHookType::kInit) {
+    if (env->async_hooks()->fields()[AsyncHooks::kInit] == 0 &&
+        env->async_hooks()->fields()[AsyncHooks::kDestroy] == 0) {
+      DeferPromiseAsyncIds(env, promise, parent);
+      return;
+    }
+  } else if (AssignPromiseAsyncIds(env, promise).IsNothing()) {
+    return;
+  }
+
   if (type == PromiseHookType::kBefore &&
       env->async_hooks()->fields()[AsyncHooks::kBefore] == 0) {
     double async_id;
@@ -335,11 +291,6 @@ static void FastPromiseHook(PromiseHookType type, Local<Promise> promise,
     }
   }
 
-  if (type == PromiseHookType::kResolve &&
-      env->async_hooks()->fields()[AsyncHooks::kPromiseResolve] == 0) {
-    return;
-  }
-
   // Getting up to this point means either init type or
   // that there are active hooks of another type.
   // In both cases fast-path JS hook should be called.
@@ -355,61 +306,6 @@ static void FastPromiseHook(PromiseHookType type, Local<Promise> promise,
   USE(promise_hook->Call(context, Undefined(env->isolate()), 3, argv));
 }
 
-static void FullPromiseHook(PromiseHookType type, Local<Promise> promise,
-                            Local<Value> parent) {
-  Local<Context> context = promise->CreationContext();
-
-  Environment* env = Environment::GetCurrent(context);
-  if (env == nullptr) return;
-  TraceEventScope trace_scope(TRACING_CATEGORY_NODE1(environment),
-                              "EnvPromiseHook", env);
-
-  PromiseWrap* wrap = extractPromiseWrap(promise);
-  if (type == PromiseHookType::kInit || wrap == nullptr) {
-    bool silent = type != PromiseHookType::kInit;
-
-    // set parent promise's async Id as this promise's triggerAsyncId
-    if (parent->IsPromise()) {
-      // parent promise exists, current promise
-      // is a chained promise, so we set parent promise's id as
-      // current promise's triggerAsyncId
-      Local<Promise> parent_promise = parent.As<Promise>();
-      PromiseWrap* parent_wrap = extractPromiseWrap(parent_promise);
-      if (parent_wrap == nullptr) {
-        parent_wrap = PromiseWrap::New(env, parent_promise, true);
-        if (parent_wrap == nullptr) return;
-      }
-
-      AsyncHooks::DefaultTriggerAsyncIdScope trigger_scope(parent_wrap);
-      wrap = PromiseWrap::New(env, promise, silent);
-    } else {
-      wrap = PromiseWrap::New(env, promise, silent);
-    }
-  }
-
-  if (wrap == nullptr) return;
-
-  if (type == PromiseHookType::kBefore) {
-    env->async_hooks()->push_async_context(wrap->get_async_id(),
-      wrap->get_trigger_async_id(), wrap->object());
-    wrap->EmitTraceEventBefore();
-    AsyncWrap::EmitBefore(wrap->env(), wrap->get_async_id());
-  } else if (type == PromiseHookType::kAfter) {
-    wrap->EmitTraceEventAfter(wrap->provider_type(), wrap->get_async_id());
-    AsyncWrap::EmitAfter(wrap->env(), wrap->get_async_id());
-    if (env->execution_async_id() == wrap->get_async_id()) {
-      // This condition might not be true if async_hooks was enabled during
-      // the promise callback execution.
-      // Popping it off the stack can be skipped in that case, because it is
-      // known that it would correspond to exactly one call with
-      // PromiseHookType::kBefore that was not witnessed by the PromiseHook.
-      env->async_hooks()->pop_async_context(wrap->get_async_id());
-    }
-  } else if (type == PromiseHookType::kResolve) {
-    AsyncWrap::EmitPromiseResolve(wrap->env(), wrap->get_async_id());
-  }
-}
-
 static void SetupHooks(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -444,12 +340,9 @@ static void SetupHooks(const FunctionCallbackInfo<Value>& args) {
 static void EnablePromiseHook(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
-  if (args[0]->IsFunction()) {
-    env->set_promise_hook_handler(args[0].As<Function>());
-    args.GetIsolate()->SetPromiseHook(FastPromiseHook);
-  } else {
-    args.GetIsolate()->SetPromiseHook(FullPromiseHook);
-  }
+  CHECK(args[0]->IsFunction());
+  env->set_promise_hook_handler(args[0].As<Function>());
+  args.GetIsolate()->SetPromiseHook(FastPromiseHook);
 }
 
 
@@ -480,20 +373,21 @@ void AsyncWrap::WeakCallback(const WeakCallbackInfo<DestroyParam>& info) {
   HandleScope scope(info.GetIsolate());
 
   std::unique_ptr<DestroyParam> p{info.GetParameter()};
-  Local<Object> prop_bag = PersistentToLocal::Default(info.GetIsolate(),
-                                                      p->propBag);
-  Local<Value> val;
 
   p->env->RemoveCleanupHook(DestroyParamCleanupHook, p.get());
 
-  if (!prop_bag->Get(p->env->context(), p->env->destroyed_string())
-        .ToLocal(&val)) {
-    return;
+  // Without a property bag, the destroy hook cannot be emitted manually.
+  if (!p->propBag.IsEmpty()) {
+    Local<Object> prop_bag = PersistentToLocal::Default(info.GetIsolate(),
+                                                        p->propBag);
+    Local<Value> val;
+    if (!prop_bag->Get(p->env->context(), p->env->destroyed_string())
+          .ToLocal(&val) || !val->IsFalse()) {
+      return;
+    }
   }
 
-  if (val->IsFalse()) {
-    AsyncWrap::EmitDestroy(p->env, p->asyncId);
-  }
+  AsyncWrap::EmitDestroy(p->env, p->asyncId);
   // unique_ptr goes out of scope here and pointer is deleted.
 }
 
@@ -501,14 +395,15 @@ void AsyncWrap::WeakCallback(const WeakCallbackInfo<DestroyParam>& info) {
 static void RegisterDestroyHook(const FunctionCallbackInfo<Value>& args) {
   CHECK(args[0]->IsObject());
   CHECK(args[1]->IsNumber());
-  CHECK(args[2]->IsObject());
+  CHECK(args[2]->IsObject() || args[2]->IsUndefined());
 
   Isolate* isolate = args.GetIsolate();
   DestroyParam* p = new DestroyParam();
   p->asyncId = args[1].As<Number>()->Value();
   p->env = Environment::GetCurrent(args);
   p->target.Reset(isolate, args[0].As<Object>());
-  p->propBag.Reset(isolate, args[2].As<Object>());
+  if (args[2]->IsObject())
+    p->propBag.Reset(isolate, args[2].As<Object>());
   p->target.SetWeak(p, AsyncWrap::WeakCallback, WeakCallbackType::kParameter);
   p->env->AddCleanupHook(DestroyParamCleanupHook, p);
 }
@@ -575,6 +470,23 @@ void AsyncWrap::GetProviderType(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// The async context frame lives in the continuation-preserved embedder data
+// of the context, which V8 captures when a promise reaction is created and
+// restores while the reaction job runs.
+void AsyncWrap::GetContextFrame(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  args.GetReturnValue().Set(
+      env->context()->GetContinuationPreservedEmbedderData());
+}
+
+
+void AsyncWrap::SetContextFrame(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsObject() || args[0]->IsUndefined());
+  env->context()->SetContinuationPreservedEmbedderData(args[0]);
+}
+
+
 void AsyncWrap::EmitDestroy(bool from_gc) {
   AsyncWrap::EmitDestroy(env(), async_id_);
   // Ensure no double destroy is emitted via AsyncReset().
@@ -633,6 +545,8 @@ void AsyncWrap::Initialize(Local<Object> target,
   env->SetMethod(target, "enablePromiseHook", EnablePromiseHook);
   env->SetMethod(target, "disablePromiseHook", DisablePromiseHook);
   env->SetMethod(target, "registerDestroyHook", RegisterDestroyHook);
+  env->SetMethod(target, "getContextFrame", GetContextFrame);
+  env->SetMethod(target, "setContextFrame", SetContextFrame);
 
   PropertyAttribute ReadOnlyDontDelete =
       static_cast<PropertyAttribute>(ReadOnly | DontDelete);
@@ -710,9 +624,6 @@ void AsyncWrap::Initialize(Local<Object> target,
   env->set_async_hooks_destroy_function(Local<Function>());
   env->set_async_hooks_promise_resolve_function(Local<Function>());
   env->set_async_hooks_binding(target);
-
-  // TODO(qard): maybe this should be GetConstructorTemplate instead?
-  PromiseWrap::Initialize(env);
 }
 
 void AsyncWrap::RegisterExternalReferences(
@@ -727,11 +638,11 @@ void AsyncWrap::RegisterExternalReferences(
   registry->Register(EnablePromiseHook);
   registry->Register(DisablePromiseHook);
   registry->Register(RegisterDestroyHook);
+  registry->Register(GetContextFrame);
+  registry->Register(SetContextFrame);
   registry->Register(AsyncWrap::GetAsyncId);
   registry->Register(AsyncWrap::AsyncReset);
   registry->Register(AsyncWrap::GetProviderType);
-  registry->Register(PromiseWrap::GetAsyncId);
-  registry->Register(PromiseWrap::GetTriggerAsyncId);
 }
 
 AsyncWrap::AsyncWrap(Environment* env,
@@ -754,15 +665,6 @@ AsyncWrap::AsyncWrap(Environment* env,
   init_hook_ran_ = true;
 }
 
-AsyncWrap::AsyncWrap(Environment* env,
-                     Local<Object> object,
-                     ProviderType provider,
-                     double execution_async_id,
-                     double trigger_async_id)
-    : AsyncWrap(env, object, provider, execution_async_id, true) {
-  trigger_async_id_ = trigger_async_id;
-}
-
 AsyncWrap::AsyncWrap(Environment* env, Local<Object> object)
   : BaseObject(env, object) {
 }
@@ -863,6 +765,12 @@ void AsyncWrap::AsyncReset(Local<Object> resource, double execution_async_id,
     if (resource != obj) {
       USE(obj->Set(env()->context(), env()->resource_symbol(), resource));
     }
+
+    if (env()->options()->experimental_async_context_frame) {
+      context_frame_.Reset(
+          env()->isolate(),
+          env()->context()->GetContinuationPreservedEmbedderData());
+    }
   }
 
   switch (provider_type()) {
@@ -931,8 +839,13 @@ MaybeLocal<Value> AsyncWrap::MakeCallback(const Local<Function> cb,
 
   ProviderType provider = provider_type();
   async_context context { get_async_id(), get_trigger_async_id() };
-  MaybeLocal<Value> ret = InternalMakeCallback(
-      env(), object(), object(), cb, argc, argv, context);
+  MaybeLocal<Value> ret;
+  {
+    profiler::ContinuousCpuProfiler::CallbackScope profiler_scope(env(),
+                                                                 provider);
+    ret = InternalMakeCallback(
+        env(), object(), object(), cb, argc, argv, context, context_frame());
+  }
 
   // This is a static call with cached values because the `this` object may
   // no longer be alive at this point.
@@ -941,8 +854,12 @@ MaybeLocal<Value> AsyncWrap::MakeCallback(const Local<Function> cb,
   return ret;
 }
 
+const char* AsyncWrap::GetProviderName(ProviderType provider) {
+  return provider_names[provider];
+}
+
 std::string AsyncWrap::MemoryInfoName() const {
-  return provider_names[provider_type()];
+  return GetProviderName(provider_type());
 }
 
 std::string AsyncWrap::diagnostic_name() const {
@@ -158,6 +158,8 @@ class AsyncWrap : public BaseObject {
       const v8::FunctionCallbackInfo<v8::Value>& args);
   static void AsyncReset(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void GetProviderType(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void GetContextFrame(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetContextFrame(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void QueueDestroyAsyncId(
     const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetCallbackTrampoline(
@@ -184,9 +186,16 @@ class AsyncWrap : public BaseObject {
 
   inline ProviderType provider_type() const;
   inline ProviderType set_provider_type(ProviderType provider);
+  // Returns the name of the provider type, e.g. "TCPWRAP".
+  static const char* GetProviderName(ProviderType provider);
 
   inline double get_async_id() const;
   inline double get_trigger_async_id() const;
+  // The async context frame (the AsyncLocalStorage stores) that was active
+  // when this resource was initialized. It is restored around the callbacks
+  // of the resource by InternalCallbackScope. Empty, so that nothing is
+  // restored, unless --experimental-async-context-frame is used.
+  inline v8::Local<v8::Value> context_frame() const;
 
   void AsyncReset(v8::Local<v8::Object> resource,
                   double execution_async_id = kInvalidAsyncId,
@@ -223,23 +232,19 @@ class AsyncWrap : public BaseObject {
   bool IsDoneInitializing() const override;
 
  private:
-  friend class PromiseWrap;
-
   AsyncWrap(Environment* env,
-            v8::Local<v8::Object> promise,
+            v8::Local<v8::Object> object,
             ProviderType provider,
             double execution_async_id,
             bool silent);
-  AsyncWrap(Environment* env,
-            v8::Local<v8::Object> promise,
-            ProviderType provider,
-            double execution_async_id,
-            double trigger_async_id);
   ProviderType provider_type_ = PROVIDER_NONE;
   bool init_hook_ran_ = false;
   // Because the values may be Reset(), cannot be made const.
   double async_id_ = kInvalidAsyncId;
   double trigger_async_id_;
+  // Empty unless --experimental-async-context-frame is used. Otherwise, this
+  // is undefined when no frame was active.
+  v8::Global<v8::Value> context_frame_;
 };
 
 }  // namespace node
@@ -158,6 +158,10 @@ class BaseObject : public MemoryRetainer {
 
   virtual inline void OnGCCollect();
 
+  // Whether this object can be serialized into a user-land snapshot, i.e.
+  // whether it is a SnapshotableObject (see node_snapshotable.h).
+  virtual bool is_snapshotable() const { return false; }
+
  private:
   v8::Local<v8::Object> WrappedObject() const override;
   bool IsRootNode() const override;
@@ -0,0 +1,592 @@
+#include "compile_cache.h"
+#include "debug_utils-inl.h"
+#include "env-inl.h"
+#include "node_file.h"
+#include "node_internals.h"
+#include "node_version.h"
+#include "util-inl.h"
+#include "zlib.h"
+
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+namespace node {
+
+using v8::Function;
+using v8::HandleScope;
+using v8::Isolate;
+using v8::Local;
+using v8::Module;
+using v8::ScriptCompiler;
+using v8::String;
+using v8::UnboundModuleScript;
+
+namespace {
+
+constexpr uint32_t kCacheMagic = 0x4e434343;
+constexpr uint32_t kResolutionsMagic = 0x4e524553;
+constexpr const char* kResolutionsFilename = "resolutions";
+// Resolutions that have not been looked up are dropped above this.
+constexpr size_t kMaxResolutions = 1 << 16;
+#ifdef _WIN32
+constexpr const char* kSeparators = "\\/";
+#else
+constexpr const char* kSeparators = "/";
+#endif
+
+// Written in front of the data of each cache file.
+struct CacheHeader {
+  uint32_t magic;
+  uint32_t type;
+  uint32_t filename_hash;
+  uint32_t source_hash;
+  uint32_t source_length;
+  uint32_t cache_size;
+  uint32_t cache_hash;
+};
+
+uint32_t Hash(uint32_t seed, const void* data, size_t length) {
+  return crc32(seed, reinterpret_cast<const Bytef*>(data), length);
+}
+
+const char* TypeName(CachedCodeType type) {
+  return type == CachedCodeType::kCommonJS ? "CommonJS" : "ESM";
+}
+
+class Writer {
+ public:
+  template <typename T>
+  void Write(T value) {
+    static_assert(std::is_trivially_copyable<T>::value, "");
+    contents_.append(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+  void Write(const std::string& value) {
+    Write(static_cast<uint32_t>(value.size()));
+    contents_.append(value);
+  }
+  std::string* contents() { return &contents_; }
+
+ private:
+  std::string contents_;
+};
+
+class Reader {
+ public:
+  Reader(const char* data, size_t length) : data_(data), end_(data + length) {}
+
+  template <typename T>
+  bool Read(T* value) {
+    static_assert(std::is_trivially_copyable<T>::value, "");
+    if (static_cast<size_t>(end_ - data_) < sizeof(T)) return false;
+    memcpy(value, data_, sizeof(T));
+    data_ += sizeof(T);
+    return true;
+  }
+  bool Read(std::string* value) {
+    uint32_t length;
+    if (!Read(&length) || static_cast<size_t>(end_ - data_) < length)
+      return false;
+    value->assign(data_, length);
+    data_ += length;
+    return true;
+  }
+  bool done() const { return data_ == end_; }
+
+ private:
+  const char* data_;
+  const char* end_;
+};
+
+}  // anonymous namespace
+
+ScriptCompiler::CachedData* CompileCacheEntry::CopyCache() const {
+  if (!cache) return nullptr;
+  return new ScriptCompiler::CachedData(cache->data, cache->length);
+}
+
+CompileCacheHandler::CompileCacheHandler(Environment* env)
+    : env_(env), isolate_(env->isolate()) {}
+
+CompileCacheHandler::~CompileCacheHandler() = default;
+
+template <typename... Args>
+inline void CompileCacheHandler::Debug(const char* format,
+                                       Args&&... args) const {
+  node::Debug(env_,
+              DebugCategory::COMPILE_CACHE,
+              format,
+              std::forward<Args>(args)...);
+}
+
+bool CompileCacheHandler::InitializeDirectory(const std::string& dir) {
+  std::string root = dir;
+  bool is_absolute = !root.empty() && root[0] == '/';
+#ifdef _WIN32
+  is_absolute = is_absolute || root[0] == '\\' ||
+                (root.size() > 1 && root[1] == ':');
+#endif
+  if (!is_absolute) {
+    // Resolve relative directories once, so that process.chdir() does not
+    // change where the caches are written.
+    char cwd[PATH_MAX_BYTES];
+    size_t size = PATH_MAX_BYTES;
+    if (uv_cwd(cwd, &size) == 0)
+      root = std::string(cwd) + kPathSeparator + root;
+  }
+
+  char subdir[64];
+  snprintf(subdir,
+           sizeof(subdir),
+           "v%s-%s-%08x",
+           NODE_VERSION_STRING,
+           NODE_ARCH,
+           ScriptCompiler::CachedDataVersionTag());
+  std::string cache_dir = root + kPathSeparator + subdir;
+
+  fs::FSReqWrapSync req_wrap;
+  int err =
+      fs::MKDirpSync(env_->event_loop(), &req_wrap.req, cache_dir, 0777);
+  if (err != 0 && err != UV_EEXIST) {
+    Debug("[compile cache] cannot create directory %s: %s\n",
+          cache_dir,
+          uv_strerror(err));
+    return false;
+  }
+  cache_dir_ = cache_dir;
+  Debug("[compile cache] using directory %s\n", cache_dir_);
+  return true;
+}
+
+CompileCacheEntry* CompileCacheHandler::GetOrInsert(Local<String> code,
+                                                    Local<String> filename,
+                                                    CachedCodeType type) {
+  Utf8Value filename_utf8(isolate_, filename);
+  uint8_t type_byte = static_cast<uint8_t>(type);
+  uint32_t filename_hash = Hash(0, &type_byte, sizeof(type_byte));
+  filename_hash = Hash(filename_hash, *filename_utf8, filename_utf8.length());
+
+  TwoByteValue source(isolate_, code);
+  uint32_t source_hash =
+      Hash(0, *source, source.length() * sizeof(**source));
+
+  uint64_t key = (static_cast<uint64_t>(filename_hash) << 32) | source_hash;
+  auto it = entries_.find(key);
+  if (it != entries_.end() &&
+      it->second->source_length == source.length() &&
+      it->second->source_filename == *filename_utf8) {
+    return it->second.get();
+  }
+
+  auto entry = std::make_unique<CompileCacheEntry>();
+  char name[17];
+  snprintf(name, sizeof(name), "%08x%08x", filename_hash, source_hash);
+  entry->cache_filename = cache_dir_ + kPathSeparator + name;
+  entry->source_filename = *filename_utf8;
+  entry->type = type;
+  entry->filename_hash = filename_hash;
+  entry->source_hash = source_hash;
+  entry->source_length = static_cast<uint32_t>(source.length());
+  ReadCacheFile(entry.get());
+
+  CompileCacheEntry* result = entry.get();
+  entries_[key] = std::move(entry);
+  return result;
+}
+
+void CompileCacheHandler::ReadCacheFile(CompileCacheEntry* entry) {
+  FILE* fp = fopen(entry->cache_filename.c_str(), "rb");
+  if (fp == nullptr) {
+    Debug("[compile cache] no cache for %s %s\n",
+          TypeName(entry->type),
+          entry->source_filename);
+    return;
+  }
+
+  CacheHeader header;
+  std::unique_ptr<uint8_t[]> data;
+  const char* error = nullptr;
+  if (fread(&header, sizeof(header), 1, fp) != 1 ||
+      header.magic != kCacheMagic) {
+    error = "is not a cache file";
+  } else if (header.type != static_cast<uint32_t>(entry->type) ||
+             header.filename_hash != entry->filename_hash ||
+             header.source_hash != entry->source_hash ||
+             header.source_length != entry->source_length) {
+    error = "does not match the source";
+  } else {
+    data.reset(new uint8_t[header.cache_size]);
+    if (fread(data.get(), 1, header.cache_size, fp) != header.cache_size ||
+        Hash(0, data.get(), header.cache_size) != header.cache_hash) {
+      error = "is corrupted";
+    }
+  }
+  fclose(fp);
+
+  if (error != nullptr) {
+    Debug("[compile cache] cache for %s %s %s\n",
+          TypeName(entry->type),
+          entry->source_filename,
+          error);
+    return;
+  }
+
+  Debug("[compile cache] read cache for %s %s (%d bytes)\n",
+        TypeName(entry->type),
+        entry->source_filename,
+        header.cache_size);
+  entry->cache = std::make_unique<ScriptCompiler::CachedData>(
+      data.release(),
+      static_cast<int>(header.cache_size),
+      ScriptCompiler::CachedData::BufferOwned);
+}
+
+void CompileCacheHandler::MaybeSave(CompileCacheEntry* entry,
+                                    Local<Function> fn,
+                                    bool rejected) {
+  if (entry->cache && !rejected) {
+    Debug("[compile cache] cache for %s %s was accepted\n",
+          TypeName(entry->type),
+          entry->source_filename);
+    entry->cache.reset();
+    return;
+  }
+  if (rejected) {
+    Debug("[compile cache] cache for %s %s was rejected\n",
+          TypeName(entry->type),
+          entry->source_filename);
+  }
+  entry->cache.reset();
+  entry->function.Reset(isolate_, fn);
+  has_pending_ = true;
+}
+
+void CompileCacheHandler::MaybeSave(CompileCacheEntry* entry,
+                                    Local<Module> module,
+                                    bool rejected) {
+  if (entry->cache && !rejected) {
+    Debug("[compile cache] cache for %s %s was accepted\n",
+          TypeName(entry->type),
+          entry->source_filename);
+    entry->cache.reset();
+    return;
+  }
+  if (rejected) {
+    Debug("[compile cache] cache for %s %s was rejected\n",
+          TypeName(entry->type),
+          entry->source_filename);
+  }
+  entry->cache.reset();
+  entry->module_script.Reset(isolate_, module->GetUnboundModuleScript());
+  has_pending_ = true;
+}
+
+void CompileCacheHandler::Persist() {
+  PersistResolutions();
+  if (!has_pending_) return;
+  has_pending_ = false;
+
+  HandleScope handle_scope(isolate_);
+  for (auto& it : entries_) {
+    CompileCacheEntry* entry = it.second.get();
+    std::unique_ptr<ScriptCompiler::CachedData> data;
+    if (!entry->function.IsEmpty()) {
+      data.reset(ScriptCompiler::CreateCodeCacheForFunction(
+          entry->function.Get(isolate_)));
+      entry->function.Reset();
+    } else if (!entry->module_script.IsEmpty()) {
+      Local<UnboundModuleScript> script = entry->module_script.Get(isolate_);
+      data.reset(ScriptCompiler::CreateCodeCache(script));
+      entry->module_script.Reset();
+    } else {
+      continue;
+    }
+    if (!data || data->length == 0) continue;
+    WriteCacheFile(entry, data.get());
+  }
+}
+
+const CompileCacheHandler::FileState& CompileCacheHandler::GetFileState(
+    const std::string& path) {
+  auto it = file_states_.find(path);
+  if (it != file_states_.end()) return it->second;
+
+  FileState state;
+  uv_fs_t req;
+  if (uv_fs_stat(env_->event_loop(), &req, path.c_str(), nullptr) == 0) {
+    const uv_stat_t* const s = static_cast<const uv_stat_t*>(req.ptr);
+    state.exists = true;
+    state.sec = s->st_mtim.tv_sec;
+    state.nsec = s->st_mtim.tv_nsec;
+    // Modification times can be as coarse as a few seconds, depending on
+    // the file system.
+    state.racy = state.sec + 2 >= static_cast<int64_t>(time(nullptr));
+  }
+  uv_fs_req_cleanup(&req);
+  return file_states_.emplace(path, state).first->second;
+}
+
+uint32_t CompileCacheHandler::AddDependency(const std::string& path,
+                                            const FileState& state) {
+  auto it = dependency_indices_.find(path);
+  if (it != dependency_indices_.end() &&
+      dependencies_[it->second].second == state) {
+    return it->second;
+  }
+  // The resolutions read from disk still refer to the previous state.
+  uint32_t index = static_cast<uint32_t>(dependencies_.size());
+  dependencies_.emplace_back(path, state);
+  dependency_indices_[path] = index;
+  return index;
+}
+
+void CompileCacheHandler::LoadResolutions() {
+  if (resolutions_loaded_) return;
+  resolutions_loaded_ = true;
+
+  std::string filename = cache_dir_ + kPathSeparator + kResolutionsFilename;
+  FILE* fp = fopen(filename.c_str(), "rb");
+  if (fp == nullptr) return;
+  std::string contents;
+  char buf[64 * 1024];
+  size_t read;
+  while ((read = fread(buf, 1, sizeof(buf), fp)) > 0)
+    contents.append(buf, read);
+  fclose(fp);
+
+  Reader reader(contents.data(), contents.size());
+  uint32_t magic, dependency_count, resolution_count;
+  bool ok = reader.Read(&magic) && magic == kResolutionsMagic &&
+            reader.Read(&dependency_count);
+  for (uint32_t i = 0; ok && i < dependency_count; i++) {
+    std::string path;
+    FileState state;
+    ok = reader.Read(&path) && reader.Read(&state.exists) &&
+         reader.Read(&state.sec) && reader.Read(&state.nsec);
+    if (!ok) break;
+    dependency_indices_[path] = i;
+    dependencies_.emplace_back(std::move(path), state);
+  }
+  ok = ok && reader.Read(&resolution_count);
+  for (uint32_t i = 0; ok && i < resolution_count; i++) {
+    std::string key;
+    Resolution resolution;
+    uint32_t count;
+    ok = reader.Read(&key) && reader.Read(&resolution.filename) &&
+         reader.Read(&count);
+    for (uint32_t j = 0; ok && j < count; j++) {
+      uint32_t index;
+      ok = reader.Read(&index) && index < dependency_count;
+      if (ok) resolution.dependencies.push_back(index);
+    }
+    if (ok) resolutions_.emplace(std::move(key), std::move(resolution));
+  }
+
+  if (!ok || !reader.done()) {
+    Debug("[compile cache] %s is corrupted\n", filename);
+    resolutions_.clear();
+    dependencies_.clear();
+    dependency_indices_.clear();
+    resolutions_dirty_ = true;
+    return;
+  }
+  Debug("[compile cache] read %d resolutions\n", resolutions_.size());
+}
+
+const std::string* CompileCacheHandler::LookupResolution(
+    const std::string& key) {
+  LoadResolutions();
+  auto it = resolutions_.find(key);
+  if (it == resolutions_.end()) return nullptr;
+
+  Resolution& resolution = it->second;
+  if (resolution.status == Resolution::Status::kUnknown) {
+    resolution.status = Resolution::Status::kValid;
+    for (uint32_t index : resolution.dependencies) {
+      const auto& dependency = dependencies_[index];
+      if (!(GetFileState(dependency.first) == dependency.second)) {
+        Debug("[compile cache] resolution of %s is outdated, %s changed\n",
+              resolution.filename,
+              dependency.first);
+        resolution.status = Resolution::Status::kInvalid;
+        resolutions_dirty_ = true;
+        break;
+      }
+    }
+  }
+  if (resolution.status == Resolution::Status::kInvalid) return nullptr;
+  return &resolution.filename;
+}
+
+void CompileCacheHandler::RecordResolution(
+    const std::string& key,
+    const std::string& filename,
+    const std::vector<std::string>& paths,
+    const std::vector<std::string>& files) {
+  LoadResolutions();
+
+  std::unordered_map<std::string, bool> seen;
+  std::vector<uint32_t> dependencies;
+  auto add = [&](const std::string& path) {
+    if (!seen.emplace(path, true).second) return true;
+    const FileState& state = GetFileState(path);
+    if (state.racy) return false;
+    dependencies.push_back(AddDependency(path, state));
+    return true;
+  };
+  // Whether a path exists, and where it points to if it is a symbolic link,
+  // only changes along with the modification time of the directories that
+  // contain it.
+  auto add_directories = [&](const std::string& path) {
+    for (size_t end = path.find_last_of(kSeparators);
+         end != std::string::npos && end > 0;
+         end = path.find_last_of(kSeparators, end - 1)) {
+      std::string directory = path.substr(0, end);
+      if (seen.count(directory) > 0) break;
+      if (!add(directory)) return false;
+    }
+    return true;
+  };
+
+  bool ok = add_directories(filename);
+  for (size_t i = 0; ok && i < paths.size(); i++)
+    ok = add_directories(paths[i]);
+  for (size_t i = 0; ok && i < files.size(); i++)
+    ok = add(files[i]) && add_directories(files[i]);
+  if (!ok) {
+    Debug("[compile cache] not recording resolution of %s, a dependency "
+          "has been modified recently\n",
+          filename);
+    return;
+  }
+
+  Resolution& resolution = resolutions_[key];
+  resolution.filename = filename;
+  resolution.dependencies = std::move(dependencies);
+  resolution.status = Resolution::Status::kValid;
+  resolutions_dirty_ = true;
+}
+
+void CompileCacheHandler::PersistResolutions() {
+  if (!resolutions_dirty_) return;
+  resolutions_dirty_ = false;
+
+  size_t count = 0;
+  for (const auto& it : resolutions_) {
+    if (it.second.status != Resolution::Status::kInvalid) count++;
+  }
+  bool drop_unknown = count > kMaxResolutions;
+
+  // Only write the dependencies that are still in use.
+  std::vector<uint32_t> remap(dependencies_.size(), UINT32_MAX);
+  std::vector<uint32_t> used;
+  Writer resolutions;
+  uint32_t resolution_count = 0;
+  for (const auto& it : resolutions_) {
+    const Resolution& resolution = it.second;
+    if (resolution.status == Resolution::Status::kInvalid ||
+        (drop_unknown &&
+         resolution.status == Resolution::Status::kUnknown)) {
+      continue;
+    }
+    resolutions.Write(it.first);
+    resolutions.Write(resolution.filename);
+    resolutions.Write(static_cast<uint32_t>(resolution.dependencies.size()));
+    for (uint32_t index : resolution.dependencies) {
+      if (remap[index] == UINT32_MAX) {
+        remap[index] = static_cast<uint32_t>(used.size());
+        used.push_back(index);
+      }
+      resolutions.Write(remap[index]);
+    }
+    resolution_count++;
+  }
+
+  Writer header;
+  header.Write(kResolutionsMagic);
+  header.Write(static_cast<uint32_t>(used.size()));
+  for (uint32_t index : used) {
+    const auto& dependency = dependencies_[index];
+    header.Write(dependency.first);
+    header.Write(dependency.second.exists);
+    header.Write(dependency.second.sec);
+    header.Write(dependency.second.nsec);
+  }
+  header.Write(resolution_count);
+
+  std::string filename = cache_dir_ + kPathSeparator + kResolutionsFilename;
+  std::string* head = header.contents();
+  std::string* body = resolutions.contents();
+  int err = WriteFileAtomically(
+      filename,
+      {uv_buf_init(&(*head)[0], head->size()),
+       uv_buf_init(&(*body)[0], body->size())});
+  if (err != 0) {
+    Debug("[compile cache] cannot write %s: %s\n",
+          filename,
+          uv_strerror(err));
+    return;
+  }
+  Debug("[compile cache] wrote %d resolutions\n", resolution_count);
+}
+
+int CompileCacheHandler::WriteFileAtomically(
+    const std::string& filename, const std::vector<uv_buf_t>& contents) {
+  // Other processes or threads may be writing the same file, each of them
+  // writes to its own temporary file.
+  std::string temp_filename = filename + "." +
+                              std::to_string(uv_os_getpid()) + "-" +
+                              std::to_string(env_->thread_id()) + ".tmp";
+  FILE* fp = fopen(temp_filename.c_str(), "wb");
+  if (fp == nullptr) return UV_EIO;
+  bool ok = true;
+  for (const uv_buf_t& buf : contents) {
+    if (fwrite(buf.base, 1, buf.len, fp) != buf.len) ok = false;
+  }
+  ok = fclose(fp) == 0 && ok;
+  if (!ok) {
+    remove(temp_filename.c_str());
+    return UV_EIO;
+  }
+
+  uv_fs_t req;
+  int err = uv_fs_rename(env_->event_loop(),
+                         &req,
+                         temp_filename.c_str(),
+                         filename.c_str(),
+                         nullptr);
+  uv_fs_req_cleanup(&req);
+  if (err != 0) remove(temp_filename.c_str());
+  return err;
+}
+
+void CompileCacheHandler::WriteCacheFile(
+    CompileCacheEntry* entry, const ScriptCompiler::CachedData* data) {
+  CacheHeader header;
+  header.magic = kCacheMagic;
+  header.type = static_cast<uint32_t>(entry->type);
+  header.filename_hash = entry->filename_hash;
+  header.source_hash = entry->source_hash;
+  header.source_length = entry->source_length;
+  header.cache_size = static_cast<uint32_t>(data->length);
+  header.cache_hash = Hash(0, data->data, data->length);
+
+  int err = WriteFileAtomically(
+      entry->cache_filename,
+      {uv_buf_init(reinterpret_cast<char*>(&header), sizeof(header)),
+       uv_buf_init(reinterpret_cast<char*>(const_cast<uint8_t*>(data->data)),
+                   data->length)});
+  if (err != 0) {
+    Debug("[compile cache] cannot write cache for %s %s: %s\n",
+          TypeName(entry->type),
+          entry->source_filename,
+          uv_strerror(err));
+    return;
+  }
+  Debug("[compile cache] wrote cache for %s %s (%d bytes)\n",
+        TypeName(entry->type),
+        entry->source_filename,
+        data->length);
+}
+
+}  // namespace node
@@ -0,0 +1,158 @@
+#ifndef SRC_COMPILE_CACHE_H_
+#define SRC_COMPILE_CACHE_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include <cinttypes>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "uv.h"
+#include "v8.h"
+
+namespace node {
+class Environment;
+
+enum class CachedCodeType : uint8_t {
+  kCommonJS = 0,
+  kESM,
+};
+
+// The code cache of one module. The cache read from disk is kept alive
+// here until the module has been compiled, and the function or module that
+// has been compiled without it is kept alive until the cache is persisted,
+// so that it also contains the functions that have been lazily compiled in
+// the meantime.
+struct CompileCacheEntry {
+  std::string cache_filename;
+  std::string source_filename;
+  CachedCodeType type;
+  uint32_t filename_hash;
+  uint32_t source_hash;
+  uint32_t source_length;
+  // The cache read from disk, if any.
+  std::unique_ptr<v8::ScriptCompiler::CachedData> cache;
+  // Set when the cache has to be written to disk.
+  v8::Global<v8::Function> function;
+  v8::Global<v8::UnboundModuleScript> module_script;
+
+  // Returns a copy of the cache that does not own the data, to be handed
+  // to a ScriptCompiler::Source, or nullptr if there is no cache.
+  v8::ScriptCompiler::CachedData* CopyCache() const;
+};
+
+// Stores the V8 code cache of the user modules compiled by the CommonJS and
+// ESM loaders in a directory on disk, enabled with --compile-cache-dir.
+//
+// The caches are stored in a subdirectory named after the version of
+// Node.js and the V8 cached data version tag, which changes with the
+// version of V8 and with the V8 flags that affect code generation. The file
+// name of each cache is derived from a hash of the file name and of the
+// source of the module, and the file starts with a header that repeats
+// them, along with a checksum of the cache data. Caches are written to a
+// temporary file that is then renamed, so that concurrent processes never
+// observe a partially written cache.
+//
+// The results of the module resolution of the CommonJS loader are stored in
+// the same directory. Each of them records the modification times of the
+// directories and package.json files that it depended on, and is only
+// reused if none of them has changed since.
+class CompileCacheHandler {
+ public:
+  explicit CompileCacheHandler(Environment* env);
+  ~CompileCacheHandler();
+  CompileCacheHandler(const CompileCacheHandler&) = delete;
+  CompileCacheHandler& operator=(const CompileCacheHandler&) = delete;
+
+  // Creates the cache directory inside `dir`. Returns false if it cannot be
+  // created, in which case the cache is not used.
+  bool InitializeDirectory(const std::string& dir);
+
+  // Returns the entry for the module, with the cache read from disk if one
+  // exists and matches the source.
+  CompileCacheEntry* GetOrInsert(v8::Local<v8::String> code,
+                                 v8::Local<v8::String> filename,
+                                 CachedCodeType type);
+  // Called once the module has been compiled. Unless the cache of the entry
+  // was used, the cache is created and written to disk in Persist().
+  void MaybeSave(CompileCacheEntry* entry,
+                 v8::Local<v8::Function> fn,
+                 bool rejected);
+  void MaybeSave(CompileCacheEntry* entry,
+                 v8::Local<v8::Module> module,
+                 bool rejected);
+
+  // Returns the file name that `key` resolved to in a previous run, or
+  // nullptr if it is unknown or out of date.
+  const std::string* LookupResolution(const std::string& key);
+  // Records the file name that `key` resolved to. `paths` are the paths
+  // that were looked up during the resolution, and `files` the package.json
+  // files that were read.
+  void RecordResolution(const std::string& key,
+                        const std::string& filename,
+                        const std::vector<std::string>& paths,
+                        const std::vector<std::string>& files);
+
+  // Writes the pending caches to disk. Called when the Environment exits.
+  void Persist();
+
+  const std::string& cache_dir() const { return cache_dir_; }
+
+ private:
+  struct FileState {
+    bool exists = false;
+    int64_t sec = 0;
+    int64_t nsec = 0;
+    // Modified so recently that a subsequent change might not update the
+    // modification time.
+    bool racy = false;
+
+    bool operator==(const FileState& other) const {
+      return exists == other.exists && sec == other.sec && nsec == other.nsec;
+    }
+  };
+
+  struct Resolution {
+    enum class Status { kUnknown, kValid, kInvalid };
+    std::string filename;
+    std::vector<uint32_t> dependencies;
+    Status status = Status::kUnknown;
+  };
+
+  void ReadCacheFile(CompileCacheEntry* entry);
+  void WriteCacheFile(CompileCacheEntry* entry,
+                      const v8::ScriptCompiler::CachedData* data);
+  int WriteFileAtomically(const std::string& filename,
+                          const std::vector<uv_buf_t>& contents);
+
+  // The state of a file at the time it is first looked at by this process.
+  const FileState& GetFileState(const std::string& path);
+  uint32_t AddDependency(const std::string& path, const FileState& state);
+  void LoadResolutions();
+  void PersistResolutions();
+
+  template <typename... Args>
+  inline void Debug(const char* format, Args&&... args) const;
+
+  Environment* env_;
+  v8::Isolate* isolate_;
+  std::string cache_dir_;
+  std::unordered_map<uint64_t, std::unique_ptr<CompileCacheEntry>> entries_;
+  bool has_pending_ = false;
+
+  std::unordered_map<std::string, FileState> file_states_;
+  // The paths that resolutions depend on, with their state at the time the
+  // resolution was recorded.
+  std::vector<std::pair<std::string, FileState>> dependencies_;
+  std::unordered_map<std::string, uint32_t> dependency_indices_;
+  std::unordered_map<std::string, Resolution> resolutions_;
+  bool resolutions_loaded_ = false;
+  bool resolutions_dirty_ = false;
+};
+
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_COMPILE_CACHE_H_
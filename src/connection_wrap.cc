@@ -62,6 +62,7 @@ void ConnectionWrap<WrapType, UVType>::OnConnection(uv_stream_t* handle,
     // returned.
     if (uv_accept(handle, client))
       return;
+    wrap_data->OnAccepted(wrap);
 
     // Successful accept. Call the onconnection callback in JavaScript land.
     client_handle = client_obj;
@@ -12,11 +12,16 @@
 namespace node {
 
 using v8::Array;
+using v8::ArrayBuffer;
+using v8::ArrayBufferView;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
 using v8::HandleScope;
 using v8::Int32;
+using v8::Just;
 using v8::Local;
+using v8::Maybe;
+using v8::Nothing;
 using v8::Object;
 using v8::Uint32;
 using v8::Value;
@@ -260,6 +265,7 @@ void CipherBase::Initialize(Environment* env, Local<Object> target) {
   env->SetProtoMethod(t, "init", Init);
   env->SetProtoMethod(t, "initiv", InitIv);
   env->SetProtoMethod(t, "update", Update);
+  env->SetProtoMethod(t, "updateInto", UpdateInto);
   env->SetProtoMethod(t, "final", Final);
   env->SetProtoMethod(t, "setAutoPadding", SetAutoPadding);
   env->SetProtoMethodNoSideEffect(t, "getAuthTag", GetAuthTag);
@@ -294,6 +300,8 @@ void CipherBase::Initialize(Environment* env, Local<Object> target) {
 
   NODE_DEFINE_CONSTANT(target, kWebCryptoCipherEncrypt);
   NODE_DEFINE_CONSTANT(target, kWebCryptoCipherDecrypt);
+
+  CipherUpdateJob::Initialize(env, target);
 }
 
 void CipherBase::New(const FunctionCallbackInfo<Value>& args) {
@@ -714,14 +722,22 @@ void CipherBase::SetAAD(const FunctionCallbackInfo<Value>& args) {
   args.GetReturnValue().Set(cipher->SetAAD(buf, plaintext_len));
 }
 
-CipherBase::UpdateResult CipherBase::Update(
+CipherBase::UpdateResult CipherBase::GetUpdateOutputSize(
     const char* data,
     size_t len,
-    AllocatedBuffer* out) {
+    int* size) {
   if (!ctx_ || len > INT_MAX)
     return kErrorState;
   MarkPopErrorOnReturn mark_pop_error_on_return;
+  return BeginUpdate(data, len, size);
+}
 
+// Checks whether an update with |len| bytes of input is possible, and
+// computes the maximum size of its output.
+CipherBase::UpdateResult CipherBase::BeginUpdate(
+    const char* data,
+    size_t len,
+    int* buf_len) {
   const int mode = EVP_CIPHER_CTX_mode(ctx_.get());
 
   if (mode == EVP_CIPH_CCM_MODE && !CheckCCMMessageLength(len))
@@ -732,37 +748,88 @@ CipherBase::UpdateResult CipherBase::Update(
   if (kind_ == kDecipher && IsAuthenticatedMode())
     CHECK(MaybePassAuthTagToOpenSSL());
 
-  int buf_len = len + EVP_CIPHER_CTX_block_size(ctx_.get());
+  *buf_len = len + EVP_CIPHER_CTX_block_size(ctx_.get());
   // For key wrapping algorithms, get output size by calling
   // EVP_CipherUpdate() with null output.
   if (kind_ == kCipher && mode == EVP_CIPH_WRAP_MODE &&
       EVP_CipherUpdate(ctx_.get(),
                        nullptr,
-                       &buf_len,
+                       buf_len,
                        reinterpret_cast<const unsigned char*>(data),
                        len) != 1) {
     return kErrorState;
   }
+  return kSuccess;
+}
 
-  *out = AllocatedBuffer::AllocateManaged(env(), buf_len);
+CipherBase::UpdateResult CipherBase::FinishUpdate(
+    const char* data,
+    size_t len,
+    unsigned char* out,
+    int* out_len) {
   int r = EVP_CipherUpdate(ctx_.get(),
-                           reinterpret_cast<unsigned char*>(out->data()),
-                           &buf_len,
+                           out,
+                           out_len,
                            reinterpret_cast<const unsigned char*>(data),
                            len);
 
-  CHECK_LE(static_cast<size_t>(buf_len), out->size());
-  out->Resize(buf_len);
-
   // When in CCM mode, EVP_CipherUpdate will fail if the authentication tag is
   // invalid. In that case, remember the error and throw in final().
-  if (!r && kind_ == kDecipher && mode == EVP_CIPH_CCM_MODE) {
+  if (!r && kind_ == kDecipher &&
+      EVP_CIPHER_CTX_mode(ctx_.get()) == EVP_CIPH_CCM_MODE) {
     pending_auth_failed_ = true;
     return kSuccess;
   }
   return r == 1 ? kSuccess : kErrorState;
 }
 
+CipherBase::UpdateResult CipherBase::Update(
+    const char* data,
+    size_t len,
+    AllocatedBuffer* out) {
+  if (!ctx_ || len > INT_MAX)
+    return kErrorState;
+  MarkPopErrorOnReturn mark_pop_error_on_return;
+
+  int buf_len;
+  UpdateResult r = BeginUpdate(data, len, &buf_len);
+  if (r != kSuccess)
+    return r;
+
+  *out = AllocatedBuffer::AllocateManaged(env(), buf_len);
+  r = FinishUpdate(data,
+                   len,
+                   reinterpret_cast<unsigned char*>(out->data()),
+                   &buf_len);
+
+  CHECK_LE(static_cast<size_t>(buf_len), out->size());
+  out->Resize(buf_len);
+  return r;
+}
+
+CipherBase::UpdateResult CipherBase::UpdateInto(
+    const char* data,
+    size_t len,
+    unsigned char* out,
+    size_t out_size,
+    int* out_len) {
+  *out_len = 0;
+  if (!ctx_ || len > INT_MAX)
+    return kErrorState;
+
+  int buf_len;
+  UpdateResult r = BeginUpdate(data, len, &buf_len);
+  if (r != kSuccess)
+    return r;
+  if (static_cast<size_t>(buf_len) > out_size)
+    return kErrorOutputSize;
+
+  r = FinishUpdate(data, len, out, &buf_len);
+  CHECK_LE(static_cast<size_t>(buf_len), out_size);
+  *out_len = buf_len;
+  return r;
+}
+
 void CipherBase::Update(const FunctionCallbackInfo<Value>& args) {
   Decode<CipherBase>(args, [](CipherBase* cipher,
                               const FunctionCallbackInfo<Value>& args,
@@ -788,6 +855,47 @@ void CipherBase::Update(const FunctionCallbackInfo<Value>& args) {
   });
 }
 
+// updateInto(data, output, outputOffset)
+void CipherBase::UpdateInto(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CipherBase* cipher;
+  ASSIGN_OR_RETURN_UNWRAP(&cipher, args.Holder());
+
+  CHECK(args[0]->IsArrayBufferView());
+  CHECK(args[1]->IsArrayBufferView());
+  CHECK(args[2]->IsUint32());
+
+  ArrayBufferOrViewContents<char> data(args[0]);
+  ArrayBufferOrViewContents<unsigned char> output(args[1]);
+  const uint32_t offset = args[2].As<Uint32>()->Value();
+  CHECK_LE(offset, output.size());
+
+  if (UNLIKELY(!data.CheckSizeInt32()))
+    return THROW_ERR_OUT_OF_RANGE(env, "data is too long");
+
+  MarkPopErrorOnReturn mark_pop_error_on_return;
+  int out_len;
+  UpdateResult r = cipher->UpdateInto(data.data(),
+                                      data.size(),
+                                      output.data() + offset,
+                                      output.size() - offset,
+                                      &out_len);
+  switch (r) {
+    case kSuccess:
+      args.GetReturnValue().Set(out_len);
+      break;
+    case kErrorOutputSize:
+      THROW_ERR_OUT_OF_RANGE(env, "output is too small");
+      break;
+    case kErrorState:
+      ThrowCryptoError(env, ERR_get_error(),
+                       "Trying to add data in unsupported state");
+      break;
+    case kErrorMessageSize:
+      break;
+  }
+}
+
 bool CipherBase::SetAutoPadding(bool auto_padding) {
   if (!ctx_)
     return false;
@@ -985,5 +1093,136 @@ void PublicKeyCipher::Cipher(const FunctionCallbackInfo<Value>& args) {
     args.GetReturnValue().Set(result);
 }
 
+CipherUpdateConfig::CipherUpdateConfig(CipherUpdateConfig&& other) noexcept
+    : mode(other.mode),
+      cipher(std::move(other.cipher)),
+      in_store(std::move(other.in_store)),
+      out_store(std::move(other.out_store)),
+      in(other.in),
+      in_size(other.in_size),
+      out(other.out),
+      out_size(other.out_size) {}
+
+CipherUpdateConfig& CipherUpdateConfig::operator=(
+    CipherUpdateConfig&& other) noexcept {
+  if (&other == this) return *this;
+  this->~CipherUpdateConfig();
+  return *new (this) CipherUpdateConfig(std::move(other));
+}
+
+void CipherUpdateConfig::MemoryInfo(MemoryTracker* tracker) const {
+  // The input and output buffers are owned by JS.
+}
+
+// CipherUpdateJob(mode, cipher, data[, output, outputOffset])
+Maybe<bool> CipherUpdateTraits::AdditionalConfig(
+    CryptoJobMode mode,
+    const FunctionCallbackInfo<Value>& args,
+    unsigned int offset,
+    CipherUpdateConfig* params) {
+  Environment* env = Environment::GetCurrent(args);
+
+  params->mode = mode;
+
+  CHECK(args[offset]->IsObject());  // CipherBase
+  CipherBase* cipher;
+  ASSIGN_OR_RETURN_UNWRAP(&cipher, args[offset], Nothing<bool>());
+  params->cipher.reset(cipher);
+
+  CHECK(args[offset + 1]->IsArrayBufferView());  // Data
+  Local<ArrayBufferView> data = args[offset + 1].As<ArrayBufferView>();
+  if (UNLIKELY(data->ByteLength() > INT_MAX)) {
+    THROW_ERR_OUT_OF_RANGE(env, "data is too long");
+    return Nothing<bool>();
+  }
+  params->in_store = data->Buffer()->GetBackingStore();
+  params->in = static_cast<const char*>(params->in_store->Data()) +
+               data->ByteOffset();
+  params->in_size = data->ByteLength();
+
+  // Check everything that might need to throw here, on the main thread.
+  int size;
+  switch (cipher->GetUpdateOutputSize(params->in, params->in_size, &size)) {
+    case CipherBase::kSuccess:
+      break;
+    case CipherBase::kErrorMessageSize:
+      return Nothing<bool>();
+    default:
+      THROW_ERR_CRYPTO_INVALID_STATE(env);
+      return Nothing<bool>();
+  }
+
+  if (args[offset + 2]->IsUndefined()) {
+    params->out_size = size;
+  } else {
+    CHECK(args[offset + 2]->IsArrayBufferView());  // Output
+    CHECK(args[offset + 3]->IsUint32());  // Output offset
+    Local<ArrayBufferView> output = args[offset + 2].As<ArrayBufferView>();
+    const uint32_t output_offset = args[offset + 3].As<Uint32>()->Value();
+    CHECK_LE(output_offset, output->ByteLength());
+    params->out_store = output->Buffer()->GetBackingStore();
+    params->out = static_cast<unsigned char*>(params->out_store->Data()) +
+                  output->ByteOffset() + output_offset;
+    params->out_size = output->ByteLength() - output_offset;
+    if (params->out_size < static_cast<size_t>(size)) {
+      THROW_ERR_OUT_OF_RANGE(env, "output is too small");
+      return Nothing<bool>();
+    }
+  }
+
+  return Just(true);
+}
+
+bool CipherUpdateTraits::DeriveBits(
+    Environment* env,
+    const CipherUpdateConfig& params,
+    ByteSource* out) {
+  unsigned char* dest = params.out;
+  ByteSource buf;
+  if (dest == nullptr && params.out_size > 0) {
+    char* data = MallocOpenSSL<char>(params.out_size);
+    buf = ByteSource::Allocated(data, params.out_size);
+    dest = reinterpret_cast<unsigned char*>(data);
+  }
+
+  int out_len;
+  if (params.cipher->UpdateInto(params.in,
+                                params.in_size,
+                                dest,
+                                params.out_size,
+                                &out_len) != CipherBase::kSuccess) {
+    // DeriveBitsJob captures the errors from the queue of this thread.
+    return false;
+  }
+  // A successful update may still leave errors behind, e.g. when the
+  // authentication of a CCM message failed, which must not be reported by
+  // the next job that fails on this thread.
+  ERR_clear_error();
+
+  if (params.out == nullptr) {
+    buf.Resize(out_len);
+    *out = std::move(buf);
+  } else {
+    *out = ByteSource::Foreign(reinterpret_cast<char*>(dest), out_len);
+  }
+  return true;
+}
+
+Maybe<bool> CipherUpdateTraits::EncodeOutput(
+    Environment* env,
+    const CipherUpdateConfig& params,
+    ByteSource* out,
+    Local<Value>* result) {
+  if (params.out != nullptr) {
+    // The output was written to the caller's buffer.
+    *result = Uint32::NewFromUnsigned(env->isolate(), out->size());
+  } else if (out->size() == 0) {
+    *result = ArrayBuffer::New(env->isolate(), 0);
+  } else {
+    *result = out->ToArrayBuffer(env);
+  }
+  return Just(!result->IsEmpty());
+}
+
 }  // namespace crypto
 }  // namespace node
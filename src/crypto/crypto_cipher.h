@@ -26,16 +26,34 @@ class CipherBase : public BaseObject {
   SET_MEMORY_INFO_NAME(CipherBase)
   SET_SELF_SIZE(CipherBase)
 
- protected:
-  enum CipherKind {
-    kCipher,
-    kDecipher
-  };
   enum UpdateResult {
     kSuccess,
     kErrorMessageSize,
+    kErrorOutputSize,
     kErrorState
   };
+
+  // Computes the maximum number of bytes that an update with |len| bytes of
+  // input can produce. Throws if the message is too long for CCM mode.
+  UpdateResult GetUpdateOutputSize(const char* data, size_t len, int* size);
+
+  // Like Update(), but writes to |out| instead of allocating. |out| may be
+  // |data| itself, i.e. in-place encryption and decryption are supported, as
+  // far as OpenSSL supports them for the cipher mode.
+  // This does not use the Environment, so it may be called from the
+  // threadpool, as long as the main thread does not use the cipher meanwhile.
+  // The OpenSSL errors are left on the error queue for the caller to report.
+  UpdateResult UpdateInto(const char* data,
+                          size_t len,
+                          unsigned char* out,
+                          size_t out_size,
+                          int* out_len);
+
+ protected:
+  enum CipherKind {
+    kCipher,
+    kDecipher
+  };
   enum AuthTagState {
     kAuthTagUnknown,
     kAuthTagKnown,
@@ -60,6 +78,11 @@ class CipherBase : public BaseObject {
   bool InitAuthenticated(const char* cipher_type, int iv_len,
                          unsigned int auth_tag_len);
   bool CheckCCMMessageLength(int message_len);
+  UpdateResult BeginUpdate(const char* data, size_t len, int* buf_len);
+  UpdateResult FinishUpdate(const char* data,
+                            size_t len,
+                            unsigned char* out,
+                            int* out_len);
   UpdateResult Update(const char* data, size_t len, AllocatedBuffer* out);
   bool Final(AllocatedBuffer* out);
   bool SetAutoPadding(bool auto_padding);
@@ -74,6 +97,7 @@ class CipherBase : public BaseObject {
   static void Init(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void InitIv(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Update(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void UpdateInto(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Final(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetAutoPadding(const v8::FunctionCallbackInfo<v8::Value>& args);
 
@@ -93,6 +117,59 @@ class CipherBase : public BaseObject {
   int max_message_size_;
 };
 
+struct CipherUpdateConfig final : public MemoryRetainer {
+  CryptoJobMode mode;
+  BaseObjectPtr<CipherBase> cipher;
+  // For async jobs, the backing stores keep the memory of the input and the
+  // caller-provided output alive until the job is done.
+  std::shared_ptr<v8::BackingStore> in_store;
+  std::shared_ptr<v8::BackingStore> out_store;
+  const char* in = nullptr;
+  size_t in_size = 0;
+  // nullptr if the job allocates the output itself.
+  unsigned char* out = nullptr;
+  size_t out_size = 0;
+
+  CipherUpdateConfig() = default;
+
+  explicit CipherUpdateConfig(CipherUpdateConfig&& other) noexcept;
+
+  CipherUpdateConfig& operator=(CipherUpdateConfig&& other) noexcept;
+
+  void MemoryInfo(MemoryTracker* tracker) const override;
+  SET_MEMORY_INFO_NAME(CipherUpdateConfig);
+  SET_SELF_SIZE(CipherUpdateConfig);
+};
+
+// Runs CipherBase::Update() on the threadpool. The JS side makes sure that
+// there is at most one job per cipher at a time, and that the cipher is not
+// used synchronously while a job is pending.
+struct CipherUpdateTraits final {
+  using AdditionalParameters = CipherUpdateConfig;
+  static constexpr const char* JobName = "CipherUpdateJob";
+  static constexpr AsyncWrap::ProviderType Provider =
+      AsyncWrap::PROVIDER_CIPHERREQUEST;
+
+  static v8::Maybe<bool> AdditionalConfig(
+      CryptoJobMode mode,
+      const v8::FunctionCallbackInfo<v8::Value>& args,
+      unsigned int offset,
+      CipherUpdateConfig* params);
+
+  static bool DeriveBits(
+      Environment* env,
+      const CipherUpdateConfig& params,
+      ByteSource* out);
+
+  static v8::Maybe<bool> EncodeOutput(
+      Environment* env,
+      const CipherUpdateConfig& params,
+      ByteSource* out,
+      v8::Local<v8::Value>* result);
+};
+
+using CipherUpdateJob = DeriveBitsJob<CipherUpdateTraits>;
+
 class PublicKeyCipher {
  public:
   typedef int (*EVP_PKEY_cipher_init_t)(EVP_PKEY_CTX* ctx);
@@ -1,17 +1,23 @@
 #include "crypto/crypto_hash.h"
+#include "crypto/crypto_sha256_mb.h"
 #include "allocated_buffer-inl.h"
 #include "async_wrap-inl.h"
 #include "base_object-inl.h"
 #include "env-inl.h"
 #include "memory_tracker-inl.h"
+#include "node_mutex.h"
 #include "string_bytes.h"
 #include "threadpoolwork-inl.h"
 #include "v8.h"
 
 #include <cstdio>
+#include <string>
+#include <unordered_map>
 
 namespace node {
 
+using v8::Array;
+using v8::ArrayBuffer;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
 using v8::Just;
@@ -21,9 +27,31 @@ using v8::MaybeLocal;
 using v8::Nothing;
 using v8::Object;
 using v8::Uint32;
+using v8::Uint32Array;
 using v8::Value;
 
 namespace crypto {
+namespace {
+// EVP_get_digestbyname() takes a global lock and hashes the (case-folded)
+// name on every call. The EVP_MD objects it returns are never freed, so it is
+// safe to remember them for the lifetime of the process.
+Mutex digest_cache_mutex;
+std::unordered_map<std::string, const EVP_MD*> digest_cache;
+}  // anonymous namespace
+
+const EVP_MD* GetDigestImplementation(const char* name) {
+  Mutex::ScopedLock lock(digest_cache_mutex);
+  auto it = digest_cache.find(name);
+  if (it != digest_cache.end())
+    return it->second;
+  const EVP_MD* md = EVP_get_digestbyname(name);
+  // Only successful lookups are cached, so that user input can not make the
+  // cache grow without bounds.
+  if (md != nullptr)
+    digest_cache.emplace(name, md);
+  return md;
+}
+
 Hash::Hash(Environment* env, Local<Object> wrap)
     : BaseObject(env, wrap),
       mdctx_(nullptr),
@@ -59,8 +87,10 @@ void Hash::Initialize(Environment* env, Local<Object> target) {
               t->GetFunction(env->context()).ToLocalChecked()).Check();
 
   env->SetMethodNoSideEffect(target, "getHashes", GetHashes);
+  env->SetMethodNoSideEffect(target, "oneShotDigest", OneShotDigest);
 
   HashJob::Initialize(env, target);
+  HashBatchJob::Initialize(env, target);
 }
 
 Hash::~Hash() {
@@ -79,7 +109,7 @@ void Hash::New(const FunctionCallbackInfo<Value>& args) {
     md = EVP_MD_CTX_md(orig->mdctx_.get());
   } else {
     const Utf8Value hash_type(env->isolate(), args[0]);
-    md = EVP_get_digestbyname(*hash_type);
+    md = GetDigestImplementation(*hash_type);
   }
 
   Maybe<unsigned int> xof_md_len = Nothing<unsigned int>();
@@ -100,6 +130,53 @@ void Hash::New(const FunctionCallbackInfo<Value>& args) {
   }
 }
 
+// oneShotDigest(algorithm, data, outputEncoding)
+// Computes the digest of a string or ArrayBufferView without creating a Hash
+// object, which saves the allocation of the BaseObject and its EVP_MD_CTX as
+// well as two of the three calls into C++ that createHash() needs.
+void Hash::OneShotDigest(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK_EQ(args.Length(), 3);
+  CHECK(args[0]->IsString());
+  CHECK(args[1]->IsString() || args[1]->IsArrayBufferView());
+
+  const Utf8Value algorithm(env->isolate(), args[0]);
+  const EVP_MD* md = GetDigestImplementation(*algorithm);
+  if (UNLIKELY(md == nullptr))
+    return THROW_ERR_CRYPTO_INVALID_DIGEST(env);
+
+  enum encoding output_enc = ParseEncoding(env->isolate(), args[2], HEX);
+
+  unsigned char md_value[EVP_MAX_MD_SIZE];
+  unsigned int md_len;
+  int ret;
+  if (args[1]->IsString()) {
+    const Utf8Value data(env->isolate(), args[1]);
+    ret = EVP_Digest(*data, data.length(), md_value, &md_len, md, nullptr);
+  } else {
+    ArrayBufferOrViewContents<char> data(args[1]);
+    if (UNLIKELY(!data.CheckSizeInt32()))
+      return THROW_ERR_OUT_OF_RANGE(env, "data is too big");
+    ret = EVP_Digest(data.data(), data.size(), md_value, &md_len, md, nullptr);
+  }
+  if (UNLIKELY(ret != 1))
+    return ThrowCryptoError(env, ERR_get_error());
+
+  Local<Value> error;
+  MaybeLocal<Value> rc =
+      StringBytes::Encode(env->isolate(),
+                          reinterpret_cast<const char*>(md_value),
+                          md_len,
+                          output_enc,
+                          &error);
+  if (rc.IsEmpty()) {
+    CHECK(!error.IsEmpty());
+    env->isolate()->ThrowException(error);
+    return;
+  }
+  args.GetReturnValue().Set(rc.ToLocalChecked());
+}
+
 bool Hash::HashInit(const EVP_MD* md, Maybe<unsigned int> xof_md_len) {
   mdctx_.reset(EVP_MD_CTX_new());
   if (!mdctx_ || EVP_DigestInit_ex(mdctx_.get(), md, nullptr) <= 0) {
@@ -239,7 +316,7 @@ Maybe<bool> HashTraits::AdditionalConfig(
 
   CHECK(args[offset]->IsString());  // Hash algorithm
   Utf8Value digest(env->isolate(), args[offset]);
-  params->digest = EVP_get_digestbyname(*digest);
+  params->digest = GetDigestImplementation(*digest);
   if (UNLIKELY(params->digest == nullptr)) {
     char msg[1024];
     snprintf(msg, sizeof(msg), "Invalid digest: %s", *digest);
@@ -310,5 +387,244 @@ bool HashTraits::DeriveBits(
   return true;
 }
 
+HashBatchConfig::HashBatchConfig(HashBatchConfig&& other) noexcept
+    : mode(other.mode),
+      digest(other.digest),
+      length(other.length),
+      in(std::move(other.in)),
+      inputs(std::move(other.inputs)),
+      hmac(other.hmac),
+      key(std::move(other.key)) {}
+
+HashBatchConfig& HashBatchConfig::operator=(HashBatchConfig&& other) noexcept {
+  if (&other == this) return *this;
+  this->~HashBatchConfig();
+  return *new (this) HashBatchConfig(std::move(other));
+}
+
+void HashBatchConfig::MemoryInfo(MemoryTracker* tracker) const {
+  // If the Job is sync, then the HashBatchConfig does not own the data.
+  if (mode == kCryptoJobAsync)
+    tracker->TrackFieldWithSize("in", in.size());
+  tracker->TrackFieldWithSize("inputs", inputs.size() * sizeof(ByteSource));
+  tracker->TrackFieldWithSize("key", key.size());
+}
+
+Maybe<bool> HashBatchTraits::EncodeOutput(
+    Environment* env,
+    const HashBatchConfig& params,
+    ByteSource* out,
+    v8::Local<v8::Value>* result) {
+  if (out->size() == 0)
+    *result = ArrayBuffer::New(env->isolate(), 0);
+  else
+    *result = out->ToArrayBuffer(env);
+  return Just(!result->IsEmpty());
+}
+
+// HashBatchJob(mode, algorithm, key, data[, offsets])
+// `key` is undefined for plain digests, or the secret (a buffer or a
+// KeyObjectHandle) for HMAC. `data` is either an array of ArrayBufferViews,
+// or a single ArrayBufferView that is split into messages at the given
+// `offsets`, a Uint32Array with one more entry than there are messages.
+Maybe<bool> HashBatchTraits::AdditionalConfig(
+    CryptoJobMode mode,
+    const FunctionCallbackInfo<Value>& args,
+    unsigned int offset,
+    HashBatchConfig* params) {
+  Environment* env = Environment::GetCurrent(args);
+
+  params->mode = mode;
+
+  CHECK(args[offset]->IsString());  // Hash algorithm
+  Utf8Value digest(env->isolate(), args[offset]);
+  params->digest = GetDigestImplementation(*digest);
+  if (UNLIKELY(params->digest == nullptr)) {
+    THROW_ERR_CRYPTO_INVALID_DIGEST(env);
+    return Nothing<bool>();
+  }
+  params->length = EVP_MD_size(params->digest);
+
+  if (!args[offset + 1]->IsUndefined()) {
+    ByteSource key = ByteSource::FromSecretKeyBytes(env, args[offset + 1]);
+    params->hmac = true;
+    if (key.size() > 0) {
+      char* data = MallocOpenSSL<char>(key.size());
+      memcpy(data, key.get(), key.size());
+      params->key = ByteSource::Allocated(data, key.size());
+    }
+  }
+
+  if (args[offset + 2]->IsArray()) {
+    Local<Array> list = args[offset + 2].As<Array>();
+    const uint32_t count = list->Length();
+    std::vector<ArrayBufferOrViewContents<char>> views;
+    views.reserve(count);
+    size_t total = 0;
+    for (uint32_t n = 0; n < count; n++) {
+      Local<Value> item;
+      if (!list->Get(env->context(), n).ToLocal(&item))
+        return Nothing<bool>();
+      CHECK(item->IsArrayBufferView());
+      views.emplace_back(item);
+      if (UNLIKELY(!views.back().CheckSizeInt32())) {
+        THROW_ERR_OUT_OF_RANGE(env, "data is too big");
+        return Nothing<bool>();
+      }
+      total += views.back().size();
+    }
+
+    params->inputs.reserve(count);
+    if (mode == kCryptoJobAsync && total > 0) {
+      // Copy everything into a single allocation instead of one per message.
+      char* data = MallocOpenSSL<char>(total);
+      params->in = ByteSource::Allocated(data, total);
+      for (const auto& view : views) {
+        memcpy(data, view.data(), view.size());
+        params->inputs.emplace_back(ByteSource::Foreign(data, view.size()));
+        data += view.size();
+      }
+    } else {
+      for (const auto& view : views) {
+        params->inputs.emplace_back(mode == kCryptoJobAsync ?
+            ByteSource() :
+            ByteSource::Foreign(view.data(), view.size()));
+      }
+    }
+  } else {
+    ArrayBufferOrViewContents<char> data(args[offset + 2]);
+    CHECK(args[offset + 3]->IsUint32Array());
+    Local<Uint32Array> offsets_array = args[offset + 3].As<Uint32Array>();
+    const size_t length = offsets_array->Length();
+    CHECK_GE(length, 1);
+    const uint32_t* offsets = reinterpret_cast<const uint32_t*>(
+        static_cast<const char*>(
+            offsets_array->Buffer()->GetBackingStore()->Data()) +
+        offsets_array->ByteOffset());
+
+    for (size_t n = 1; n < length; n++) {
+      if (UNLIKELY(offsets[n] < offsets[n - 1] || offsets[n] > data.size())) {
+        THROW_ERR_OUT_OF_RANGE(env, "offsets are out of range");
+        return Nothing<bool>();
+      }
+    }
+
+    const char* base;
+    if (mode == kCryptoJobAsync) {
+      params->in = data.ToCopy();
+      base = params->in.get();
+    } else {
+      base = data.data();
+    }
+
+    params->inputs.reserve(length - 1);
+    for (size_t n = 1; n < length; n++) {
+      const size_t size = offsets[n] - offsets[n - 1];
+      params->inputs.emplace_back(size == 0 ?
+          ByteSource() :
+          ByteSource::Foreign(base + offsets[n - 1], size));
+    }
+  }
+
+  return Just(true);
+}
+
+namespace {
+bool HashBatchWithEVP(const HashBatchConfig& params, unsigned char* out) {
+  EVPMDPointer ctx(EVP_MD_CTX_new());
+  if (UNLIKELY(!ctx))
+    return false;
+
+  // The same EVP_MD_CTX is reused for all messages: re-initializing it only
+  // resets the digest state, without allocating.
+  for (const ByteSource& input : params.inputs) {
+    unsigned int length = params.length;
+    if (UNLIKELY(
+            EVP_DigestInit_ex(ctx.get(), params.digest, nullptr) <= 0 ||
+            EVP_DigestUpdate(ctx.get(), input.get(), input.size()) <= 0 ||
+            EVP_DigestFinal_ex(ctx.get(), out, &length) <= 0)) {
+      return false;
+    }
+    out += params.length;
+  }
+  return true;
+}
+
+bool HmacBatchWithEVP(const HashBatchConfig& params, unsigned char* out) {
+  HMACCtxPointer ctx(HMAC_CTX_new());
+  if (UNLIKELY(!ctx) ||
+      !HMAC_Init_ex(ctx.get(),
+                    params.key.size() > 0 ? params.key.get() : "",
+                    params.key.size(),
+                    params.digest,
+                    nullptr)) {
+    return false;
+  }
+
+  // Passing no key and no digest to HMAC_Init_ex() restarts the computation
+  // with the key that has already been set up, i.e. the ipad/opad blocks are
+  // only processed once for the whole batch.
+  for (const ByteSource& input : params.inputs) {
+    unsigned int length = params.length;
+    if (UNLIKELY(
+            !HMAC_Init_ex(ctx.get(), nullptr, 0, nullptr, nullptr) ||
+            !HMAC_Update(ctx.get(),
+                         input.data<unsigned char>(),
+                         input.size()) ||
+            !HMAC_Final(ctx.get(), out, &length))) {
+      return false;
+    }
+    out += params.length;
+  }
+  return true;
+}
+}  // anonymous namespace
+
+bool HashBatchTraits::DeriveBits(
+    Environment* env,
+    const HashBatchConfig& params,
+    ByteSource* out) {
+  if (params.inputs.empty() || params.length == 0)
+    return true;
+
+  const size_t count = params.inputs.size();
+  const size_t total = count * params.length;
+  char* data = MallocOpenSSL<char>(total);
+  ByteSource buf = ByteSource::Allocated(data, total);
+  unsigned char* ptr = reinterpret_cast<unsigned char*>(data);
+
+  size_t input_length = 0;
+  for (const ByteSource& input : params.inputs)
+    input_length += input.size();
+
+  // SHA-256 is common enough, and cheap enough per message, that it pays to
+  // hash several messages in parallel using SIMD instructions.
+  if (EVP_MD_type(params.digest) == NID_sha256 &&
+      sha256_mb::ShouldUse(count, input_length)) {
+    std::vector<sha256_mb::Message> messages(count);
+    for (size_t n = 0; n < count; n++) {
+      messages[n] = sha256_mb::Message {
+        params.inputs[n].data<unsigned char>(),
+        params.inputs[n].size()
+      };
+    }
+    if (params.hmac) {
+      sha256_mb::Hmac(params.key.data<unsigned char>(),
+                      params.key.size(),
+                      messages.data(),
+                      count,
+                      ptr);
+    } else {
+      sha256_mb::Digest(messages.data(), count, ptr);
+    }
+  } else if (!(params.hmac ? HmacBatchWithEVP(params, ptr)
+                           : HashBatchWithEVP(params, ptr))) {
+    return false;
+  }
+
+  *out = std::move(buf);
+  return true;
+}
+
 }  // namespace crypto
 }  // namespace node
@@ -11,8 +11,14 @@
 #include "memory_tracker.h"
 #include "v8.h"
 
+#include <vector>
+
 namespace node {
 namespace crypto {
+// Returns the digest implementation for the given algorithm name, or nullptr
+// if it is not supported. Lookups are cached for the lifetime of the process.
+const EVP_MD* GetDigestImplementation(const char* name);
+
 class Hash final : public BaseObject {
  public:
   ~Hash() override;
@@ -27,6 +33,7 @@ class Hash final : public BaseObject {
   bool HashUpdate(const char* data, size_t len);
 
   static void GetHashes(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void OneShotDigest(const v8::FunctionCallbackInfo<v8::Value>& args);
 
  protected:
   static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -85,6 +92,57 @@ struct HashTraits final {
 
 using HashJob = DeriveBitsJob<HashTraits>;
 
+struct HashBatchConfig final : public MemoryRetainer {
+  CryptoJobMode mode;
+  const EVP_MD* digest;
+  unsigned int length;
+  // For async jobs, this owns a copy of all inputs and the entries of
+  // `inputs` point into it. For sync jobs, `inputs` point directly into the
+  // memory of the JS buffers and `in` is empty.
+  ByteSource in;
+  std::vector<ByteSource> inputs;
+  // Set for HMAC batches. Always a copy, which also keeps it alive for the
+  // duration of async jobs.
+  bool hmac = false;
+  ByteSource key;
+
+  HashBatchConfig() = default;
+
+  explicit HashBatchConfig(HashBatchConfig&& other) noexcept;
+
+  HashBatchConfig& operator=(HashBatchConfig&& other) noexcept;
+
+  void MemoryInfo(MemoryTracker* tracker) const override;
+  SET_MEMORY_INFO_NAME(HashBatchConfig);
+  SET_SELF_SIZE(HashBatchConfig);
+};
+
+struct HashBatchTraits final {
+  using AdditionalParameters = HashBatchConfig;
+  static constexpr const char* JobName = "HashBatchJob";
+  static constexpr AsyncWrap::ProviderType Provider =
+      AsyncWrap::PROVIDER_HASHREQUEST;
+
+  static v8::Maybe<bool> AdditionalConfig(
+      CryptoJobMode mode,
+      const v8::FunctionCallbackInfo<v8::Value>& args,
+      unsigned int offset,
+      HashBatchConfig* params);
+
+  static bool DeriveBits(
+      Environment* env,
+      const HashBatchConfig& params,
+      ByteSource* out);
+
+  static v8::Maybe<bool> EncodeOutput(
+      Environment* env,
+      const HashBatchConfig& params,
+      ByteSource* out,
+      v8::Local<v8::Value>* result);
+};
+
+using HashBatchJob = DeriveBitsJob<HashBatchTraits>;
+
 }  // namespace crypto
 }  // namespace node
 
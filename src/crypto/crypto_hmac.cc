@@ -1,4 +1,5 @@
 #include "crypto/crypto_hmac.h"
+#include "crypto/crypto_hash.h"
 #include "crypto/crypto_keys.h"
 #include "crypto/crypto_sig.h"
 #include "crypto/crypto_util.h"
@@ -63,7 +64,7 @@ void Hmac::New(const FunctionCallbackInfo<Value>& args) {
 void Hmac::HmacInit(const char* hash_type, const char* key, int key_len) {
   HandleScope scope(env()->isolate());
 
-  const EVP_MD* md = EVP_get_digestbyname(hash_type);
+  const EVP_MD* md = GetDigestImplementation(hash_type);
   if (md == nullptr)
     return THROW_ERR_CRYPTO_INVALID_DIGEST(env());
   if (key_len == 0) {
@@ -177,7 +178,7 @@ Maybe<bool> HmacTraits::AdditionalConfig(
   CHECK(args[offset + 2]->IsObject());  // Key
 
   Utf8Value digest(env->isolate(), args[offset + 1]);
-  params->digest = EVP_get_digestbyname(*digest);
+  params->digest = GetDigestImplementation(*digest);
   if (params->digest == nullptr) {
     THROW_ERR_CRYPTO_INVALID_DIGEST(env);
     return Nothing<bool>();
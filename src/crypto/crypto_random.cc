@@ -2,11 +2,19 @@
 #include "crypto/crypto_util.h"
 #include "allocated_buffer-inl.h"
 #include "async_wrap-inl.h"
+#include "base_object-inl.h"
 #include "env-inl.h"
 #include "memory_tracker-inl.h"
 #include "threadpoolwork-inl.h"
 #include "v8.h"
 
+#include <atomic>
+#include <cstring>
+
+#ifdef __POSIX__
+#include <pthread.h>
+#endif
+
 namespace node {
 
 using v8::FunctionCallbackInfo;
@@ -19,6 +27,24 @@ using v8::Uint32;
 using v8::Value;
 
 namespace crypto {
+namespace {
+// Incremented in the child process after a fork(), the same way OpenSSL
+// detects forks to reseed its DRBG.
+std::atomic<uint64_t> fork_generation { 0 };
+
+#ifdef __POSIX__
+uv_once_t register_atfork_once = UV_ONCE_INIT;
+
+void OnForkChild() {
+  fork_generation++;
+}
+
+void RegisterAtFork() {
+  CHECK_EQ(pthread_atfork(nullptr, nullptr, OnForkChild), 0);
+}
+#endif
+}  // anonymous namespace
+
 Maybe<bool> RandomBytesTraits::EncodeOutput(
     Environment* env,
     const RandomBytesConfig& params,
@@ -64,9 +90,131 @@ bool RandomBytesTraits::DeriveBits(
   return RAND_bytes(params.buffer, params.size) != 0;
 }
 
+bool RandomPool::Chunk::CanServe(size_t size,
+                                  uint64_t generation,
+                                  uint64_t now) const {
+  return used + size <= kChunkSize &&
+         fork_generation == generation &&
+         now - timestamp <= kMaxChunkAge;
+}
+
+bool RandomPool::Chunk::Generate() {
+  CheckEntropy();  // Ensure that OpenSSL's PRNG is properly seeded.
+  fork_generation = crypto::fork_generation.load();
+  timestamp = uv_hrtime();
+  if (RAND_bytes(data.get(), kChunkSize) != 1)
+    return false;
+  used = 0;
+  return true;
+}
+
+void RandomPool::Chunk::Discard() {
+  if (used < kChunkSize)
+    OPENSSL_cleanse(data.get() + used, kChunkSize - used);
+  used = kChunkSize;
+}
+
+class RandomPool::RefillWork final : public ThreadPoolWork {
+ public:
+  explicit RefillWork(RandomPool* pool)
+      : ThreadPoolWork(pool->env()),
+        pool_(pool),
+        chunk_(&pool->standby_) {}
+
+  void DoThreadPoolWork() override {
+    success_ = chunk_->Generate();
+  }
+
+  void AfterThreadPoolWork(int status) override {
+    std::unique_ptr<RefillWork> self(this);
+    pool_->refill_pending_ = false;
+    if (status != 0 || !success_)
+      chunk_->Discard();
+  }
+
+ private:
+  // Keeps the pool alive while the chunk is being generated.
+  BaseObjectPtr<RandomPool> pool_;
+  Chunk* chunk_;
+  bool success_ = false;
+};
+
+RandomPool::RandomPool(Environment* env, Local<Object> wrap)
+    : BaseObject(env, wrap) {
+#ifdef __POSIX__
+  uv_once(&register_atfork_once, RegisterAtFork);
+#endif
+  active_.data.reset(new unsigned char[kChunkSize]);
+  standby_.data.reset(new unsigned char[kChunkSize]);
+}
+
+RandomPool::~RandomPool() {
+  CHECK(!refill_pending_);
+  active_.Discard();
+  standby_.Discard();
+}
+
+void RandomPool::MemoryInfo(MemoryTracker* tracker) const {
+  tracker->TrackFieldWithSize("chunks", 2 * kChunkSize);
+}
+
+bool RandomPool::Fill(unsigned char* out, size_t size) {
+  if (size > kMaxRequestSize)
+    return false;
+
+  const uint64_t generation = fork_generation.load();
+  const uint64_t now = uv_hrtime();
+  if (!active_.CanServe(size, generation, now)) {
+    active_.Discard();
+    if (!refill_pending_ && standby_.CanServe(size, generation, now)) {
+      std::swap(active_, standby_);
+    } else if (!active_.Generate()) {
+      // Let the caller use RAND_bytes() directly, which reports the error.
+      active_.Discard();
+      return false;
+    }
+  }
+
+  unsigned char* bytes = active_.data.get() + active_.used;
+  memcpy(out, bytes, size);
+  OPENSSL_cleanse(bytes, size);
+  active_.used += size;
+
+  if (!refill_pending_ && standby_.used == kChunkSize)
+    ScheduleRefill();
+  return true;
+}
+
+void RandomPool::ScheduleRefill() {
+  refill_pending_ = true;
+  (new RefillWork(this))->ScheduleWork();
+}
+
+void RandomPool::FillFromPool(const FunctionCallbackInfo<Value>& args) {
+  RandomPool* pool = Environment::GetBindingData<RandomPool>(args);
+  CHECK(IsAnyByteSource(args[0]));  // Buffer to fill
+  CHECK(args[1]->IsUint32());  // Offset
+  CHECK(args[2]->IsUint32());  // Size
+
+  ArrayBufferOrViewContents<unsigned char> in(args[0]);
+  const uint32_t byte_offset = args[1].As<Uint32>()->Value();
+  const uint32_t size = args[2].As<Uint32>()->Value();
+  CHECK_GE(byte_offset + size, byte_offset);  // Overflow check.
+  CHECK_LE(byte_offset + size, in.size());  // Bounds check.
+
+  args.GetReturnValue().Set(pool->Fill(in.data() + byte_offset, size));
+}
+
+constexpr FastStringKey RandomPool::binding_data_name;
+
 namespace Random {
 void Initialize(Environment* env, Local<Object> target) {
   RandomBytesJob::Initialize(env, target);
+
+  env->AddBindingData<RandomPool>(env->context(), target);
+  env->SetMethod(target, "randomFillFromPool", RandomPool::FillFromPool);
+  constexpr size_t kRandomPoolMaxRequestSize = RandomPool::kMaxRequestSize;
+  NODE_DEFINE_CONSTANT(target, kRandomPoolMaxRequestSize);
 }
 }  // namespace Random
 }  // namespace crypto
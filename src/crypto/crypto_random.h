@@ -11,6 +11,8 @@
 #include "node_internals.h"
 #include "v8.h"
 
+#include <memory>
+
 namespace node {
 namespace crypto {
 struct RandomBytesConfig final : public MemoryRetainer {
@@ -47,6 +49,63 @@ struct RandomBytesTraits final {
 
 using RandomBytesJob = DeriveBitsJob<RandomBytesTraits>;
 
+// A per-Environment pool of random bytes. Small requests are served from it
+// with a memcpy(), instead of a call to RAND_bytes() each or, for the async
+// APIs, a round trip through the threadpool. The pool is double-buffered:
+// while one chunk is being consumed, the next one is generated on the
+// threadpool, so the main thread only calls RAND_bytes() itself when
+// requests outpace the refills.
+//
+// Bytes are handed out at most once and are wiped as they are consumed.
+// A chunk is discarded if the process forks after it was generated, and
+// once it is older than kMaxChunkAge, so that reseeding of the OpenSSL DRBG
+// (which happens on fork and periodically) is not undermined by bytes that
+// were generated before the reseed.
+class RandomPool final : public BaseObject {
+ public:
+  // Larger requests bypass the pool.
+  static constexpr size_t kMaxRequestSize = 256;
+  static constexpr size_t kChunkSize = 8 * 1024;
+  static constexpr uint64_t kMaxChunkAge = 60 * 1000 * 1000 * 1000ull;  // ns
+
+  RandomPool(Environment* env, v8::Local<v8::Object> wrap);
+  ~RandomPool() override;
+
+  // Copies |size| random bytes to |out|. Returns false if the request can
+  // not be served from the pool and RAND_bytes() should be used instead.
+  bool Fill(unsigned char* out, size_t size);
+
+  // randomFillFromPool(buffer, offset, size)
+  static void FillFromPool(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  static constexpr FastStringKey binding_data_name { "crypto_random" };
+
+  void MemoryInfo(MemoryTracker* tracker) const override;
+  SET_MEMORY_INFO_NAME(RandomPool)
+  SET_SELF_SIZE(RandomPool)
+
+ private:
+  struct Chunk {
+    std::unique_ptr<unsigned char[]> data;
+    // Starts out exhausted, until the chunk is filled.
+    size_t used = kChunkSize;
+    uint64_t fork_generation = 0;
+    uint64_t timestamp = 0;
+
+    bool CanServe(size_t size, uint64_t fork_generation, uint64_t now) const;
+    bool Generate();
+    void Discard();
+  };
+
+  class RefillWork;
+
+  void ScheduleRefill();
+
+  Chunk active_;
+  Chunk standby_;
+  bool refill_pending_ = false;
+};
+
 namespace Random {
 void Initialize(Environment* env, v8::Local<v8::Object> target);
 }  // namespace Random
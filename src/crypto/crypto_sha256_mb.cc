@@ -0,0 +1,483 @@
+#include "crypto/crypto_sha256_mb.h"
+
+#include <openssl/crypto.h>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define NODE_SHA256_MB_X86 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+namespace node {
+namespace crypto {
+namespace sha256_mb {
+namespace {
+
+constexpr size_t kMaxLanes = 16;
+
+constexpr uint32_t kInitialState[8] = {
+  0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+  0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+constexpr uint32_t kRoundConstants[64] = {
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+  0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+  0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+  0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+  0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+  0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+  0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+  0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+  0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+  0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+  0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+  0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+  0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+  0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+// The state and the message words of all lanes are stored transposed, i.e.
+// word |i| of lane |l| lives at [i][l], so that a single vector load fetches
+// the same word of every lane.
+struct alignas(64) Block {
+  uint32_t state[8][kMaxLanes];
+  uint32_t words[16][kMaxLanes];
+};
+
+using Kernel = void (*)(Block* block);
+
+// A message, the state it starts from and the number of bytes that were
+// already absorbed into that state (64 for the inner and outer HMAC hashes).
+struct Job {
+  const uint32_t* state;
+  uint64_t prefix;
+  const unsigned char* data;
+  size_t length;
+  unsigned char* out;
+};
+
+inline uint32_t LoadBigEndian(const unsigned char* p) {
+  return (static_cast<uint32_t>(p[0]) << 24) |
+         (static_cast<uint32_t>(p[1]) << 16) |
+         (static_cast<uint32_t>(p[2]) << 8) |
+         static_cast<uint32_t>(p[3]);
+}
+
+inline void StoreBigEndian(unsigned char* p, uint32_t value) {
+  p[0] = static_cast<unsigned char>(value >> 24);
+  p[1] = static_cast<unsigned char>(value >> 16);
+  p[2] = static_cast<unsigned char>(value >> 8);
+  p[3] = static_cast<unsigned char>(value);
+}
+
+inline uint32_t Rotr(uint32_t x, int n) {
+  return (x >> n) | (x << (32 - n));
+}
+
+void CompressOne(uint32_t state[8], const uint32_t words[16]) {
+  uint32_t w[64];
+  for (int t = 0; t < 16; t++)
+    w[t] = words[t];
+  for (int t = 16; t < 64; t++) {
+    const uint32_t s0 =
+        Rotr(w[t - 15], 7) ^ Rotr(w[t - 15], 18) ^ (w[t - 15] >> 3);
+    const uint32_t s1 =
+        Rotr(w[t - 2], 17) ^ Rotr(w[t - 2], 19) ^ (w[t - 2] >> 10);
+    w[t] = w[t - 16] + s0 + w[t - 7] + s1;
+  }
+
+  uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+  uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+  for (int t = 0; t < 64; t++) {
+    const uint32_t t1 = h + (Rotr(e, 6) ^ Rotr(e, 11) ^ Rotr(e, 25)) +
+                        ((e & f) ^ (~e & g)) + kRoundConstants[t] + w[t];
+    const uint32_t t2 = (Rotr(a, 2) ^ Rotr(a, 13) ^ Rotr(a, 22)) +
+                        ((a & b) | (c & (a | b)));
+    h = g;
+    g = f;
+    f = e;
+    e = d + t1;
+    d = c;
+    c = b;
+    b = a;
+    a = t1 + t2;
+  }
+  state[0] += a;
+  state[1] += b;
+  state[2] += c;
+  state[3] += d;
+  state[4] += e;
+  state[5] += f;
+  state[6] += g;
+  state[7] += h;
+}
+
+// Processes lane 0 only.
+void CompressPortable(Block* block) {
+  uint32_t state[8];
+  uint32_t words[16];
+  for (int i = 0; i < 8; i++)
+    state[i] = block->state[i][0];
+  for (int i = 0; i < 16; i++)
+    words[i] = block->words[i][0];
+  CompressOne(state, words);
+  for (int i = 0; i < 8; i++)
+    block->state[i][0] = state[i];
+}
+
+#ifdef NODE_SHA256_MB_X86
+
+#define ROTR256(x, n)                                                         \
+  _mm256_or_si256(_mm256_srli_epi32((x), (n)), _mm256_slli_epi32((x), 32 - (n)))
+
+// Processes lanes 0 to 7.
+__attribute__((target("avx2")))
+void CompressAvx2(Block* block) {
+  __m256i w[16];
+  for (int i = 0; i < 16; i++)
+    w[i] = _mm256_load_si256(reinterpret_cast<__m256i*>(block->words[i]));
+  __m256i s[8];
+  for (int i = 0; i < 8; i++)
+    s[i] = _mm256_load_si256(reinterpret_cast<__m256i*>(block->state[i]));
+
+  __m256i a = s[0], b = s[1], c = s[2], d = s[3];
+  __m256i e = s[4], f = s[5], g = s[6], h = s[7];
+  for (int t = 0; t < 64; t++) {
+    __m256i wt = w[t & 15];
+    if (t >= 16) {
+      const __m256i w15 = w[(t - 15) & 15];
+      const __m256i w2 = w[(t - 2) & 15];
+      const __m256i s0 = _mm256_xor_si256(
+          _mm256_xor_si256(ROTR256(w15, 7), ROTR256(w15, 18)),
+          _mm256_srli_epi32(w15, 3));
+      const __m256i s1 = _mm256_xor_si256(
+          _mm256_xor_si256(ROTR256(w2, 17), ROTR256(w2, 19)),
+          _mm256_srli_epi32(w2, 10));
+      wt = _mm256_add_epi32(_mm256_add_epi32(wt, s0),
+                            _mm256_add_epi32(w[(t - 7) & 15], s1));
+      w[t & 15] = wt;
+    }
+    const __m256i sum1 = _mm256_xor_si256(
+        _mm256_xor_si256(ROTR256(e, 6), ROTR256(e, 11)), ROTR256(e, 25));
+    const __m256i ch = _mm256_xor_si256(_mm256_and_si256(e, f),
+                                        _mm256_andnot_si256(e, g));
+    const __m256i t1 = _mm256_add_epi32(
+        _mm256_add_epi32(_mm256_add_epi32(h, sum1), ch),
+        _mm256_add_epi32(
+            _mm256_set1_epi32(static_cast<int>(kRoundConstants[t])), wt));
+    const __m256i sum0 = _mm256_xor_si256(
+        _mm256_xor_si256(ROTR256(a, 2), ROTR256(a, 13)), ROTR256(a, 22));
+    const __m256i maj = _mm256_or_si256(
+        _mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_or_si256(a, b)));
+    const __m256i t2 = _mm256_add_epi32(sum0, maj);
+    h = g;
+    g = f;
+    f = e;
+    e = _mm256_add_epi32(d, t1);
+    d = c;
+    c = b;
+    b = a;
+    a = _mm256_add_epi32(t1, t2);
+  }
+
+  s[0] = _mm256_add_epi32(s[0], a);
+  s[1] = _mm256_add_epi32(s[1], b);
+  s[2] = _mm256_add_epi32(s[2], c);
+  s[3] = _mm256_add_epi32(s[3], d);
+  s[4] = _mm256_add_epi32(s[4], e);
+  s[5] = _mm256_add_epi32(s[5], f);
+  s[6] = _mm256_add_epi32(s[6], g);
+  s[7] = _mm256_add_epi32(s[7], h);
+  for (int i = 0; i < 8; i++)
+    _mm256_store_si256(reinterpret_cast<__m256i*>(block->state[i]), s[i]);
+}
+
+#undef ROTR256
+
+// Processes lanes 0 to 15. AVX-512 has native rotates and three-input logic
+// operations, so each round needs noticeably fewer instructions than with
+// AVX2 on top of processing twice as many lanes.
+__attribute__((target("avx512f")))
+void CompressAvx512(Block* block) {
+  __m512i w[16];
+  for (int i = 0; i < 16; i++)
+    w[i] = _mm512_load_si512(block->words[i]);
+  __m512i s[8];
+  for (int i = 0; i < 8; i++)
+    s[i] = _mm512_load_si512(block->state[i]);
+
+  __m512i a = s[0], b = s[1], c = s[2], d = s[3];
+  __m512i e = s[4], f = s[5], g = s[6], h = s[7];
+  for (int t = 0; t < 64; t++) {
+    __m512i wt = w[t & 15];
+    if (t >= 16) {
+      const __m512i w15 = w[(t - 15) & 15];
+      const __m512i w2 = w[(t - 2) & 15];
+      const __m512i s0 = _mm512_ternarylogic_epi32(
+          _mm512_ror_epi32(w15, 7), _mm512_ror_epi32(w15, 18),
+          _mm512_srli_epi32(w15, 3), 0x96);
+      const __m512i s1 = _mm512_ternarylogic_epi32(
+          _mm512_ror_epi32(w2, 17), _mm512_ror_epi32(w2, 19),
+          _mm512_srli_epi32(w2, 10), 0x96);
+      wt = _mm512_add_epi32(_mm512_add_epi32(wt, s0),
+                            _mm512_add_epi32(w[(t - 7) & 15], s1));
+      w[t & 15] = wt;
+    }
+    // 0x96 is a ^ b ^ c, 0xca is a ? b : c and 0xe8 is the majority function.
+    const __m512i sum1 = _mm512_ternarylogic_epi32(
+        _mm512_ror_epi32(e, 6), _mm512_ror_epi32(e, 11),
+        _mm512_ror_epi32(e, 25), 0x96);
+    const __m512i ch = _mm512_ternarylogic_epi32(e, f, g, 0xca);
+    const __m512i t1 = _mm512_add_epi32(
+        _mm512_add_epi32(_mm512_add_epi32(h, sum1), ch),
+        _mm512_add_epi32(
+            _mm512_set1_epi32(static_cast<int>(kRoundConstants[t])), wt));
+    const __m512i sum0 = _mm512_ternarylogic_epi32(
+        _mm512_ror_epi32(a, 2), _mm512_ror_epi32(a, 13),
+        _mm512_ror_epi32(a, 22), 0x96);
+    const __m512i maj = _mm512_ternarylogic_epi32(a, b, c, 0xe8);
+    const __m512i t2 = _mm512_add_epi32(sum0, maj);
+    h = g;
+    g = f;
+    f = e;
+    e = _mm512_add_epi32(d, t1);
+    d = c;
+    c = b;
+    b = a;
+    a = _mm512_add_epi32(t1, t2);
+  }
+
+  s[0] = _mm512_add_epi32(s[0], a);
+  s[1] = _mm512_add_epi32(s[1], b);
+  s[2] = _mm512_add_epi32(s[2], c);
+  s[3] = _mm512_add_epi32(s[3], d);
+  s[4] = _mm512_add_epi32(s[4], e);
+  s[5] = _mm512_add_epi32(s[5], f);
+  s[6] = _mm512_add_epi32(s[6], g);
+  s[7] = _mm512_add_epi32(s[7], h);
+  for (int i = 0; i < 8; i++)
+    _mm512_store_si512(block->state[i], s[i]);
+}
+
+#endif  // NODE_SHA256_MB_X86
+
+struct Implementation {
+  Kernel kernel;
+  size_t lanes;
+  bool accelerated;
+  // Above this average message length, OpenSSL is faster.
+  size_t max_average_length;
+};
+
+Implementation Detect() {
+#ifdef NODE_SHA256_MB_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f"))
+    return { CompressAvx512, 16, true, SIZE_MAX };
+  if (__builtin_cpu_supports("avx2")) {
+    // With the SHA extensions, OpenSSL hashes a single long message faster
+    // than the AVX2 kernel hashes eight of them. For short messages, the
+    // per-message overhead of EVP still dominates.
+    unsigned int eax, ebx, ecx, edx;
+    const bool has_sha_ni =
+        __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) &&
+        (ebx & (1u << 29)) != 0;
+    return { CompressAvx2, 8, true, has_sha_ni ? 512 : SIZE_MAX };
+  }
+#endif
+  return { CompressPortable, 1, false, 0 };
+}
+
+const Implementation& GetImplementation() {
+  static const Implementation implementation = Detect();
+  return implementation;
+}
+
+struct Lane {
+  const Job* job;
+  const unsigned char* data;
+  size_t full_blocks;
+  size_t tail_blocks;
+  size_t tail_index;
+  unsigned char tail[2 * kBlockLength];
+};
+
+class Scheduler {
+ public:
+  Scheduler(const Job* jobs, size_t count)
+      : implementation_(GetImplementation()), jobs_(jobs), count_(count) {
+    memset(&block_, 0, sizeof(block_));
+  }
+
+  void Run() {
+    const size_t lanes = implementation_.lanes;
+    size_t active = 0;
+    for (size_t l = 0; l < lanes; l++) {
+      if (Load(l))
+        active++;
+    }
+
+    while (active > 0) {
+      for (size_t l = 0; l < lanes; l++) {
+        const Lane& lane = lanes_[l];
+        if (lane.job == nullptr)
+          continue;
+        const unsigned char* p = lane.full_blocks > 0 ?
+            lane.data : lane.tail + lane.tail_index * kBlockLength;
+        for (int i = 0; i < 16; i++)
+          block_.words[i][l] = LoadBigEndian(p + 4 * i);
+      }
+
+      implementation_.kernel(&block_);
+
+      for (size_t l = 0; l < lanes; l++) {
+        Lane& lane = lanes_[l];
+        if (lane.job == nullptr)
+          continue;
+        if (lane.full_blocks > 0) {
+          lane.full_blocks--;
+          lane.data += kBlockLength;
+          continue;
+        }
+        if (++lane.tail_index < lane.tail_blocks)
+          continue;
+        for (int i = 0; i < 8; i++)
+          StoreBigEndian(lane.job->out + 4 * i, block_.state[i][l]);
+        if (!Load(l))
+          active--;
+      }
+    }
+  }
+
+ private:
+  // Assigns the next job to lane |l|. The final partial block and the padding
+  // are prepared up front, so that the lane only ever has to read whole
+  // blocks afterwards.
+  bool Load(size_t l) {
+    Lane& lane = lanes_[l];
+    if (next_ == count_) {
+      lane.job = nullptr;
+      return false;
+    }
+    const Job& job = jobs_[next_++];
+    lane.job = &job;
+    for (int i = 0; i < 8; i++)
+      block_.state[i][l] = job.state[i];
+
+    const size_t remainder = job.length % kBlockLength;
+    lane.data = job.data;
+    lane.full_blocks = job.length / kBlockLength;
+    lane.tail_blocks = remainder + 9 > kBlockLength ? 2 : 1;
+    lane.tail_index = 0;
+    memset(lane.tail, 0, sizeof(lane.tail));
+    if (remainder > 0)
+      memcpy(lane.tail, job.data + job.length - remainder, remainder);
+    lane.tail[remainder] = 0x80;
+    const uint64_t bits = (job.prefix + job.length) * 8;
+    unsigned char* end = lane.tail + lane.tail_blocks * kBlockLength;
+    StoreBigEndian(end - 8, static_cast<uint32_t>(bits >> 32));
+    StoreBigEndian(end - 4, static_cast<uint32_t>(bits));
+    return true;
+  }
+
+  const Implementation& implementation_;
+  const Job* jobs_;
+  size_t count_;
+  size_t next_ = 0;
+  Block block_;
+  Lane lanes_[kMaxLanes];
+};
+
+void HashPad(const unsigned char key[kBlockLength],
+             unsigned char pad,
+             uint32_t state[8]) {
+  uint32_t words[16];
+  unsigned char block[kBlockLength];
+  for (size_t i = 0; i < kBlockLength; i++)
+    block[i] = key[i] ^ pad;
+  for (int i = 0; i < 16; i++)
+    words[i] = LoadBigEndian(block + 4 * i);
+  memcpy(state, kInitialState, sizeof(kInitialState));
+  CompressOne(state, words);
+  OPENSSL_cleanse(block, sizeof(block));
+  OPENSSL_cleanse(words, sizeof(words));
+}
+
+}  // anonymous namespace
+
+size_t Lanes() {
+  const Implementation& implementation = GetImplementation();
+  return implementation.accelerated ? implementation.lanes : 0;
+}
+
+bool ShouldUse(size_t count, size_t total_length) {
+  // With fewer messages than half the lanes, most of the work is wasted on
+  // idle lanes and the single-message assembly in OpenSSL is faster.
+  const Implementation& implementation = GetImplementation();
+  return implementation.accelerated &&
+         count >= implementation.lanes / 2 &&
+         total_length / count <= implementation.max_average_length;
+}
+
+void Digest(const Message* messages, size_t count, unsigned char* out) {
+  std::vector<Job> jobs(count);
+  for (size_t i = 0; i < count; i++) {
+    jobs[i] = Job { kInitialState, 0, messages[i].data, messages[i].length,
+                    out + i * kDigestLength };
+  }
+  Scheduler(jobs.data(), count).Run();
+}
+
+void Hmac(const unsigned char* key,
+          size_t key_length,
+          const Message* messages,
+          size_t count,
+          unsigned char* out) {
+  unsigned char padded_key[kBlockLength] = {};
+  if (key_length > kBlockLength) {
+    const Message message { key, key_length };
+    Digest(&message, 1, padded_key);
+  } else if (key_length > 0) {
+    memcpy(padded_key, key, key_length);
+  }
+
+  // The first block of both the inner and the outer hash only depends on the
+  // key, so it is compressed once for the whole batch.
+  uint32_t inner_state[8];
+  uint32_t outer_state[8];
+  HashPad(padded_key, 0x36, inner_state);
+  HashPad(padded_key, 0x5c, outer_state);
+
+  std::vector<unsigned char> inner(count * kDigestLength);
+  std::vector<Job> jobs(count);
+  for (size_t i = 0; i < count; i++) {
+    jobs[i] = Job { inner_state, kBlockLength, messages[i].data,
+                    messages[i].length, inner.data() + i * kDigestLength };
+  }
+  Scheduler(jobs.data(), count).Run();
+
+  for (size_t i = 0; i < count; i++) {
+    jobs[i] = Job { outer_state, kBlockLength,
+                    inner.data() + i * kDigestLength, kDigestLength,
+                    out + i * kDigestLength };
+  }
+  Scheduler(jobs.data(), count).Run();
+
+  // The padded key and the pad states are as good as the key itself. Unlike
+  // memset(), OPENSSL_cleanse() is not optimized away on dead buffers.
+  OPENSSL_cleanse(padded_key, sizeof(padded_key));
+  OPENSSL_cleanse(inner_state, sizeof(inner_state));
+  OPENSSL_cleanse(outer_state, sizeof(outer_state));
+  OPENSSL_cleanse(inner.data(), inner.size());
+}
+
+}  // namespace sha256_mb
+}  // namespace crypto
+}  // namespace node
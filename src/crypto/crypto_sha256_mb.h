@@ -0,0 +1,53 @@
+#ifndef SRC_CRYPTO_CRYPTO_SHA256_MB_H_
+#define SRC_CRYPTO_CRYPTO_SHA256_MB_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include <cstddef>
+#include <cstdint>
+
+namespace node {
+namespace crypto {
+namespace sha256_mb {
+
+// Multi-buffer SHA-256: hashes several independent messages at once by
+// running one message per SIMD lane (8 lanes with AVX2, 16 with AVX-512).
+// OpenSSL only ever works on a single message, which leaves most of the
+// vector units idle when hashing many short messages, e.g. when computing
+// one HMAC per header for request signing.
+
+constexpr size_t kDigestLength = 32;
+constexpr size_t kBlockLength = 64;
+
+struct Message {
+  const unsigned char* data;
+  size_t length;
+};
+
+// Returns the number of lanes the selected kernel processes in parallel, or
+// 0 if this CPU has no multi-buffer kernel that is faster than OpenSSL.
+size_t Lanes();
+
+// Whether a batch of |count| messages with a combined size of |total_length|
+// bytes should go through the multi-buffer kernel rather than through EVP,
+// one message at a time.
+bool ShouldUse(size_t count, size_t total_length);
+
+// Writes the SHA-256 digest of each message to |out|, kDigestLength bytes
+// per message. Falls back to a portable implementation when no kernel is
+// available, so the result is always correct.
+void Digest(const Message* messages, size_t count, unsigned char* out);
+
+// Same as Digest(), but computes HMAC-SHA256 of each message with |key|.
+void Hmac(const unsigned char* key,
+          size_t key_length,
+          const Message* messages,
+          size_t count,
+          unsigned char* out);
+
+}  // namespace sha256_mb
+}  // namespace crypto
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+#endif  // SRC_CRYPTO_CRYPTO_SHA256_MB_H_
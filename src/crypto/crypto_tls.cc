@@ -28,6 +28,7 @@
 #include "allocated_buffer-inl.h"
 #include "async_wrap-inl.h"
 #include "debug_utils-inl.h"
+#include "histogram-inl.h"
 #include "memory_tracker-inl.h"
 #include "node_buffer.h"
 #include "node_errors.h"
@@ -516,6 +517,8 @@ void TLSWrap::SSLInfoCallback(const SSL* ssl_, int where, int ret) {
 
   if (where & SSL_CB_HANDSHAKE_START) {
     Debug(c, "SSLInfoCallback(SSL_CB_HANDSHAKE_START);");
+    if (c->handshake_histogram_ && c->handshake_start_time_ == 0)
+      c->handshake_start_time_ = uv_hrtime();
     // Start is tracked to limit number and frequency of renegotiation attempts,
     // since excessive renegotiation may be an attack.
     Local<Value> callback;
@@ -537,6 +540,14 @@ void TLSWrap::SSLInfoCallback(const SSL* ssl_, int where, int ret) {
 
     c->established_ = true;
 
+    if (c->handshake_start_time_ != 0) {
+      c->handshake_histogram_->RecordValue(
+          uv_hrtime() - c->handshake_start_time_);
+      // Only the initial handshake is recorded.
+      c->handshake_histogram_.reset();
+      c->handshake_start_time_ = 0;
+    }
+
     if (object->Get(env->context(), env->onhandshakedone_string())
           .ToLocal(&callback) && callback->IsFunction()) {
       c->MakeCallback(callback.As<Function>(), 0, nullptr);
@@ -1575,6 +1586,15 @@ void TLSWrap::SetALPNProtocols(const FunctionCallbackInfo<Value>& args) {
   }
 }
 
+void TLSWrap::SetHandshakeHistogram(const FunctionCallbackInfo<Value>& args) {
+  TLSWrap* w;
+  ASSIGN_OR_RETURN_UNWRAP(&w, args.Holder());
+  CHECK(args[0]->IsObject());
+  HistogramBase* histogram;
+  ASSIGN_OR_RETURN_UNWRAP(&histogram, args[0].As<Object>());
+  w->handshake_histogram_.reset(histogram);
+}
+
 void TLSWrap::GetPeerCertificate(const FunctionCallbackInfo<Value>& args) {
   TLSWrap* w;
   ASSIGN_OR_RETURN_UNWRAP(&w, args.Holder());
@@ -2039,6 +2059,7 @@ void TLSWrap::Initialize(
   env->SetProtoMethod(t, "renegotiate", Renegotiate);
   env->SetProtoMethod(t, "requestOCSP", RequestOCSP);
   env->SetProtoMethod(t, "setALPNProtocols", SetALPNProtocols);
+  env->SetProtoMethod(t, "setHandshakeHistogram", SetHandshakeHistogram);
   env->SetProtoMethod(t, "setOCSPResponse", SetOCSPResponse);
   env->SetProtoMethod(t, "setServername", SetServername);
   env->SetProtoMethod(t, "setSession", SetSession);
@@ -29,6 +29,7 @@
 
 #include "allocated_buffer.h"
 #include "async_wrap.h"
+#include "histogram.h"
 #include "stream_wrap.h"
 #include "v8.h"
 
@@ -206,6 +207,8 @@ class TLSWrap : public AsyncWrap,
   static void Renegotiate(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void RequestOCSP(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetALPNProtocols(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetHandshakeHistogram(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetOCSPResponse(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetServername(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetSession(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -274,6 +277,11 @@ class TLSWrap : public AsyncWrap,
 
   int cycle_depth_ = 0;
 
+  // Set by tls.Server when the latency histograms are enabled. The duration
+  // of the initial handshake is recorded into it.
+  BaseObjectPtr<HistogramBase> handshake_histogram_;
+  uint64_t handshake_start_time_ = 0;
+
   // SSL_set_cert_cb
   CertCb cert_cb_ = nullptr;
   void* cert_cb_arg_ = nullptr;
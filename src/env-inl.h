@@ -58,7 +58,9 @@ inline MultiIsolatePlatform* IsolateData::platform() const {
 }
 
 inline void IsolateData::set_worker_context(worker::Worker* context) {
-  CHECK_NULL(worker_context_);  // Should be set only once.
+  // Should be set only once, unless the isolate is reused by another Worker
+  // after having been reset.
+  CHECK_IMPLIES(context != nullptr, worker_context_ == nullptr);
   worker_context_ = context;
 }
 
@@ -66,6 +68,22 @@ inline worker::Worker* IsolateData::worker_context() const {
   return worker_context_;
 }
 
+inline bool IsolateData::deserialized_from_snapshot() const {
+  return snapshot_indexes_ != nullptr;
+}
+
+inline v8::StartupData* IsolateData::snapshot_blob() const {
+  return snapshot_blob_;
+}
+
+inline void IsolateData::set_snapshot_blob(v8::StartupData* blob) {
+  snapshot_blob_ = blob;
+}
+
+inline const std::vector<size_t>* IsolateData::snapshot_indexes() const {
+  return snapshot_indexes_;
+}
+
 inline v8::Local<v8::String> IsolateData::async_wrap_provider(int index) const {
   return async_wrap_providers_[index].Get(isolate_);
 }
@@ -366,13 +384,15 @@ inline T* Environment::GetBindingData(v8::Local<v8::Context> context) {
   return result;
 }
 
-template <typename T>
+template <typename T, typename... Args>
 inline T* Environment::AddBindingData(
     v8::Local<v8::Context> context,
-    v8::Local<v8::Object> target) {
+    v8::Local<v8::Object> target,
+    Args&&... args) {
   DCHECK_EQ(GetCurrent(context), this);
   // This won't compile if T is not a BaseObject subclass.
-  BaseObjectPtr<T> item = MakeDetachedBaseObject<T>(this, target);
+  BaseObjectPtr<T> item =
+      MakeDetachedBaseObject<T>(this, target, std::forward<Args>(args)...);
   BindingDataStore* map = static_cast<BindingDataStore*>(
       context->GetAlignedPointerFromEmbedderData(
           ContextEmbedderIndex::kBindingListIndex));
@@ -412,6 +432,10 @@ inline uv_idle_t* Environment::immediate_idle_handle() {
   return &immediate_idle_handle_;
 }
 
+inline LoopPhaseTracer* Environment::loop_phase_tracer() {
+  return &loop_phase_tracer_;
+}
+
 inline void Environment::RegisterHandleCleanup(uv_handle_t* handle,
                                                HandleCleanupCb cb,
                                                void* arg) {
@@ -489,6 +513,15 @@ inline uint64_t Environment::timer_base() const {
   return timer_base_;
 }
 
+inline TimerWheel* Environment::timer_wheel() {
+  return &timer_wheel_;
+}
+
+inline profiler::ContinuousCpuProfiler*
+Environment::continuous_cpu_profiler() {
+  return continuous_cpu_profiler_.get();
+}
+
 inline std::shared_ptr<KVStore> Environment::env_vars() {
   return env_vars_;
 }
@@ -543,6 +576,11 @@ inline uint32_t Environment::get_next_function_id() {
   return function_id_counter_++;
 }
 
+inline void Environment::ReserveFunctionId(uint32_t id) {
+  if (function_id_counter_ <= id)
+    function_id_counter_ = id + 1;
+}
+
 ShouldNotAbortOnUncaughtScope::ShouldNotAbortOnUncaughtScope(
     Environment* env)
     : env_(env) {
@@ -2,14 +2,17 @@
 #include "allocated_buffer-inl.h"
 #include "async_wrap.h"
 #include "base_object-inl.h"
+#include "compile_cache.h"
 #include "debug_utils-inl.h"
 #include "memory_tracker-inl.h"
 #include "node_buffer.h"
 #include "node_context_data.h"
+#include "node_continuous_profiler.h"
 #include "node_errors.h"
 #include "node_internals.h"
 #include "node_options-inl.h"
 #include "node_process.h"
+#include "node_snapshotable.h"
 #include "node_v8_platform-inl.h"
 #include "node_worker.h"
 #include "req_wrap-inl.h"
@@ -200,6 +203,7 @@ IsolateData::IsolateData(Isolate* isolate,
     CreateProperties();
   } else {
     DeserializeProperties(indexes);
+    snapshot_indexes_ = indexes;
   }
 }
 
@@ -230,6 +234,12 @@ void InitThreadLocalOnce() {
 }
 
 void TrackingTraceStateObserver::UpdateTraceCategoryState() {
+  // This may be called from any thread, so the handle that is only needed
+  // for the node.loop category is started or stopped from the event loop.
+  env_->SetImmediateThreadsafe([](Environment* env) {
+    env->UpdateLoopPhaseTracing();
+  }, CallbackFlags::kUnrefed);
+
   if (!env_->owns_process_state() || !env_->can_call_into_js()) {
     // Ideally, we’d have a consistent story that treats all threads/Environment
     // instances equally here. However, tracing is essentially global, and this
@@ -254,6 +264,35 @@ void TrackingTraceStateObserver::UpdateTraceCategoryState() {
   USE(cb->Call(env_->context(), Undefined(isolate), arraysize(args), args));
 }
 
+void LoopPhaseTracer::Enter(Phase phase) {
+  bool enabled;
+  TRACE_EVENT_CATEGORY_GROUP_ENABLED(TRACING_CATEGORY_NODE1(loop), &enabled);
+  if (LIKELY(!enabled)) {
+    phase_ = Phase::kNone;
+    return;
+  }
+  if (phase_ != Phase::kNone) {
+    TRACE_EVENT_END1(TRACING_CATEGORY_NODE1(loop), PhaseName(phase_),
+                     "callbacks",
+                     callback_count_ - phase_start_callback_count_);
+  }
+  TRACE_EVENT_BEGIN0(TRACING_CATEGORY_NODE1(loop), PhaseName(phase));
+  phase_ = phase;
+  phase_start_callback_count_ = callback_count_;
+}
+
+const char* LoopPhaseTracer::PhaseName(Phase phase) {
+  switch (phase) {
+    case Phase::kTimers: return "Timers";
+    case Phase::kPending: return "Pending";
+    case Phase::kPoll: return "Poll";
+    case Phase::kCheck: return "Check";
+    case Phase::kClose: return "Close";
+    case Phase::kNone: break;
+  }
+  UNREACHABLE();
+}
+
 void Environment::CreateProperties() {
   HandleScope handle_scope(isolate_);
   Local<Context> ctx = context();
@@ -368,6 +407,19 @@ Environment::Environment(IsolateData* isolate_data,
   inspector_agent_ = std::make_unique<inspector::Agent>(this);
 #endif
 
+  if (!options_->compile_cache_dir.empty()) {
+    compile_cache_handler_ = std::make_unique<CompileCacheHandler>(this);
+    if (!compile_cache_handler_->InitializeDirectory(
+            options_->compile_cache_dir)) {
+      compile_cache_handler_.reset();
+    }
+  }
+
+  if (options_->max_idle_worker_isolates > 0) {
+    idle_worker_isolates_ = std::make_unique<worker::IdleIsolateCache>(
+        options_->max_idle_worker_isolates);
+  }
+
   static uv_once_t init_once = UV_ONCE_INIT;
   uv_once(&init_once, InitThreadLocalOnce);
   uv_key_set(&thread_local_env, this);
@@ -382,6 +434,8 @@ Environment::Environment(IsolateData* isolate_data,
 
   performance_state_ = std::make_unique<performance::PerformanceState>(
       isolate, MAYBE_FIELD_PTR(env_info, performance_state));
+  performance_state_->loop_idle_time_baseline =
+      uv_metrics_idle_time(event_loop());
 
   if (*TRACE_EVENT_API_GET_CATEGORY_GROUP_ENABLED(
           TRACING_CATEGORY_NODE1(environment)) != 0) {
@@ -532,6 +586,10 @@ void Environment::InitializeLibuv() {
 
   uv_check_start(immediate_check_handle(), CheckImmediate);
 
+  uv_prepare_init(event_loop(), &loop_phase_prepare_handle_);
+  uv_unref(reinterpret_cast<uv_handle_t*>(&loop_phase_prepare_handle_));
+  UpdateLoopPhaseTracing();
+
   uv_async_init(
       event_loop(),
       &task_queues_async_,
@@ -583,6 +641,7 @@ void Environment::RegisterHandleCleanups() {
   register_handle(reinterpret_cast<uv_handle_t*>(timer_handle()));
   register_handle(reinterpret_cast<uv_handle_t*>(immediate_check_handle()));
   register_handle(reinterpret_cast<uv_handle_t*>(immediate_idle_handle()));
+  register_handle(reinterpret_cast<uv_handle_t*>(&loop_phase_prepare_handle_));
   register_handle(reinterpret_cast<uv_handle_t*>(&task_queues_async_));
 }
 
@@ -630,6 +689,7 @@ void Environment::RunCleanup() {
   started_cleanup_ = true;
   TraceEventScope trace_scope(TRACING_CATEGORY_NODE1(environment),
                               "RunCleanup", this);
+  if (compile_cache_handler_) compile_cache_handler_->Persist();
   bindings_.clear();
   initial_base_object_count_ = 0;
   CleanupHandles();
@@ -701,6 +761,13 @@ void Environment::RunAndClearInterrupts() {
 void Environment::RunAndClearNativeImmediates(bool only_refed) {
   TraceEventScope trace_scope(TRACING_CATEGORY_NODE1(environment),
                               "RunAndClearNativeImmediates", this);
+  TRACE_EVENT_BEGIN0(TRACING_CATEGORY_NODE1(loop),
+                     "RunAndClearNativeImmediates");
+  size_t call_count = 0;
+  auto end_trace_event = OnScopeLeave([&]() {
+    TRACE_EVENT_END1(TRACING_CATEGORY_NODE1(loop),
+                     "RunAndClearNativeImmediates", "count", call_count);
+  });
   HandleScope handle_scope(isolate_);
   InternalCallbackScope cb_scope(this, Object::New(isolate_), { 0, 0 });
 
@@ -718,8 +785,10 @@ void Environment::RunAndClearNativeImmediates(bool only_refed) {
       if (is_refed)
         ref_count++;
 
-      if (is_refed || !only_refed)
+      if (is_refed || !only_refed) {
         head->Call(this);
+        call_count++;
+      }
 
       head.reset();  // Destroy now so that this is also observed by try_catch.
 
@@ -792,6 +861,22 @@ void Environment::ScheduleTimer(int64_t duration_ms) {
   uv_timer_start(timer_handle(), RunTimers, duration_ms, 0);
 }
 
+void Environment::set_continuous_cpu_profiler(
+    std::unique_ptr<profiler::ContinuousCpuProfiler> profiler) {
+  continuous_cpu_profiler_ = std::move(profiler);
+}
+
+void Environment::InsertTimer(uint32_t id, uint64_t expiry) {
+  timer_wheel_.Schedule(id, expiry);
+  if (expiry >= timer_wakeup_)
+    return;
+  int64_t duration_ms =
+      static_cast<int64_t>(expiry) -
+      static_cast<int64_t>(uv_now(event_loop()) - timer_base());
+  ScheduleTimer(duration_ms > 0 ? duration_ms : 1);
+  timer_wakeup_ = expiry;
+}
+
 void Environment::ToggleTimerRef(bool ref) {
   if (started_cleanup_) return;
 
@@ -806,6 +891,10 @@ void Environment::RunTimers(uv_timer_t* handle) {
   Environment* env = Environment::from_timer_handle(handle);
   TraceEventScope trace_scope(TRACING_CATEGORY_NODE1(environment),
                               "RunTimers", env);
+  env->loop_phase_tracer()->Enter(LoopPhaseTracer::Phase::kTimers);
+  auto end_phase = OnScopeLeave([&]() {
+    env->loop_phase_tracer()->Enter(LoopPhaseTracer::Phase::kPending);
+  });
 
   if (!env->can_call_into_js())
     return;
@@ -816,58 +905,104 @@ void Environment::RunTimers(uv_timer_t* handle) {
   Local<Object> process = env->process_object();
   InternalCallbackScope scope(env, process, {0, 0});
 
-  Local<Function> cb = env->timers_callback_function();
-  MaybeLocal<Value> ret;
-  Local<Value> arg = env->GetNow();
-  // This code will loop until all currently due timers will process. It is
-  // impossible for us to end up in an infinite loop due to how the JS-side
-  // is structured.
-  do {
-    TryCatchScope try_catch(env);
-    try_catch.SetVerbose(true);
-    ret = cb->Call(env->context(), process, 1, &arg);
-  } while (ret.IsEmpty() && env->can_call_into_js());
-
-  // NOTE(apapirovski): If it ever becomes possible that `call_into_js` above
-  // is reset back to `true` after being previously set to `false` then this
-  // code becomes invalid and needs to be rewritten. Otherwise catastrophic
-  // timers corruption will occur and all timers behaviour will become
-  // entirely unpredictable.
-  if (ret.IsEmpty())
-    return;
-
-  // To allow for less JS-C++ boundary crossing, the value returned from JS
-  // serves a few purposes:
-  // 1. If it's 0, no more timers exist and the handle should be unrefed
-  // 2. If it's > 0, the value represents the next timer's expiry and there
-  //    is at least one timer remaining that is refed.
-  // 3. If it's < 0, the absolute value represents the next timer's expiry
-  //    and there are no timers that are refed.
-  int64_t expiry_ms =
-      ret.ToLocalChecked()->IntegerValue(env->context()).FromJust();
+  // The timer handle is not running anymore, any timer that is inserted from
+  // here on restarts it until it is rescheduled below.
+  env->timer_wakeup_ = TimerWheel::kNever;
+
+  TimerWheel* wheel = env->timer_wheel();
+  uint64_t now = env->GetNowUint64();
+  std::vector<uint32_t> expired;
+  wheel->Advance(now, &expired);
+
+  // Native timers run first, the timers that expired are handed to JS as a
+  // single batch of ids.
+  std::vector<uint32_t> expired_js;
+  expired_js.reserve(expired.size());
+  for (uint32_t id : expired) {
+    if (TimerWheel::IsNativeTimer(id))
+      wheel->RunNativeTimer(id);
+    else
+      expired_js.push_back(id);
+  }
 
   uv_handle_t* h = reinterpret_cast<uv_handle_t*>(handle);
+  // Unless JS tells otherwise, the timer handle is refed while there are
+  // refed JS timers, as JS toggles it when their count goes from or to 0.
+  // Native timers never keep the event loop alive.
+  bool refed = uv_has_ref(h);
+
+  // The handle may have fired only to cascade timers within the wheel.
+  if (!expired_js.empty()) {
+    if (!env->RunExpiredTimers(now, expired_js, &refed))
+      return;
+  }
 
-  if (expiry_ms != 0) {
+  uint64_t wakeup = wheel->NextWakeup();
+  if (wakeup != TimerWheel::kNever) {
     int64_t duration_ms =
-        llabs(expiry_ms) - (uv_now(env->event_loop()) - env->timer_base());
+        static_cast<int64_t>(wakeup) -
+        static_cast<int64_t>(uv_now(env->event_loop()) - env->timer_base());
 
     env->ScheduleTimer(duration_ms > 0 ? duration_ms : 1);
+    env->timer_wakeup_ = wakeup;
 
-    if (expiry_ms > 0)
+    if (refed)
       uv_ref(h);
     else
       uv_unref(h);
   } else {
+    env->timer_wakeup_ = TimerWheel::kNever;
     uv_unref(h);
   }
 }
 
+bool Environment::RunExpiredTimers(uint64_t now,
+                                   const std::vector<uint32_t>& expired,
+                                   bool* refed) {
+  Local<Object> process = process_object();
+  Local<Function> cb = timers_callback_function();
+  MaybeLocal<Value> ret;
+  Local<Value> args[] = {
+    Number::New(isolate(), static_cast<double>(now)),
+    Undefined(isolate())
+  };
+  if (!ToV8Value(context(), expired).ToLocal(&args[1]))
+    return false;
+  // This code will loop until all currently due timers will process. It is
+  // impossible for us to end up in an infinite loop due to how the JS-side
+  // is structured: the timers of the batch that have not run yet when one of
+  // them throws are kept on the JS side, and run by the next call, which
+  // does not pass a new batch.
+  do {
+    TryCatchScope try_catch(this);
+    try_catch.SetVerbose(true);
+    ret = cb->Call(context(), process, arraysize(args), args);
+    args[1] = Undefined(isolate());
+  } while (ret.IsEmpty() && can_call_into_js());
+
+  // NOTE(apapirovski): If it ever becomes possible that `call_into_js` above
+  // is reset back to `true` after being previously set to `false` then this
+  // code becomes invalid and needs to be rewritten. Otherwise catastrophic
+  // timers corruption will occur and all timers behaviour will become
+  // entirely unpredictable.
+  if (ret.IsEmpty())
+    return false;
+
+  // The value returned from JS tells whether there are timers left that are
+  // refed.
+  *refed = ret.ToLocalChecked()->IsTrue();
+  return true;
+}
+
 
 void Environment::CheckImmediate(uv_check_t* handle) {
   Environment* env = Environment::from_immediate_check_handle(handle);
   TraceEventScope trace_scope(TRACING_CATEGORY_NODE1(environment),
                               "CheckImmediate", env);
+  env->loop_phase_tracer()->Enter(LoopPhaseTracer::Phase::kCheck);
+  auto end_phase = OnScopeLeave([&]() {
+    env->loop_phase_tracer()->Enter(LoopPhaseTracer::Phase::kClose);
+  });
 
   HandleScope scope(env->isolate());
   Context::Scope context_scope(env->context());
@@ -901,12 +1036,33 @@ void Environment::ToggleImmediateRef(bool ref) {
   }
 }
 
+void Environment::UpdateLoopPhaseTracing() {
+  if (started_cleanup_) return;
 
-Local<Value> Environment::GetNow() {
+  bool enabled;
+  TRACE_EVENT_CATEGORY_GROUP_ENABLED(TRACING_CATEGORY_NODE1(loop), &enabled);
+  if (enabled) {
+    // Prepare handles run right before the poll phase.
+    uv_prepare_start(&loop_phase_prepare_handle_, [](uv_prepare_t* handle) {
+      Environment* env =
+          ContainerOf(&Environment::loop_phase_prepare_handle_, handle);
+      env->loop_phase_tracer()->Enter(LoopPhaseTracer::Phase::kPoll);
+    });
+  } else {
+    uv_prepare_stop(&loop_phase_prepare_handle_);
+  }
+}
+
+
+uint64_t Environment::GetNowUint64() {
   uv_update_time(event_loop());
   uint64_t now = uv_now(event_loop());
   CHECK_GE(now, timer_base());
-  now -= timer_base();
+  return now - timer_base();
+}
+
+Local<Value> Environment::GetNow() {
+  uint64_t now = GetNowUint64();
   if (now <= 0xffffffff)
     return Integer::NewFromUnsigned(isolate(), static_cast<uint32_t>(now));
   else
@@ -1157,6 +1313,8 @@ void Environment::Exit(int exit_code) {
                     StackTrace::CurrentStackTrace(
                         isolate(), stack_trace_limit(), StackTrace::kDetailed));
   }
+  // The main thread does not run the cleanup when it exits.
+  if (compile_cache_handler_) compile_cache_handler_->Persist();
   process_exit_handler_(this, exit_code);
 }
 
@@ -1169,6 +1327,11 @@ void Environment::stop_sub_worker_contexts() {
     w->Exit(1);
     w->JoinThread();
   }
+
+  // The idle isolates are disposed of here rather than when the Environment
+  // is destroyed, as the snapshot they were deserialized from might not
+  // outlive it.
+  if (idle_worker_isolates_) idle_worker_isolates_->Clear();
 }
 
 Environment* Environment::worker_parent_env() const {
@@ -1237,10 +1400,13 @@ EnvSerializeInfo Environment::Serialize(SnapshotCreator* creator) {
   EnvSerializeInfo info;
   Local<Context> ctx = context();
 
-  // Currently all modules are compiled without cache in builtin snapshot
-  // builder.
+  // The builtin snapshot builder compiles all modules without cache, but a
+  // user-land snapshot may have loaded modules with the embedded code cache.
   info.native_modules = std::vector<std::string>(
       native_modules_without_cache.begin(), native_modules_without_cache.end());
+  info.native_modules.insert(info.native_modules.end(),
+                             native_modules_with_cache.begin(),
+                             native_modules_with_cache.end());
 
   info.async_hooks = async_hooks_.Serialize(ctx, creator);
   info.immediate_info = immediate_info_.Serialize(ctx, creator);
@@ -1280,6 +1446,26 @@ EnvSerializeInfo Environment::Serialize(SnapshotCreator* creator) {
   return info;
 }
 
+void Environment::EnqueueDeserializeRequest(DeserializeRequestCallback cb,
+                                            Local<Object> holder,
+                                            int index,
+                                            InternalFieldInfo* info) {
+  DeserializeRequest request{cb, {isolate(), holder}, index, info};
+  deserialize_requests_.push_back(std::move(request));
+}
+
+void Environment::RunDeserializeRequests() {
+  HandleScope scope(isolate());
+  Local<Context> ctx = context();
+  while (!deserialize_requests_.empty()) {
+    DeserializeRequest request(std::move(deserialize_requests_.front()));
+    deserialize_requests_.pop_front();
+    Local<Object> holder = request.holder.Get(isolate());
+    request.cb(ctx, holder, request.index, request.info);
+    request.info->Delete();
+  }
+}
+
 std::ostream& operator<<(std::ostream& output,
                          const std::vector<PropInfo>& vec) {
   output << "{\n";
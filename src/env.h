@@ -38,6 +38,7 @@
 #include "node_options.h"
 #include "node_perf_common.h"
 #include "req_wrap.h"
+#include "timer_wheel.h"
 #include "util.h"
 #include "uv.h"
 #include "v8.h"
@@ -67,6 +68,10 @@ namespace tracing {
 class AgentWriterHandle;
 }
 
+namespace profiler {
+class ContinuousCpuProfiler;
+}  // namespace profiler
+
 #if HAVE_INSPECTOR
 namespace profiler {
 class V8CoverageConnection;
@@ -80,9 +85,12 @@ class ParentInspectorHandle;
 #endif  // HAVE_INSPECTOR
 
 namespace worker {
+class IdleIsolateCache;
 class Worker;
 }
 
+class CompileCacheHandler;
+
 namespace loader {
 class ModuleWrap;
 
@@ -449,6 +457,7 @@ constexpr size_t kFsStatsBufferLength =
   V(binding_data_ctor_template, v8::FunctionTemplate)                          \
   V(blocklist_instance_template, v8::ObjectTemplate)                           \
   V(compiled_fn_entry_template, v8::ObjectTemplate)                            \
+  V(contextify_global_template, v8::ObjectTemplate)                            \
   V(dir_instance_template, v8::ObjectTemplate)                                 \
   V(fd_constructor_template, v8::ObjectTemplate)                               \
   V(fdclose_constructor_template, v8::ObjectTemplate)                          \
@@ -464,7 +473,6 @@ constexpr size_t kFsStatsBufferLength =
   V(message_port_constructor_template, v8::FunctionTemplate)                   \
   V(microtask_queue_ctor_template, v8::FunctionTemplate)                       \
   V(pipe_constructor_template, v8::FunctionTemplate)                           \
-  V(promise_wrap_template, v8::ObjectTemplate)                                 \
   V(sab_lifetimepartner_constructor_template, v8::FunctionTemplate)            \
   V(script_context_constructor_template, v8::FunctionTemplate)                 \
   V(secure_context_constructor_template, v8::FunctionTemplate)                 \
@@ -547,7 +555,7 @@ constexpr size_t kFsStatsBufferLength =
   V(primordials, v8::Object)                                                   \
   V(promise_hook_handler, v8::Function)                                        \
   V(promise_reject_callback, v8::Function)                                     \
-  V(script_data_constructor_function, v8::Function)                            \
+  V(snapshot_deserialize_main, v8::Function)                                   \
   V(source_map_cache_getter, v8::Function)                                     \
   V(tick_callback_function, v8::Function)                                      \
   V(timers_callback_function, v8::Function)                                    \
@@ -583,6 +591,16 @@ class IsolateData : public MemoryRetainer {
   inline worker::Worker* worker_context() const;
   inline void set_worker_context(worker::Worker* context);
 
+  // Whether the isolate has been deserialized from a snapshot built by
+  // SnapshotBuilder, which then also contains the vm context template.
+  inline bool deserialized_from_snapshot() const;
+  // The snapshot that the isolate has been deserialized from, which is also
+  // used for the isolates of Workers. Only set by NodeMainInstance and for
+  // Workers, as the snapshot has to outlive the isolate.
+  inline v8::StartupData* snapshot_blob() const;
+  inline void set_snapshot_blob(v8::StartupData* blob);
+  inline const std::vector<size_t>* snapshot_indexes() const;
+
 #define VP(PropertyName, StringValue) V(v8::Private, PropertyName)
 #define VY(PropertyName, StringValue) V(v8::Symbol, PropertyName)
 #define VS(PropertyName, StringValue) V(v8::String, PropertyName)
@@ -631,6 +649,8 @@ class IsolateData : public MemoryRetainer {
   MultiIsolatePlatform* platform_;
   std::shared_ptr<PerIsolateOptions> options_;
   worker::Worker* worker_context_ = nullptr;
+  const std::vector<size_t>* snapshot_indexes_ = nullptr;
+  v8::StartupData* snapshot_blob_ = nullptr;
 };
 
 struct ContextInfo {
@@ -675,6 +695,7 @@ extern std::shared_ptr<KVStore> system_environment;
 }
 
 struct EnvSerializeInfo;
+struct InternalFieldInfo;
 
 class AsyncHooks : public MemoryRetainer {
  public:
@@ -853,6 +874,40 @@ class TickInfo : public MemoryRetainer {
   AliasedUint8Array fields_;
 };
 
+// Records the phases of the event loop as trace events in the node.loop
+// category. Only some of the boundaries between the libuv phases can be
+// observed from here: the timers phase is delimited by RunTimers(), and the
+// poll phase starts in a prepare handle and ends when CheckImmediate()
+// starts. The rest of an iteration is split into Pending, which follows the
+// timers, and Close, which follows the check phase and also covers the
+// pending callbacks of the next iteration when no timer is due.
+class LoopPhaseTracer {
+ public:
+  enum class Phase : uint8_t {
+    kNone,
+    kTimers,
+    kPending,
+    kPoll,
+    kCheck,
+    kClose,
+  };
+
+  // Ends the current phase and starts `phase`. When the node.loop category
+  // is disabled, this only checks the state of the category.
+  void Enter(Phase phase);
+  // Called for each callback into JavaScript from the event loop. The number
+  // of callbacks is recorded with the end of each phase.
+  inline void CountCallback() { callback_count_++; }
+
+ private:
+  static const char* PhaseName(Phase phase);
+
+  Phase phase_ = Phase::kNone;
+  uint64_t callback_count_ = 0;
+  // The value of callback_count_ when the current phase started.
+  uint64_t phase_start_callback_count_ = 0;
+};
+
 class TrackingTraceStateObserver :
     public v8::TracingController::TraceStateObserver {
  public:
@@ -959,6 +1014,8 @@ class Environment : public MemoryRetainer {
 
   void PrintAllBaseObjects();
   void VerifyNoStrongBaseObjects();
+  template <typename T>
+  void ForEachBaseObject(T&& iterator);
   // Should be called before InitializeInspector()
   void InitializeDiagnostics();
 #if HAVE_INSPECTOR
@@ -987,10 +1044,12 @@ class Environment : public MemoryRetainer {
 
   // Methods created using SetMethod(), SetPrototypeMethod(), etc. inside
   // this scope can access the created T* object using
-  // GetBindingData<T>(args) later.
-  template <typename T>
+  // GetBindingData<T>(args) later. Extra arguments are passed on to the
+  // constructor of T.
+  template <typename T, typename... Args>
   T* AddBindingData(v8::Local<v8::Context> context,
-                    v8::Local<v8::Object> target);
+                    v8::Local<v8::Object> target,
+                    Args&&... args);
   template <typename T, typename U>
   static inline T* GetBindingData(const v8::PropertyCallbackInfo<U>& info);
   template <typename T>
@@ -1018,6 +1077,19 @@ class Environment : public MemoryRetainer {
               ThreadId thread_id);
   void InitializeMainContext(v8::Local<v8::Context> context,
                              const EnvSerializeInfo* env_info);
+
+  // Native objects in a user-land snapshot can only be recreated once the
+  // Environment is fully deserialized, so the internal field deserializer
+  // queues them up to be run by RunDeserializeRequests().
+  typedef void (*DeserializeRequestCallback)(v8::Local<v8::Context> context,
+                                             v8::Local<v8::Object> holder,
+                                             int index,
+                                             InternalFieldInfo* info);
+  void EnqueueDeserializeRequest(DeserializeRequestCallback cb,
+                                 v8::Local<v8::Object> holder,
+                                 int index,
+                                 InternalFieldInfo* info);
+  void RunDeserializeRequests();
   // Create an Environment and initialize the provided main context for it.
   Environment(IsolateData* isolate_data,
               v8::Local<v8::Context> context,
@@ -1071,6 +1143,7 @@ class Environment : public MemoryRetainer {
   static inline Environment* from_immediate_check_handle(uv_check_t* handle);
   inline uv_check_t* immediate_check_handle();
   inline uv_idle_t* immediate_idle_handle();
+  inline LoopPhaseTracer* loop_phase_tracer();
 
   inline void IncreaseWaitingRequestCounter();
   inline void DecreaseWaitingRequestCounter();
@@ -1079,6 +1152,11 @@ class Environment : public MemoryRetainer {
   inline ImmediateInfo* immediate_info();
   inline TickInfo* tick_info();
   inline uint64_t timer_base() const;
+  inline TimerWheel* timer_wheel();
+  // The profiler started with v8.startContinuousCpuProfiler(), if any.
+  inline profiler::ContinuousCpuProfiler* continuous_cpu_profiler();
+  void set_continuous_cpu_profiler(
+      std::unique_ptr<profiler::ContinuousCpuProfiler> profiler);
   inline std::shared_ptr<KVStore> env_vars();
   inline void set_env_vars(std::shared_ptr<KVStore> env_vars);
 
@@ -1128,6 +1206,9 @@ class Environment : public MemoryRetainer {
   inline uint32_t get_next_module_id();
   inline uint32_t get_next_script_id();
   inline uint32_t get_next_function_id();
+  // Used when deserializing a snapshot, so that ids of functions compiled
+  // afterwards do not collide with the ones stored in the snapshot.
+  inline void ReserveFunctionId(uint32_t id);
 
   EnabledDebugList* enabled_debug_list() { return &enabled_debug_list_; }
 
@@ -1268,6 +1349,17 @@ class Environment : public MemoryRetainer {
   inline void set_is_in_inspector_console_call(bool value);
 #endif
 
+  // nullptr unless --compile-cache-dir is used.
+  inline CompileCacheHandler* compile_cache_handler() const {
+    return compile_cache_handler_.get();
+  }
+
+  // The isolates of stopped Workers that can be reused by new ones. nullptr
+  // unless --max-idle-worker-isolates is used.
+  inline worker::IdleIsolateCache* idle_worker_isolates() const {
+    return idle_worker_isolates_.get();
+  }
+
   typedef ListHead<HandleWrap, &HandleWrap::handle_wrap_queue_> HandleWrapQueue;
   typedef ListHead<ReqWrapBase, &ReqWrapBase::req_wrap_queue_> ReqWrapQueue;
 
@@ -1304,6 +1396,9 @@ class Environment : public MemoryRetainer {
   inline void RequestInterrupt(Fn&& cb);
   // This needs to be available for the JS-land setImmediate().
   void ToggleImmediateRef(bool ref);
+  // Starts or stops the handle that marks the start of the poll phase,
+  // depending on whether the node.loop trace category is enabled.
+  void UpdateLoopPhaseTracing();
 
   inline void PushShouldNotAbortOnUncaughtScope();
   inline void PopShouldNotAbortOnUncaughtScope();
@@ -1312,7 +1407,12 @@ class Environment : public MemoryRetainer {
   static inline Environment* ForAsyncHooks(AsyncHooks* hooks);
 
   v8::Local<v8::Value> GetNow();
+  // The current time of the event loop, in milliseconds since timer_base().
+  uint64_t GetNowUint64();
   void ScheduleTimer(int64_t duration);
+  // Schedules a timer of the timer wheel to expire at `expiry`, relative to
+  // timer_base(), and makes sure that the timer handle fires by then.
+  void InsertTimer(uint32_t id, uint64_t expiry);
   void ToggleTimerRef(bool ref);
 
   inline void AddCleanupHook(void (*fn)(void*), void* arg);
@@ -1393,6 +1493,8 @@ class Environment : public MemoryRetainer {
   uv_timer_t timer_handle_;
   uv_check_t immediate_check_handle_;
   uv_idle_t immediate_idle_handle_;
+  uv_prepare_t loop_phase_prepare_handle_;
+  LoopPhaseTracer loop_phase_tracer_;
   uv_async_t task_queues_async_;
   int64_t task_queues_async_refs_ = 0;
 
@@ -1400,6 +1502,11 @@ class Environment : public MemoryRetainer {
   ImmediateInfo immediate_info_;
   TickInfo tick_info_;
   const uint64_t timer_base_;
+  TimerWheel timer_wheel_;
+  // The time at which the timer handle is going to fire, relative to
+  // timer_base(), or TimerWheel::kNever if it is not running.
+  uint64_t timer_wakeup_ = TimerWheel::kNever;
+  std::unique_ptr<profiler::ContinuousCpuProfiler> continuous_cpu_profiler_;
   std::shared_ptr<KVStore> env_vars_;
   bool printed_error_ = false;
   bool trace_sync_io_ = false;
@@ -1441,6 +1548,14 @@ class Environment : public MemoryRetainer {
   uint32_t script_id_counter_ = 0;
   uint32_t function_id_counter_ = 0;
 
+  struct DeserializeRequest {
+    DeserializeRequestCallback cb;
+    v8::Global<v8::Object> holder;
+    int index;
+    InternalFieldInfo* info;  // Owned by the request.
+  };
+  std::list<DeserializeRequest> deserialize_requests_;
+
   AliasedUint32Array should_abort_on_uncaught_toggle_;
   int should_not_abort_scope_counter_ = 0;
 
@@ -1468,6 +1583,9 @@ class Environment : public MemoryRetainer {
   bool is_in_inspector_console_call_ = false;
 #endif
 
+  std::unique_ptr<CompileCacheHandler> compile_cache_handler_;
+  std::unique_ptr<worker::IdleIsolateCache> idle_worker_isolates_;
+
   // handle_wrap_queue_ and req_wrap_queue_ needs to be at a fixed offset from
   // the start of the class because it is used by
   // src/node_postmortem_metadata.cc to calculate offsets and generate debug
@@ -1487,6 +1605,11 @@ class Environment : public MemoryRetainer {
   Mutex extra_linked_bindings_mutex_;
 
   static void RunTimers(uv_timer_t* handle);
+  // Hands a batch of expired timers to JS. Returns false if JS could not be
+  // called, otherwise sets `refed` to whether refed JS timers are left.
+  bool RunExpiredTimers(uint64_t now,
+                        const std::vector<uint32_t>& expired,
+                        bool* refed);
 
   struct ExitCallback {
     void (*cb_)(void* arg);
@@ -1528,8 +1651,6 @@ class Environment : public MemoryRetainer {
   std::function<void(Environment*, int)> process_exit_handler_ {
       DefaultProcessExitHandler };
 
-  template <typename T>
-  void ForEachBaseObject(T&& iterator);
 
 #define V(PropertyName, TypeName) v8::Global<TypeName> PropertyName ## _;
   ENVIRONMENT_STRONG_PERSISTENT_VALUES(V)
@@ -1,9 +1,15 @@
 #include "diagnosticfilename-inl.h"
 #include "env-inl.h"
 #include "memory_tracker-inl.h"
+#include "node_external_reference.h"
 #include "stream_base-inl.h"
 #include "util-inl.h"
 
+#include "zlib.h"
+#include "zstd.h"
+
+#include <fcntl.h>  // O_WRONLY, O_CREAT, O_TRUNC
+
 using v8::Array;
 using v8::Boolean;
 using v8::Context;
@@ -14,6 +20,7 @@ using v8::FunctionTemplate;
 using v8::Global;
 using v8::HandleScope;
 using v8::HeapSnapshot;
+using v8::Int32;
 using v8::Isolate;
 using v8::Local;
 using v8::MaybeLocal;
@@ -203,30 +210,126 @@ void BuildEmbedderGraph(const FunctionCallbackInfo<Value>& args) {
 }
 
 namespace {
+// Serializes a heap snapshot straight to a file descriptor, optionally
+// compressing it on the way. The JSON chunks produced by V8 are compressed
+// into a fixed-size buffer that is written out whenever it fills up, so the
+// memory used for the serialization does not depend on the size of the heap.
 class FileOutputStream : public v8::OutputStream {
  public:
-  explicit FileOutputStream(FILE* stream) : stream_(stream) {}
+  FileOutputStream(uv_file fd, HeapSnapshotCompression compression)
+      : fd_(fd), compression_(compression) {
+    switch (compression_) {
+      case HeapSnapshotCompression::kNone:
+        break;
+      case HeapSnapshotCompression::kGzip:
+        // 15 bits of window, plus 16 to write a gzip header and trailer.
+        failed_ = deflateInit2(&zlib_, Z_BEST_SPEED, Z_DEFLATED, 15 + 16, 8,
+                               Z_DEFAULT_STRATEGY) != Z_OK;
+        break;
+      case HeapSnapshotCompression::kZstd:
+        zstd_ = ZSTD_createCCtx();
+        failed_ = zstd_ == nullptr;
+        break;
+    }
+  }
+
+  ~FileOutputStream() override {
+    if (compression_ == HeapSnapshotCompression::kGzip)
+      deflateEnd(&zlib_);
+    ZSTD_freeCCtx(zstd_);
+  }
+
+  FileOutputStream(const FileOutputStream&) = delete;
+  FileOutputStream& operator=(const FileOutputStream&) = delete;
 
   int GetChunkSize() override {
-    return 65536;  // big chunks == faster
+    return kBufferSize;  // big chunks == faster
   }
 
-  void EndOfStream() override {}
+  void EndOfStream() override {
+    Compress(nullptr, 0, true);
+  }
 
   WriteResult WriteAsciiChunk(char* data, int size) override {
-    const size_t len = static_cast<size_t>(size);
-    size_t off = 0;
+    return Compress(data, static_cast<size_t>(size), false) ? kContinue
+                                                             : kAbort;
+  }
 
-    while (off < len && !feof(stream_) && !ferror(stream_))
-      off += fwrite(data + off, 1, len - off, stream_);
+  bool failed() const { return failed_; }
+
+ private:
+  static constexpr size_t kBufferSize = 64 * 1024;
+
+  bool Compress(char* data, size_t size, bool end) {
+    if (failed_)
+      return false;
+    switch (compression_) {
+      case HeapSnapshotCompression::kNone:
+        return Write(data, size);
+      case HeapSnapshotCompression::kGzip:
+        zlib_.next_in = reinterpret_cast<Bytef*>(data);
+        zlib_.avail_in = size;
+        for (;;) {
+          zlib_.next_out = reinterpret_cast<Bytef*>(buffer_.get());
+          zlib_.avail_out = kBufferSize;
+          int err = deflate(&zlib_, end ? Z_FINISH : Z_NO_FLUSH);
+          if (err == Z_STREAM_ERROR) {
+            failed_ = true;
+            return false;
+          }
+          if (!Write(buffer_.get(), kBufferSize - zlib_.avail_out))
+            return false;
+          // Without more input, deflate() keeps the output buffer partially
+          // empty, or reports the end of the stream once it is finished.
+          if (end ? err == Z_STREAM_END : zlib_.avail_out != 0)
+            return true;
+        }
+      case HeapSnapshotCompression::kZstd: {
+        ZSTD_inBuffer input = { data, size, 0 };
+        for (;;) {
+          ZSTD_outBuffer output = { buffer_.get(), kBufferSize, 0 };
+          size_t remaining = ZSTD_compressStream2(
+              zstd_, &output, &input, end ? ZSTD_e_end : ZSTD_e_continue);
+          if (ZSTD_isError(remaining)) {
+            failed_ = true;
+            return false;
+          }
+          if (!Write(buffer_.get(), output.pos))
+            return false;
+          if (end ? remaining == 0 : input.pos == input.size)
+            return true;
+        }
+      }
+    }
+    UNREACHABLE();
+  }
 
-    return off == len ? kContinue : kAbort;
+  bool Write(const char* data, size_t size) {
+    while (size > 0) {
+      uv_buf_t buf = uv_buf_init(const_cast<char*>(data), size);
+      uv_fs_t req;
+      int written = uv_fs_write(nullptr, &req, fd_, &buf, 1, -1, nullptr);
+      uv_fs_req_cleanup(&req);
+      if (written < 0) {
+        failed_ = true;
+        return false;
+      }
+      data += written;
+      size -= written;
+    }
+    return true;
   }
 
- private:
-  FILE* stream_;
+  uv_file fd_;
+  HeapSnapshotCompression compression_;
+  z_stream zlib_ = {};
+  ZSTD_CCtx* zstd_ = nullptr;
+  bool failed_ = false;
+  std::unique_ptr<char[]> buffer_ { new char[kBufferSize] };
 };
 
+constexpr size_t FileOutputStream::kBufferSize;
+
 class HeapSnapshotStream : public AsyncWrap,
                            public StreamBase,
                            public v8::OutputStream {
@@ -307,24 +410,133 @@ class HeapSnapshotStream : public AsyncWrap,
   HeapSnapshotPointer snapshot_;
 };
 
-inline void TakeSnapshot(Isolate* isolate, v8::OutputStream* out) {
-  HeapSnapshotPointer snapshot {
-      isolate->GetHeapProfiler()->TakeHeapSnapshot() };
-  snapshot->Serialize(out, HeapSnapshot::kJSON);
+const char* HeapSnapshotExtension(HeapSnapshotCompression compression) {
+  switch (compression) {
+    case HeapSnapshotCompression::kNone:
+      return "heapsnapshot";
+    case HeapSnapshotCompression::kGzip:
+      return "heapsnapshot.gz";
+    case HeapSnapshotCompression::kZstd:
+      return "heapsnapshot.zst";
+  }
+  UNREACHABLE();
 }
 
-inline bool WriteSnapshot(Isolate* isolate, const char* filename) {
-  FILE* fp = fopen(filename, "w");
-  if (fp == nullptr)
-    return false;
-  FileOutputStream stream(fp);
-  TakeSnapshot(isolate, &stream);
-  fclose(fp);
-  return true;
+HeapSnapshotCompression ParseHeapSnapshotCompression(Isolate* isolate,
+                                                     Local<Value> value) {
+  if (value->IsUndefined())
+    return HeapSnapshotCompression::kNone;
+  Utf8Value name(isolate, value);
+  if (strcmp(*name, "gzip") == 0)
+    return HeapSnapshotCompression::kGzip;
+  CHECK_EQ(strcmp(*name, "zstd"), 0);
+  return HeapSnapshotCompression::kZstd;
 }
 
+// Watches for a signal on a thread of its own, and writes a heap snapshot of
+// the Environment when it is received. The snapshot is taken in an interrupt,
+// so that it is written even while JavaScript code is busy, and without
+// running any JavaScript.
+class HeapSnapshotSignalWatcher {
+ public:
+  HeapSnapshotSignalWatcher(Environment* env,
+                            HeapSnapshotCompression compression)
+      : env_(env), compression_(compression) {}
+
+  int Start(int signo) {
+    int err = uv_loop_init(&loop_);
+    if (err != 0)
+      return err;
+    CHECK_EQ(0, uv_async_init(&loop_, &stop_async_, OnStop));
+    CHECK_EQ(0, uv_signal_init(&loop_, &signal_));
+    signal_.data = this;
+    err = uv_signal_start(&signal_, OnSignal, signo);
+    if (err == 0)
+      err = uv_thread_create(&thread_, Run, this);
+    if (err != 0) {
+      OnStop(&stop_async_);
+      uv_run(&loop_, UV_RUN_DEFAULT);
+      CheckedUvLoopClose(&loop_);
+      return err;
+    }
+    env_->AddCleanupHook(Stop, this);
+    return 0;
+  }
+
+ private:
+  static void Run(void* arg) {
+    HeapSnapshotSignalWatcher* watcher =
+        static_cast<HeapSnapshotSignalWatcher*>(arg);
+    uv_run(&watcher->loop_, UV_RUN_DEFAULT);
+  }
+
+  static void OnSignal(uv_signal_t* signal, int signo) {
+    HeapSnapshotSignalWatcher* watcher =
+        ContainerOf(&HeapSnapshotSignalWatcher::signal_, signal);
+    HeapSnapshotCompression compression = watcher->compression_;
+    watcher->env_->RequestInterrupt([compression](Environment* env) {
+      DiagnosticFilename name(env, "Heap", HeapSnapshotExtension(compression));
+      WriteSnapshot(env->isolate(), *name, compression);
+    });
+  }
+
+  static void OnStop(uv_async_t* async) {
+    HeapSnapshotSignalWatcher* watcher =
+        ContainerOf(&HeapSnapshotSignalWatcher::stop_async_, async);
+    uv_close(reinterpret_cast<uv_handle_t*>(&watcher->signal_), nullptr);
+    uv_close(reinterpret_cast<uv_handle_t*>(&watcher->stop_async_), nullptr);
+  }
+
+  static void Stop(void* arg) {
+    std::unique_ptr<HeapSnapshotSignalWatcher> watcher(
+        static_cast<HeapSnapshotSignalWatcher*>(arg));
+    CHECK_EQ(0, uv_async_send(&watcher->stop_async_));
+    CHECK_EQ(0, uv_thread_join(&watcher->thread_));
+    CheckedUvLoopClose(&watcher->loop_);
+  }
+
+  Environment* const env_;
+  const HeapSnapshotCompression compression_;
+  uv_loop_t loop_;
+  uv_async_t stop_async_;
+  uv_signal_t signal_;
+  uv_thread_t thread_;
+};
+
 }  // namespace
 
+bool WriteSnapshot(Isolate* isolate,
+                   const char* filename,
+                   HeapSnapshotCompression compression) {
+  uv_fs_t req;
+  // Same permissions as the fopen() that was used before, i.e. 0666 minus
+  // the umask.
+  int fd = uv_fs_open(nullptr,
+                      &req,
+                      filename,
+                      O_WRONLY | O_CREAT | O_TRUNC,
+                      0666,
+                      nullptr);
+  uv_fs_req_cleanup(&req);
+  if (fd < 0)
+    return false;
+
+  bool ok;
+  {
+    FileOutputStream stream(fd, compression);
+    if (!stream.failed()) {
+      HeapSnapshotPointer snapshot {
+          isolate->GetHeapProfiler()->TakeHeapSnapshot() };
+      snapshot->Serialize(&stream, HeapSnapshot::kJSON);
+    }
+    ok = !stream.failed();
+  }
+
+  ok = uv_fs_close(nullptr, &req, fd, nullptr) == 0 && ok;
+  uv_fs_req_cleanup(&req);
+  return ok;
+}
+
 void DeleteHeapSnapshot(const HeapSnapshot* snapshot) {
   const_cast<HeapSnapshot*>(snapshot)->Delete();
 }
@@ -370,10 +582,12 @@ void TriggerHeapSnapshot(const FunctionCallbackInfo<Value>& args) {
   Isolate* isolate = args.GetIsolate();
 
   Local<Value> filename_v = args[0];
+  HeapSnapshotCompression compression =
+      ParseHeapSnapshotCompression(isolate, args[1]);
 
   if (filename_v->IsUndefined()) {
-    DiagnosticFilename name(env, "Heap", "heapsnapshot");
-    if (!WriteSnapshot(isolate, *name))
+    DiagnosticFilename name(env, "Heap", HeapSnapshotExtension(compression));
+    if (!WriteSnapshot(isolate, *name, compression))
       return;
     if (String::NewFromUtf8(isolate, *name).ToLocal(&filename_v)) {
       args.GetReturnValue().Set(filename_v);
@@ -383,11 +597,27 @@ void TriggerHeapSnapshot(const FunctionCallbackInfo<Value>& args) {
 
   BufferValue path(isolate, filename_v);
   CHECK_NOT_NULL(*path);
-  if (!WriteSnapshot(isolate, *path))
+  if (!WriteSnapshot(isolate, *path, compression))
     return;
   return args.GetReturnValue().Set(filename_v);
 }
 
+// Writes a heap snapshot whenever the signal args[0] is received, with the
+// compression args[1]. Returns 0, or a libuv error code if the signal cannot
+// be watched natively on this platform.
+void StartHeapSnapshotSignalWatcher(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsInt32());
+  int signo = args[0].As<Int32>()->Value();
+  auto watcher = std::make_unique<HeapSnapshotSignalWatcher>(
+      env, ParseHeapSnapshotCompression(env->isolate(), args[1]));
+  int err = watcher->Start(signo);
+  // On success, the watcher is owned by its cleanup hook.
+  if (err == 0)
+    watcher.release();
+  args.GetReturnValue().Set(err);
+}
+
 void Initialize(Local<Object> target,
                 Local<Value> unused,
                 Local<Context> context,
@@ -397,9 +627,21 @@ void Initialize(Local<Object> target,
   env->SetMethod(target, "buildEmbedderGraph", BuildEmbedderGraph);
   env->SetMethod(target, "triggerHeapSnapshot", TriggerHeapSnapshot);
   env->SetMethod(target, "createHeapSnapshotStream", CreateHeapSnapshotStream);
+  env->SetMethod(target,
+                 "startHeapSnapshotSignalWatcher",
+                 StartHeapSnapshotSignalWatcher);
+}
+
+void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
+  registry->Register(BuildEmbedderGraph);
+  registry->Register(TriggerHeapSnapshot);
+  registry->Register(CreateHeapSnapshotStream);
+  registry->Register(StartHeapSnapshotSignalWatcher);
 }
 
 }  // namespace heap
 }  // namespace node
 
 NODE_MODULE_CONTEXT_AWARE_INTERNAL(heap_utils, node::heap::Initialize)
+NODE_MODULE_EXTERNAL_REFERENCE(heap_utils,
+                               node::heap::RegisterExternalReferences)
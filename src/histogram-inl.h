@@ -40,6 +40,14 @@ double Histogram::Percentile(double percentile) {
       hdr_value_at_percentile(histogram_.get(), percentile));
 }
 
+int64_t Histogram::Count() {
+  return histogram_->total_count;
+}
+
+int64_t Histogram::Add(const Histogram& other) {
+  return hdr_add(histogram_.get(), other.histogram_.get());
+}
+
 template <typename Iterator>
 void Histogram::Percentiles(Iterator&& fn) {
   hdr_iter iter;
@@ -70,12 +78,32 @@ bool HistogramBase::RecordDelta() {
   return ret;
 }
 
+bool HistogramBase::RecordValue(int64_t value) {
+  if (Record(value))
+    return true;
+  if (exceeds_ < 0xFFFFFFFF)
+    exceeds_++;
+  return false;
+}
+
 void HistogramBase::ResetState() {
   Reset();
   exceeds_ = 0;
   prev_ = 0;
 }
 
+bool ConcurrentHistogram::Record(int64_t value) {
+  Shard* shard = shards_[ShardIndex()].get();
+  Mutex::ScopedLock lock(shard->mutex);
+  if (!shard->histogram)
+    shard->histogram.reset(new Histogram(lowest_, highest_, figures_));
+  shard->version++;
+  if (shard->histogram->Record(value))
+    return true;
+  exceeds_.fetch_add(1, std::memory_order_relaxed);
+  return false;
+}
+
 }  // namespace node
 
 #endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
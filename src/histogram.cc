@@ -6,9 +6,11 @@ namespace node {
 
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
+using v8::Int32;
 using v8::Local;
 using v8::Map;
 using v8::Number;
+using v8::Object;
 using v8::ObjectTemplate;
 using v8::String;
 using v8::Value;
@@ -138,4 +140,234 @@ void HistogramBase::Initialize(Environment* env) {
   env->set_histogram_instance_template(histogramt);
 }
 
+ConcurrentHistogram::ConcurrentHistogram(int64_t lowest,
+                                         int64_t highest,
+                                         int figures)
+    : lowest_(lowest), highest_(highest), figures_(figures) {
+  for (std::unique_ptr<Shard>& shard : shards_)
+    shard.reset(new Shard());
+}
+
+size_t ConcurrentHistogram::ShardIndex() {
+  static std::atomic<size_t> next_index {0};
+  thread_local size_t index =
+      next_index.fetch_add(1, std::memory_order_relaxed) % kShardCount;
+  return index;
+}
+
+int64_t ConcurrentHistogram::Snapshot(Histogram* out, bool reset) {
+  for (std::unique_ptr<Shard>& shard : shards_) {
+    Mutex::ScopedLock lock(shard->mutex);
+    if (!shard->histogram)
+      continue;
+    out->Add(*shard->histogram);
+    if (reset) {
+      shard->histogram->Reset();
+      shard->version++;
+    }
+  }
+  if (reset)
+    return exceeds_.exchange(0, std::memory_order_relaxed);
+  return Exceeds();
+}
+
+void ConcurrentHistogram::Reset() {
+  for (std::unique_ptr<Shard>& shard : shards_) {
+    Mutex::ScopedLock lock(shard->mutex);
+    if (!shard->histogram)
+      continue;
+    shard->histogram->Reset();
+    shard->version++;
+  }
+  exceeds_.store(0, std::memory_order_relaxed);
+}
+
+uint64_t ConcurrentHistogram::Version() {
+  uint64_t version = 0;
+  for (std::unique_ptr<Shard>& shard : shards_) {
+    Mutex::ScopedLock lock(shard->mutex);
+    version += shard->version;
+  }
+  return version;
+}
+
+size_t ConcurrentHistogram::GetMemorySize() {
+  size_t size = sizeof(*this) + kShardCount * sizeof(Shard);
+  for (std::unique_ptr<Shard>& shard : shards_) {
+    Mutex::ScopedLock lock(shard->mutex);
+    if (shard->histogram)
+      size += shard->histogram->GetMemorySize();
+  }
+  return size;
+}
+
+RecordableHistogram::RecordableHistogram(
+    Environment* env,
+    Local<Object> wrap,
+    int64_t lowest,
+    int64_t highest,
+    int figures)
+    : BaseObject(env, wrap),
+      histogram_(std::make_shared<ConcurrentHistogram>(
+          lowest, highest, figures)),
+      view_(lowest, highest, figures) {
+  MakeWeak();
+}
+
+void RecordableHistogram::MemoryInfo(MemoryTracker* tracker) const {
+  tracker->TrackFieldWithSize("histogram", histogram_->GetMemorySize());
+  tracker->TrackFieldWithSize("view", view_.GetMemorySize());
+}
+
+Histogram* RecordableHistogram::View() {
+  uint64_t version = histogram_->Version();
+  if (version != view_version_) {
+    view_.Reset();
+    histogram_->Snapshot(&view_, false);
+    view_version_ = version;
+  }
+  return &view_;
+}
+
+void RecordableHistogram::New(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args.IsConstructCall());
+  CHECK(args[0]->IsNumber());
+  CHECK(args[1]->IsNumber());
+  CHECK(args[2]->IsInt32());
+  int64_t lowest = static_cast<int64_t>(args[0].As<Number>()->Value());
+  int64_t highest = static_cast<int64_t>(args[1].As<Number>()->Value());
+  int figures = args[2].As<Int32>()->Value();
+  CHECK_GE(lowest, 1);
+  CHECK_GE(highest, 2 * lowest);
+  CHECK(figures >= 1 && figures <= 5);
+  new RecordableHistogram(env, args.This(), lowest, highest, figures);
+}
+
+void RecordableHistogram::GetMin(const FunctionCallbackInfo<Value>& args) {
+  RecordableHistogram* histogram;
+  ASSIGN_OR_RETURN_UNWRAP(&histogram, args.Holder());
+  double value = static_cast<double>(histogram->View()->Min());
+  args.GetReturnValue().Set(value);
+}
+
+void RecordableHistogram::GetMax(const FunctionCallbackInfo<Value>& args) {
+  RecordableHistogram* histogram;
+  ASSIGN_OR_RETURN_UNWRAP(&histogram, args.Holder());
+  double value = static_cast<double>(histogram->View()->Max());
+  args.GetReturnValue().Set(value);
+}
+
+void RecordableHistogram::GetMean(const FunctionCallbackInfo<Value>& args) {
+  RecordableHistogram* histogram;
+  ASSIGN_OR_RETURN_UNWRAP(&histogram, args.Holder());
+  args.GetReturnValue().Set(histogram->View()->Mean());
+}
+
+void RecordableHistogram::GetExceeds(
+    const FunctionCallbackInfo<Value>& args) {
+  RecordableHistogram* histogram;
+  ASSIGN_OR_RETURN_UNWRAP(&histogram, args.Holder());
+  double value = static_cast<double>(histogram->histogram_->Exceeds());
+  args.GetReturnValue().Set(value);
+}
+
+void RecordableHistogram::GetStddev(const FunctionCallbackInfo<Value>& args) {
+  RecordableHistogram* histogram;
+  ASSIGN_OR_RETURN_UNWRAP(&histogram, args.Holder());
+  args.GetReturnValue().Set(histogram->View()->Stddev());
+}
+
+void RecordableHistogram::GetPercentile(
+    const FunctionCallbackInfo<Value>& args) {
+  RecordableHistogram* histogram;
+  ASSIGN_OR_RETURN_UNWRAP(&histogram, args.Holder());
+  CHECK(args[0]->IsNumber());
+  double percentile = args[0].As<Number>()->Value();
+  args.GetReturnValue().Set(histogram->View()->Percentile(percentile));
+}
+
+void RecordableHistogram::GetPercentiles(
+    const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  RecordableHistogram* histogram;
+  ASSIGN_OR_RETURN_UNWRAP(&histogram, args.Holder());
+  CHECK(args[0]->IsMap());
+  Local<Map> map = args[0].As<Map>();
+  histogram->View()->Percentiles([map, env](double key, double value) {
+    map->Set(
+        env->context(),
+        Number::New(env->isolate(), key),
+        Number::New(env->isolate(), value)).IsEmpty();
+  });
+}
+
+void RecordableHistogram::DoRecord(const FunctionCallbackInfo<Value>& args) {
+  RecordableHistogram* histogram;
+  ASSIGN_OR_RETURN_UNWRAP(&histogram, args.Holder());
+  CHECK(args[0]->IsNumber());
+  int64_t value = static_cast<int64_t>(args[0].As<Number>()->Value());
+  histogram->histogram_->Record(value);
+}
+
+void RecordableHistogram::DoRecordDelta(
+    const FunctionCallbackInfo<Value>& args) {
+  RecordableHistogram* histogram;
+  ASSIGN_OR_RETURN_UNWRAP(&histogram, args.Holder());
+  uint64_t time = uv_hrtime();
+  if (histogram->prev_ > 0 && time > histogram->prev_)
+    histogram->histogram_->Record(time - histogram->prev_);
+  histogram->prev_ = time;
+}
+
+void RecordableHistogram::DoSnapshot(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  RecordableHistogram* histogram;
+  ASSIGN_OR_RETURN_UNWRAP(&histogram, args.Holder());
+  ConcurrentHistogram* concurrent = histogram->histogram_.get();
+  BaseObjectPtr<HistogramBase> snapshot =
+      HistogramBase::New(env,
+                         concurrent->lowest(),
+                         concurrent->highest(),
+                         concurrent->figures());
+  if (!snapshot)
+    return;
+  snapshot->set_exceeds(
+      concurrent->Snapshot(snapshot.get(), args[0]->IsTrue()));
+  args.GetReturnValue().Set(snapshot->object());
+}
+
+void RecordableHistogram::DoReset(const FunctionCallbackInfo<Value>& args) {
+  RecordableHistogram* histogram;
+  ASSIGN_OR_RETURN_UNWRAP(&histogram, args.Holder());
+  histogram->histogram_->Reset();
+  histogram->prev_ = 0;
+}
+
+void RecordableHistogram::Initialize(Environment* env, Local<Object> target) {
+  HistogramBase::Initialize(env);
+
+  Local<FunctionTemplate> tmpl = env->NewFunctionTemplate(New);
+  Local<String> classname =
+      FIXED_ONE_BYTE_STRING(env->isolate(), "RecordableHistogram");
+  tmpl->SetClassName(classname);
+  tmpl->InstanceTemplate()->SetInternalFieldCount(
+      RecordableHistogram::kInternalFieldCount);
+  tmpl->Inherit(BaseObject::GetConstructorTemplate(env));
+  env->SetProtoMethod(tmpl, "exceeds", GetExceeds);
+  env->SetProtoMethod(tmpl, "min", GetMin);
+  env->SetProtoMethod(tmpl, "max", GetMax);
+  env->SetProtoMethod(tmpl, "mean", GetMean);
+  env->SetProtoMethod(tmpl, "stddev", GetStddev);
+  env->SetProtoMethod(tmpl, "percentile", GetPercentile);
+  env->SetProtoMethod(tmpl, "percentiles", GetPercentiles);
+  env->SetProtoMethod(tmpl, "record", DoRecord);
+  env->SetProtoMethod(tmpl, "recordDelta", DoRecordDelta);
+  env->SetProtoMethod(tmpl, "snapshot", DoSnapshot);
+  env->SetProtoMethod(tmpl, "reset", DoReset);
+  target->Set(env->context(),
+              classname,
+              tmpl->GetFunction(env->context()).ToLocalChecked()).Check();
+}
+
 }  // namespace node
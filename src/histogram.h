@@ -5,11 +5,14 @@
 
 #include "hdr_histogram.h"
 #include "base_object.h"
+#include "node_mutex.h"
 #include "util.h"
 
+#include <atomic>
 #include <functional>
 #include <limits>
 #include <map>
+#include <memory>
 
 namespace node {
 
@@ -30,6 +33,10 @@ class Histogram {
   inline double Mean();
   inline double Stddev();
   inline double Percentile(double percentile);
+  inline int64_t Count();
+  // Adds the values recorded in `other` to this histogram. Returns the
+  // number of values that were dropped because they are out of range.
+  inline int64_t Add(const Histogram& other);
 
   // Iterator is a function type that takes two doubles as argument, one for
   // percentile and one for the value at that percentile.
@@ -53,9 +60,12 @@ class HistogramBase : public BaseObject, public Histogram {
   virtual void TraceExceeds(int64_t delta) {}
 
   inline bool RecordDelta();
+  // Like Record(), but values out of range are counted in Exceeds().
+  inline bool RecordValue(int64_t value);
   inline void ResetState();
 
   int64_t Exceeds() const { return exceeds_; }
+  void set_exceeds(int64_t exceeds) { exceeds_ = exceeds; }
 
   void MemoryInfo(MemoryTracker* tracker) const override;
   SET_MEMORY_INFO_NAME(HistogramBase)
@@ -91,6 +101,111 @@ class HistogramBase : public BaseObject, public Histogram {
   uint64_t prev_ = 0;
 };
 
+// A histogram that can be recorded into from any thread, e.g. from the
+// threadpool or from the platform worker threads. Each thread records into
+// one of several shards, each guarded by its own mutex, so that recording
+// threads do not contend with each other. The mutexes are only contended
+// while the shards are merged into a regular Histogram by Snapshot().
+class ConcurrentHistogram {
+ public:
+  ConcurrentHistogram(int64_t lowest, int64_t highest, int figures);
+  ConcurrentHistogram(const ConcurrentHistogram&) = delete;
+  ConcurrentHistogram& operator=(const ConcurrentHistogram&) = delete;
+
+  inline bool Record(int64_t value);
+  // Adds the values recorded so far to `out`, which should have been created
+  // with the same bounds. With `reset`, the recorded values are removed as
+  // they are merged, so that the next snapshot only contains the values
+  // recorded in the meantime. Returns the number of values that were out of
+  // bounds.
+  int64_t Snapshot(Histogram* out, bool reset);
+  void Reset();
+
+  // Changes whenever values are recorded or reset, so that readers can tell
+  // whether a previous snapshot is still current.
+  uint64_t Version();
+  int64_t Exceeds() const { return exceeds_.load(std::memory_order_relaxed); }
+  size_t GetMemorySize();
+
+  int64_t lowest() const { return lowest_; }
+  int64_t highest() const { return highest_; }
+  int figures() const { return figures_; }
+
+ private:
+  static constexpr size_t kShardCount = 16;
+
+  // Shards are allocated separately, and their histograms are only
+  // allocated by the first thread that records into them. malloc() only
+  // guarantees 16-byte alignment (and aligned operator new needs C++17), so
+  // each shard ends with a full cache line of padding: the hot fields of two
+  // shards are then always at least one line apart and their mutexes do not
+  // false-share, wherever the allocator places them.
+  static constexpr size_t kCacheLineSize = 64;
+  struct Shard {
+    Mutex mutex;
+    std::unique_ptr<Histogram> histogram;
+    uint64_t version = 0;
+    char padding[kCacheLineSize];
+  };
+
+  // The shard used by the current thread.
+  static size_t ShardIndex();
+
+  const int64_t lowest_;
+  const int64_t highest_;
+  const int figures_;
+  std::unique_ptr<Shard> shards_[kShardCount];
+  std::atomic<int64_t> exceeds_ {0};
+};
+
+// The JS handle of a ConcurrentHistogram created by
+// perf_hooks.createHistogram(). The values are read from a merged copy of
+// the shards, which is only rebuilt when something has been recorded since.
+class RecordableHistogram : public BaseObject {
+ public:
+  RecordableHistogram(Environment* env,
+                      v8::Local<v8::Object> wrap,
+                      int64_t lowest,
+                      int64_t highest,
+                      int figures);
+
+  // Native code can hold on to the histogram and record into it from other
+  // threads, independently of the lifetime of the JS object.
+  std::shared_ptr<ConcurrentHistogram> histogram() const {
+    return histogram_;
+  }
+
+  void MemoryInfo(MemoryTracker* tracker) const override;
+  SET_MEMORY_INFO_NAME(RecordableHistogram)
+  SET_SELF_SIZE(RecordableHistogram)
+
+  static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void GetMin(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void GetMax(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void GetMean(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void GetExceeds(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void GetStddev(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void GetPercentile(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void GetPercentiles(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void DoRecord(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void DoRecordDelta(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void DoSnapshot(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void DoReset(const v8::FunctionCallbackInfo<v8::Value>& args);
+  // Adds the `RecordableHistogram` constructor to `target`.
+  static void Initialize(Environment* env, v8::Local<v8::Object> target);
+
+ private:
+  // Returns the merged copy of the shards.
+  Histogram* View();
+
+  std::shared_ptr<ConcurrentHistogram> histogram_;
+  Histogram view_;
+  uint64_t view_version_ = 0;
+  uint64_t prev_ = 0;
+};
+
 }  // namespace node
 
 #endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
@@ -1,5 +1,8 @@
 #include "json_utils.h"
 
+#include <cctype>
+#include <cstring>
+
 namespace node {
 
 std::string EscapeJsonChars(const std::string& str) {
@@ -40,6 +43,195 @@ std::string EscapeJsonChars(const std::string& str) {
   return ret;
 }
 
+namespace {
+
+class JsonScanner {
+ public:
+  JsonScanner(const char* json, size_t length)
+      : p_(json), end_(json + length) {}
+
+  bool ScanDocument(const char* const* keys,
+                    size_t key_count,
+                    std::string* values) {
+    SkipWhitespace();
+    if (p_ < end_ && *p_ == '{') {
+      if (!ScanTopLevelObject(keys, key_count, values)) return false;
+    } else if (!SkipValue(0)) {
+      return false;
+    }
+    SkipWhitespace();
+    return p_ == end_;
+  }
+
+ private:
+  // V8 throws a RangeError for JSON that is nested more deeply than its
+  // stack allows, leave these to it.
+  static constexpr int kMaxDepth = 1000;
+
+  bool ScanTopLevelObject(const char* const* keys,
+                          size_t key_count,
+                          std::string* values) {
+    p_++;  // '{'
+    SkipWhitespace();
+    if (Consume('}')) return true;
+    do {
+      SkipWhitespace();
+      const char* key = p_ + 1;
+      bool has_escapes;
+      if (!SkipString(&has_escapes) || has_escapes) return false;
+      size_t key_length = p_ - key - 1;
+      SkipWhitespace();
+      if (!Consume(':')) return false;
+      SkipWhitespace();
+      const char* value = p_;
+      if (!SkipValue(1)) return false;
+      for (size_t i = 0; i < key_count; i++) {
+        if (strlen(keys[i]) == key_length &&
+            memcmp(keys[i], key, key_length) == 0) {
+          values[i].assign(value, p_ - value);
+        }
+      }
+      SkipWhitespace();
+    } while (Consume(','));
+    return Consume('}');
+  }
+
+  bool SkipValue(int depth) {
+    if (p_ == end_) return false;
+    switch (*p_) {
+      case '{':
+        return SkipObject(depth + 1);
+      case '[':
+        return SkipArray(depth + 1);
+      case '"': {
+        bool has_escapes;
+        return SkipString(&has_escapes);
+      }
+      case 't':
+        return SkipLiteral("true", 4);
+      case 'f':
+        return SkipLiteral("false", 5);
+      case 'n':
+        return SkipLiteral("null", 4);
+      default:
+        return SkipNumber();
+    }
+  }
+
+  bool SkipObject(int depth) {
+    if (depth > kMaxDepth) return false;
+    p_++;  // '{'
+    SkipWhitespace();
+    if (Consume('}')) return true;
+    do {
+      SkipWhitespace();
+      bool has_escapes;
+      if (!SkipString(&has_escapes)) return false;
+      SkipWhitespace();
+      if (!Consume(':')) return false;
+      SkipWhitespace();
+      if (!SkipValue(depth)) return false;
+      SkipWhitespace();
+    } while (Consume(','));
+    return Consume('}');
+  }
+
+  bool SkipArray(int depth) {
+    if (depth > kMaxDepth) return false;
+    p_++;  // '['
+    SkipWhitespace();
+    if (Consume(']')) return true;
+    do {
+      SkipWhitespace();
+      if (!SkipValue(depth)) return false;
+      SkipWhitespace();
+    } while (Consume(','));
+    return Consume(']');
+  }
+
+  bool SkipString(bool* has_escapes) {
+    *has_escapes = false;
+    if (!Consume('"')) return false;
+    while (p_ < end_) {
+      unsigned char c = *p_++;
+      if (c == '"') return true;
+      if (c < 0x20) return false;
+      if (c != '\\') continue;
+      *has_escapes = true;
+      if (p_ == end_) return false;
+      c = *p_++;
+      if (c == 'u') {
+        for (int i = 0; i < 4; i++) {
+          if (p_ == end_ || !isxdigit(static_cast<unsigned char>(*p_)))
+            return false;
+          p_++;
+        }
+      } else if (strchr("\"\\/bfnrt", c) == nullptr || c == '\0') {
+        return false;
+      }
+    }
+    return false;
+  }
+
+  bool SkipNumber() {
+    Consume('-');
+    if (Consume('0')) {
+      // No leading zeros.
+    } else if (!SkipDigits()) {
+      return false;
+    }
+    if (Consume('.') && !SkipDigits()) return false;
+    if (Consume('e') || Consume('E')) {
+      if (!Consume('+')) Consume('-');
+      if (!SkipDigits()) return false;
+    }
+    return true;
+  }
+
+  bool SkipDigits() {
+    const char* start = p_;
+    while (p_ < end_ && *p_ >= '0' && *p_ <= '9') p_++;
+    return p_ > start;
+  }
+
+  bool SkipLiteral(const char* literal, size_t length) {
+    if (static_cast<size_t>(end_ - p_) < length ||
+        memcmp(p_, literal, length) != 0) {
+      return false;
+    }
+    p_ += length;
+    return true;
+  }
+
+  void SkipWhitespace() {
+    while (p_ < end_ &&
+           (*p_ == ' ' || *p_ == '\t' || *p_ == '\n' || *p_ == '\r')) {
+      p_++;
+    }
+  }
+
+  bool Consume(char c) {
+    if (p_ == end_ || *p_ != c) return false;
+    p_++;
+    return true;
+  }
+
+  const char* p_;
+  const char* end_;
+};
+
+}  // anonymous namespace
+
+bool ScanJsonObject(const char* json,
+                    size_t length,
+                    const char* const* keys,
+                    size_t key_count,
+                    std::string* values) {
+  for (size_t i = 0; i < key_count; i++) values[i].clear();
+  JsonScanner scanner(json, length);
+  return scanner.ScanDocument(keys, key_count, values);
+}
+
 std::string Reindent(const std::string& str, int indent_depth) {
   if (indent_depth <= 0) return str;
   const std::string indent(indent_depth, ' ');
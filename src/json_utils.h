@@ -13,6 +13,21 @@ namespace node {
 std::string EscapeJsonChars(const std::string& str);
 std::string Reindent(const std::string& str, int indentation);
 
+// Checks that `json` is a valid JSON text and, if it is an object, copies the
+// values of those of its top-level properties that are named in `keys` into
+// `values`, as JSON text. values[i] is left empty if there is no property
+// named keys[i]; if there are several, the last one wins, as with
+// JSON.parse(). Other values are only validated, not copied.
+//
+// Returns false if `json` is not valid JSON, is nested too deeply, or if the
+// name of a top-level property contains escape sequences, in which case the
+// text should be handed to a full parser instead.
+bool ScanJsonObject(const char* json,
+                    size_t length,
+                    const char* const* keys,
+                    size_t key_count,
+                    std::string* values);
+
 // JSON compiler definitions.
 class JSONWriter {
  public:
@@ -1,9 +1,11 @@
 #include "module_wrap.h"
 
+#include "compile_cache.h"
 #include "env.h"
 #include "memory_tracker-inl.h"
 #include "node_contextify.h"
 #include "node_errors.h"
+#include "node_external_reference.h"
 #include "node_internals.h"
 #include "node_process.h"
 #include "node_url.h"
@@ -136,7 +138,8 @@ void ModuleWrap::New(const FunctionCallbackInfo<Value>& args) {
     // new ModuleWrap(url, context, exportNames, syntheticExecutionFunction)
     CHECK(args[3]->IsFunction());
   } else {
-    // new ModuleWrap(url, context, source, lineOffset, columOffset, cachedData)
+    // new ModuleWrap(url, context, source, lineOffset, columOffset, cachedData,
+    //                useCompileCache)
     CHECK(args[2]->IsString());
     CHECK(args[3]->IsNumber());
     line_offset = args[3].As<Integer>();
@@ -172,7 +175,9 @@ void ModuleWrap::New(const FunctionCallbackInfo<Value>& args) {
       module = Module::CreateSyntheticModule(isolate, url, export_names,
         SyntheticModuleEvaluationStepsCallback);
     } else {
+      Local<String> source_text = args[2].As<String>();
       ScriptCompiler::CachedData* cached_data = nullptr;
+      CompileCacheEntry* cache_entry = nullptr;
       if (!args[5]->IsUndefined()) {
         CHECK(args[5]->IsArrayBufferView());
         Local<ArrayBufferView> cached_data_buf = args[5].As<ArrayBufferView>();
@@ -181,9 +186,12 @@ void ModuleWrap::New(const FunctionCallbackInfo<Value>& args) {
         cached_data =
             new ScriptCompiler::CachedData(data + cached_data_buf->ByteOffset(),
                                            cached_data_buf->ByteLength());
+      } else if (args[6]->IsTrue() && env->compile_cache_handler() != nullptr) {
+        cache_entry = env->compile_cache_handler()->GetOrInsert(
+            source_text, url, CachedCodeType::kESM);
+        cached_data = cache_entry->CopyCache();
       }
 
-      Local<String> source_text = args[2].As<String>();
       ScriptOrigin origin(url,
                           line_offset,                      // line offset
                           column_offset,                    // column offset
@@ -212,8 +220,14 @@ void ModuleWrap::New(const FunctionCallbackInfo<Value>& args) {
         }
         return;
       }
-      if (options == ScriptCompiler::kConsumeCodeCache &&
-          source.GetCachedData()->rejected) {
+      if (cache_entry != nullptr) {
+        env->compile_cache_handler()->MaybeSave(
+            cache_entry,
+            module,
+            options == ScriptCompiler::kConsumeCodeCache &&
+                source.GetCachedData()->rejected);
+      } else if (options == ScriptCompiler::kConsumeCodeCache &&
+                 source.GetCachedData()->rejected) {
         THROW_ERR_VM_MODULE_CACHED_DATA_REJECTED(
             env, "cachedData buffer was rejected");
         try_catch.ReThrow();
@@ -763,8 +777,28 @@ void ModuleWrap::Initialize(Local<Object> target,
 #undef V
 }
 
+void ModuleWrap::RegisterExternalReferences(
+    ExternalReferenceRegistry* registry) {
+  registry->Register(New);
+
+  registry->Register(Link);
+  registry->Register(Instantiate);
+  registry->Register(Evaluate);
+  registry->Register(SetSyntheticExport);
+  registry->Register(CreateCachedData);
+  registry->Register(GetNamespace);
+  registry->Register(GetStatus);
+  registry->Register(GetError);
+  registry->Register(GetStaticDependencySpecifiers);
+
+  registry->Register(SetImportModuleDynamicallyCallback);
+  registry->Register(SetInitializeImportMetaObjectCallback);
+}
+
 }  // namespace loader
 }  // namespace node
 
 NODE_MODULE_CONTEXT_AWARE_INTERNAL(module_wrap,
                                    node::loader::ModuleWrap::Initialize)
+NODE_MODULE_EXTERNAL_REFERENCE(
+    module_wrap, node::loader::ModuleWrap::RegisterExternalReferences)
@@ -37,6 +37,7 @@
 #include "node_process.h"
 #include "node_report.h"
 #include "node_revert.h"
+#include "node_snapshotable.h"
 #include "node_v8_platform-inl.h"
 #include "node_version.h"
 
@@ -472,6 +473,23 @@ MaybeLocal<Value> StartExecution(Environment* env, StartExecutionCallback cb) {
     return StartExecution(env, "internal/main/worker_thread");
   }
 
+  if (per_process::cli_options->build_snapshot) {
+    return StartExecution(env, "internal/main/mksnapshot");
+  }
+
+  // The application was started from a user-land snapshot that set up a main
+  // function with v8.startupSnapshot.setDeserializeMainFunction().
+  Local<Function> deserialize_main = env->snapshot_deserialize_main();
+  if (!deserialize_main.IsEmpty()) {
+    env->set_snapshot_deserialize_main(Local<Function>());
+    Local<Value> mark_bootstrap_complete =
+        env->NewFunctionTemplate(MarkBootstrapComplete)
+            ->GetFunction(env->context())
+            .ToLocalChecked();
+    return deserialize_main->Call(
+        env->context(), env->process_object(), 1, &mark_bootstrap_complete);
+  }
+
   std::string first_argv;
   if (env->argv().size() > 1) {
     first_argv = env->argv()[1];
@@ -1094,13 +1112,56 @@ int Start(int argc, char** argv) {
     return result.exit_code;
   }
 
+  if (per_process::cli_options->build_snapshot) {
+    if (result.args.size() < 2) {
+      fprintf(stderr,
+              "%s: --build-snapshot must be used with an entry point script.\n"
+              "Usage: node --build-snapshot /path/to/entry.js\n",
+              result.args[0].c_str());
+      result.exit_code = 9;
+    } else {
+      std::string snapshot_blob_path =
+          per_process::cli_options->snapshot_blob.empty()
+              ? "snapshot.blob"
+              : per_process::cli_options->snapshot_blob;
+      result.exit_code = SnapshotBuilder::GenerateAsBlob(
+          snapshot_blob_path, result.args, result.exec_args);
+    }
+    TearDownOncePerProcess();
+    return result.exit_code;
+  }
+
   {
     Isolate::CreateParams params;
     const std::vector<size_t>* indexes = nullptr;
     const EnvSerializeInfo* env_info = nullptr;
+    SnapshotData snapshot_data;
     bool force_no_snapshot =
         per_process::cli_options->per_isolate->no_node_snapshot;
-    if (!force_no_snapshot) {
+    const std::string& snapshot_blob_path =
+        per_process::cli_options->snapshot_blob;
+    if (!snapshot_blob_path.empty()) {
+      FILE* fp = fopen(snapshot_blob_path.c_str(), "rb");
+      if (fp == nullptr) {
+        fprintf(stderr,
+                "Cannot open %s: %s\n",
+                snapshot_blob_path.c_str(),
+                strerror(errno));
+        TearDownOncePerProcess();
+        return 1;
+      }
+      bool ok = SnapshotData::FromBlob(&snapshot_data, fp);
+      fclose(fp);
+      if (!ok) {
+        fprintf(stderr, "Cannot load snapshot blob %s\n",
+                snapshot_blob_path.c_str());
+        TearDownOncePerProcess();
+        return 1;
+      }
+      params.snapshot_blob = &snapshot_data.blob;
+      indexes = &snapshot_data.isolate_data_indices;
+      env_info = &snapshot_data.env_info;
+    } else if (!force_no_snapshot) {
       v8::StartupData* blob = NodeMainInstance::GetEmbeddedSnapshotBlob();
       if (blob != nullptr) {
         params.snapshot_blob = blob;
@@ -51,6 +51,7 @@
   V(cares_wrap)                                                                \
   V(config)                                                                    \
   V(contextify)                                                                \
+  V(continuous_profiler)                                                       \
   V(credentials)                                                               \
   V(errors)                                                                    \
   V(fs)                                                                        \
@@ -63,6 +64,7 @@
   V(js_stream)                                                                 \
   V(js_udp_wrap)                                                               \
   V(messaging)                                                                 \
+  V(mksnapshot)                                                                \
   V(module_wrap)                                                               \
   V(native_module)                                                             \
   V(options)                                                                   \
@@ -21,8 +21,11 @@
 
 #include "node_contextify.h"
 
+#include "compile_cache.h"
 #include "memory_tracker-inl.h"
+#include "node_external_reference.h"
 #include "node_internals.h"
+#include "node_main_instance.h"
 #include "node_watchdog.h"
 #include "base_object-inl.h"
 #include "node_context_data.h"
@@ -137,40 +140,16 @@ void ContextifyContext::CleanupHook(void* arg) {
 }
 
 
-// This is an object that just keeps an internal pointer to this
-// ContextifyContext.  It's passed to the NamedPropertyHandler.  If we
-// pass the main JavaScript context object we're embedded in, then the
-// NamedPropertyHandler will store a reference to it forever and keep it
-// from getting gc'd.
-MaybeLocal<Object> ContextifyContext::CreateDataWrapper(Environment* env) {
-  Local<Object> wrapper;
-  if (!env->script_data_constructor_function()
-           ->NewInstance(env->context())
-           .ToLocal(&wrapper)) {
-    return MaybeLocal<Object>();
-  }
-
-  wrapper->SetAlignedPointerInInternalField(ContextifyContext::kSlot, this);
-  return wrapper;
-}
-
-MaybeLocal<Context> ContextifyContext::CreateV8Context(
-    Environment* env,
-    Local<Object> sandbox_obj,
-    const ContextOptions& options) {
-  EscapableHandleScope scope(env->isolate());
-  Local<FunctionTemplate> function_template =
-      FunctionTemplate::New(env->isolate());
-
-  function_template->SetClassName(sandbox_obj->GetConstructorName());
-
+// The interceptors find the ContextifyContext through the context that the
+// global object belongs to rather than through their data, so that the same
+// template can be used for all the contexts, and be put into the snapshot.
+// static
+Local<ObjectTemplate> ContextifyContext::CreateGlobalTemplate(
+    Isolate* isolate) {
+  Local<FunctionTemplate> function_template = FunctionTemplate::New(isolate);
   Local<ObjectTemplate> object_template =
       function_template->InstanceTemplate();
 
-  Local<Object> data_wrapper;
-  if (!CreateDataWrapper(env).ToLocal(&data_wrapper))
-    return MaybeLocal<Context>();
-
   NamedPropertyHandlerConfiguration config(
       PropertyGetterCallback,
       PropertySetterCallback,
@@ -178,7 +157,7 @@ MaybeLocal<Context> ContextifyContext::CreateV8Context(
       PropertyDeleterCallback,
       PropertyEnumeratorCallback,
       PropertyDefinerCallback,
-      data_wrapper,
+      {},
       PropertyHandlerFlags::kHasNoSideEffect);
 
   IndexedPropertyHandlerConfiguration indexed_config(
@@ -188,19 +167,76 @@ MaybeLocal<Context> ContextifyContext::CreateV8Context(
       IndexedPropertyDeleterCallback,
       PropertyEnumeratorCallback,
       IndexedPropertyDefinerCallback,
-      data_wrapper,
+      {},
       PropertyHandlerFlags::kHasNoSideEffect);
 
   object_template->SetHandler(config);
   object_template->SetHandler(indexed_config);
-  Local<Context> ctx = Context::New(
-      env->isolate(),
-      nullptr,  // extensions
-      object_template,
-      {},       // global object
-      {},       // deserialization callback
-      microtask_queue() ? microtask_queue().get() : nullptr);
+  return object_template;
+}
+
+// static
+Local<ObjectTemplate> ContextifyContext::GetGlobalTemplate(Environment* env) {
+  Local<ObjectTemplate> object_template = env->contextify_global_template();
+  if (object_template.IsEmpty()) {
+    object_template = CreateGlobalTemplate(env->isolate());
+    env->set_contextify_global_template(object_template);
+  }
+  return object_template;
+}
+
+// Creates the V8 context without any of the Node.js specific data. Used to
+// build the contexts that are stored in the snapshot.
+// static
+MaybeLocal<Context> ContextifyContext::CreateTemplateContext(
+    Environment* env) {
+  EscapableHandleScope scope(env->isolate());
+  Local<Context> ctx = Context::New(env->isolate(),
+                                    nullptr,  // extensions
+                                    GetGlobalTemplate(env));
   if (ctx.IsEmpty()) return MaybeLocal<Context>();
+  return scope.Escape(ctx);
+}
+
+MaybeLocal<Context> ContextifyContext::CreateV8Context(
+    Environment* env,
+    Local<Object> sandbox_obj,
+    const ContextOptions& options) {
+  EscapableHandleScope scope(env->isolate());
+  MicrotaskQueue* queue =
+      microtask_queue() ? microtask_queue().get() : nullptr;
+
+  // Deserializing the context from the snapshot is much cheaper than
+  // setting up the builtins of a new one.
+  Local<Context> ctx;
+  if (env->isolate_data()->deserialized_from_snapshot()) {
+    size_t index = NodeMainInstance::kNodeVMContextIndex;
+    if (options.context_template >= 0) {
+      index = NodeMainInstance::kNodeVMContextTemplateIndex +
+              options.context_template;
+    }
+    if (!Context::FromSnapshot(env->isolate(),
+                               index,
+                               {},       // deserialization callback
+                               nullptr,  // extensions
+                               {},       // global object
+                               queue).ToLocal(&ctx)) {
+      return MaybeLocal<Context>();
+    }
+  } else {
+    // Context templates only exist in user-land snapshots.
+    CHECK_LT(options.context_template, 0);
+    ctx = Context::New(env->isolate(),
+                       nullptr,  // extensions
+                       GetGlobalTemplate(env),
+                       {},       // global object
+                       {},       // deserialization callback
+                       queue);
+    if (ctx.IsEmpty()) return MaybeLocal<Context>();
+  }
+
+  ctx->SetAlignedPointerInEmbedderData(
+      ContextEmbedderIndex::kContextifyContext, this);
   // Only partially initialize the context - the primordials are left out
   // and only initialized when necessary.
   InitializeContextRuntime(ctx);
@@ -210,7 +246,6 @@ MaybeLocal<Context> ContextifyContext::CreateV8Context(
   }
 
   ctx->SetSecurityToken(env->context()->GetSecurityToken());
-
   // We need to tie the lifetime of the sandbox object with the lifetime of
   // newly created context. We do this by making them hold references to each
   // other. The context can directly hold a reference to the sandbox as an
@@ -241,24 +276,39 @@ MaybeLocal<Context> ContextifyContext::CreateV8Context(
 
 
 void ContextifyContext::Init(Environment* env, Local<Object> target) {
-  Local<FunctionTemplate> function_template =
-      FunctionTemplate::New(env->isolate());
-  function_template->InstanceTemplate()->SetInternalFieldCount(
-      ContextifyContext::kInternalFieldCount);
-  env->set_script_data_constructor_function(
-      function_template->GetFunction(env->context()).ToLocalChecked());
-
   env->SetMethod(target, "makeContext", MakeContext);
   env->SetMethod(target, "isContext", IsContext);
   env->SetMethod(target, "compileFunction", CompileFunction);
 }
 
+void ContextifyContext::RegisterExternalReferences(
+    ExternalReferenceRegistry* registry) {
+  registry->Register(MakeContext);
+  registry->Register(IsContext);
+  registry->Register(CompileFunction);
+
+  // The interceptors of the global object template, which is stored in the
+  // snapshot.
+  registry->Register(PropertyGetterCallback);
+  registry->Register(PropertySetterCallback);
+  registry->Register(PropertyDescriptorCallback);
+  registry->Register(PropertyDeleterCallback);
+  registry->Register(PropertyEnumeratorCallback);
+  registry->Register(PropertyDefinerCallback);
+  registry->Register(IndexedPropertyGetterCallback);
+  registry->Register(IndexedPropertySetterCallback);
+  registry->Register(IndexedPropertyDescriptorCallback);
+  registry->Register(IndexedPropertyDeleterCallback);
+  registry->Register(IndexedPropertyDefinerCallback);
+}
+
 
-// makeContext(sandbox, name, origin, strings, wasm);
+// makeContext(sandbox, name, origin, strings, wasm, microtaskQueue,
+//             contextTemplate);
 void ContextifyContext::MakeContext(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
-  CHECK_EQ(args.Length(), 6);
+  CHECK_EQ(args.Length(), 7);
   CHECK(args[0]->IsObject());
   Local<Object> sandbox = args[0].As<Object>();
 
@@ -291,6 +341,12 @@ void ContextifyContext::MakeContext(const FunctionCallbackInfo<Value>& args) {
         Unwrap<MicrotaskQueueWrap>(args[5].As<Object>()));
   }
 
+  CHECK(args[6]->IsInt32() || args[6]->IsUndefined());
+  if (args[6]->IsInt32()) {
+    options.context_template = args[6].As<Int32>()->Value();
+    CHECK_GE(options.context_template, 0);
+  }
+
   TryCatchScope try_catch(env);
   auto context_ptr = std::make_unique<ContextifyContext>(env, sandbox, options);
 
@@ -348,10 +404,16 @@ ContextifyContext* ContextifyContext::ContextFromContextifiedSandbox(
 // static
 template <typename T>
 ContextifyContext* ContextifyContext::Get(const PropertyCallbackInfo<T>& args) {
-  Local<Value> data = args.Data();
+  // The holder is the global object of the vm context.
+  Local<Context> context = args.Holder()->CreationContext();
+  // Not set yet while V8 sets up the builtins of the context.
+  if (context->GetNumberOfEmbedderDataFields() <=
+      ContextEmbedderIndex::kContextifyContext) {
+    return nullptr;
+  }
   return static_cast<ContextifyContext*>(
-      data.As<Object>()->GetAlignedPointerFromInternalField(
-          ContextifyContext::kSlot));
+      context->GetAlignedPointerFromEmbedderData(
+          ContextEmbedderIndex::kContextifyContext));
 }
 
 // static
@@ -360,8 +422,7 @@ void ContextifyContext::PropertyGetterCallback(
     const PropertyCallbackInfo<Value>& args) {
   ContextifyContext* ctx = ContextifyContext::Get(args);
 
-  // Still initializing
-  if (ctx->context_.IsEmpty())
+  if (IsStillInitializing(ctx))
     return;
 
   Local<Context> context = ctx->context();
@@ -389,8 +450,7 @@ void ContextifyContext::PropertySetterCallback(
     const PropertyCallbackInfo<Value>& args) {
   ContextifyContext* ctx = ContextifyContext::Get(args);
 
-  // Still initializing
-  if (ctx->context_.IsEmpty())
+  if (IsStillInitializing(ctx))
     return;
 
   auto attributes = PropertyAttribute::None;
@@ -449,8 +509,7 @@ void ContextifyContext::PropertyDescriptorCallback(
     const PropertyCallbackInfo<Value>& args) {
   ContextifyContext* ctx = ContextifyContext::Get(args);
 
-  // Still initializing
-  if (ctx->context_.IsEmpty())
+  if (IsStillInitializing(ctx))
     return;
 
   Local<Context> context = ctx->context();
@@ -472,8 +531,7 @@ void ContextifyContext::PropertyDefinerCallback(
     const PropertyCallbackInfo<Value>& args) {
   ContextifyContext* ctx = ContextifyContext::Get(args);
 
-  // Still initializing
-  if (ctx->context_.IsEmpty())
+  if (IsStillInitializing(ctx))
     return;
 
   Local<Context> context = ctx->context();
@@ -533,8 +591,7 @@ void ContextifyContext::PropertyDeleterCallback(
     const PropertyCallbackInfo<Boolean>& args) {
   ContextifyContext* ctx = ContextifyContext::Get(args);
 
-  // Still initializing
-  if (ctx->context_.IsEmpty())
+  if (IsStillInitializing(ctx))
     return;
 
   Maybe<bool> success = ctx->sandbox()->Delete(ctx->context(), property);
@@ -552,8 +609,7 @@ void ContextifyContext::PropertyEnumeratorCallback(
     const PropertyCallbackInfo<Array>& args) {
   ContextifyContext* ctx = ContextifyContext::Get(args);
 
-  // Still initializing
-  if (ctx->context_.IsEmpty())
+  if (IsStillInitializing(ctx))
     return;
 
   Local<Array> properties;
@@ -570,8 +626,7 @@ void ContextifyContext::IndexedPropertyGetterCallback(
     const PropertyCallbackInfo<Value>& args) {
   ContextifyContext* ctx = ContextifyContext::Get(args);
 
-  // Still initializing
-  if (ctx->context_.IsEmpty())
+  if (IsStillInitializing(ctx))
     return;
 
   ContextifyContext::PropertyGetterCallback(
@@ -585,8 +640,7 @@ void ContextifyContext::IndexedPropertySetterCallback(
     const PropertyCallbackInfo<Value>& args) {
   ContextifyContext* ctx = ContextifyContext::Get(args);
 
-  // Still initializing
-  if (ctx->context_.IsEmpty())
+  if (IsStillInitializing(ctx))
     return;
 
   ContextifyContext::PropertySetterCallback(
@@ -599,8 +653,7 @@ void ContextifyContext::IndexedPropertyDescriptorCallback(
     const PropertyCallbackInfo<Value>& args) {
   ContextifyContext* ctx = ContextifyContext::Get(args);
 
-  // Still initializing
-  if (ctx->context_.IsEmpty())
+  if (IsStillInitializing(ctx))
     return;
 
   ContextifyContext::PropertyDescriptorCallback(
@@ -614,8 +667,7 @@ void ContextifyContext::IndexedPropertyDefinerCallback(
     const PropertyCallbackInfo<Value>& args) {
   ContextifyContext* ctx = ContextifyContext::Get(args);
 
-  // Still initializing
-  if (ctx->context_.IsEmpty())
+  if (IsStillInitializing(ctx))
     return;
 
   ContextifyContext::PropertyDefinerCallback(
@@ -628,8 +680,7 @@ void ContextifyContext::IndexedPropertyDeleterCallback(
     const PropertyCallbackInfo<Boolean>& args) {
   ContextifyContext* ctx = ContextifyContext::Get(args);
 
-  // Still initializing
-  if (ctx->context_.IsEmpty())
+  if (IsStillInitializing(ctx))
     return;
 
   Maybe<bool> success = ctx->sandbox()->Delete(ctx->context(), index);
@@ -1078,6 +1129,14 @@ void ContextifyContext::CompileFunction(
     params_buf = args[8].As<Array>();
   }
 
+  // Argument 10: use the compile cache of the environment (optional)
+  CompileCacheEntry* cache_entry = nullptr;
+  if (args[9]->IsTrue() && cached_data_buf.IsEmpty() &&
+      env->compile_cache_handler() != nullptr) {
+    cache_entry = env->compile_cache_handler()->GetOrInsert(
+        code, filename, CachedCodeType::kCommonJS);
+  }
+
   // Read cache from cached data buffer
   ScriptCompiler::CachedData* cached_data = nullptr;
   if (!cached_data_buf.IsEmpty()) {
@@ -1085,6 +1144,8 @@ void ContextifyContext::CompileFunction(
         cached_data_buf->Buffer()->GetBackingStore()->Data());
     cached_data = new ScriptCompiler::CachedData(
       data + cached_data_buf->ByteOffset(), cached_data_buf->ByteLength());
+  } else if (cache_entry != nullptr) {
+    cached_data = cache_entry->CopyCache();
   }
 
   // Get the function id
@@ -1159,6 +1220,14 @@ void ContextifyContext::CompileFunction(
     return;
   }
 
+  if (cache_entry != nullptr) {
+    env->compile_cache_handler()->MaybeSave(
+        cache_entry,
+        fn,
+        options == ScriptCompiler::kConsumeCodeCache &&
+            source.GetCachedData()->rejected);
+  }
+
   Local<Object> cache_key;
   if (!env->compiled_fn_entry_template()->NewInstance(
            context).ToLocal(&cache_key)) {
@@ -1211,15 +1280,41 @@ CompiledFnEntry::CompiledFnEntry(Environment* env,
                                  Local<Object> object,
                                  uint32_t id,
                                  Local<ScriptOrModule> script)
-    : BaseObject(env, object),
+    : SnapshotableObject(env, object, EmbedderObjectType::k_compiled_fn_entry),
       id_(id),
       script_(env->isolate(), script) {
-  script_.SetWeak(this, WeakCallback, v8::WeakCallbackType::kParameter);
+  if (!script.IsEmpty())
+    script_.SetWeak(this, WeakCallback, v8::WeakCallbackType::kParameter);
 }
 
 CompiledFnEntry::~CompiledFnEntry() {
   env()->id_to_function_map.erase(id_);
-  script_.ClearWeak();
+  if (!script_.IsEmpty())
+    script_.ClearWeak();
+}
+
+node::InternalFieldInfo* CompiledFnEntry::Serialize(int index) {
+  DCHECK_EQ(index, BaseObject::kSlot);
+  InternalFieldInfo* info = InternalFieldInfo::New<InternalFieldInfo>(type());
+  info->id = id_;
+  return info;
+}
+
+void CompiledFnEntry::Deserialize(Local<Context> context,
+                                  Local<Object> holder,
+                                  int index,
+                                  node::InternalFieldInfo* info) {
+  DCHECK_EQ(index, BaseObject::kSlot);
+  HandleScope scope(context->GetIsolate());
+  Environment* env = Environment::GetCurrent(context);
+  uint32_t id = static_cast<InternalFieldInfo*>(info)->id;
+  // The functions compiled while the snapshot was built refer to their
+  // entry through the id in their host defined options, make sure that
+  // it is not handed out again.
+  env->ReserveFunctionId(id);
+  CompiledFnEntry* entry =
+      new CompiledFnEntry(env, holder, id, Local<ScriptOrModule>());
+  env->id_to_function_map.emplace(id, entry);
 }
 
 static void StartSigintWatchdog(const FunctionCallbackInfo<Value>& args) {
@@ -1350,7 +1445,22 @@ void Initialize(Local<Object> target,
   env->SetMethod(target, "measureMemory", MeasureMemory);
 }
 
+void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
+  ContextifyContext::RegisterExternalReferences(registry);
+  registry->Register(ContextifyScript::New);
+  registry->Register(ContextifyScript::CreateCachedData);
+  registry->Register(ContextifyScript::RunInContext);
+  registry->Register(ContextifyScript::RunInThisContext);
+  registry->Register(MicrotaskQueueWrap::New);
+  registry->Register(StartSigintWatchdog);
+  registry->Register(StopSigintWatchdog);
+  registry->Register(WatchdogHasPendingSigint);
+  registry->Register(MeasureMemory);
+}
+
 }  // namespace contextify
 }  // namespace node
 
 NODE_MODULE_CONTEXT_AWARE_INTERNAL(contextify, node::contextify::Initialize)
+NODE_MODULE_EXTERNAL_REFERENCE(contextify,
+                               node::contextify::RegisterExternalReferences)
@@ -6,8 +6,11 @@
 #include "base_object-inl.h"
 #include "node_context_data.h"
 #include "node_errors.h"
+#include "node_snapshotable.h"
 
 namespace node {
+class ExternalReferenceRegistry;
+
 namespace contextify {
 
 class MicrotaskQueueWrap : public BaseObject {
@@ -36,22 +39,33 @@ struct ContextOptions {
   v8::Local<v8::Boolean> allow_code_gen_strings;
   v8::Local<v8::Boolean> allow_code_gen_wasm;
   BaseObjectPtr<MicrotaskQueueWrap> microtask_queue_wrap;
+  // The position of the context template that the context is deserialized
+  // from, or -1 for the pristine vm context.
+  int32_t context_template = -1;
 };
 
 class ContextifyContext {
  public:
-  enum InternalFields { kSlot, kInternalFieldCount };
   ContextifyContext(Environment* env,
                     v8::Local<v8::Object> sandbox_obj,
                     const ContextOptions& options);
   ~ContextifyContext();
   static void CleanupHook(void* arg);
 
-  v8::MaybeLocal<v8::Object> CreateDataWrapper(Environment* env);
   v8::MaybeLocal<v8::Context> CreateV8Context(Environment* env,
                                               v8::Local<v8::Object> sandbox_obj,
                                               const ContextOptions& options);
+  // The template of the global object of vm contexts, whose interceptors
+  // forward the accesses to the sandbox object.
+  static v8::Local<v8::ObjectTemplate> CreateGlobalTemplate(
+      v8::Isolate* isolate);
+  static v8::Local<v8::ObjectTemplate> GetGlobalTemplate(Environment* env);
+  // Creates a context that vm contexts can be deserialized from when Node.js
+  // is started from a snapshot. It is used as is for the pristine vm
+  // context, and the setup code of context templates is run in it.
+  static v8::MaybeLocal<v8::Context> CreateTemplateContext(Environment* env);
   static void Init(Environment* env, v8::Local<v8::Object> target);
+  static void RegisterExternalReferences(ExternalReferenceRegistry* registry);
 
   static ContextifyContext* ContextFromContextifiedSandbox(
       Environment* env,
@@ -83,6 +97,10 @@ class ContextifyContext {
   template <typename T>
   static ContextifyContext* Get(const v8::PropertyCallbackInfo<T>& args);
 
+  static bool IsStillInitializing(const ContextifyContext* ctx) {
+    return ctx == nullptr || ctx->context_.IsEmpty();
+  }
+
  private:
   static void MakeContext(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void IsContext(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -162,12 +180,18 @@ class ContextifyScript : public BaseObject {
   uint32_t id_;
 };
 
-class CompiledFnEntry final : public BaseObject {
+class CompiledFnEntry final : public SnapshotableObject {
  public:
+  struct InternalFieldInfo : public node::InternalFieldInfo {
+    uint32_t id;
+  };
+
   SET_NO_MEMORY_INFO()
   SET_MEMORY_INFO_NAME(CompiledFnEntry)
   SET_SELF_SIZE(CompiledFnEntry)
 
+  // `script` is empty for entries that have been deserialized from a
+  // snapshot, those are kept until the Environment is torn down.
   CompiledFnEntry(Environment* env,
                   v8::Local<v8::Object> object,
                   uint32_t id,
@@ -176,6 +200,14 @@ class CompiledFnEntry final : public BaseObject {
 
   bool IsNotIndicativeOfMemoryLeakAtExit() const override { return true; }
 
+  void PrepareForSerialization(v8::Local<v8::Context> context,
+                               v8::SnapshotCreator* creator) override {}
+  node::InternalFieldInfo* Serialize(int index) override;
+  static void Deserialize(v8::Local<v8::Context> context,
+                          v8::Local<v8::Object> holder,
+                          int index,
+                          node::InternalFieldInfo* info);
+
  private:
   uint32_t id_;
   v8::Global<v8::ScriptOrModule> script_;
@@ -0,0 +1,507 @@
+#include "node_continuous_profiler.h"
+#include "diagnosticfilename-inl.h"
+#include "env-inl.h"
+#include "node_buffer.h"
+#include "node_external_reference.h"
+#include "node_internals.h"
+#include "util-inl.h"
+
+#include "zlib.h"
+
+#include <algorithm>
+
+namespace node {
+
+using v8::Context;
+using v8::CpuProfile;
+using v8::CpuProfileNode;
+using v8::CpuProfiler;
+using v8::FunctionCallbackInfo;
+using v8::HandleScope;
+using v8::Int32;
+using v8::Local;
+using v8::Number;
+using v8::Object;
+using v8::String;
+using v8::Value;
+
+namespace profiler {
+
+namespace {
+
+constexpr const char* kProfileTitle = "node:continuous-cpu-profiler";
+
+// Samples that are taken within this fraction of the sampling interval from
+// the start or the end of a callback may be attributed to the provider type
+// that ran next. This bounds the number of transitions that are recorded.
+constexpr uint64_t kTransitionsPerSample = 8;
+// Transitions are dropped once a window has recorded this many of them, e.g.
+// if the event loop is too busy to end the window in time.
+constexpr size_t kMaxTransitions = 1 << 16;
+
+// Writes the messages of the pprof format, that is described in
+// https://github.com/google/pprof/blob/master/proto/profile.proto.
+class ProtobufWriter {
+ public:
+  void WriteVarint(uint64_t value) {
+    while (value >= 0x80) {
+      data_.push_back(static_cast<char>((value & 0x7f) | 0x80));
+      value >>= 7;
+    }
+    data_.push_back(static_cast<char>(value));
+  }
+
+  void WriteInt(uint32_t field, uint64_t value) {
+    WriteVarint(field << 3);
+    WriteVarint(value);
+  }
+
+  void WriteBytes(uint32_t field, const char* data, size_t size) {
+    WriteVarint(field << 3 | 2);
+    WriteVarint(size);
+    data_.append(data, size);
+  }
+
+  void WriteString(uint32_t field, const std::string& value) {
+    WriteBytes(field, value.data(), value.size());
+  }
+
+  void WriteMessage(uint32_t field, const ProtobufWriter& message) {
+    WriteString(field, message.data_);
+  }
+
+  void WritePacked(uint32_t field, const std::vector<uint64_t>& values) {
+    ProtobufWriter packed;
+    for (uint64_t value : values)
+      packed.WriteVarint(value);
+    WriteMessage(field, packed);
+  }
+
+  const std::string& data() const { return data_; }
+
+ private:
+  std::string data_;
+};
+
+class StringTable {
+ public:
+  StringTable() { Intern(""); }
+
+  uint64_t Intern(const std::string& value) {
+    auto it = indices_.find(value);
+    if (it != indices_.end())
+      return it->second;
+    uint64_t index = strings_.size();
+    strings_.push_back(value);
+    indices_.emplace(value, index);
+    return index;
+  }
+
+  const std::vector<std::string>& strings() const { return strings_; }
+
+ private:
+  std::vector<std::string> strings_;
+  std::unordered_map<std::string, uint64_t> indices_;
+};
+
+std::string Gzip(const std::string& data) {
+  z_stream stream = {};
+  // 15 bits of window, plus 16 to write a gzip header and trailer.
+  CHECK_EQ(deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16,
+                        8, Z_DEFAULT_STRATEGY), Z_OK);
+  std::string out(deflateBound(&stream, data.size()), '\0');
+  stream.next_in =
+      reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+  stream.avail_in = data.size();
+  stream.next_out = reinterpret_cast<Bytef*>(&out[0]);
+  stream.avail_out = out.size();
+  CHECK_EQ(deflate(&stream, Z_FINISH), Z_STREAM_END);
+  out.resize(stream.total_out);
+  deflateEnd(&stream);
+  return out;
+}
+
+}  // anonymous namespace
+
+ContinuousCpuProfiler::ContinuousCpuProfiler(Environment* env,
+                                             const Options& options)
+    : env_(env),
+      options_(options),
+      cpu_profiler_(CpuProfiler::New(env->isolate())),
+      timer_id_(env->timer_wheel()->AddNativeTimer(OnWindowEnd, this)) {
+  cpu_profiler_->SetSamplingInterval(options_.sampling_interval_us);
+  StartWindow();
+}
+
+ContinuousCpuProfiler::~ContinuousCpuProfiler() {
+  HandleScope handle_scope(env_->isolate());
+  CpuProfile* profile = cpu_profiler_->StopProfiling(
+      OneByteString(env_->isolate(), kProfileTitle));
+  if (profile != nullptr)
+    profile->Delete();
+  cpu_profiler_->Dispose();
+  env_->timer_wheel()->RemoveNativeTimer(timer_id_);
+}
+
+void ContinuousCpuProfiler::OnWindowEnd(void* data) {
+  static_cast<ContinuousCpuProfiler*>(data)->RotateWindow();
+}
+
+void ContinuousCpuProfiler::StartWindow() {
+  HandleScope handle_scope(env_->isolate());
+  window_start_time_ =
+      static_cast<uint64_t>(GetCurrentTimeInMicroseconds()) * 1000;
+  window_start_hrtime_ = uv_hrtime();
+  transitions_.clear();
+  transitions_.push_back({
+      window_start_hrtime_,
+      callbacks_.empty() ? AsyncWrap::PROVIDER_NONE : callbacks_.back()});
+  cpu_profiler_->StartProfiling(OneByteString(env_->isolate(), kProfileTitle),
+                                true);
+  env_->InsertTimer(timer_id_,
+                    env_->GetNowUint64() + options_.window_duration_ms);
+}
+
+void ContinuousCpuProfiler::RotateWindow() {
+  HandleScope handle_scope(env_->isolate());
+  CpuProfile* profile = cpu_profiler_->StopProfiling(
+      OneByteString(env_->isolate(), kProfileTitle));
+  uint64_t start_time = window_start_time_;
+  uint64_t start_hrtime = window_start_hrtime_;
+  std::vector<Transition> transitions;
+  transitions.swap(transitions_);
+  StartWindow();
+
+  uint64_t now = uv_hrtime();
+  if (profile != nullptr) {
+    Window window;
+    window.start_time = start_time;
+    window.end_hrtime = now;
+    window.duration = static_cast<uint64_t>(
+        profile->GetEndTime() - profile->GetStartTime()) * 1000;
+    Aggregate(profile, start_hrtime, transitions, &window);
+    profile->Delete();
+    windows_.push_back(std::move(window));
+  }
+
+  uint64_t retention = options_.retention_ms * 1000 * 1000;
+  bool evicted = false;
+  while (!windows_.empty() && windows_.front().end_hrtime + retention < now) {
+    windows_.pop_front();
+    evicted = true;
+  }
+  if (evicted)
+    CompactFunctions();
+}
+
+void ContinuousCpuProfiler::CompactFunctions() {
+  constexpr uint32_t kUnused = static_cast<uint32_t>(-1);
+  std::vector<uint32_t> new_ids(functions_.size(), kUnused);
+  for (const Window& window : windows_) {
+    for (const auto& sample : window.samples) {
+      for (size_t i = 1; i < sample.first.size(); i++)
+        new_ids[sample.first[i]] = 0;
+    }
+  }
+
+  std::vector<Function> functions;
+  for (uint32_t id = 0; id < functions_.size(); id++) {
+    if (new_ids[id] == kUnused)
+      continue;
+    new_ids[id] = functions.size();
+    functions.push_back(std::move(functions_[id]));
+  }
+  if (functions.size() == functions_.size())
+    return;
+  functions_ = std::move(functions);
+
+  for (auto it = function_ids_.begin(); it != function_ids_.end();) {
+    uint32_t id = new_ids[it->second];
+    if (id == kUnused) {
+      it = function_ids_.erase(it);
+    } else {
+      it->second = id;
+      ++it;
+    }
+  }
+
+  for (Window& window : windows_) {
+    std::map<StackKey, int64_t> samples;
+    for (auto& sample : window.samples) {
+      StackKey key = sample.first;
+      for (size_t i = 1; i < key.size(); i++)
+        key[i] = new_ids[key[i]];
+      samples.emplace(std::move(key), sample.second);
+    }
+    window.samples.swap(samples);
+  }
+}
+
+void ContinuousCpuProfiler::Aggregate(
+    CpuProfile* profile,
+    uint64_t start_hrtime,
+    const std::vector<Transition>& transitions,
+    Window* window) {
+  // The stacks of the nodes that have been sampled, without the provider
+  // type.
+  std::unordered_map<const CpuProfileNode*, StackKey> stacks;
+  int64_t profile_start = profile->GetStartTime();
+  size_t transition = 0;
+
+  for (int i = 0; i < profile->GetSamplesCount(); i++) {
+    const CpuProfileNode* node = profile->GetSample(i);
+    if (node == nullptr || node->GetParent() == nullptr)
+      continue;
+
+    // The sample timestamps are measured in microseconds on V8's own clock,
+    // from the start of the profile.
+    int64_t offset =
+        std::max<int64_t>(profile->GetSampleTimestamp(i) - profile_start, 0);
+    uint64_t time = start_hrtime + static_cast<uint64_t>(offset) * 1000;
+    while (transition + 1 < transitions.size() &&
+           transitions[transition + 1].time <= time) {
+      transition++;
+    }
+
+    auto it = stacks.find(node);
+    if (it == stacks.end()) {
+      StackKey stack;
+      for (; node->GetParent() != nullptr; node = node->GetParent())
+        stack.push_back(GetFunctionId(node));
+      it = stacks.emplace(profile->GetSample(i), std::move(stack)).first;
+    }
+
+    StackKey key;
+    key.reserve(it->second.size() + 1);
+    key.push_back(transitions[transition].provider);
+    key.insert(key.end(), it->second.begin(), it->second.end());
+    window->samples[key]++;
+  }
+}
+
+uint32_t ContinuousCpuProfiler::GetFunctionId(const CpuProfileNode* node) {
+  const char* name = node->GetFunctionNameStr();
+  const char* filename = node->GetScriptResourceNameStr();
+  int line = node->GetLineNumber();
+  std::string key = std::string(name) + '\0' + filename + '\0' +
+                    std::to_string(line) + ':' +
+                    std::to_string(node->GetColumnNumber());
+  auto it = function_ids_.find(key);
+  if (it != function_ids_.end())
+    return it->second;
+
+  uint32_t id = functions_.size();
+  functions_.push_back({*name != '\0' ? name : "(anonymous)", filename, line});
+  function_ids_.emplace(std::move(key), id);
+  return id;
+}
+
+void ContinuousCpuProfiler::EnterCallback(AsyncWrap::ProviderType provider) {
+  callbacks_.push_back(provider);
+  RecordTransition(provider);
+}
+
+void ContinuousCpuProfiler::LeaveCallback() {
+  // The profiler may have been started by the callback.
+  if (callbacks_.empty())
+    return;
+  callbacks_.pop_back();
+  RecordTransition(callbacks_.empty() ? AsyncWrap::PROVIDER_NONE
+                                      : callbacks_.back());
+}
+
+void ContinuousCpuProfiler::RecordTransition(
+    AsyncWrap::ProviderType provider) {
+  uint64_t now = uv_hrtime();
+  uint64_t resolution =
+      options_.sampling_interval_us * 1000 / kTransitionsPerSample;
+  Transition& last = transitions_.back();
+  if (now - last.time < resolution) {
+    last.provider = provider;
+    return;
+  }
+  if (transitions_.size() < kMaxTransitions)
+    transitions_.push_back({now, provider});
+}
+
+std::string ContinuousCpuProfiler::Export() {
+  RotateWindow();
+
+  std::map<StackKey, int64_t> samples;
+  uint64_t start_time = window_start_time_;
+  uint64_t duration = 0;
+  for (const Window& window : windows_) {
+    start_time = std::min(start_time, window.start_time);
+    duration += window.duration;
+    for (const auto& sample : window.samples)
+      samples[sample.first] += sample.second;
+  }
+
+  StringTable strings;
+  ProtobufWriter profile;
+  uint64_t period = static_cast<uint64_t>(options_.sampling_interval_us) * 1000;
+
+  // Each sample has two values, a count and an amount of CPU time.
+  ProtobufWriter samples_type;
+  samples_type.WriteInt(1, strings.Intern("samples"));
+  samples_type.WriteInt(2, strings.Intern("count"));
+  profile.WriteMessage(1, samples_type);
+  ProtobufWriter cpu_type;
+  cpu_type.WriteInt(1, strings.Intern("cpu"));
+  cpu_type.WriteInt(2, strings.Intern("nanoseconds"));
+  profile.WriteMessage(1, cpu_type);
+
+  // Functions and locations are one and the same, their ids start at 1.
+  std::vector<bool> used(functions_.size());
+  for (const auto& sample : samples) {
+    const StackKey& key = sample.first;
+    ProtobufWriter message;
+    std::vector<uint64_t> locations;
+    locations.reserve(key.size() - 1);
+    for (size_t i = 1; i < key.size(); i++) {
+      used[key[i]] = true;
+      locations.push_back(key[i] + 1);
+    }
+    message.WritePacked(1, locations);
+    uint64_t count = sample.second;
+    message.WritePacked(2, {count, count * period});
+    auto provider = static_cast<AsyncWrap::ProviderType>(key[0]);
+    if (provider != AsyncWrap::PROVIDER_NONE) {
+      ProtobufWriter label;
+      label.WriteInt(1, strings.Intern("async_resource"));
+      label.WriteInt(2, strings.Intern(AsyncWrap::GetProviderName(provider)));
+      message.WriteMessage(3, label);
+    }
+    profile.WriteMessage(2, message);
+  }
+
+  for (uint32_t id = 0; id < functions_.size(); id++) {
+    if (!used[id])
+      continue;
+    const Function& function = functions_[id];
+    ProtobufWriter line;
+    line.WriteInt(1, id + 1);
+    line.WriteInt(2, function.line);
+    ProtobufWriter location;
+    location.WriteInt(1, id + 1);
+    location.WriteMessage(4, line);
+    profile.WriteMessage(4, location);
+
+    ProtobufWriter message;
+    message.WriteInt(1, id + 1);
+    message.WriteInt(2, strings.Intern(function.name));
+    message.WriteInt(3, strings.Intern(function.name));
+    message.WriteInt(4, strings.Intern(function.filename));
+    message.WriteInt(5, function.line);
+    profile.WriteMessage(5, message);
+  }
+
+  profile.WriteInt(9, start_time);
+  profile.WriteInt(10, duration);
+  profile.WriteMessage(11, cpu_type);
+  profile.WriteInt(12, period);
+  for (const std::string& string : strings.strings())
+    profile.WriteString(6, string);
+
+  return Gzip(profile.data());
+}
+
+static void StopOnCleanup(void* arg) {
+  static_cast<Environment*>(arg)->set_continuous_cpu_profiler(nullptr);
+}
+
+// Starts the profiler with the sampling interval args[0] in microseconds, the
+// window duration args[1] and the retention period args[2] in milliseconds.
+// Returns false if the profiler is already running.
+static void Start(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsInt32());
+  CHECK(args[1]->IsNumber());
+  CHECK(args[2]->IsNumber());
+  if (env->continuous_cpu_profiler() != nullptr)
+    return args.GetReturnValue().Set(false);
+
+  ContinuousCpuProfiler::Options options;
+  options.sampling_interval_us = args[0].As<Int32>()->Value();
+  options.window_duration_ms = args[1].As<Number>()->Value();
+  options.retention_ms = args[2].As<Number>()->Value();
+  env->set_continuous_cpu_profiler(
+      std::make_unique<ContinuousCpuProfiler>(env, options));
+  env->AddCleanupHook(StopOnCleanup, env);
+  args.GetReturnValue().Set(true);
+}
+
+static void Stop(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  if (env->continuous_cpu_profiler() == nullptr)
+    return args.GetReturnValue().Set(false);
+  env->RemoveCleanupHook(StopOnCleanup, env);
+  env->set_continuous_cpu_profiler(nullptr);
+  args.GetReturnValue().Set(true);
+}
+
+static void GetProfile(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  ContinuousCpuProfiler* profiler = env->continuous_cpu_profiler();
+  if (profiler == nullptr)
+    return;
+  std::string profile = profiler->Export();
+  Local<Object> buffer;
+  if (Buffer::Copy(env, profile.data(), profile.size()).ToLocal(&buffer))
+    args.GetReturnValue().Set(buffer);
+}
+
+// Writes the profile to the file args[0], or to a generated file name in the
+// current working directory if it is undefined. Returns the file name, or
+// undefined if the profiler is not running or the file could not be written.
+static void WriteProfile(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  ContinuousCpuProfiler* profiler = env->continuous_cpu_profiler();
+  if (profiler == nullptr)
+    return;
+
+  std::string filename;
+  if (args[0]->IsUndefined()) {
+    filename = *DiagnosticFilename(env, "CPU", "pb.gz");
+  } else {
+    BufferValue path(env->isolate(), args[0]);
+    CHECK_NOT_NULL(*path);
+    filename = *path;
+  }
+
+  std::string profile = profiler->Export();
+  uv_buf_t buf = uv_buf_init(&profile[0], profile.size());
+  if (WriteFileSync(filename.c_str(), buf) != 0)
+    return;
+  Local<String> ret;
+  if (String::NewFromUtf8(env->isolate(), filename.c_str()).ToLocal(&ret))
+    args.GetReturnValue().Set(ret);
+}
+
+static void Initialize(Local<Object> target,
+                       Local<Value> unused,
+                       Local<Context> context,
+                       void* priv) {
+  Environment* env = Environment::GetCurrent(context);
+
+  env->SetMethod(target, "start", Start);
+  env->SetMethod(target, "stop", Stop);
+  env->SetMethod(target, "getProfile", GetProfile);
+  env->SetMethod(target, "writeProfile", WriteProfile);
+}
+
+static void RegisterExternalReferences(
+    ExternalReferenceRegistry* registry) {
+  registry->Register(Start);
+  registry->Register(Stop);
+  registry->Register(GetProfile);
+  registry->Register(WriteProfile);
+}
+
+}  // namespace profiler
+}  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_INTERNAL(continuous_profiler,
+                                   node::profiler::Initialize)
+NODE_MODULE_EXTERNAL_REFERENCE(continuous_profiler,
+                               node::profiler::RegisterExternalReferences)
@@ -0,0 +1,146 @@
+#ifndef SRC_NODE_CONTINUOUS_PROFILER_H_
+#define SRC_NODE_CONTINUOUS_PROFILER_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include "async_wrap.h"
+#include "env.h"
+#include "v8-profiler.h"
+
+#include <deque>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace node {
+namespace profiler {
+
+// A low-frequency sampling CPU profiler that is meant to be left running.
+// The samples are recorded by V8 in windows of a fixed duration. When a
+// window ends, its samples are aggregated into a count per distinct stack,
+// and the V8 profile is discarded, so that the memory used by the profiler
+// depends on the number of distinct stacks rather than on the number of
+// samples. The windows that ended within the retention period are exported
+// together as a gzip-compressed pprof profile.
+//
+// The samples that are taken while a callback of an AsyncWrap runs are
+// labelled with the provider type of the AsyncWrap, e.g. TCPWRAP.
+class ContinuousCpuProfiler {
+ public:
+  struct Options {
+    int sampling_interval_us;
+    uint64_t window_duration_ms;
+    uint64_t retention_ms;
+  };
+
+  // Marks the time spent in a callback of an AsyncWrap, when the continuous
+  // profiler of the Environment is running.
+  class CallbackScope {
+   public:
+    inline CallbackScope(Environment* env, AsyncWrap::ProviderType provider);
+    inline ~CallbackScope();
+
+    CallbackScope(const CallbackScope&) = delete;
+    CallbackScope& operator=(const CallbackScope&) = delete;
+
+   private:
+    Environment* const env_;
+    bool entered_ = false;
+  };
+
+  ContinuousCpuProfiler(Environment* env, const Options& options);
+  ~ContinuousCpuProfiler();
+
+  ContinuousCpuProfiler(const ContinuousCpuProfiler&) = delete;
+  ContinuousCpuProfiler& operator=(const ContinuousCpuProfiler&) = delete;
+
+  // Ends the current window early, and returns the samples of the windows
+  // within the retention period as a gzip-compressed pprof profile.
+  std::string Export();
+
+  void EnterCallback(AsyncWrap::ProviderType provider);
+  void LeaveCallback();
+
+ private:
+  // The provider type that was running from `time` on, in nanoseconds from
+  // uv_hrtime().
+  struct Transition {
+    uint64_t time;
+    AsyncWrap::ProviderType provider;
+  };
+
+  struct Function {
+    std::string name;
+    std::string filename;
+    int64_t line;
+  };
+
+  // The provider type of the samples, followed by the ids of the functions
+  // of their stack, from the leaf to the root.
+  using StackKey = std::vector<uint32_t>;
+
+  struct Window {
+    // Wall-clock time at which the window started, in nanoseconds.
+    uint64_t start_time;
+    // Monotonic time at which the window ended, from uv_hrtime().
+    uint64_t end_hrtime;
+    uint64_t duration;
+    std::map<StackKey, int64_t> samples;
+  };
+
+  static void OnWindowEnd(void* data);
+
+  void StartWindow();
+  // Ends the current window, starts the next one, and drops the windows that
+  // are now older than the retention period.
+  void RotateWindow();
+  void Aggregate(v8::CpuProfile* profile,
+                 uint64_t start_hrtime,
+                 const std::vector<Transition>& transitions,
+                 Window* window);
+  uint32_t GetFunctionId(const v8::CpuProfileNode* node);
+  // Drops the functions that are not part of the samples of any window
+  // anymore, so that the table does not grow with every function that has
+  // ever been sampled.
+  void CompactFunctions();
+  void RecordTransition(AsyncWrap::ProviderType provider);
+
+  Environment* const env_;
+  const Options options_;
+  v8::CpuProfiler* cpu_profiler_;
+  uint32_t timer_id_;
+
+  uint64_t window_start_time_ = 0;
+  uint64_t window_start_hrtime_ = 0;
+  std::deque<Window> windows_;
+
+  std::vector<AsyncWrap::ProviderType> callbacks_;
+  std::vector<Transition> transitions_;
+
+  std::unordered_map<std::string, uint32_t> function_ids_;
+  std::vector<Function> functions_;
+};
+
+ContinuousCpuProfiler::CallbackScope::CallbackScope(
+    Environment* env, AsyncWrap::ProviderType provider) : env_(env) {
+  ContinuousCpuProfiler* profiler = env->continuous_cpu_profiler();
+  if (profiler != nullptr) {
+    profiler->EnterCallback(provider);
+    entered_ = true;
+  }
+}
+
+ContinuousCpuProfiler::CallbackScope::~CallbackScope() {
+  // The profiler may have been stopped, or restarted, by the callback.
+  ContinuousCpuProfiler* profiler = env_->continuous_cpu_profiler();
+  if (entered_ && profiler != nullptr)
+    profiler->LeaveCallback();
+}
+
+}  // namespace profiler
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_NODE_CONTINUOUS_PROFILER_H_
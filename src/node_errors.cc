@@ -435,6 +435,9 @@ void OnFatalError(const char* location, const char* message) {
   if (report_on_fatalerror) {
     report::TriggerNodeReport(
         isolate, env, message, "FatalError", "", Local<Object>());
+  } else {
+    // The report also writes the trace events.
+    tracing::WriteFlightRecorder(env, "", true);
   }
 
   fflush(stderr);
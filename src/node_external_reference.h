@@ -25,7 +25,11 @@ class ExternalReferenceRegistry {
   V(v8::GenericNamedPropertyDeleterCallback)                                   \
   V(v8::GenericNamedPropertyEnumeratorCallback)                                \
   V(v8::GenericNamedPropertyQueryCallback)                                     \
-  V(v8::GenericNamedPropertySetterCallback)
+  V(v8::GenericNamedPropertySetterCallback)                                    \
+  V(v8::IndexedPropertyDefinerCallback)                                        \
+  V(v8::IndexedPropertyDeleterCallback)                                        \
+  V(v8::IndexedPropertyGetterCallback)                                         \
+  V(v8::IndexedPropertySetterCallback)
 
 #define V(ExternalReferenceType)                                               \
   void Register(ExternalReferenceType addr) { RegisterT(addr); }
@@ -50,14 +54,24 @@ class ExternalReferenceRegistry {
   V(async_wrap)                                                                \
   V(binding)                                                                   \
   V(buffer)                                                                    \
+  V(contextify)                                                                \
+  V(continuous_profiler)                                                       \
   V(credentials)                                                               \
   V(env_var)                                                                   \
   V(errors)                                                                    \
+  V(fs)                                                                        \
+  V(fs_dir)                                                                    \
   V(handle_wrap)                                                               \
+  V(heap_utils)                                                                \
   V(messaging)                                                                 \
+  V(mksnapshot)                                                                \
+  V(module_wrap)                                                               \
   V(native_module)                                                             \
+  V(options)                                                                   \
   V(process_methods)                                                           \
   V(process_object)                                                            \
+  V(report)                                                                    \
+  V(serdes)                                                                    \
   V(task_queue)                                                                \
   V(url)                                                                       \
   V(util)                                                                      \
@@ -65,6 +79,7 @@ class ExternalReferenceRegistry {
   V(trace_events)                                                              \
   V(timers)                                                                    \
   V(types)                                                                     \
+  V(v8)                                                                        \
   V(worker)
 
 #if NODE_HAVE_I18N_SUPPORT
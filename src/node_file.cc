@@ -21,8 +21,11 @@
 #include "node_file.h"  // NOLINT(build/include_inline)
 #include "node_file-inl.h"
 #include "aliased_buffer.h"
+#include "compile_cache.h"
+#include "json_utils.h"
 #include "memory_tracker-inl.h"
 #include "node_buffer.h"
+#include "node_external_reference.h"
 #include "node_process.h"
 #include "node_stat_watcher.h"
 #include "util-inl.h"
@@ -67,6 +70,7 @@ using v8::Number;
 using v8::Object;
 using v8::ObjectTemplate;
 using v8::Promise;
+using v8::SnapshotCreator;
 using v8::String;
 using v8::Symbol;
 using v8::Uint32;
@@ -888,27 +892,16 @@ void Close(const FunctionCallbackInfo<Value>& args) {
 }
 
 
-// Used to speed up module loading. Returns an array [string, boolean]
-static void InternalModuleReadJSON(const FunctionCallbackInfo<Value>& args) {
-  Environment* env = Environment::GetCurrent(args);
-  Isolate* isolate = env->isolate();
-  uv_loop_t* loop = env->event_loop();
-
-  CHECK(args[0]->IsString());
-  node::Utf8Value path(isolate, args[0]);
+namespace {
 
-  if (strlen(*path) != path.length()) {
-    args.GetReturnValue().Set(Array::New(isolate));
-    return;  // Contains a nul byte.
-  }
+// Reads a file for the module loaders, skipping its UTF-8 BOM. Returns false
+// if it cannot be read.
+bool ReadModuleFile(uv_loop_t* loop, const char* path, std::string* contents) {
   uv_fs_t open_req;
-  const int fd = uv_fs_open(loop, &open_req, *path, O_RDONLY, 0, nullptr);
+  const int fd = uv_fs_open(loop, &open_req, path, O_RDONLY, 0, nullptr);
   uv_fs_req_cleanup(&open_req);
 
-  if (fd < 0) {
-    args.GetReturnValue().Set(Array::New(isolate));
-    return;
-  }
+  if (fd < 0) return false;
 
   auto defer_close = OnScopeLeave([fd, loop]() {
     uv_fs_t close_req;
@@ -932,10 +925,7 @@ static void InternalModuleReadJSON(const FunctionCallbackInfo<Value>& args) {
     numchars = uv_fs_read(loop, &read_req, fd, &buf, 1, offset, nullptr);
     uv_fs_req_cleanup(&read_req);
 
-    if (numchars < 0) {
-      args.GetReturnValue().Set(Array::New(isolate));
-      return;
-    }
+    if (numchars < 0) return false;
     offset += numchars;
   } while (static_cast<size_t>(numchars) == kBlockSize);
 
@@ -943,12 +933,17 @@ static void InternalModuleReadJSON(const FunctionCallbackInfo<Value>& args) {
   if (offset >= 3 && 0 == memcmp(&chars[0], "\xEF\xBB\xBF", 3)) {
     start = 3;  // Skip UTF-8 BOM.
   }
+  contents->assign(&chars[start], offset - start);
+  return true;
+}
 
-  const size_t size = offset - start;
-  char* p = &chars[start];
-  char* pe = &chars[size];
-  char* pos[2];
-  char** ppos = &pos[0];
+// A quick check for whether the text mentions any of the package.json
+// fields that the module loaders use.
+bool ContainsPackageJsonKeys(const std::string& contents) {
+  const char* p = contents.data();
+  const char* pe = p + contents.size();
+  const char* pos[2];
+  const char** ppos = &pos[0];
 
   while (p < pe) {
     char c = *p++;
@@ -958,52 +953,274 @@ static void InternalModuleReadJSON(const FunctionCallbackInfo<Value>& args) {
     if (ppos < &pos[2]) continue;
     ppos = &pos[0];
 
-    char* s = &pos[0][0];
-    char* se = &pos[1][-1];  // Exclude quote.
+    const char* s = &pos[0][0];
+    const char* se = &pos[1][-1];  // Exclude quote.
     size_t n = se - s;
 
     if (n == 4) {
-      if (0 == memcmp(s, "main", 4)) break;
-      if (0 == memcmp(s, "name", 4)) break;
-      if (0 == memcmp(s, "type", 4)) break;
+      if (0 == memcmp(s, "main", 4)) return true;
+      if (0 == memcmp(s, "name", 4)) return true;
+      if (0 == memcmp(s, "type", 4)) return true;
     } else if (n == 7) {
-      if (0 == memcmp(s, "exports", 7)) break;
-      if (0 == memcmp(s, "imports", 7)) break;
+      if (0 == memcmp(s, "exports", 7)) return true;
+      if (0 == memcmp(s, "imports", 7)) return true;
     }
   }
+  return false;
+}
 
-
-  Local<Value> return_value[] = {
+Local<Array> PackageJsonSource(Isolate* isolate, const std::string& contents) {
+  Local<Value> values[] = {
     String::NewFromUtf8(isolate,
-                        &chars[start],
+                        contents.data(),
                         v8::NewStringType::kNormal,
-                        size).ToLocalChecked(),
-    Boolean::New(isolate, p < pe ? true : false)
+                        contents.size()).ToLocalChecked(),
+    Boolean::New(isolate, ContainsPackageJsonKeys(contents))
   };
-  args.GetReturnValue().Set(
-    Array::New(isolate, return_value, arraysize(return_value)));
+  return Array::New(isolate, values, arraysize(values));
+}
+
+#define PACKAGE_JSON_FIELDS(V)                                                 \
+  V(name)                                                                      \
+  V(main)                                                                      \
+  V(exports)                                                                   \
+  V(imports)                                                                   \
+  V(type)
+
+const char* const kPackageJsonFields[] = {
+#define V(name) #name,
+  PACKAGE_JSON_FIELDS(V)
+#undef V
+};
+constexpr size_t kPackageJsonFieldCount = arraysize(kPackageJsonFields);
+
+// The fields of a package.json file that the module loaders use, as JSON
+// text, shared by all the threads of the process.
+struct PackageJson {
+  uint64_t size;
+  uv_timespec_t mtime;
+  // Whether the file is valid JSON. If it is not, the source has to be
+  // handed to JavaScript so that it can report the error.
+  bool valid;
+  std::string fields[kPackageJsonFieldCount];
+};
+
+Mutex package_json_mutex;
+std::unordered_map<std::string, std::shared_ptr<const PackageJson>>
+    package_json_cache;
+
+}  // anonymous namespace
+
+// Used to speed up module loading. Returns an array [string, boolean]
+static void InternalModuleReadJSON(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Isolate* isolate = env->isolate();
+
+  CHECK(args[0]->IsString());
+  node::Utf8Value path(isolate, args[0]);
+
+  std::string contents;
+  if (strlen(*path) != path.length() ||  // Contains a nul byte.
+      !ReadModuleFile(env->event_loop(), *path, &contents)) {
+    args.GetReturnValue().Set(Array::New(isolate));
+    return;
+  }
+
+  args.GetReturnValue().Set(PackageJsonSource(isolate, contents));
 }
 
-// Used to speed up module loading.  Returns 0 if the path refers to
-// a file, 1 when it's a directory or < 0 on error (usually -ENOENT.)
-// The speedup comes from not creating thousands of Stat and Error objects.
-static void InternalModuleStat(const FunctionCallbackInfo<Value>& args) {
+// Used by the module loaders instead of internalModuleReadJSON() when the
+// source of the file is not needed. Returns undefined if the file cannot be
+// read, and an object with the name, main, exports, imports and type fields
+// that are present otherwise. Only these fields are parsed, the rest of the
+// file is merely validated. If the file is not valid JSON, returns
+// [string, boolean] like internalModuleReadJSON().
+//
+// The fields are cached for the whole process and are reused as long as the
+// size and the modification time of the file do not change.
+static void InternalModuleReadPackageJSON(
+    const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
+  Isolate* isolate = env->isolate();
+  Local<Context> context = env->context();
+  uv_loop_t* loop = env->event_loop();
 
   CHECK(args[0]->IsString());
-  node::Utf8Value path(env->isolate(), args[0]);
+  node::Utf8Value path(isolate, args[0]);
+  if (strlen(*path) != path.length()) return;  // Contains a nul byte.
+
+  uv_fs_t stat_req;
+  int err = uv_fs_stat(loop, &stat_req, *path, nullptr);
+  uv_stat_t stat = stat_req.statbuf;
+  uv_fs_req_cleanup(&stat_req);
+  if (err != 0 || (stat.st_mode & S_IFMT) == S_IFDIR) return;
 
+  std::shared_ptr<const PackageJson> package_json;
+  {
+    Mutex::ScopedLock lock(package_json_mutex);
+    auto it = package_json_cache.find(path.ToString());
+    if (it != package_json_cache.end() && it->second->size == stat.st_size &&
+        it->second->mtime.tv_sec == stat.st_mtim.tv_sec &&
+        it->second->mtime.tv_nsec == stat.st_mtim.tv_nsec) {
+      package_json = it->second;
+    }
+  }
+
+  std::string contents;
+  if (!package_json || !package_json->valid) {
+    if (!ReadModuleFile(loop, *path, &contents)) return;
+    auto result = std::make_shared<PackageJson>();
+    result->size = stat.st_size;
+    result->mtime = stat.st_mtim;
+    result->valid = ScanJsonObject(contents.data(),
+                                   contents.size(),
+                                   kPackageJsonFields,
+                                   kPackageJsonFieldCount,
+                                   result->fields);
+    // A file modified within the granularity of the modification time
+    // could change again without it being updated.
+    if (result->mtime.tv_sec + 2 < static_cast<int64_t>(time(nullptr))) {
+      Mutex::ScopedLock lock(package_json_mutex);
+      package_json_cache[path.ToString()] = result;
+    }
+    package_json = std::move(result);
+  }
+
+  if (!package_json->valid) {
+    args.GetReturnValue().Set(PackageJsonSource(isolate, contents));
+    return;
+  }
+
+  Local<Object> result = Object::New(isolate);
+  for (size_t i = 0; i < kPackageJsonFieldCount; i++) {
+    const std::string& field = package_json->fields[i];
+    if (field.empty()) continue;
+    Local<String> name;
+    Local<String> text;
+    Local<Value> value;
+    if (!String::NewFromUtf8(isolate, kPackageJsonFields[i]).ToLocal(&name) ||
+        !String::NewFromUtf8(isolate,
+                             field.data(),
+                             v8::NewStringType::kNormal,
+                             field.size()).ToLocal(&text) ||
+        !v8::JSON::Parse(context, text).ToLocal(&value) ||
+        result->Set(context, name, value).IsNothing()) {
+      return;
+    }
+  }
+  args.GetReturnValue().Set(result);
+}
+
+// Used to speed up module loading.  Returns 0 if the path refers to
+// a file, 1 when it's a directory or < 0 on error (usually -ENOENT.)
+// The speedup comes from not creating thousands of Stat and Error objects.
+static int ModuleStat(uv_loop_t* loop, const char* path) {
   uv_fs_t req;
-  int rc = uv_fs_stat(env->event_loop(), &req, *path, nullptr);
+  int rc = uv_fs_stat(loop, &req, path, nullptr);
   if (rc == 0) {
     const uv_stat_t* const s = static_cast<const uv_stat_t*>(req.ptr);
     rc = !!(s->st_mode & S_IFDIR);
   }
   uv_fs_req_cleanup(&req);
+  return rc;
+}
+
+int ModuleStatCache::Stat(uv_loop_t* loop, const std::string& path) {
+  auto it = results_.find(path);
+  if (it != results_.end()) return it->second;
+
+#ifdef _WIN32
+  static constexpr const char* kSeparators = "\\/";
+#else
+  static constexpr const char* kSeparators = "/";
+#endif
+  // Look for the closest ancestor with a known result. Below a directory
+  // that exists, nothing can be inferred.
+  int rc = 1;
+  for (size_t end = path.find_last_of(kSeparators);
+       end != std::string::npos && end > 0;
+       end = path.find_last_of(kSeparators, end - 1)) {
+    auto parent = results_.find(path.substr(0, end));
+    if (parent == results_.end()) continue;
+    if (parent->second == 0)
+      rc = UV_ENOTDIR;
+    else if (parent->second == UV_ENOENT || parent->second == UV_ENOTDIR)
+      rc = parent->second;
+    break;
+  }
+  if (rc == 1) rc = ModuleStat(loop, path.c_str());
+
+  results_.emplace(path, rc);
+  return rc;
+}
+
+// Used by the CommonJS loader. When the second argument is true, the result
+// is memoized until clearModuleStatCache() is called.
+static void InternalModuleStat(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  CHECK(args[0]->IsString());
+  node::Utf8Value path(env->isolate(), args[0]);
+
+  int rc;
+  if (args[1]->IsTrue()) {
+    BindingData* binding_data = Environment::GetBindingData<BindingData>(args);
+    rc = binding_data->module_stat_cache.Stat(env->event_loop(),
+                                              path.ToString());
+  } else {
+    rc = ModuleStat(env->event_loop(), *path);
+  }
 
   args.GetReturnValue().Set(rc);
 }
 
+static void ClearModuleStatCache(const FunctionCallbackInfo<Value>& args) {
+  BindingData* binding_data = Environment::GetBindingData<BindingData>(args);
+  binding_data->module_stat_cache.Clear();
+}
+
+// Used by the CommonJS loader with --compile-cache-dir, to reuse the results
+// of the module resolution of previous runs.
+static void LookupModuleResolution(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CompileCacheHandler* handler = env->compile_cache_handler();
+  if (handler == nullptr) return;
+
+  CHECK(args[0]->IsString());
+  node::Utf8Value key(env->isolate(), args[0]);
+  const std::string* filename = handler->LookupResolution(key.ToString());
+  if (filename == nullptr) return;
+  Local<Value> result;
+  if (ToV8Value(env->context(), *filename).ToLocal(&result))
+    args.GetReturnValue().Set(result);
+}
+
+static void RecordModuleResolution(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CompileCacheHandler* handler = env->compile_cache_handler();
+  if (handler == nullptr) return;
+
+  CHECK(args[0]->IsString());
+  CHECK(args[1]->IsString());
+  CHECK(args[2]->IsArray());
+  CHECK(args[3]->IsArray());
+  node::Utf8Value key(env->isolate(), args[0]);
+  node::Utf8Value filename(env->isolate(), args[1]);
+  std::vector<std::string> lists[2];
+  for (int i = 0; i < 2; i++) {
+    Local<Array> array = args[2 + i].As<Array>();
+    lists[i].reserve(array->Length());
+    for (uint32_t j = 0; j < array->Length(); j++) {
+      Local<Value> value;
+      if (!array->Get(env->context(), j).ToLocal(&value)) return;
+      CHECK(value->IsString());
+      lists[i].push_back(*node::Utf8Value(env->isolate(), value));
+    }
+  }
+  handler->RecordResolution(
+      key.ToString(), filename.ToString(), lists[0], lists[1]);
+}
+
 static void Stat(const FunctionCallbackInfo<Value>& args) {
   BindingData* binding_data = Environment::GetBindingData<BindingData>(args);
   Environment* env = binding_data->env();
@@ -2384,6 +2601,55 @@ static void Mkdtemp(const FunctionCallbackInfo<Value>& args) {
   }
 }
 
+BindingData::BindingData(Environment* env,
+                         Local<Object> wrap,
+                         const InternalFieldInfo* info)
+    : SnapshotableObject(env, wrap, EmbedderObjectType::k_fs_binding_data),
+      stats_field_array(env->isolate(),
+                        kFsStatsBufferLength,
+                        MAYBE_FIELD_PTR(info, stats_field_array)),
+      stats_field_bigint_array(env->isolate(),
+                               kFsStatsBufferLength,
+                               MAYBE_FIELD_PTR(info,
+                                               stats_field_bigint_array)) {
+  if (info != nullptr) {
+    stats_field_array.Deserialize(env->context());
+    stats_field_bigint_array.Deserialize(env->context());
+  }
+}
+
+void BindingData::PrepareForSerialization(Local<Context> context,
+                                          SnapshotCreator* creator) {
+  // The read requests are only kept around for reuse.
+  file_handle_read_wrap_freelist.clear();
+  CHECK_NULL(internal_field_info_);
+  internal_field_info_ =
+      InternalFieldInfo::New<InternalFieldInfo>(type());
+  internal_field_info_->stats_field_array =
+      stats_field_array.Serialize(context, creator);
+  internal_field_info_->stats_field_bigint_array =
+      stats_field_bigint_array.Serialize(context, creator);
+}
+
+node::InternalFieldInfo* BindingData::Serialize(int index) {
+  DCHECK_EQ(index, BaseObject::kSlot);
+  InternalFieldInfo* info = internal_field_info_;
+  internal_field_info_ = nullptr;
+  return info;
+}
+
+void BindingData::Deserialize(Local<Context> context,
+                              Local<Object> holder,
+                              int index,
+                              node::InternalFieldInfo* info) {
+  DCHECK_EQ(index, BaseObject::kSlot);
+  HandleScope scope(context->GetIsolate());
+  Environment* env = Environment::GetCurrent(context);
+  BindingData* binding = env->AddBindingData<BindingData>(
+      context, holder, static_cast<InternalFieldInfo*>(info));
+  CHECK_NOT_NULL(binding);
+}
+
 void BindingData::MemoryInfo(MemoryTracker* tracker) const {
   tracker->TrackField("stats_field_array", stats_field_array);
   tracker->TrackField("stats_field_bigint_array", stats_field_bigint_array);
@@ -2418,7 +2684,13 @@ void Initialize(Local<Object> target,
   env->SetMethod(target, "mkdir", MKDir);
   env->SetMethod(target, "readdir", ReadDir);
   env->SetMethod(target, "internalModuleReadJSON", InternalModuleReadJSON);
+  env->SetMethod(target,
+                 "internalModuleReadPackageJSON",
+                 InternalModuleReadPackageJSON);
   env->SetMethod(target, "internalModuleStat", InternalModuleStat);
+  env->SetMethod(target, "clearModuleStatCache", ClearModuleStatCache);
+  env->SetMethod(target, "lookupModuleResolution", LookupModuleResolution);
+  env->SetMethod(target, "recordModuleResolution", RecordModuleResolution);
   env->SetMethod(target, "stat", Stat);
   env->SetMethod(target, "lstat", LStat);
   env->SetMethod(target, "fstat", FStat);
@@ -2534,8 +2806,61 @@ void Initialize(Local<Object> target,
               use_promises_symbol).Check();
 }
 
+void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
+  registry->Register(Access);
+  registry->Register(Close);
+  registry->Register(Open);
+  registry->Register(OpenFileHandle);
+  registry->Register(Read);
+  registry->Register(ReadBuffers);
+  registry->Register(Fdatasync);
+  registry->Register(Fsync);
+  registry->Register(Rename);
+  registry->Register(FTruncate);
+  registry->Register(RMDir);
+  registry->Register(MKDir);
+  registry->Register(ReadDir);
+  registry->Register(InternalModuleReadJSON);
+  registry->Register(InternalModuleReadPackageJSON);
+  registry->Register(InternalModuleStat);
+  registry->Register(ClearModuleStatCache);
+  registry->Register(LookupModuleResolution);
+  registry->Register(RecordModuleResolution);
+  registry->Register(Stat);
+  registry->Register(LStat);
+  registry->Register(FStat);
+  registry->Register(Link);
+  registry->Register(Symlink);
+  registry->Register(ReadLink);
+  registry->Register(Unlink);
+  registry->Register(WriteBuffer);
+  registry->Register(WriteBuffers);
+  registry->Register(WriteString);
+  registry->Register(RealPath);
+  registry->Register(CopyFile);
+  registry->Register(Chmod);
+  registry->Register(FChmod);
+  registry->Register(Chown);
+  registry->Register(FChown);
+  registry->Register(LChown);
+  registry->Register(UTimes);
+  registry->Register(FUTimes);
+  registry->Register(LUTimes);
+  registry->Register(Mkdtemp);
+
+  StatWatcher::RegisterExternalReferences(registry);
+
+  registry->Register(NewFSReqCallback);
+
+  registry->Register(FileHandle::New);
+  registry->Register(FileHandle::Close);
+  registry->Register(FileHandle::ReleaseFD);
+  StreamBase::RegisterExternalReferences(registry);
+}
+
 }  // namespace fs
 
 }  // end namespace node
 
 NODE_MODULE_CONTEXT_AWARE_INTERNAL(fs, node::fs::Initialize)
+NODE_MODULE_EXTERNAL_REFERENCE(fs, node::fs::RegisterExternalReferences)
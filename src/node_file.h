@@ -6,20 +6,45 @@
 #include "node.h"
 #include "aliased_buffer.h"
 #include "node_messaging.h"
+#include "node_snapshotable.h"
 #include "stream_base.h"
 #include <iostream>
+#include <unordered_map>
 
 namespace node {
 namespace fs {
 
 class FileHandleReadWrap;
 
-class BindingData : public BaseObject {
+// Memoizes the results of internalModuleStat() while the CommonJS loader
+// resolves the modules of a top-level require() call. Once a directory is
+// known not to exist, or to be a file, the lookups of all the paths below
+// it are answered without a system call, which covers most of the
+// candidates that the loader tries in the node_modules directories of the
+// ancestors of a module.
+class ModuleStatCache {
  public:
-  explicit BindingData(Environment* env, v8::Local<v8::Object> wrap)
-      : BaseObject(env, wrap),
-        stats_field_array(env->isolate(), kFsStatsBufferLength),
-        stats_field_bigint_array(env->isolate(), kFsStatsBufferLength) {}
+  // Returns 0 for a file, 1 for a directory and a negative error code
+  // otherwise, like internalModuleStat().
+  int Stat(uv_loop_t* loop, const std::string& path);
+  void Clear() { results_.clear(); }
+
+  size_t size() const { return results_.size(); }
+
+ private:
+  std::unordered_map<std::string, int> results_;
+};
+
+class BindingData : public SnapshotableObject {
+ public:
+  struct InternalFieldInfo : public node::InternalFieldInfo {
+    AliasedBufferInfo stats_field_array;
+    AliasedBufferInfo stats_field_bigint_array;
+  };
+
+  BindingData(Environment* env,
+              v8::Local<v8::Object> wrap,
+              const InternalFieldInfo* info = nullptr);
 
   AliasedFloat64Array stats_field_array;
   AliasedBigUint64Array stats_field_bigint_array;
@@ -27,11 +52,24 @@ class BindingData : public BaseObject {
   std::vector<BaseObjectPtr<FileHandleReadWrap>>
       file_handle_read_wrap_freelist;
 
+  ModuleStatCache module_stat_cache;
+
   static constexpr FastStringKey binding_data_name { "fs" };
 
+  void PrepareForSerialization(v8::Local<v8::Context> context,
+                               v8::SnapshotCreator* creator) override;
+  node::InternalFieldInfo* Serialize(int index) override;
+  static void Deserialize(v8::Local<v8::Context> context,
+                          v8::Local<v8::Object> holder,
+                          int index,
+                          node::InternalFieldInfo* info);
+
   void MemoryInfo(MemoryTracker* tracker) const override;
   SET_SELF_SIZE(BindingData)
   SET_MEMORY_INFO_NAME(BindingData)
+
+ private:
+  InternalFieldInfo* internal_field_info_ = nullptr;
 };
 
 // structure used to store state during a complex operation, e.g., mkdirp.
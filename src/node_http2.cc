@@ -4,6 +4,7 @@
 #include "debug_utils-inl.h"
 #include "memory_tracker-inl.h"
 #include "node.h"
+#include "node_bob-inl.h"
 #include "node_buffer.h"
 #include "node_http2.h"
 #include "node_http_common-inl.h"
@@ -1889,6 +1890,7 @@ Http2Stream::~Http2Stream() {
 void Http2Stream::MemoryInfo(MemoryTracker* tracker) const {
   tracker->TrackField("current_headers", current_headers_);
   tracker->TrackField("queue", queue_);
+  tracker->TrackField("source", source_);
 }
 
 std::string Http2Stream::diagnostic_name() const {
@@ -1953,6 +1955,11 @@ void Http2Stream::Destroy() {
     FlushRstStream();
   set_destroyed();
 
+  // The source may still be reading, e.g. when the stream was reset in the
+  // middle of a file, in which case JavaScript has to close or release it.
+  if (source_)
+    StreamSource::Cancel(std::move(source_));
+
   Debug(this, "destroying stream");
 
   // Wait until the start of the next loop to delete because there
@@ -2334,6 +2341,58 @@ ssize_t Http2Stream::Provider::Stream::OnRead(nghttp2_session* handle,
   return amount;
 }
 
+void Http2Stream::PullFrom(StreamBase* source) {
+  CHECK(!source_);
+  source_ = std::make_unique<StreamSource>(
+      source,
+      [this]() { OnSourceReadable(); });
+  source_->Start();
+}
+
+void Http2Stream::SendBody(Local<ArrayBufferView> body) {
+  CHECK(!source_);
+  if (is_destroyed())
+    return;
+  ArrayBufferViewSource source(body);
+  PullAvailable(&source);
+}
+
+void Http2Stream::OnSourceReadable() {
+  if (is_destroyed() || !source_)
+    return;
+  PullAvailable(source_.get());
+}
+
+void Http2Stream::PullAvailable(bob::Source<uv_buf_t>* source) {
+  Http2Scope h2scope(this);
+  int status = bob::Status::STATUS_CONTINUE;
+  while (status == bob::Status::STATUS_CONTINUE) {
+    status = source->Pull(
+        [&](int, const uv_buf_t* bufs, size_t count, bob::Done done) {
+      // The Done callback releases all of the buffers, so it travels with
+      // the last one. Writes complete in order.
+      for (size_t n = 0; n < count; n++) {
+        IncrementAvailableOutboundLength(bufs[n].len);
+        if (n + 1 < count)
+          queue_.emplace(NgHttp2StreamWrite { bufs[n] });
+        else
+          queue_.emplace(NgHttp2StreamWrite { bufs[n], std::move(done) });
+      }
+    },
+    bob::Options::OPTIONS_SYNC,
+    nullptr,
+    0);
+  }
+
+  // Errors are reported to JavaScript by a StreamSource, which will close the
+  // stream. On END, or EOS when pulled again after END, the body is complete.
+  if (status == bob::Status::STATUS_END || status == bob::Status::STATUS_EOS)
+    set_not_writable();
+
+  CHECK_NE(nghttp2_session_resume_data(session_->session(), id_),
+           NGHTTP2_ERR_NOMEM);
+}
+
 void Http2Stream::IncrementAvailableOutboundLength(size_t amount) {
   available_outbound_length_ += amount;
   session_->IncrementCurrentSessionMemory(amount);
@@ -2566,6 +2625,24 @@ void Http2Stream::RstStream(const FunctionCallbackInfo<Value>& args) {
   stream->SubmitRstStream(code);
 }
 
+// Pulls the body of the stream from another StreamBase, e.g. a FileHandle.
+void Http2Stream::PullFrom(const FunctionCallbackInfo<Value>& args) {
+  Http2Stream* stream;
+  ASSIGN_OR_RETURN_UNWRAP(&stream, args.Holder());
+  CHECK(args[0]->IsObject());
+  StreamBase* source = StreamBase::FromObject(args[0].As<Object>());
+  CHECK_NOT_NULL(source);
+  stream->PullFrom(source);
+}
+
+// Sends an ArrayBufferView as the whole body of a response.
+void Http2Stream::SendBody(const FunctionCallbackInfo<Value>& args) {
+  Http2Stream* stream;
+  ASSIGN_OR_RETURN_UNWRAP(&stream, args.Holder());
+  CHECK(args[0]->IsArrayBufferView());
+  stream->SendBody(args[0].As<ArrayBufferView>());
+}
+
 // Initiates a response on the Http2Stream using the StreamBase API to provide
 // outbound DATA frames.
 void Http2Stream::Respond(const FunctionCallbackInfo<Value>& args) {
@@ -3034,6 +3111,8 @@ void Initialize(Local<Object> target,
   env->SetProtoMethod(stream, "trailers", Http2Stream::Trailers);
   env->SetProtoMethod(stream, "respond", Http2Stream::Respond);
   env->SetProtoMethod(stream, "rstStream", Http2Stream::RstStream);
+  env->SetProtoMethod(stream, "pullFrom", Http2Stream::PullFrom);
+  env->SetProtoMethod(stream, "sendBody", Http2Stream::SendBody);
   env->SetProtoMethod(stream, "refreshState", Http2Stream::RefreshState);
   stream->Inherit(AsyncWrap::GetConstructorTemplate(env));
   StreamBase::AddMethods(env, stream);
@@ -14,6 +14,7 @@
 #include "node_mem.h"
 #include "node_perf.h"
 #include "stream_base.h"
+#include "stream_source.h"
 #include "string_bytes.h"
 
 #include <algorithm>
@@ -146,10 +147,14 @@ using Http2RcBufferPointer = NgRcBufPointer<Http2RcBufferPointerTraits>;
 struct NgHttp2StreamWrite : public MemoryRetainer {
   BaseObjectPtr<AsyncWrap> req_wrap;
   uv_buf_t buf;
+  // Keeps data pulled from a bob::Source alive until it has been written.
+  bob::Done done;
 
   inline explicit NgHttp2StreamWrite(uv_buf_t buf_) : buf(buf_) {}
   inline NgHttp2StreamWrite(BaseObjectPtr<AsyncWrap> req_wrap, uv_buf_t buf_) :
       req_wrap(std::move(req_wrap)), buf(buf_) {}
+  inline NgHttp2StreamWrite(uv_buf_t buf_, bob::Done done_) :
+      buf(buf_), done(std::move(done_)) {}
 
   void MemoryInfo(MemoryTracker* tracker) const override;
   SET_MEMORY_INFO_NAME(NgHttp2StreamWrite)
@@ -298,6 +303,15 @@ class Http2Stream : public AsyncWrap,
   // Initiate a response on this stream.
   int SubmitResponse(const Http2Headers& headers, int options);
 
+  // Sends the data read from the given stream as the body of this stream,
+  // without going through the StreamBase write path. The writable side is
+  // shut down once the source stream has ended.
+  void PullFrom(StreamBase* source);
+
+  // Sends the memory of the given view as the rest of the body of this
+  // stream, without copying it, and shuts down the writable side.
+  void SendBody(v8::Local<v8::ArrayBufferView> body);
+
   // Submit informational headers for this stream
   int SubmitInfo(const Http2Headers& headers);
 
@@ -445,6 +459,8 @@ class Http2Stream : public AsyncWrap,
   static void Trailers(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Respond(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void RstStream(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void PullFrom(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SendBody(const v8::FunctionCallbackInfo<v8::Value>& args);
 
   class Provider;
 
@@ -469,6 +485,13 @@ class Http2Stream : public AsyncWrap,
 
   void EmitStatistics();
 
+  // Moves everything the source_ has read into queue_.
+  void OnSourceReadable();
+  // Moves everything that can be pulled from the source without blocking
+  // into queue_, and shuts down the writable side once the source has
+  // ended.
+  void PullAvailable(bob::Source<uv_buf_t>* source);
+
   BaseObjectWeakPtr<Http2Session> session_;     // The Parent HTTP/2 Session
   int32_t id_ = 0;                              // The Stream Identifier
   int32_t code_ = NGHTTP2_NO_ERROR;             // The RST_STREAM code (if any)
@@ -495,6 +518,9 @@ class Http2Stream : public AsyncWrap,
   std::queue<NgHttp2StreamWrite> queue_;
   size_t available_outbound_length_ = 0;
 
+  // Set when the body is pulled from another stream, see PullFrom().
+  std::unique_ptr<StreamSource> source_;
+
   Http2StreamListener stream_listener_;
 
   friend class Http2Session;
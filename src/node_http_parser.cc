@@ -25,6 +25,7 @@
 
 #include "async_wrap-inl.h"
 #include "env-inl.h"
+#include "histogram-inl.h"
 #include "memory_tracker-inl.h"
 #include "stream_base-inl.h"
 #include "v8.h"
@@ -32,6 +33,7 @@
 
 #include <cstdlib>  // free()
 #include <cstring>  // strdup(), strchr()
+#include <vector>
 
 
 // This is a binding to llhttp (https://github.com/nodejs/llhttp)
@@ -295,6 +297,8 @@ class Parser : public AsyncWrap, public StreamListener {
   int on_headers_complete() {
     header_nread_ = 0;
     header_parsing_start_time_ = 0;
+    if (request_histogram_)
+      request_start_times_.push_back(uv_hrtime());
 
     // Arguments for the on-headers-complete javascript callback. This
     // list needs to be kept in sync with the actual argument list for
@@ -486,6 +490,10 @@ class Parser : public AsyncWrap, public StreamListener {
     // it needs to be triggered manually.
     parser->EmitTraceEventDestroy();
     parser->EmitDestroy();
+
+    // Do not keep the histogram alive while the parser is in the free list.
+    parser->request_histogram_.reset();
+    parser->request_start_times_.clear();
   }
 
 
@@ -560,6 +568,10 @@ class Parser : public AsyncWrap, public StreamListener {
       headers_timeout = args[4].As<Number>()->Value();
     }
 
+    HistogramBase* request_histogram = nullptr;
+    if (args.Length() > 5 && args[5]->IsObject())
+      ASSIGN_OR_RETURN_UNWRAP(&request_histogram, args[5].As<Object>());
+
     llhttp_type_t type =
         static_cast<llhttp_type_t>(args[0].As<Int32>()->Value());
 
@@ -577,6 +589,20 @@ class Parser : public AsyncWrap, public StreamListener {
     parser->set_provider_type(provider);
     parser->AsyncReset(args[1].As<Object>());
     parser->Init(type, max_http_header_size, lenient, headers_timeout);
+    parser->request_histogram_.reset(request_histogram);
+  }
+
+  // Records the time since the headers of the oldest request that has not
+  // been responded to were complete. Called when the response to it has
+  // been sent.
+  static void RecordResponse(const FunctionCallbackInfo<Value>& args) {
+    Parser* parser;
+    ASSIGN_OR_RETURN_UNWRAP(&parser, args.Holder());
+    if (parser->request_start_times_.empty())
+      return;
+    uint64_t start = parser->request_start_times_.front();
+    parser->request_start_times_.erase(parser->request_start_times_.begin());
+    parser->request_histogram_->RecordValue(uv_hrtime() - start);
   }
 
   template <bool should_pause>
@@ -855,6 +881,7 @@ class Parser : public AsyncWrap, public StreamListener {
     max_http_header_size_ = max_http_header_size;
     header_parsing_start_time_ = 0;
     headers_timeout_ = headers_timeout;
+    request_start_times_.clear();
   }
 
 
@@ -907,6 +934,11 @@ class Parser : public AsyncWrap, public StreamListener {
   uint64_t max_http_header_size_;
   uint64_t headers_timeout_;
   uint64_t header_parsing_start_time_ = 0;
+  // Set on the parsers of servers with latency histograms. The times at
+  // which the headers of the requests that have not been responded to yet
+  // were complete, oldest first.
+  BaseObjectPtr<HistogramBase> request_histogram_;
+  std::vector<uint64_t> request_start_times_;
 
   BaseObjectPtr<BindingData> binding_data_;
 
@@ -998,6 +1030,7 @@ void InitializeHttpParser(Local<Object> target,
   env->SetProtoMethod(t, "consume", Parser::Consume);
   env->SetProtoMethod(t, "unconsume", Parser::Unconsume);
   env->SetProtoMethod(t, "getCurrentBuffer", Parser::GetCurrentBuffer);
+  env->SetProtoMethod(t, "recordResponse", Parser::RecordResponse);
 
   target->Set(env->context(),
               FIXED_ONE_BYTE_STRING(env->isolate(), "HTTPParser"),
@@ -198,7 +198,8 @@ v8::MaybeLocal<v8::Value> InternalMakeCallback(
     const v8::Local<v8::Function> callback,
     int argc,
     v8::Local<v8::Value> argv[],
-    async_context asyncContext);
+    async_context asyncContext,
+    v8::Local<v8::Value> context_frame = v8::Local<v8::Value>());
 
 class InternalCallbackScope {
  public:
@@ -212,10 +213,14 @@ class InternalCallbackScope {
     // compatibility issues, but it shouldn't.)
     kSkipTaskQueues = 2
   };
+  // If `context_frame` is not empty, it is entered for the duration of the
+  // scope, see AsyncWrap::context_frame().
   InternalCallbackScope(Environment* env,
                         v8::Local<v8::Object> object,
                         const async_context& asyncContext,
-                        int flags = kNoFlags);
+                        int flags = kNoFlags,
+                        v8::Local<v8::Value> context_frame =
+                            v8::Local<v8::Value>());
   // Utility that can be used by AsyncWrap classes.
   explicit InternalCallbackScope(AsyncWrap* async_wrap, int flags = 0);
   ~InternalCallbackScope();
@@ -228,6 +233,7 @@ class InternalCallbackScope {
   Environment* env_;
   async_context async_context_;
   v8::Local<v8::Object> object_;
+  v8::Local<v8::Value> prior_context_frame_;
   bool skip_hooks_;
   bool skip_task_queues_;
   bool failed_ = false;
@@ -363,6 +369,18 @@ class DiagnosticFilename {
   std::string filename_;
 };
 
+namespace tracing {
+// Writes the events of the flight recorder enabled with
+// --trace-event-flight-recorder to a new file in `directory`, or in the
+// current working directory if it is empty. `env` may be null. Returns the
+// path of the file, or an empty string if the flight recorder is not
+// enabled or the file could not be written. On fatal errors, nothing is
+// written if a lock that is needed is held, rather than risking a deadlock.
+std::string WriteFlightRecorder(Environment* env,
+                                const std::string& directory,
+                                bool fatal_error = false);
+}  // namespace tracing
+
 class TraceEventScope {
  public:
   TraceEventScope(const char* category,
@@ -388,6 +406,14 @@ using HeapSnapshotPointer =
 
 BaseObjectPtr<AsyncWrap> CreateHeapSnapshotStream(
     Environment* env, HeapSnapshotPointer&& snapshot);
+
+enum class HeapSnapshotCompression { kNone, kGzip, kZstd };
+// Takes a heap snapshot and writes it to `filename`. Returns false if the
+// file could not be written.
+bool WriteSnapshot(v8::Isolate* isolate,
+                   const char* filename,
+                   HeapSnapshotCompression compression =
+                       HeapSnapshotCompression::kNone);
 }  // namespace heap
 
 namespace fs {
@@ -5,6 +5,7 @@
 #include "node_external_reference.h"
 #include "node_internals.h"
 #include "node_options-inl.h"
+#include "node_snapshotable.h"
 #include "node_v8_platform-inl.h"
 #include "util-inl.h"
 #if defined(LEAK_SANITIZER)
@@ -22,7 +23,6 @@ using v8::HandleScope;
 using v8::Isolate;
 using v8::Local;
 using v8::Locker;
-using v8::Object;
 
 std::unique_ptr<ExternalReferenceRegistry> NodeMainInstance::registry_ =
     nullptr;
@@ -46,10 +46,17 @@ NodeMainInstance::NodeMainInstance(Isolate* isolate,
 }
 
 const std::vector<intptr_t>& NodeMainInstance::CollectExternalReferences() {
-  // Cannot be called more than once.
-  CHECK_NULL(registry_);
-  registry_.reset(new ExternalReferenceRegistry());
-  return registry_->external_references();
+  // The references are collected once, and then shared with the isolates of
+  // Workers that are deserialized from the same snapshot.
+  static Mutex mutex;
+  static const std::vector<intptr_t>* external_references = nullptr;
+  Mutex::ScopedLock lock(mutex);
+  if (external_references == nullptr) {
+    CHECK_NULL(registry_);
+    registry_.reset(new ExternalReferenceRegistry());
+    external_references = &registry_->external_references();
+  }
+  return *external_references;
 }
 
 std::unique_ptr<NodeMainInstance> NodeMainInstance::Create(
@@ -101,6 +108,8 @@ NodeMainInstance::NodeMainInstance(
                                                 platform,
                                                 array_buffer_allocator_.get(),
                                                 per_isolate_data_indexes);
+  if (deserialize_mode_)
+    isolate_data_->set_snapshot_blob(params->snapshot_blob);
   IsolateSettings s;
   SetIsolateMiscHandlers(isolate_, s);
   if (!deserialize_mode_) {
@@ -165,18 +174,6 @@ int NodeMainInstance::Run(const EnvSerializeInfo* env_info) {
   return exit_code;
 }
 
-void DeserializeNodeInternalFields(Local<Object> holder,
-                                   int index,
-                                   v8::StartupData payload,
-                                   void* env) {
-  if (payload.raw_size == 0) {
-    holder->SetAlignedPointerInInternalField(index, nullptr);
-    return;
-  }
-  // No embedder object in the builtin snapshot yet.
-  UNREACHABLE();
-}
-
 DeleteFnPtr<Environment, FreeEnvironment>
 NodeMainInstance::CreateMainEnvironment(int* exit_code,
                                         const EnvSerializeInfo* env_info) {
@@ -225,6 +222,9 @@ NodeMainInstance::CreateMainEnvironment(int* exit_code,
   Context::Scope context_scope(context);
 
   env->InitializeMainContext(context, env_info);
+  if (deserialize_mode_) {
+    env->RunDeserializeRequests();
+  }
 
 #if HAVE_INSPECTOR
   env->InitializeInspector({});
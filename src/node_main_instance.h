@@ -73,6 +73,14 @@ class NodeMainInstance {
   static const std::vector<intptr_t>& CollectExternalReferences();
 
   static const size_t kNodeContextIndex = 0;
+  // The template that the contexts of the vm module are deserialized from.
+  static const size_t kNodeVMContextIndex = 1;
+  // A context that has been initialized with NewContext(), which the main
+  // contexts of Workers are deserialized from.
+  static const size_t kNodeBaseContextIndex = 2;
+  // The contexts added with v8.startupSnapshot.addContextTemplate() while
+  // building a user-land snapshot start here, in the order they were added.
+  static const size_t kNodeVMContextTemplateIndex = 3;
   NodeMainInstance(const NodeMainInstance&) = delete;
   NodeMainInstance& operator=(const NodeMainInstance&) = delete;
   NodeMainInstance(NodeMainInstance&&) = delete;
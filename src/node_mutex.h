@@ -69,6 +69,8 @@ class MutexBase {
   inline MutexBase();
   inline ~MutexBase();
   inline void Lock();
+  // Returns false, without blocking, if the mutex is held by another thread.
+  inline bool TryLock();
   inline void Unlock();
 
   MutexBase(const MutexBase&) = delete;
@@ -164,6 +166,10 @@ struct LibuvMutexTraits {
     uv_mutex_lock(mutex);
   }
 
+  static inline int mutex_trylock(MutexT* mutex) {
+    return uv_mutex_trylock(mutex);
+  }
+
   static inline void mutex_unlock(MutexT* mutex) {
     uv_mutex_unlock(mutex);
   }
@@ -209,6 +215,11 @@ void MutexBase<Traits>::Lock() {
   Traits::mutex_lock(&mutex_);
 }
 
+template <typename Traits>
+bool MutexBase<Traits>::TryLock() {
+  return Traits::mutex_trylock(&mutex_) == 0;
+}
+
 template <typename Traits>
 void MutexBase<Traits>::Unlock() {
   Traits::mutex_unlock(&mutex_);
@@ -3,6 +3,7 @@
 
 #include "env-inl.h"
 #include "node_binding.h"
+#include "node_external_reference.h"
 #include "node_internals.h"
 
 #include <errno.h>
@@ -70,6 +71,9 @@ void PerProcessOptions::CheckOptions(std::vector<std::string>* errors) {
       use_largepages != "silent") {
     errors->push_back("invalid value for --use-largepages");
   }
+  if (trace_event_format != "json" && trace_event_format != "proto") {
+    errors->push_back("--trace-event-format must be \"json\" or \"proto\"");
+  }
   per_isolate->CheckOptions(errors);
 }
 
@@ -113,6 +117,12 @@ void EnvironmentOptions::CheckOptions(std::vector<std::string>* errors) {
     errors->push_back("invalid value for --unhandled-rejections");
   }
 
+  if (!heap_snapshot_compression.empty() &&
+      heap_snapshot_compression != "gzip" &&
+      heap_snapshot_compression != "zstd") {
+    errors->push_back("invalid value for --heapsnapshot-compression");
+  }
+
   if (tls_min_v1_3 && tls_max_v1_2) {
     errors->push_back("either --tls-min-v1.3 or --tls-max-v1.2 can be "
                       "used, not both");
@@ -268,6 +278,10 @@ DebugOptionsParser::DebugOptionsParser() {
 }
 
 EnvironmentOptionsParser::EnvironmentOptionsParser() {
+  AddOption("--compile-cache-dir",
+            "cache the compiled code of user modules in a directory",
+            &EnvironmentOptions::compile_cache_dir,
+            kAllowedInEnvironment);
   AddOption("--conditions",
             "additional user conditions for conditional exports and imports",
             &EnvironmentOptions::conditions,
@@ -283,6 +297,11 @@ EnvironmentOptionsParser::EnvironmentOptionsParser() {
             kAllowedInEnvironment);
   AddOption("--experimental-abortcontroller", "",
             NoOp{}, kAllowedInEnvironment);
+  AddOption("--experimental-async-context-frame",
+            "propagate the AsyncLocalStorage context natively instead of "
+            "through async_hooks",
+            &EnvironmentOptions::experimental_async_context_frame,
+            kAllowedInEnvironment);
   AddOption("--experimental-json-modules",
             "experimental JSON interop support for the ES Module loader",
             &EnvironmentOptions::experimental_json_modules,
@@ -341,6 +360,16 @@ EnvironmentOptionsParser::EnvironmentOptionsParser() {
             "Generate heap snapshot on specified signal",
             &EnvironmentOptions::heap_snapshot_signal,
             kAllowedInEnvironment);
+  AddOption("--cpu-prof-continuous-signal",
+            "start the continuous CPU profiler, and write its pprof profile "
+            "on specified signal",
+            &EnvironmentOptions::cpu_prof_continuous_signal,
+            kAllowedInEnvironment);
+  AddOption("--heapsnapshot-compression",
+            "compress the heap snapshots written on --heapsnapshot-signal "
+            "(gzip, zstd)",
+            &EnvironmentOptions::heap_snapshot_compression,
+            kAllowedInEnvironment);
   AddOption("--http-parser", "", NoOp{}, kAllowedInEnvironment);
   AddOption("--insecure-http-parser",
             "use an insecure HTTP parser that accepts invalid HTTP headers",
@@ -431,6 +460,11 @@ EnvironmentOptionsParser::EnvironmentOptionsParser() {
             "set the maximum size of HTTP headers (default: 16384 (16KB))",
             &EnvironmentOptions::max_http_header_size,
             kAllowedInEnvironment);
+  AddOption("--max-idle-worker-isolates",
+            "keep the isolates of up to this many stopped Workers, so that "
+            "they can be reused by new Workers (default: 0)",
+            &EnvironmentOptions::max_idle_worker_isolates,
+            kAllowedInEnvironment);
   AddOption("--redirect-warnings",
             "write warnings to file instead of stderr",
             &EnvironmentOptions::redirect_warnings,
@@ -634,6 +668,16 @@ PerProcessOptionsParser::PerProcessOptionsParser(
             "data, it supports ${rotation} and ${pid}.",
             &PerProcessOptions::trace_event_file_pattern,
             kAllowedInEnvironment);
+  AddOption("--trace-event-format",
+            "format of the trace-events data, either 'json' (default) or "
+            "'proto' (Perfetto protobuf)",
+            &PerProcessOptions::trace_event_format,
+            kAllowedInEnvironment);
+  AddOption("--trace-event-flight-recorder",
+            "keep the most recent trace events in memory instead of writing "
+            "them to a file",
+            &PerProcessOptions::trace_event_flight_recorder,
+            kAllowedInEnvironment);
   AddAlias("--trace-events-enabled", {
     "--trace-event-categories", "v8,node,node.async_hooks" });
   AddOption("--v8-pool-size",
@@ -653,6 +697,16 @@ PerProcessOptionsParser::PerProcessOptionsParser(
             "disable Object.prototype.__proto__",
             &PerProcessOptions::disable_proto,
             kAllowedInEnvironment);
+  AddOption("--build-snapshot",
+            "run the entry point script, and write a snapshot blob of "
+            "the application state to --snapshot-blob once it is done",
+            &PerProcessOptions::build_snapshot,
+            kDisallowedInEnvironment);
+  AddOption("--snapshot-blob",
+            "path of the snapshot blob written by --build-snapshot, or of "
+            "the snapshot blob to start the application from",
+            &PerProcessOptions::snapshot_blob,
+            kAllowedInEnvironment);
 
   // 12.x renamed this inadvertently, so alias it for consistency within the
   // release line, while using the original name for consistency with older
@@ -1012,6 +1066,10 @@ void Initialize(Local<Object> target,
       .Check();
 }
 
+void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
+  registry->Register(GetOptions);
+}
+
 }  // namespace options_parser
 
 void HandleEnvOptions(std::shared_ptr<EnvironmentOptions> env_options) {
@@ -1078,3 +1136,5 @@ std::vector<std::string> ParseNodeOptionsEnvVar(
 }  // namespace node
 
 NODE_MODULE_CONTEXT_AWARE_INTERNAL(options, node::options_parser::Initialize)
+NODE_MODULE_EXTERNAL_REFERENCE(options,
+                               node::options_parser::RegisterExternalReferences)
@@ -443,11 +443,21 @@ void Notify(const FunctionCallbackInfo<Value>& args) {
 // Return idle time of the event loop
 void LoopIdleTime(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
-  uint64_t idle_time = uv_metrics_idle_time(env->event_loop());
+  uint64_t idle_time = uv_metrics_idle_time(env->event_loop()) -
+      env->performance_state()->loop_idle_time_baseline;
   args.GetReturnValue().Set(1.0 * idle_time / 1e6);
 }
 
 
+// Creates a Histogram of latencies in nanoseconds, of up to one hour, that
+// is recorded into by native code, e.g. by the net and http servers.
+void CreateLatencyHistogram(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  BaseObjectPtr<HistogramBase> histogram = HistogramBase::New(env, 1, 3.6e12);
+  if (histogram)
+    args.GetReturnValue().Set(histogram->object());
+}
+
 // Event Loop Timing Histogram
 namespace {
 static void ELDHistogramMin(const FunctionCallbackInfo<Value>& args) {
@@ -637,6 +647,7 @@ void Initialize(Local<Object> target,
                  RemoveGarbageCollectionTracking);
   env->SetMethod(target, "notify", Notify);
   env->SetMethod(target, "loopIdleTime", LoopIdleTime);
+  env->SetMethod(target, "createLatencyHistogram", CreateLatencyHistogram);
 
   Local<Object> constants = Object::New(isolate);
 
@@ -708,6 +719,8 @@ void Initialize(Local<Object> target,
   env->SetProtoMethod(eldh, "reset", ELDHistogramReset);
   target->Set(context, eldh_classname,
               eldh->GetFunction(env->context()).ToLocalChecked()).Check();
+
+  RecordableHistogram::Initialize(env, target);
 }
 
 }  // namespace performance
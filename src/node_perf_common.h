@@ -73,6 +73,9 @@ class PerformanceState {
   AliasedUint32Array observers;
 
   uint64_t performance_last_gc_start_mark = 0;
+  // The idle time of the event loop before the Environment was created, e.g.
+  // when the loop is reused from a previous Worker.
+  uint64_t loop_idle_time_baseline = 0;
 
   void Mark(enum PerformanceMilestone milestone,
             uint64_t ts = PERFORMANCE_NOW());
@@ -107,6 +107,18 @@ std::string TriggerNodeReport(Isolate* isolate,
     }
   }
 
+  // Keep the recent trace events, if they are being recorded, next to the
+  // report.
+  {
+    std::string report_directory;
+    {
+      Mutex::ScopedLock lock(per_process::cli_options_mutex);
+      report_directory = per_process::cli_options->report_directory;
+    }
+    node::tracing::WriteFlightRecorder(env, report_directory,
+                                       strcmp(trigger, "FatalError") == 0);
+  }
+
   // Open the report file stream for writing. Supports stdout/err,
   // user-specified or (default) generated name
   std::ofstream outfile;
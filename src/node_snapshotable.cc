@@ -0,0 +1,670 @@
+#include "node_snapshotable.h"
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+#include "base_object-inl.h"
+#include "debug_utils-inl.h"
+#include "env-inl.h"
+#include "node_contextify.h"
+#include "node_errors.h"
+#include "node_external_reference.h"
+#include "node_file.h"
+#include "node_internals.h"
+#include "node_main_instance.h"
+#include "node_metadata.h"
+#include "node_process.h"
+#include "node_v8.h"
+#include "node_v8_platform-inl.h"
+
+namespace node {
+
+using v8::Context;
+using v8::Function;
+using v8::FunctionCallbackInfo;
+using v8::Global;
+using v8::HandleScope;
+using v8::Isolate;
+using v8::Local;
+using v8::Object;
+using v8::Script;
+using v8::ScriptCompiler;
+using v8::ScriptOrigin;
+using v8::SealHandleScope;
+using v8::SnapshotCreator;
+using v8::StartupData;
+using v8::String;
+using v8::Value;
+
+SnapshotData::~SnapshotData() {
+  delete[] blob.data;
+}
+
+namespace {
+
+// Writes the fields of a SnapshotData into a file, in the host's byte
+// order. Blobs are only ever read back by the same binary that wrote them,
+// which is checked through the version strings in the header.
+class BlobWriter {
+ public:
+  explicit BlobWriter(FILE* out) : out_(out) {}
+
+  void WriteBytes(const void* data, size_t size) {
+    if (ok_ && size > 0) ok_ = fwrite(data, size, 1, out_) == 1;
+  }
+
+  template <typename T>
+  void Write(const T& value) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Only trivially copyable values can be written as-is");
+    WriteBytes(&value, sizeof(value));
+  }
+
+  void Write(const std::string& str) {
+    Write<size_t>(str.size());
+    WriteBytes(str.data(), str.size());
+  }
+
+  template <typename T>
+  void Write(const std::vector<T>& vec) {
+    Write<size_t>(vec.size());
+    for (const T& item : vec) Write(item);
+  }
+
+  void Write(const PropInfo& info) {
+    Write(info.name);
+    Write<size_t>(info.id);
+    Write<SnapshotIndex>(info.index);
+  }
+
+  void Write(const EnvSerializeInfo& info) {
+    Write(info.native_modules);
+    Write<AliasedBufferInfo>(info.async_hooks.async_ids_stack);
+    Write<AliasedBufferInfo>(info.async_hooks.fields);
+    Write<AliasedBufferInfo>(info.async_hooks.async_id_fields);
+    Write<SnapshotIndex>(info.async_hooks.js_execution_async_resources);
+    Write(info.async_hooks.native_execution_async_resources);
+    Write<AliasedBufferInfo>(info.tick_info.fields);
+    Write<AliasedBufferInfo>(info.immediate_info.fields);
+    Write<AliasedBufferInfo>(info.performance_state.root);
+    Write<AliasedBufferInfo>(info.performance_state.milestones);
+    Write<AliasedBufferInfo>(info.performance_state.observers);
+    Write<AliasedBufferInfo>(info.stream_base_state);
+    Write<AliasedBufferInfo>(info.should_abort_on_uncaught_toggle);
+    Write(info.persistent_templates);
+    Write(info.persistent_values);
+    Write<SnapshotIndex>(info.context);
+  }
+
+  bool ok() const { return ok_; }
+
+ private:
+  FILE* out_;
+  bool ok_ = true;
+};
+
+class BlobReader {
+ public:
+  explicit BlobReader(FILE* in) : in_(in) {}
+
+  void ReadBytes(void* data, size_t size) {
+    if (ok_ && size > 0) ok_ = fread(data, size, 1, in_) == 1;
+  }
+
+  template <typename T>
+  void Read(T* value) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Only trivially copyable values can be read as-is");
+    ReadBytes(value, sizeof(*value));
+  }
+
+  void Read(std::string* str) {
+    size_t size = 0;
+    Read(&size);
+    // Guard against allocating huge amounts of memory for a corrupt file.
+    if (!ok_ || size > kMaxStringLength) {
+      ok_ = false;
+      return;
+    }
+    str->resize(size);
+    ReadBytes(&(*str)[0], size);
+  }
+
+  template <typename T>
+  void Read(std::vector<T>* vec) {
+    size_t size = 0;
+    Read(&size);
+    if (!ok_ || size > kMaxVectorLength) {
+      ok_ = false;
+      return;
+    }
+    vec->resize(size);
+    for (size_t i = 0; i < size && ok_; i++) Read(&(*vec)[i]);
+  }
+
+  void Read(PropInfo* info) {
+    Read(&info->name);
+    Read(&info->id);
+    Read(&info->index);
+  }
+
+  void Read(EnvSerializeInfo* info) {
+    Read(&info->native_modules);
+    Read(&info->async_hooks.async_ids_stack);
+    Read(&info->async_hooks.fields);
+    Read(&info->async_hooks.async_id_fields);
+    Read(&info->async_hooks.js_execution_async_resources);
+    Read(&info->async_hooks.native_execution_async_resources);
+    Read(&info->tick_info.fields);
+    Read(&info->immediate_info.fields);
+    Read(&info->performance_state.root);
+    Read(&info->performance_state.milestones);
+    Read(&info->performance_state.observers);
+    Read(&info->stream_base_state);
+    Read(&info->should_abort_on_uncaught_toggle);
+    Read(&info->persistent_templates);
+    Read(&info->persistent_values);
+    Read(&info->context);
+  }
+
+  bool ok() const { return ok_; }
+
+ private:
+  static constexpr size_t kMaxStringLength = 1 << 20;
+  static constexpr size_t kMaxVectorLength = 1 << 20;
+
+  FILE* in_;
+  bool ok_ = true;
+};
+
+}  // anonymous namespace
+
+bool SnapshotData::ToBlob(FILE* out) const {
+  BlobWriter w(out);
+  w.Write<uint32_t>(kMagic);
+  w.Write(per_process::metadata.versions.node);
+  w.Write(per_process::metadata.versions.v8);
+  w.Write(per_process::metadata.arch);
+  w.Write(per_process::metadata.platform);
+
+  w.Write<int>(blob.raw_size);
+  w.WriteBytes(blob.data, blob.raw_size);
+  w.Write(isolate_data_indices);
+  w.Write(env_info);
+  return w.ok();
+}
+
+bool SnapshotData::FromBlob(SnapshotData* out, FILE* in) {
+  BlobReader r(in);
+  uint32_t magic = 0;
+  r.Read(&magic);
+  if (!r.ok() || magic != kMagic) {
+    fprintf(stderr, "The file is not a snapshot blob\n");
+    return false;
+  }
+
+  std::string node_version, v8_version, arch, platform;
+  r.Read(&node_version);
+  r.Read(&v8_version);
+  r.Read(&arch);
+  r.Read(&platform);
+  if (!r.ok()) {
+    fprintf(stderr, "The snapshot blob is corrupted\n");
+    return false;
+  }
+  if (node_version != per_process::metadata.versions.node ||
+      v8_version != per_process::metadata.versions.v8 ||
+      arch != per_process::metadata.arch ||
+      platform != per_process::metadata.platform) {
+    fprintf(stderr,
+            "The snapshot blob was built by Node.js v%s (V8 %s, %s-%s) and "
+            "cannot be used by Node.js v%s (V8 %s, %s-%s)\n",
+            node_version.c_str(),
+            v8_version.c_str(),
+            platform.c_str(),
+            arch.c_str(),
+            per_process::metadata.versions.node.c_str(),
+            per_process::metadata.versions.v8.c_str(),
+            per_process::metadata.platform.c_str(),
+            per_process::metadata.arch.c_str());
+    return false;
+  }
+
+  int raw_size = 0;
+  r.Read(&raw_size);
+  if (!r.ok() || raw_size <= 0) {
+    fprintf(stderr, "The snapshot blob is corrupted\n");
+    return false;
+  }
+  char* data = new char[raw_size];
+  r.ReadBytes(data, raw_size);
+  delete[] out->blob.data;
+  out->blob.data = data;
+  out->blob.raw_size = raw_size;
+
+  r.Read(&out->isolate_data_indices);
+  r.Read(&out->env_info);
+  if (!r.ok()) {
+    fprintf(stderr, "The snapshot blob is corrupted\n");
+    return false;
+  }
+  return true;
+}
+
+template <typename T>
+void WriteVector(std::stringstream* ss, const T* vec, size_t size) {
+  for (size_t i = 0; i < size; i++) {
+    *ss << std::to_string(vec[i]) << (i == size - 1 ? '\n' : ',');
+  }
+}
+
+static std::string FormatBlob(const SnapshotData& data) {
+  std::stringstream ss;
+
+  ss << R"(#include <cstddef>
+#include "env.h"
+#include "node_main_instance.h"
+#include "v8.h"
+
+// This file is generated by tools/snapshot. Do not edit.
+
+namespace node {
+
+static const char blob_data[] = {
+)";
+  WriteVector(&ss, data.blob.data, data.blob.raw_size);
+  ss << R"(};
+
+static const int blob_size = )"
+     << data.blob.raw_size << R"(;
+static v8::StartupData blob = { blob_data, blob_size };
+)";
+
+  ss << R"(v8::StartupData* NodeMainInstance::GetEmbeddedSnapshotBlob() {
+  return &blob;
+}
+
+static const std::vector<size_t> isolate_data_indexes {
+)";
+  WriteVector(&ss,
+              data.isolate_data_indices.data(),
+              data.isolate_data_indices.size());
+  ss << R"(};
+
+const std::vector<size_t>* NodeMainInstance::GetIsolateDataIndexes() {
+  return &isolate_data_indexes;
+}
+
+static const EnvSerializeInfo env_info )"
+     << data.env_info << R"(;
+
+const EnvSerializeInfo* NodeMainInstance::GetEnvSerializeInfo() {
+  return &env_info;
+}
+
+}  // namespace node
+)";
+
+  return ss.str();
+}
+
+namespace {
+
+// Passed to the internal field serializer of the main context.
+struct SerializeContextData {
+  Environment* env;
+  // The BaseObjects of the Environment, keyed by the pointer stored in their
+  // internal field.
+  std::unordered_map<void*, BaseObject*> base_objects;
+  std::vector<std::string> errors;
+};
+
+// The contexts added with v8.startupSnapshot.addContextTemplate(), which are
+// added to the snapshot after the ones of Node.js. Only one snapshot is built
+// per process.
+std::vector<Global<Context>> context_templates;
+
+}  // anonymous namespace
+
+static StartupData SerializeNodeContextInternalFields(Local<Object> holder,
+                                                      int index,
+                                                      void* callback_data) {
+  SerializeContextData* data =
+      static_cast<SerializeContextData*>(callback_data);
+  void* ptr = holder->GetAlignedPointerFromInternalField(index);
+  if (ptr == nullptr || ptr == data->env) {
+    return StartupData{nullptr, 0};
+  }
+
+  auto it = data->base_objects.find(ptr);
+  if (it == data->base_objects.end()) {
+    data->errors.push_back("Cannot include an unknown native object in the "
+                           "snapshot");
+    return StartupData{nullptr, 0};
+  }
+
+  BaseObject* obj = it->second;
+  if (!obj->is_snapshotable()) {
+    data->errors.push_back(std::string("Cannot include ") +
+                           obj->MemoryInfoName() + " in the snapshot");
+    return StartupData{nullptr, 0};
+  }
+
+  SnapshotableObject* snapshotable = static_cast<SnapshotableObject*>(obj);
+  per_process::Debug(DebugCategory::MKSNAPSHOT,
+                     "Serializing %s %p, index=%d\n",
+                     snapshotable->GetTypeName(),
+                     ptr,
+                     index);
+  InternalFieldInfo* info = snapshotable->Serialize(index);
+  // V8 takes ownership of the data, and frees it with delete[].
+  return StartupData{reinterpret_cast<const char*>(info),
+                     static_cast<int>(info->length)};
+}
+
+void DeserializeNodeInternalFields(Local<Object> holder,
+                                   int index,
+                                   StartupData payload,
+                                   void* env) {
+  if (payload.raw_size == 0) {
+    holder->SetAlignedPointerInInternalField(index, nullptr);
+    return;
+  }
+
+  Environment* env_ptr = static_cast<Environment*>(env);
+  InternalFieldInfo* info = InternalFieldInfo::Copy(payload);
+  switch (info->type) {
+#define V(PropertyName, NativeTypeName)                                        \
+  case EmbedderObjectType::k_##PropertyName: {                                 \
+    per_process::Debug(DebugCategory::MKSNAPSHOT,                              \
+                       "Object %p is %s\n",                                    \
+                       (*holder),                                              \
+                       #NativeTypeName);                                       \
+    env_ptr->EnqueueDeserializeRequest(                                        \
+        NativeTypeName::Deserialize, holder, index, info);                     \
+    break;                                                                     \
+  }
+    SERIALIZABLE_OBJECT_TYPES(V)
+#undef V
+    default: {
+      UNREACHABLE();
+    }
+  }
+
+  // The C++ object is recreated once the Environment is ready, see
+  // Environment::RunDeserializeRequests().
+  holder->SetAlignedPointerInInternalField(index, nullptr);
+}
+
+// Runs the entry point passed to --build-snapshot, and spins the event loop
+// until it is empty, like SpinEventLoop() but without emitting 'exit' as the
+// process is going to be serialized instead.
+static int RunSnapshotEntryPoint(Environment* env) {
+  MultiIsolatePlatform* platform = per_process::v8_platform.Platform();
+
+  if (LoadEnvironment(env, StartExecutionCallback{}).IsEmpty()) return 1;
+
+  SealHandleScope seal(env->isolate());
+  bool more;
+  do {
+    if (env->is_stopping()) break;
+    uv_run(env->event_loop(), UV_RUN_DEFAULT);
+    if (env->is_stopping()) break;
+
+    platform->DrainTasks(env->isolate());
+
+    more = uv_loop_alive(env->event_loop());
+    if (more && !env->is_stopping()) continue;
+
+    if (EmitProcessBeforeExit(env).IsNothing())
+      break;
+
+    more = uv_loop_alive(env->event_loop());
+  } while (more == true && !env->is_stopping());
+
+  return env->is_stopping() ? 1 : 0;
+}
+
+int SnapshotBuilder::Generate(SnapshotData* out,
+                              const std::vector<std::string> args,
+                              const std::vector<std::string> exec_args) {
+  Isolate* isolate = Isolate::Allocate();
+  per_process::v8_platform.Platform()->RegisterIsolate(isolate,
+                                                       uv_default_loop());
+  std::unique_ptr<NodeMainInstance> main_instance;
+  int exit_code = 0;
+
+  {
+    const std::vector<intptr_t>& external_references =
+        NodeMainInstance::CollectExternalReferences();
+    SnapshotCreator creator(isolate, external_references.data());
+    Environment* env;
+    SerializeContextData data;
+    {
+      main_instance =
+          NodeMainInstance::Create(isolate,
+                                   uv_default_loop(),
+                                   per_process::v8_platform.Platform(),
+                                   args,
+                                   exec_args);
+
+      HandleScope scope(isolate);
+      creator.SetDefaultContext(Context::New(isolate));
+      out->isolate_data_indices =
+          main_instance->isolate_data()->Serialize(&creator);
+
+      Local<Context> context = NewContext(isolate);
+      Context::Scope context_scope(context);
+
+      env = new Environment(main_instance->isolate_data(),
+                            context,
+                            args,
+                            exec_args,
+                            nullptr,
+                            node::EnvironmentFlags::kDefaultFlags,
+                            {});
+      data.env = env;
+      if (env->RunBootstrapping().IsEmpty()) {
+        exit_code = 1;
+      } else if (per_process::cli_options->build_snapshot) {
+        SetIsolateUpForNode(isolate);
+        exit_code = RunSnapshotEntryPoint(env);
+        // The listener is stored in the heap, and it is set up again by
+        // NodeMainInstance when the snapshot is deserialized.
+        isolate->RemoveMessageListeners(errors::PerIsolateMessageListener);
+      }
+
+      // The context that vm contexts are deserialized from. It has to be
+      // created before the Environment is serialized, which includes the
+      // template of its global object.
+      Local<Context> vm_context;
+      if (exit_code == 0 &&
+          !contextify::ContextifyContext::CreateTemplateContext(env)
+               .ToLocal(&vm_context)) {
+        exit_code = 1;
+      }
+
+      if (exit_code == 0) {
+        if (per_process::enabled_debug_list.enabled(
+                DebugCategory::MKSNAPSHOT)) {
+          env->PrintAllBaseObjects();
+          printf("Environment = %p\n", env);
+        }
+        env->ForEachBaseObject([&](BaseObject* obj) {
+          data.base_objects.emplace(obj, obj);
+          if (obj->is_snapshotable()) {
+            static_cast<SnapshotableObject*>(obj)->PrepareForSerialization(
+                context, &creator);
+          }
+        });
+        out->env_info = env->Serialize(&creator);
+        size_t index = creator.AddContext(
+            context, {SerializeNodeContextInternalFields, &data});
+        CHECK_EQ(index, NodeMainInstance::kNodeContextIndex);
+        index = creator.AddContext(vm_context);
+        CHECK_EQ(index, NodeMainInstance::kNodeVMContextIndex);
+        index = creator.AddContext(NewContext(isolate));
+        CHECK_EQ(index, NodeMainInstance::kNodeBaseContextIndex);
+        for (size_t i = 0; i < context_templates.size(); i++) {
+          index = creator.AddContext(context_templates[i].Get(isolate));
+          CHECK_EQ(index, NodeMainInstance::kNodeVMContextTemplateIndex + i);
+        }
+      }
+      // Not needed anymore, and they must not outlive the isolate.
+      context_templates.clear();
+    }
+
+    // Must be out of HandleScope
+    StartupData blob =
+        creator.CreateBlob(SnapshotCreator::FunctionCodeHandling::kClear);
+    if (exit_code == 0 && !data.errors.empty()) {
+      for (const std::string& error : data.errors) {
+        fprintf(stderr, "%s\n", error.c_str());
+      }
+      exit_code = 1;
+    }
+    if (exit_code == 0) {
+      CHECK(blob.CanBeRehashed());
+      delete[] out->blob.data;
+      out->blob = blob;
+    } else {
+      delete[] blob.data;
+    }
+    // Must be done while the snapshot creator isolate is entered i.e. the
+    // creator is still alive.
+    FreeEnvironment(env);
+    main_instance->Dispose();
+  }
+
+  per_process::v8_platform.Platform()->UnregisterIsolate(isolate);
+  return exit_code;
+}
+
+std::string SnapshotBuilder::Generate(
+    const std::vector<std::string> args,
+    const std::vector<std::string> exec_args) {
+  SnapshotData data;
+  int exit_code = Generate(&data, args, exec_args);
+  CHECK_EQ(exit_code, 0);
+  return FormatBlob(data);
+}
+
+int SnapshotBuilder::GenerateAsBlob(const std::string& snapshot_blob_path,
+                                    const std::vector<std::string> args,
+                                    const std::vector<std::string> exec_args) {
+  SnapshotData data;
+  int exit_code = Generate(&data, args, exec_args);
+  if (exit_code != 0) return exit_code;
+
+  FILE* fp = fopen(snapshot_blob_path.c_str(), "wb");
+  if (fp == nullptr) {
+    fprintf(stderr,
+            "Cannot open %s for writing the snapshot blob: %s\n",
+            snapshot_blob_path.c_str(),
+            strerror(errno));
+    return 1;
+  }
+  bool ok = data.ToBlob(fp);
+  ok = fclose(fp) == 0 && ok;
+  if (!ok) {
+    fprintf(stderr,
+            "Cannot write the snapshot blob to %s\n",
+            snapshot_blob_path.c_str());
+    return 1;
+  }
+  return 0;
+}
+
+InternalFieldInfo* InternalFieldInfo::Copy(const StartupData& payload) {
+  CHECK_GE(payload.raw_size, static_cast<int>(sizeof(InternalFieldInfo)));
+  char* data = new char[payload.raw_size];
+  memcpy(data, payload.data, payload.raw_size);
+  InternalFieldInfo* result = reinterpret_cast<InternalFieldInfo*>(data);
+  CHECK_EQ(result->length, static_cast<size_t>(payload.raw_size));
+  return result;
+}
+
+SnapshotableObject::SnapshotableObject(Environment* env,
+                                       Local<Object> wrap,
+                                       EmbedderObjectType type)
+    : BaseObject(env, wrap), type_(type) {}
+
+const char* SnapshotableObject::GetTypeName() const {
+  switch (type_) {
+#define V(PropertyName, NativeTypeName)                                        \
+  case EmbedderObjectType::k_##PropertyName: {                                 \
+    return #NativeTypeName;                                                    \
+  }
+    SERIALIZABLE_OBJECT_TYPES(V)
+#undef V
+    default: {
+      UNREACHABLE();
+    }
+  }
+}
+
+namespace mksnapshot {
+
+static void SetDeserializeMainFunction(
+    const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsFunction());
+  env->set_snapshot_deserialize_main(args[0].As<Function>());
+}
+
+// addContextTemplate(code, filename) runs `code` in a new context made from
+// the vm global template, which is added to the snapshot. Returns the
+// position of the context template, which vm.createContext() deserializes
+// the context from.
+static void AddContextTemplate(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(per_process::cli_options->build_snapshot);
+  CHECK(args[0]->IsString());
+  CHECK(args[1]->IsString());
+
+  Local<Context> context;
+  if (!contextify::ContextifyContext::CreateTemplateContext(env)
+           .ToLocal(&context)) {
+    return;
+  }
+
+  {
+    Context::Scope context_scope(context);
+    ScriptOrigin origin(args[1].As<String>());
+    ScriptCompiler::Source source(args[0].As<String>(), origin);
+    Local<Script> script;
+    // The exception, if any, is thrown to the caller.
+    if (!ScriptCompiler::Compile(context, &source).ToLocal(&script) ||
+        script->Run(context).IsEmpty()) {
+      return;
+    }
+  }
+
+  context_templates.emplace_back(env->isolate(), context);
+  args.GetReturnValue().Set(
+      static_cast<uint32_t>(context_templates.size() - 1));
+}
+
+void Initialize(Local<Object> target,
+                Local<Value> unused,
+                Local<Context> context,
+                void* priv) {
+  Environment* env = Environment::GetCurrent(context);
+  env->SetMethod(
+      target, "setDeserializeMainFunction", SetDeserializeMainFunction);
+  env->SetMethod(target, "addContextTemplate", AddContextTemplate);
+}
+
+void RegisterExternalReferences(ExternalReferenceRegistry* registry) {
+  registry->Register(SetDeserializeMainFunction);
+  registry->Register(AddContextTemplate);
+  // Passed to internal/main/mksnapshot, which may keep it alive in the heap.
+  registry->Register(MarkBootstrapComplete);
+}
+
+}  // namespace mksnapshot
+}  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_INTERNAL(mksnapshot, node::mksnapshot::Initialize)
+NODE_MODULE_EXTERNAL_REFERENCE(mksnapshot,
+                               node::mksnapshot::RegisterExternalReferences)
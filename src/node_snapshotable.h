@@ -0,0 +1,151 @@
+#ifndef SRC_NODE_SNAPSHOTABLE_H_
+#define SRC_NODE_SNAPSHOTABLE_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include "base_object.h"
+#include "env.h"
+#include "util.h"
+#include "v8.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace node {
+
+class Environment;
+class ExternalReferenceRegistry;
+
+// The data needed to start a Node.js instance from a V8 startup snapshot:
+// the snapshot blob itself, and the indices of the per-isolate and
+// per-environment data that has been added to it.
+struct SnapshotData {
+  SnapshotData() = default;
+  ~SnapshotData();
+  SnapshotData(const SnapshotData&) = delete;
+  SnapshotData& operator=(const SnapshotData&) = delete;
+
+  // A blob written by ToBlob() starts with this, followed by the version of
+  // Node.js and V8 it was built with, which need to match exactly when it
+  // is deserialized.
+  static constexpr uint32_t kMagic = 0x0f0e5e0d;
+
+  v8::StartupData blob = {nullptr, 0};
+  std::vector<size_t> isolate_data_indices;
+  EnvSerializeInfo env_info;
+
+  // Writes the snapshot data into a file. Returns false on failure.
+  bool ToBlob(FILE* out) const;
+  // Reads snapshot data written by ToBlob(). Returns false, and prints the
+  // reason to stderr, if the file is not a snapshot blob, or was built with
+  // a different version of Node.js.
+  static bool FromBlob(SnapshotData* out, FILE* in);
+};
+
+class SnapshotBuilder {
+ public:
+  // Builds the snapshot of Node.js's own bootstrap and returns it as a C++
+  // source file that can be compiled into the binary. Used by
+  // node_mksnapshot.
+  static std::string Generate(const std::vector<std::string> args,
+                              const std::vector<std::string> exec_args);
+
+  // Builds a snapshot and stores it in `out`. With --build-snapshot, the
+  // entry point in `args` (e.g. `node --build-snapshot entry.js`) is run
+  // with internal/main/mksnapshot after bootstrapping, and the event loop is
+  // run until it is empty before the heap is serialized. Returns an exit
+  // code.
+  static int Generate(SnapshotData* out,
+                      const std::vector<std::string> args,
+                      const std::vector<std::string> exec_args);
+
+  // Builds a snapshot as above, and writes it to `snapshot_blob_path`.
+  static int GenerateAsBlob(const std::string& snapshot_blob_path,
+                            const std::vector<std::string> args,
+                            const std::vector<std::string> exec_args);
+};
+
+// The types of BaseObjects that can be included in a user-land snapshot.
+// Each of them is identified in the payload of the internal field, so that
+// the matching C++ object can be recreated when the snapshot is
+// deserialized.
+#define SERIALIZABLE_OBJECT_TYPES(V)                                           \
+  V(fs_binding_data, fs::BindingData)                                          \
+  V(v8_binding_data, v8_utils::BindingData)                                    \
+  V(compiled_fn_entry, contextify::CompiledFnEntry)
+
+enum class EmbedderObjectType : uint8_t {
+  k_default = 0,
+#define V(PropertyName, NativeType) k_##PropertyName,
+  SERIALIZABLE_OBJECT_TYPES(V)
+#undef V
+};
+
+// The payload stored in the snapshot for an internal field of a
+// SnapshotableObject. Subclasses append their own data to this header,
+// the whole struct has to be trivially copyable.
+struct InternalFieldInfo {
+  EmbedderObjectType type;
+  size_t length;  // Length of the whole payload, including this header.
+
+  template <typename T>
+  static T* New(EmbedderObjectType type) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "InternalFieldInfo must be trivially copyable");
+    T* result = reinterpret_cast<T*>(new char[sizeof(T)]());
+    result->type = type;
+    result->length = sizeof(T);
+    return result;
+  }
+
+  // Copies a payload handed out by V8 during deserialization, which is
+  // only valid for the duration of the deserialization callback.
+  static InternalFieldInfo* Copy(const v8::StartupData& payload);
+
+  void Delete() { delete[] reinterpret_cast<char*>(this); }
+};
+
+// A BaseObject that can be serialized into a user-land snapshot. Before the
+// heap is serialized, PrepareForSerialization() is called on each of them
+// so that they can add the V8 data they hold on to (e.g. the typed arrays
+// of their AliasedBuffers) to the snapshot. Serialize() is then called from
+// the internal field callback of the SnapshotCreator, and returns a payload
+// that describes the object. When the snapshot is deserialized, the static
+// `Deserialize(context, holder, index, info)` of the type is called once
+// the Environment is ready, and recreates the C++ object.
+class SnapshotableObject : public BaseObject {
+ public:
+  SnapshotableObject(Environment* env,
+                     v8::Local<v8::Object> wrap,
+                     EmbedderObjectType type);
+
+  const char* GetTypeName() const;
+  EmbedderObjectType type() const { return type_; }
+
+  bool is_snapshotable() const override { return true; }
+
+  virtual void PrepareForSerialization(v8::Local<v8::Context> context,
+                                       v8::SnapshotCreator* creator) = 0;
+  // Returns a payload allocated with InternalFieldInfo::New(). Ownership
+  // is passed to the caller.
+  virtual InternalFieldInfo* Serialize(int index) = 0;
+
+ private:
+  EmbedderObjectType type_;
+};
+
+void DeserializeNodeInternalFields(v8::Local<v8::Object> holder,
+                                   int index,
+                                   v8::StartupData payload,
+                                   void* env);
+
+namespace mksnapshot {
+void RegisterExternalReferences(ExternalReferenceRegistry* registry);
+}  // namespace mksnapshot
+
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_NODE_SNAPSHOTABLE_H_
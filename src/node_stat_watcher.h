@@ -35,10 +35,12 @@ class BindingData;
 }
 
 class Environment;
+class ExternalReferenceRegistry;
 
 class StatWatcher : public HandleWrap {
  public:
   static void Initialize(Environment* env, v8::Local<v8::Object> target);
+  static void RegisterExternalReferences(ExternalReferenceRegistry* registry);
 
  protected:
   StatWatcher(fs::BindingData* binding_data,
@@ -100,6 +100,7 @@ static void EnqueueMicrotask(const FunctionCallbackInfo<Value>& args) {
 }
 
 static void RunMicrotasks(const FunctionCallbackInfo<Value>& args) {
+  TRACE_EVENT0(TRACING_CATEGORY_NODE1(loop), "RunMicrotasks");
   MicrotasksScope::PerformCheckpoint(args.GetIsolate());
 }
 
@@ -22,6 +22,7 @@ using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
 using v8::Local;
 using v8::NewStringType;
+using v8::Number;
 using v8::Object;
 using v8::String;
 using v8::Value;
@@ -112,6 +113,62 @@ void GetEnabledCategories(const FunctionCallbackInfo<Value>& args) {
   }
 }
 
+namespace tracing {
+std::string WriteFlightRecorder(Environment* env,
+                                const std::string& directory,
+                                bool fatal_error) {
+  Agent* agent = TraceEventHelper::GetAgent();
+  if (agent == nullptr || !agent->IsFlightRecorderEnabled())
+    return "";
+  std::string filename = *DiagnosticFilename(
+      env != nullptr ? env->thread_id() : 0, "trace", "log");
+  if (!directory.empty())
+    filename = directory + kPathSeparator + filename;
+  int err = agent->DumpFlightRecorder(filename, 0, fatal_error);
+  if (err != 0) {
+    FPrintF(stderr, "Failed to write trace events to %s: %s\n",
+            filename, uv_strerror(err));
+    return "";
+  }
+  FPrintF(stderr, "Wrote trace events to %s\n", filename);
+  return filename;
+}
+}  // namespace tracing
+
+static void IsFlightRecorderEnabled(const FunctionCallbackInfo<Value>& args) {
+  tracing::Agent* agent = tracing::TraceEventHelper::GetAgent();
+  args.GetReturnValue().Set(agent != nullptr &&
+                            agent->IsFlightRecorderEnabled());
+}
+
+// dumpFlightRecorder(filename, durationMs) writes the events recorded in the
+// last `durationMs` milliseconds, or all of them if it is 0, to `filename`,
+// or to a generated file name if it is undefined. Returns the file name.
+static void DumpFlightRecorder(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  tracing::Agent* agent = tracing::TraceEventHelper::GetAgent();
+  CHECK(agent != nullptr && agent->IsFlightRecorderEnabled());
+  CHECK(args[1]->IsNumber());
+
+  std::string filename;
+  if (args[0]->IsUndefined()) {
+    filename = *DiagnosticFilename(env, "trace", "log");
+  } else {
+    CHECK(args[0]->IsString());
+    filename = *Utf8Value(env->isolate(), args[0]);
+  }
+  uint64_t duration_ms =
+      static_cast<uint64_t>(args[1].As<Number>()->Value());
+  int err = agent->DumpFlightRecorder(filename, duration_ms);
+  if (err != 0)
+    return env->ThrowUVException(err, "open", nullptr, filename.c_str());
+  args.GetReturnValue().Set(
+      String::NewFromUtf8(env->isolate(),
+                          filename.c_str(),
+                          NewStringType::kNormal,
+                          filename.size()).ToLocalChecked());
+}
+
 static void SetTraceCategoryStateUpdateHandler(
     const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
@@ -126,6 +183,8 @@ void NodeCategorySet::Initialize(Local<Object> target,
   Environment* env = Environment::GetCurrent(context);
 
   env->SetMethod(target, "getEnabledCategories", GetEnabledCategories);
+  env->SetMethod(target, "isFlightRecorderEnabled", IsFlightRecorderEnabled);
+  env->SetMethod(target, "dumpFlightRecorder", DumpFlightRecorder);
   env->SetMethod(
       target, "setTraceCategoryStateUpdateHandler",
       SetTraceCategoryStateUpdateHandler);
@@ -160,6 +219,8 @@ void NodeCategorySet::Initialize(Local<Object> target,
 void NodeCategorySet::RegisterExternalReferences(
     ExternalReferenceRegistry* registry) {
   registry->Register(GetEnabledCategories);
+  registry->Register(IsFlightRecorderEnabled);
+  registry->Register(DumpFlightRecorder);
   registry->Register(SetTraceCategoryStateUpdateHandler);
   registry->Register(NodeCategorySet::New);
   registry->Register(NodeCategorySet::Enable);
@@ -0,0 +1,56 @@
+#ifndef SRC_NODE_V8_H_
+#define SRC_NODE_V8_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include "aliased_buffer.h"
+#include "base_object.h"
+#include "node_snapshotable.h"
+#include "util.h"
+#include "v8.h"
+
+namespace node {
+class Environment;
+
+namespace v8_utils {
+class BindingData : public SnapshotableObject {
+ public:
+  struct InternalFieldInfo : public node::InternalFieldInfo {
+    AliasedBufferInfo heap_statistics_buffer;
+    AliasedBufferInfo heap_space_statistics_buffer;
+    AliasedBufferInfo heap_code_statistics_buffer;
+  };
+
+  BindingData(Environment* env,
+              v8::Local<v8::Object> obj,
+              const InternalFieldInfo* info = nullptr);
+
+  static constexpr FastStringKey binding_data_name{"v8"};
+
+  AliasedFloat64Array heap_statistics_buffer;
+  AliasedFloat64Array heap_space_statistics_buffer;
+  AliasedFloat64Array heap_code_statistics_buffer;
+
+  void PrepareForSerialization(v8::Local<v8::Context> context,
+                               v8::SnapshotCreator* creator) override;
+  node::InternalFieldInfo* Serialize(int index) override;
+  static void Deserialize(v8::Local<v8::Context> context,
+                          v8::Local<v8::Object> holder,
+                          int index,
+                          node::InternalFieldInfo* info);
+
+  void MemoryInfo(MemoryTracker* tracker) const override;
+  SET_SELF_SIZE(BindingData)
+  SET_MEMORY_INFO_NAME(BindingData)
+
+ private:
+  InternalFieldInfo* internal_field_info_ = nullptr;
+};
+
+}  // namespace v8_utils
+
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_NODE_V8_H_
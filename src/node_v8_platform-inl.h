@@ -88,6 +88,10 @@ struct V8Platform {
     CHECK(!initialized_);
     initialized_ = true;
     tracing_agent_ = std::make_unique<tracing::Agent>();
+    if (per_process::cli_options->trace_event_flight_recorder) {
+      tracing_agent_->UseFlightRecorder(
+          per_process::cli_options->trace_event_format == "proto");
+    }
     node::tracing::TraceEventHelper::SetAgent(tracing_agent_.get());
     node::tracing::TracingController* controller =
         tracing_agent_->GetTracingController();
@@ -135,7 +139,10 @@ struct V8Platform {
                                 std::make_move_iterator(categories.end())),
           std::unique_ptr<tracing::AsyncTraceWriter>(
               new tracing::NodeTraceWriter(
-                  per_process::cli_options->trace_event_file_pattern)),
+                  per_process::cli_options->trace_event_file_pattern,
+                  per_process::cli_options->trace_event_format == "proto" ?
+                      tracing::NodeTraceWriter::kProto :
+                      tracing::NodeTraceWriter::kJSON)),
           tracing::Agent::kUseDefaultCategories);
     }
   }
@@ -4,6 +4,8 @@
 #include "node_errors.h"
 #include "node_external_reference.h"
 #include "node_buffer.h"
+#include "node_internals.h"
+#include "node_main_instance.h"
 #include "node_options-inl.h"
 #include "node_perf.h"
 #include "util-inl.h"
@@ -123,12 +125,14 @@ void Worker::UpdateResourceConstraints(ResourceConstraints* constraints) {
 }
 
 // This class contains data that is only relevant to the child thread itself,
-// and only while it is running.
+// and only while it is running: its isolate and its event loop. When the
+// parent Environment keeps idle isolates, it outlives the Worker and can be
+// handed to another one with the same resource limits.
 // (Eventually, the Environment instance should probably also be moved here.)
 class WorkerThreadData {
  public:
   explicit WorkerThreadData(Worker* w)
-    : w_(w) {
+    : platform_(w->platform_) {
     int ret = uv_loop_init(&loop_);
     if (ret != 0) {
       char err_buf[128];
@@ -145,7 +149,23 @@ class WorkerThreadData {
     SetIsolateCreateParamsForNode(&params);
     params.array_buffer_allocator_shared = allocator;
 
+    // Deserialize the isolate from the same snapshot as the one of the
+    // parent, if any, instead of setting up the builtins from scratch.
+    const std::vector<size_t>* indexes = nullptr;
+    if (UsesSnapshot(w)) {
+      params.snapshot_blob = w->env()->isolate_data()->snapshot_blob();
+      params.external_references =
+          NodeMainInstance::CollectExternalReferences().data();
+      indexes = w->env()->isolate_data()->snapshot_indexes();
+    }
+
+    std::copy(std::begin(w->resource_limits_),
+              std::end(w->resource_limits_),
+              std::begin(requested_resource_limits_));
     w->UpdateResourceConstraints(&params.constraints);
+    std::copy(std::begin(w->resource_limits_),
+              std::end(w->resource_limits_),
+              std::begin(resource_limits_));
 
     Isolate* isolate = Isolate::Allocate();
     if (isolate == nullptr) {
@@ -155,50 +175,43 @@ class WorkerThreadData {
       return;
     }
 
-    w->platform_->RegisterIsolate(isolate, &loop_);
+    platform_->RegisterIsolate(isolate, &loop_);
     Isolate::Initialize(isolate, params);
     SetIsolateUpForNode(isolate);
 
-    isolate->AddNearHeapLimitCallback(Worker::NearHeapLimit, w);
+    isolate->AddNearHeapLimitCallback(Worker::NearHeapLimit, this);
 
     {
       Locker locker(isolate);
       Isolate::Scope isolate_scope(isolate);
-      // V8 computes its stack limit the first time a `Locker` is used based on
-      // --stack-size. Reset it to the correct value.
-      isolate->SetStackLimit(w->stack_base_);
-
       HandleScope handle_scope(isolate);
-      isolate_data_.reset(CreateIsolateData(isolate,
-                                            &loop_,
-                                            w_->platform_,
-                                            allocator.get()));
+      isolate_data_.reset(new IsolateData(isolate,
+                                          &loop_,
+                                          platform_,
+                                          allocator.get(),
+                                          indexes));
       CHECK(isolate_data_);
-      if (w_->per_isolate_opts_)
-        isolate_data_->set_options(std::move(w_->per_isolate_opts_));
-      isolate_data_->set_worker_context(w_);
+      if (indexes != nullptr)
+        isolate_data_->set_snapshot_blob(params.snapshot_blob);
     }
 
-    Mutex::ScopedLock lock(w_->mutex_);
-    w_->isolate_ = isolate;
+    isolate_ = isolate;
+    Attach(w);
   }
 
   ~WorkerThreadData() {
-    Debug(w_, "Worker %llu dispose isolate", w_->thread_id_.id);
-    Isolate* isolate;
-    {
-      Mutex::ScopedLock lock(w_->mutex_);
-      isolate = w_->isolate_;
-      w_->isolate_ = nullptr;
+    if (w_ != nullptr) {
+      Debug(w_, "Worker %llu dispose isolate", w_->thread_id_.id);
+      Detach();
     }
 
-    if (isolate != nullptr) {
+    if (isolate_ != nullptr) {
       CHECK(!loop_init_failed_);
       bool platform_finished = false;
 
       isolate_data_.reset();
 
-      w_->platform_->AddIsolateFinishedCallback(isolate, [](void* data) {
+      platform_->AddIsolateFinishedCallback(isolate_, [](void* data) {
         *static_cast<bool*>(data) = true;
       }, &platform_finished);
 
@@ -207,8 +220,8 @@ class WorkerThreadData {
       // new Isolate at the same address can successfully be registered with
       // the platform.
       // (Refs: https://github.com/nodejs/node/issues/30846)
-      w_->platform_->UnregisterIsolate(isolate);
-      isolate->Dispose();
+      platform_->UnregisterIsolate(isolate_);
+      isolate_->Dispose();
 
       // Wait until the platform has cleaned up all relevant resources.
       while (!platform_finished) {
@@ -220,21 +233,135 @@ class WorkerThreadData {
     }
   }
 
+  // Whether the isolate of `w` would be deserialized from a snapshot.
+  static bool UsesSnapshot(Worker* w) {
+    IsolateData* parent_data = w->env()->isolate_data();
+    if (parent_data->snapshot_blob() == nullptr) return false;
+    return !w->per_isolate_opts_ || !w->per_isolate_opts_->no_node_snapshot;
+  }
+
+  // Whether the isolate can be used by `w`, which has not been started yet.
+  // The isolate has to have been created with the same resource limits.
+  bool CanBeReusedBy(Worker* w) const {
+    for (int i = 0; i < kStackSizeMb; i++) {
+      if (requested_resource_limits_[i] != w->resource_limits_[i])
+        return false;
+    }
+    return UsesSnapshot(w) == isolate_data_->deserialized_from_snapshot();
+  }
+
+  // Hands the isolate over to `w`. Called on the thread of `w`.
+  void Attach(Worker* w) {
+    CHECK_NULL(w_);
+    w_ = w;
+    {
+      Locker locker(isolate_);
+      Isolate::Scope isolate_scope(isolate_);
+      // V8 computes its stack limit the first time a `Locker` is used based on
+      // --stack-size. Reset it to the correct value.
+      isolate_->SetStackLimit(w->stack_base_);
+
+      if (w->per_isolate_opts_) {
+        isolate_data_->set_options(std::move(w->per_isolate_opts_));
+      } else {
+        isolate_data_->set_options(std::make_shared<PerIsolateOptions>(
+            *per_process::cli_options->per_isolate));
+      }
+      isolate_data_->set_worker_context(w);
+    }
+
+    // The size of the stack is not tied to the isolate.
+    for (int i = 0; i < kStackSizeMb; i++)
+      w->resource_limits_[i] = resource_limits_[i];
+
+    Mutex::ScopedLock lock(w->mutex_);
+    w->isolate_ = isolate_;
+  }
+
+  void Detach() {
+    isolate_data_->set_worker_context(nullptr);
+    Mutex::ScopedLock lock(w_->mutex_);
+    w_->isolate_ = nullptr;
+    w_ = nullptr;
+  }
+
+  // Called once the Environment of the Worker has been freed, while the
+  // isolate is still locked. Returns whether the isolate and the loop are
+  // in a state in which they can be used by another Worker.
+  bool PrepareForReuse() {
+    if (!reusable_ || isolate_->IsExecutionTerminating()) return false;
+    // Only the handles of the platform, which are unref'ed, may be left.
+    uv_run(&loop_, UV_RUN_NOWAIT);
+    if (uv_loop_alive(&loop_)) return false;
+    // Release the memory of the previous Environment while the isolate is
+    // not used.
+    isolate_->ContextDisposedNotification();
+    isolate_->LowMemoryNotification();
+    return true;
+  }
+
   bool loop_is_usable() const { return !loop_init_failed_; }
 
  private:
-  Worker* const w_;
+  Worker* w_ = nullptr;
+  MultiIsolatePlatform* const platform_;
   uv_loop_t loop_;
   bool loop_init_failed_ = true;
+  Isolate* isolate_ = nullptr;
   DeleteFnPtr<IsolateData, FreeIsolateData> isolate_data_;
+  // The resource limits that the Worker asked for, and the ones that were
+  // applied to the isolate.
+  double requested_resource_limits_[kTotalResourceLimitCount];
+  double resource_limits_[kTotalResourceLimitCount];
+  // Unset once the heap limit of the isolate has been raised.
+  bool reusable_ = true;
 
   friend class Worker;
 };
 
+IdleIsolateCache::IdleIsolateCache(size_t max_size) : max_size_(max_size) {}
+
+IdleIsolateCache::~IdleIsolateCache() {
+  Clear();
+}
+
+std::unique_ptr<WorkerThreadData> IdleIsolateCache::Take(Worker* w) {
+  Mutex::ScopedLock lock(mutex_);
+  for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+    if ((*it)->CanBeReusedBy(w)) {
+      std::unique_ptr<WorkerThreadData> data = std::move(*it);
+      entries_.erase(it);
+      return data;
+    }
+  }
+  return nullptr;
+}
+
+void IdleIsolateCache::Put(std::unique_ptr<WorkerThreadData> data) {
+  {
+    Mutex::ScopedLock lock(mutex_);
+    if (entries_.size() < max_size_) {
+      entries_.emplace_back(std::move(data));
+      return;
+    }
+  }
+  // The cache is full, so dispose of the isolate outside of the lock.
+  data.reset();
+}
+
+void IdleIsolateCache::Clear() {
+  std::vector<std::unique_ptr<WorkerThreadData>> entries;
+  {
+    Mutex::ScopedLock lock(mutex_);
+    entries.swap(entries_);
+  }
+}
+
 size_t Worker::NearHeapLimit(void* data, size_t current_heap_limit,
                              size_t initial_heap_limit) {
-  Worker* worker = static_cast<Worker*>(data);
-  worker->Exit(1, "ERR_WORKER_OUT_OF_MEMORY", "JS heap out of memory");
+  WorkerThreadData* thread_data = static_cast<WorkerThreadData*>(data);
+  thread_data->reusable_ = false;
+  thread_data->w_->Exit(1, "ERR_WORKER_OUT_OF_MEMORY", "JS heap out of memory");
   // Give the current GC some extra leeway to let it finish rather than
   // crash hard. We are not going to perform further allocations anyway.
   constexpr size_t kExtraHeapAllowance = 16 * 1024 * 1024;
@@ -249,18 +376,31 @@ void Worker::Run() {
       TRACE_STR_COPY(name.c_str()));
   CHECK_NOT_NULL(platform_);
 
-  Debug(this, "Creating isolate for worker with id %llu", thread_id_.id);
-
-  WorkerThreadData data(this);
+  IdleIsolateCache* idle_isolates = env()->idle_worker_isolates();
+  std::unique_ptr<WorkerThreadData> data;
+  if (idle_isolates != nullptr) data = idle_isolates->Take(this);
+  if (data) {
+    Debug(this, "Reusing isolate for worker with id %llu", thread_id_.id);
+    data->Attach(this);
+  } else {
+    Debug(this, "Creating isolate for worker with id %llu", thread_id_.id);
+    data = std::make_unique<WorkerThreadData>(this);
+  }
   if (isolate_ == nullptr) return;
-  CHECK(data.loop_is_usable());
+  CHECK(data->loop_is_usable());
 
+  bool reuse_isolate = false;
   Debug(this, "Starting worker with id %llu", thread_id_.id);
   {
     Locker locker(isolate_);
     Isolate::Scope isolate_scope(isolate_);
     SealHandleScope outer_seal(isolate_);
 
+    // Runs after the Environment has been freed below.
+    auto prepare_reuse = OnScopeLeave([&]() {
+      if (idle_isolates != nullptr) reuse_isolate = data->PrepareForReuse();
+    });
+
     DeleteFnPtr<Environment, FreeEnvironment> env_;
     auto cleanup_env = OnScopeLeave([&]() {
       // TODO(addaleax): This call is harmless but should not be necessary.
@@ -290,7 +430,15 @@ void Worker::Run() {
         // resource constraints, we need something in place to handle it,
         // though.
         TryCatch try_catch(isolate_);
-        context = NewContext(isolate_);
+        if (data->isolate_data_->deserialized_from_snapshot()) {
+          if (Context::FromSnapshot(isolate_,
+                                    NodeMainInstance::kNodeBaseContextIndex)
+                  .ToLocal(&context)) {
+            InitializeContextRuntime(context);
+          }
+        } else {
+          context = NewContext(isolate_);
+        }
         if (context.IsEmpty()) {
           // TODO(addaleax): This should be ERR_WORKER_INIT_FAILED,
           // ERR_WORKER_OUT_OF_MEMORY is for reaching the per-Worker heap limit.
@@ -304,7 +452,7 @@ void Worker::Run() {
       Context::Scope context_scope(context);
       {
         env_.reset(CreateEnvironment(
-            data.isolate_data_.get(),
+            data->isolate_data_.get(),
             context,
             std::move(argv_),
             std::move(exec_argv_),
@@ -347,6 +495,12 @@ void Worker::Run() {
     }
   }
 
+  if (reuse_isolate) {
+    Debug(this, "Keeping isolate of worker %llu", thread_id_.id);
+    data->Detach();
+    idle_isolates->Put(std::move(data));
+  }
+
   Debug(this, "Worker %llu thread stops", thread_id_.id);
 }
 
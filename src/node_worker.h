@@ -20,6 +20,32 @@ enum ResourceLimits {
   kTotalResourceLimitCount
 };
 
+// The isolates and event loops of stopped Workers, kept by their parent
+// Environment when --max-idle-worker-isolates is used. Workers created later
+// by the same parent with the same resource limits reuse them instead of
+// creating and bootstrapping new isolates.
+class IdleIsolateCache {
+ public:
+  explicit IdleIsolateCache(size_t max_size);
+  ~IdleIsolateCache();
+  IdleIsolateCache(const IdleIsolateCache&) = delete;
+  IdleIsolateCache& operator=(const IdleIsolateCache&) = delete;
+
+  // Returns an isolate that `w` can use, or nullptr. Called from the thread
+  // of the Worker.
+  std::unique_ptr<WorkerThreadData> Take(Worker* w);
+  // Keeps the isolate of a stopped Worker, or disposes of it if the cache
+  // is full.
+  void Put(std::unique_ptr<WorkerThreadData> data);
+  // Disposes of all the idle isolates.
+  void Clear();
+
+ private:
+  const size_t max_size_;
+  Mutex mutex_;
+  std::vector<std::unique_ptr<WorkerThreadData>> entries_;
+};
+
 // A worker thread, as represented in its parent thread.
 class Worker : public AsyncWrap {
  public:
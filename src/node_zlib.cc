@@ -33,6 +33,9 @@
 #include "brotli/encode.h"
 #include "brotli/decode.h"
 #include "zlib.h"
+#define ZSTD_STATIC_LINKING_ONLY  // For ZSTD_customMem.
+#include "zstd.h"
+#include "zstd_errors.h"
 
 #include <sys/types.h>
 
@@ -51,6 +54,7 @@ using v8::FunctionTemplate;
 using v8::Global;
 using v8::HandleScope;
 using v8::Int32;
+using v8::Int32Array;
 using v8::Integer;
 using v8::Local;
 using v8::Object;
@@ -91,6 +95,43 @@ inline const char* ZlibStrerror(int err) {
   return "Z_UNKNOWN_ERROR";
 }
 
+#define ZSTD_ERROR_CODES(V)                      \
+  V(ZSTD_error_no_error)                         \
+  V(ZSTD_error_GENERIC)                          \
+  V(ZSTD_error_prefix_unknown)                   \
+  V(ZSTD_error_version_unsupported)              \
+  V(ZSTD_error_frameParameter_unsupported)       \
+  V(ZSTD_error_frameParameter_windowTooLarge)    \
+  V(ZSTD_error_corruption_detected)              \
+  V(ZSTD_error_checksum_wrong)                   \
+  V(ZSTD_error_literals_headerWrong)             \
+  V(ZSTD_error_dictionary_corrupted)             \
+  V(ZSTD_error_dictionary_wrong)                 \
+  V(ZSTD_error_dictionaryCreation_failed)        \
+  V(ZSTD_error_parameter_unsupported)            \
+  V(ZSTD_error_parameter_combination_unsupported)\
+  V(ZSTD_error_parameter_outOfBound)             \
+  V(ZSTD_error_tableLog_tooLarge)                \
+  V(ZSTD_error_maxSymbolValue_tooLarge)          \
+  V(ZSTD_error_maxSymbolValue_tooSmall)          \
+  V(ZSTD_error_stabilityCondition_notRespected)  \
+  V(ZSTD_error_stage_wrong)                      \
+  V(ZSTD_error_init_missing)                     \
+  V(ZSTD_error_memory_allocation)                \
+  V(ZSTD_error_workSpace_tooSmall)               \
+  V(ZSTD_error_dstSize_tooSmall)                 \
+  V(ZSTD_error_srcSize_wrong)                    \
+  V(ZSTD_error_dstBuffer_null)                   \
+  V(ZSTD_error_noForwardProgress_destFull)       \
+  V(ZSTD_error_noForwardProgress_inputEmpty)     \
+
+inline const char* ZstdStrerror(ZSTD_ErrorCode err) {
+#define V(code) if (err == code) return #code;
+  ZSTD_ERROR_CODES(V)
+#undef V
+  return "ZSTD_error_GENERIC";
+}
+
 enum node_zlib_mode {
   NONE,
   DEFLATE,
@@ -101,7 +142,9 @@ enum node_zlib_mode {
   INFLATERAW,
   UNZIP,
   BROTLI_DECODE,
-  BROTLI_ENCODE
+  BROTLI_ENCODE,
+  ZSTD_COMPRESS,
+  ZSTD_DECOMPRESS
 };
 
 #define GZIP_HEADER_ID1 0x1f
@@ -245,6 +288,81 @@ class BrotliDecoderContext final : public BrotliContext {
   DeleteFnPtr<BrotliDecoderState, BrotliDecoderDestroyInstance> state_;
 };
 
+// Like Brotli, Zstandard uses separate stream types for compression and
+// decompression, so the shared parts live in a common base class.
+class ZstdContext : public MemoryRetainer {
+ public:
+  ZstdContext() = default;
+
+  void SetBuffers(char* in, uint32_t in_len, char* out, uint32_t out_len);
+  void SetFlush(int flush);
+  void GetAfterWriteOffsets(uint32_t* avail_in, uint32_t* avail_out) const;
+  inline void SetMode(node_zlib_mode mode) { mode_ = mode; }
+
+  ZstdContext(const ZstdContext&) = delete;
+  ZstdContext& operator=(const ZstdContext&) = delete;
+
+ protected:
+  CompressionError ErrorForCode(size_t code, const char* message) const;
+
+  node_zlib_mode mode_ = NONE;
+  ZSTD_inBuffer input_ = { nullptr, 0, 0 };
+  ZSTD_outBuffer output_ = { nullptr, 0, 0 };
+  ZSTD_EndDirective flush_ = ZSTD_e_continue;
+  size_t last_result_ = 0;
+  ZSTD_customMem mem_ = { nullptr, nullptr, nullptr };
+};
+
+class ZstdCompressContext final : public ZstdContext {
+ public:
+  void Close();
+  void DoThreadPoolWork();
+  CompressionError Init(ZSTD_allocFunction alloc,
+                        ZSTD_freeFunction free,
+                        void* opaque);
+  CompressionError ResetStream();
+  CompressionError SetParams(int key, int value);
+  CompressionError SetPledgedSrcSize(uint64_t pledged_src_size);
+  CompressionError SetDictionary(const char* data, size_t length);
+  CompressionError GetErrorInfo() const;
+
+  SET_MEMORY_INFO_NAME(ZstdCompressContext)
+  SET_SELF_SIZE(ZstdCompressContext)
+  SET_NO_MEMORY_INFO()  // cctx_ is covered through allocation tracking.
+
+ private:
+  static void FreeCCtx(ZSTD_CCtx* cctx) { ZSTD_freeCCtx(cctx); }
+
+  DeleteFnPtr<ZSTD_CCtx, FreeCCtx> cctx_;
+};
+
+class ZstdDecompressContext final : public ZstdContext {
+ public:
+  void Close();
+  void DoThreadPoolWork();
+  CompressionError Init(ZSTD_allocFunction alloc,
+                        ZSTD_freeFunction free,
+                        void* opaque);
+  CompressionError ResetStream();
+  CompressionError SetParams(int key, int value);
+  CompressionError SetPledgedSrcSize(uint64_t pledged_src_size);
+  CompressionError SetDictionary(const char* data, size_t length);
+  CompressionError GetErrorInfo() const;
+
+  SET_MEMORY_INFO_NAME(ZstdDecompressContext)
+  SET_SELF_SIZE(ZstdDecompressContext)
+  SET_NO_MEMORY_INFO()  // dctx_ is covered through allocation tracking.
+
+ private:
+  static void FreeDCtx(ZSTD_DCtx* dctx) { ZSTD_freeDCtx(dctx); }
+
+  // Whether the last frame seen so far has been fully decoded. This is
+  // tracked separately from last_result_ because a call that consumes no
+  // input at a frame boundary reports the size of the next frame header.
+  bool frame_complete_ = false;
+  DeleteFnPtr<ZSTD_DCtx, FreeDCtx> dctx_;
+};
+
 template <typename CompressionContext>
 class CompressionStream : public AsyncWrap, public ThreadPoolWork {
  public:
@@ -721,6 +839,110 @@ class BrotliCompressionStream : public CompressionStream<CompressionContext> {
 using BrotliEncoderStream = BrotliCompressionStream<BrotliEncoderContext>;
 using BrotliDecoderStream = BrotliCompressionStream<BrotliDecoderContext>;
 
+template <typename CompressionContext>
+class ZstdCompressionStream : public CompressionStream<CompressionContext> {
+ public:
+  ZstdCompressionStream(Environment* env,
+                        Local<Object> wrap,
+                        node_zlib_mode mode)
+    : CompressionStream<CompressionContext>(env, wrap) {
+    context()->SetMode(mode);
+  }
+
+  inline CompressionContext* context() {
+    return this->CompressionStream<CompressionContext>::context();
+  }
+  typedef typename CompressionStream<CompressionContext>::AllocScope AllocScope;
+
+  static void New(const FunctionCallbackInfo<Value>& args) {
+    Environment* env = Environment::GetCurrent(args);
+    CHECK(args[0]->IsInt32());
+    node_zlib_mode mode =
+        static_cast<node_zlib_mode>(args[0].As<Int32>()->Value());
+    new ZstdCompressionStream(env, args.This(), mode);
+  }
+
+  static void Init(const FunctionCallbackInfo<Value>& args) {
+    ZstdCompressionStream* wrap;
+    ASSIGN_OR_RETURN_UNWRAP(&wrap, args.Holder());
+    CHECK(args.Length() == 5 &&
+          "init(params, pledgedSrcSize, writeResult, writeCallback, "
+          "dictionary)");
+
+    CHECK(args[2]->IsUint32Array());
+    uint32_t* write_result = reinterpret_cast<uint32_t*>(Buffer::Data(args[2]));
+
+    CHECK(args[3]->IsFunction());
+    Local<Function> write_js_callback = args[3].As<Function>();
+    wrap->InitStream(write_result, write_js_callback);
+
+    AllocScope alloc_scope(wrap);
+    CompressionError err =
+        wrap->context()->Init(
+          CompressionStream<CompressionContext>::AllocForBrotli,
+          CompressionStream<CompressionContext>::FreeForZlib,
+          static_cast<CompressionStream<CompressionContext>*>(wrap));
+    if (err.IsError()) {
+      wrap->EmitError(err);
+      args.GetReturnValue().Set(false);
+      return;
+    }
+
+    // The parameters are key/value pairs, since -1 is a valid value for
+    // some of them and cannot be used to mark the ones that are not set.
+    CHECK(args[0]->IsInt32Array());
+    const int32_t* data = reinterpret_cast<int32_t*>(Buffer::Data(args[0]));
+    size_t len = args[0].As<Int32Array>()->Length();
+    CHECK_EQ(len % 2, 0);
+
+    for (size_t i = 0; i < len; i += 2) {
+      err = wrap->context()->SetParams(data[i], data[i + 1]);
+      if (err.IsError()) {
+        wrap->EmitError(err);
+        args.GetReturnValue().Set(false);
+        return;
+      }
+    }
+
+    if (args[1]->IsNumber()) {
+      Local<Context> context = args.GetIsolate()->GetCurrentContext();
+      int64_t pledged_src_size;
+      if (!args[1]->IntegerValue(context).To(&pledged_src_size)) return;
+      CHECK_GE(pledged_src_size, 0);
+      err = wrap->context()->SetPledgedSrcSize(pledged_src_size);
+      if (err.IsError()) {
+        wrap->EmitError(err);
+        args.GetReturnValue().Set(false);
+        return;
+      }
+    }
+
+    if (Buffer::HasInstance(args[4])) {
+      err = wrap->context()->SetDictionary(Buffer::Data(args[4]),
+                                           Buffer::Length(args[4]));
+      if (err.IsError()) {
+        wrap->EmitError(err);
+        args.GetReturnValue().Set(false);
+        return;
+      }
+    }
+
+    args.GetReturnValue().Set(true);
+  }
+
+  static void Params(const FunctionCallbackInfo<Value>& args) {
+    // Currently a no-op, and not accessed from JS land.
+    // Zstandard does support changing some parameters between frames,
+    // but exposing that is left for when there is a use case for it.
+  }
+
+  SET_MEMORY_INFO_NAME(ZstdCompressionStream)
+  SET_SELF_SIZE(ZstdCompressionStream)
+};
+
+using ZstdCompressStream = ZstdCompressionStream<ZstdCompressContext>;
+using ZstdDecompressStream = ZstdCompressionStream<ZstdDecompressContext>;
+
 void ZlibContext::Close() {
   {
     Mutex::ScopedLock lock(mutex_);
@@ -1245,6 +1467,211 @@ CompressionError BrotliDecoderContext::GetErrorInfo() const {
 }
 
 
+void ZstdContext::SetBuffers(char* in, uint32_t in_len,
+                             char* out, uint32_t out_len) {
+  input_.src = in;
+  input_.size = in_len;
+  input_.pos = 0;
+  output_.dst = out;
+  output_.size = out_len;
+  output_.pos = 0;
+}
+
+
+void ZstdContext::SetFlush(int flush) {
+  flush_ = static_cast<ZSTD_EndDirective>(flush);
+}
+
+
+void ZstdContext::GetAfterWriteOffsets(uint32_t* avail_in,
+                                       uint32_t* avail_out) const {
+  *avail_in = input_.size - input_.pos;
+  *avail_out = output_.size - output_.pos;
+}
+
+
+CompressionError ZstdContext::ErrorForCode(size_t code,
+                                           const char* message) const {
+  ZSTD_ErrorCode error = ZSTD_getErrorCode(code);
+  return CompressionError(message,
+                          ZstdStrerror(error),
+                          -static_cast<int>(error));
+}
+
+
+void ZstdCompressContext::Close() {
+  cctx_.reset();
+  mode_ = NONE;
+}
+
+void ZstdCompressContext::DoThreadPoolWork() {
+  CHECK_EQ(mode_, ZSTD_COMPRESS);
+  CHECK(cctx_);
+  // With worker threads enabled, ZSTD_e_continue may return before all of
+  // the input has been handed off, even though there is output space left.
+  // Keep going so that the JS side's "input left over means end of stream"
+  // logic continues to hold.
+  do {
+    last_result_ = ZSTD_compressStream2(cctx_.get(),
+                                        &output_,
+                                        &input_,
+                                        flush_);
+  } while (!ZSTD_isError(last_result_) &&
+           input_.pos < input_.size &&
+           output_.pos < output_.size);
+}
+
+CompressionError ZstdCompressContext::Init(ZSTD_allocFunction alloc,
+                                           ZSTD_freeFunction free,
+                                           void* opaque) {
+  mem_ = { alloc, free, opaque };
+  cctx_.reset(ZSTD_createCCtx_advanced(mem_));
+  if (!cctx_) {
+    return CompressionError("Could not initialize zstd instance",
+                            "ERR_ZLIB_INITIALIZATION_FAILED",
+                            -1);
+  } else {
+    return CompressionError {};
+  }
+}
+
+CompressionError ZstdCompressContext::ResetStream() {
+  // Parameters and dictionary are kept, only the current frame is dropped.
+  last_result_ = ZSTD_CCtx_reset(cctx_.get(), ZSTD_reset_session_only);
+  if (ZSTD_isError(last_result_))
+    return ErrorForCode(last_result_, "Failed to reset stream");
+  return CompressionError {};
+}
+
+CompressionError ZstdCompressContext::SetParams(int key, int value) {
+  size_t result = ZSTD_CCtx_setParameter(cctx_.get(),
+                                         static_cast<ZSTD_cParameter>(key),
+                                         value);
+  if (ZSTD_isError(result)) {
+    return CompressionError("Setting parameter failed",
+                            "ERR_ZSTD_PARAM_SET_FAILED",
+                            -1);
+  } else {
+    return CompressionError {};
+  }
+}
+
+CompressionError ZstdCompressContext::SetPledgedSrcSize(
+    uint64_t pledged_src_size) {
+  size_t result = ZSTD_CCtx_setPledgedSrcSize(cctx_.get(), pledged_src_size);
+  if (ZSTD_isError(result))
+    return ErrorForCode(result, "Setting pledged source size failed");
+  return CompressionError {};
+}
+
+CompressionError ZstdCompressContext::SetDictionary(const char* data,
+                                                    size_t length) {
+  size_t result = ZSTD_CCtx_loadDictionary(cctx_.get(), data, length);
+  if (ZSTD_isError(result))
+    return ErrorForCode(result, "Failed to set dictionary");
+  return CompressionError {};
+}
+
+CompressionError ZstdCompressContext::GetErrorInfo() const {
+  if (ZSTD_isError(last_result_)) {
+    return ErrorForCode(last_result_, "Compression failed");
+  } else {
+    return CompressionError {};
+  }
+}
+
+
+void ZstdDecompressContext::Close() {
+  dctx_.reset();
+  mode_ = NONE;
+}
+
+void ZstdDecompressContext::DoThreadPoolWork() {
+  CHECK_EQ(mode_, ZSTD_DECOMPRESS);
+  CHECK(dctx_);
+  // ZSTD_decompressStream() stops at the end of each frame. Concatenated
+  // frames are valid input, so keep decoding as long as there is both input
+  // and output space left.
+  do {
+    size_t pos = input_.pos;
+    last_result_ = ZSTD_decompressStream(dctx_.get(), &output_, &input_);
+    if (last_result_ == 0)
+      frame_complete_ = true;
+    else if (input_.pos != pos)
+      frame_complete_ = false;
+  } while (!ZSTD_isError(last_result_) &&
+           input_.pos < input_.size &&
+           output_.pos < output_.size);
+}
+
+CompressionError ZstdDecompressContext::Init(ZSTD_allocFunction alloc,
+                                             ZSTD_freeFunction free,
+                                             void* opaque) {
+  mem_ = { alloc, free, opaque };
+  dctx_.reset(ZSTD_createDCtx_advanced(mem_));
+  if (!dctx_) {
+    return CompressionError("Could not initialize zstd instance",
+                            "ERR_ZLIB_INITIALIZATION_FAILED",
+                            -1);
+  } else {
+    return CompressionError {};
+  }
+}
+
+CompressionError ZstdDecompressContext::ResetStream() {
+  frame_complete_ = false;
+  last_result_ = ZSTD_DCtx_reset(dctx_.get(), ZSTD_reset_session_only);
+  if (ZSTD_isError(last_result_))
+    return ErrorForCode(last_result_, "Failed to reset stream");
+  return CompressionError {};
+}
+
+CompressionError ZstdDecompressContext::SetParams(int key, int value) {
+  size_t result = ZSTD_DCtx_setParameter(dctx_.get(),
+                                         static_cast<ZSTD_dParameter>(key),
+                                         value);
+  if (ZSTD_isError(result)) {
+    return CompressionError("Setting parameter failed",
+                            "ERR_ZSTD_PARAM_SET_FAILED",
+                            -1);
+  } else {
+    return CompressionError {};
+  }
+}
+
+CompressionError ZstdDecompressContext::SetPledgedSrcSize(
+    uint64_t pledged_src_size) {
+  // The content size is read from the frame header when decompressing.
+  return CompressionError {};
+}
+
+CompressionError ZstdDecompressContext::SetDictionary(const char* data,
+                                                      size_t length) {
+  size_t result = ZSTD_DCtx_loadDictionary(dctx_.get(), data, length);
+  if (ZSTD_isError(result))
+    return ErrorForCode(result, "Failed to set dictionary");
+  return CompressionError {};
+}
+
+CompressionError ZstdDecompressContext::GetErrorInfo() const {
+  if (ZSTD_isError(last_result_)) {
+    return ErrorForCode(last_result_, "Decompression failed");
+  } else if (flush_ == ZSTD_e_end &&
+             !frame_complete_ &&
+             input_.pos == input_.size &&
+             output_.pos < output_.size) {
+    // The frame is incomplete even though all input has been consumed and
+    // there is still room for more output. Match zlib's behaviour here, like
+    // Brotli does.
+    return CompressionError("unexpected end of file",
+                            "Z_BUF_ERROR",
+                            Z_BUF_ERROR);
+  } else {
+    return CompressionError {};
+  }
+}
+
+
 template <typename Stream>
 struct MakeClass {
   static void Make(Environment* env, Local<Object> target, const char* name) {
@@ -1279,6 +1706,8 @@ void Initialize(Local<Object> target,
   MakeClass<ZlibStream>::Make(env, target, "Zlib");
   MakeClass<BrotliEncoderStream>::Make(env, target, "BrotliEncoder");
   MakeClass<BrotliDecoderStream>::Make(env, target, "BrotliDecoder");
+  MakeClass<ZstdCompressStream>::Make(env, target, "ZstdCompress");
+  MakeClass<ZstdDecompressStream>::Make(env, target, "ZstdDecompress");
 
   target->Set(env->context(),
               FIXED_ONE_BYTE_STRING(env->isolate(), "ZLIB_VERSION"),
@@ -1326,6 +1755,8 @@ void DefineZlibConstants(Local<Object> target) {
   NODE_DEFINE_CONSTANT(target, UNZIP);
   NODE_DEFINE_CONSTANT(target, BROTLI_DECODE);
   NODE_DEFINE_CONSTANT(target, BROTLI_ENCODE);
+  NODE_DEFINE_CONSTANT(target, ZSTD_COMPRESS);
+  NODE_DEFINE_CONSTANT(target, ZSTD_DECOMPRESS);
 
   NODE_DEFINE_CONSTANT(target, Z_MIN_WINDOWBITS);
   NODE_DEFINE_CONSTANT(target, Z_MAX_WINDOWBITS);
@@ -1405,6 +1836,44 @@ void DefineZlibConstants(Local<Object> target) {
   NODE_DEFINE_CONSTANT(target, BROTLI_DECODER_ERROR_ALLOC_RING_BUFFER_2);
   NODE_DEFINE_CONSTANT(target, BROTLI_DECODER_ERROR_ALLOC_BLOCK_TYPE_TREES);
   NODE_DEFINE_CONSTANT(target, BROTLI_DECODER_ERROR_UNREACHABLE);
+
+  // Zstd constants
+  NODE_DEFINE_CONSTANT(target, ZSTD_e_continue);
+  NODE_DEFINE_CONSTANT(target, ZSTD_e_flush);
+  NODE_DEFINE_CONSTANT(target, ZSTD_e_end);
+  NODE_DEFINE_CONSTANT(target, ZSTD_fast);
+  NODE_DEFINE_CONSTANT(target, ZSTD_dfast);
+  NODE_DEFINE_CONSTANT(target, ZSTD_greedy);
+  NODE_DEFINE_CONSTANT(target, ZSTD_lazy);
+  NODE_DEFINE_CONSTANT(target, ZSTD_lazy2);
+  NODE_DEFINE_CONSTANT(target, ZSTD_btlazy2);
+  NODE_DEFINE_CONSTANT(target, ZSTD_btopt);
+  NODE_DEFINE_CONSTANT(target, ZSTD_btultra);
+  NODE_DEFINE_CONSTANT(target, ZSTD_btultra2);
+  NODE_DEFINE_CONSTANT(target, ZSTD_c_compressionLevel);
+  NODE_DEFINE_CONSTANT(target, ZSTD_c_windowLog);
+  NODE_DEFINE_CONSTANT(target, ZSTD_c_hashLog);
+  NODE_DEFINE_CONSTANT(target, ZSTD_c_chainLog);
+  NODE_DEFINE_CONSTANT(target, ZSTD_c_searchLog);
+  NODE_DEFINE_CONSTANT(target, ZSTD_c_minMatch);
+  NODE_DEFINE_CONSTANT(target, ZSTD_c_targetLength);
+  NODE_DEFINE_CONSTANT(target, ZSTD_c_strategy);
+  NODE_DEFINE_CONSTANT(target, ZSTD_c_enableLongDistanceMatching);
+  NODE_DEFINE_CONSTANT(target, ZSTD_c_ldmHashLog);
+  NODE_DEFINE_CONSTANT(target, ZSTD_c_ldmMinMatch);
+  NODE_DEFINE_CONSTANT(target, ZSTD_c_ldmBucketSizeLog);
+  NODE_DEFINE_CONSTANT(target, ZSTD_c_ldmHashRateLog);
+  NODE_DEFINE_CONSTANT(target, ZSTD_c_contentSizeFlag);
+  NODE_DEFINE_CONSTANT(target, ZSTD_c_checksumFlag);
+  NODE_DEFINE_CONSTANT(target, ZSTD_c_dictIDFlag);
+  NODE_DEFINE_CONSTANT(target, ZSTD_c_nbWorkers);
+  NODE_DEFINE_CONSTANT(target, ZSTD_c_jobSize);
+  NODE_DEFINE_CONSTANT(target, ZSTD_c_overlapLog);
+  NODE_DEFINE_CONSTANT(target, ZSTD_d_windowLogMax);
+  NODE_DEFINE_CONSTANT(target, ZSTD_CLEVEL_DEFAULT);
+#define V(code) NODE_DEFINE_CONSTANT(target, code);
+  ZSTD_ERROR_CODES(V)
+#undef V
 }
 
 }  // namespace node
@@ -188,6 +188,7 @@ void Initialize(Local<Object> target,
   V(QUICCLIENTSESSION_OPTION_VERIFY_HOSTNAME_IDENTITY)                         \
   V(QUICSERVERSESSION_OPTION_REJECT_UNAUTHORIZED)                              \
   V(QUICSERVERSESSION_OPTION_REQUEST_CERT)                                     \
+  V(QUICSOCKET_OPTIONS_TRACK_SEND_REQUESTS)                                    \
   V(QUICSOCKET_OPTIONS_VALIDATE_ADDRESS)                                       \
   V(QUICSTREAM_HEADER_FLAGS_NONE)                                              \
   V(QUICSTREAM_HEADER_FLAGS_TERMINAL)                                          \
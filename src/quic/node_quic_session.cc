@@ -900,6 +900,17 @@ void QuicSession::RandomConnectionIDStrategy(
     EntropySource(cid->data, cidlen);
 }
 
+// Generates a new random connection ID that starts with the server id of
+// the QuicSocket, so that packets for it can be steered to that socket.
+void QuicSession::ServerIdConnectionIDStrategy(
+    QuicSession* session,
+    ngtcp2_cid* cid,
+    size_t cidlen) {
+  RandomConnectionIDStrategy(session, cid, cidlen);
+  if (LIKELY(cidlen > 0))
+    cid->data[0] = session->socket()->server_id();
+}
+
 // Check required capabilities were not excluded from the OpenSSL build:
 // - OPENSSL_NO_SSL_TRACE excludes SSL_trace()
 // - OPENSSL_NO_STDIO excludes BIO_new_fp()
@@ -1630,7 +1641,10 @@ QuicSession::QuicSession(
     state_(env()->isolate()),
     quic_state_(socket->quic_state()) {
   PushListener(&default_listener_);
-  set_connection_id_strategy(RandomConnectionIDStrategy);
+  set_connection_id_strategy(
+      socket->has_server_id() ?
+          ServerIdConnectionIDStrategy :
+          RandomConnectionIDStrategy);
   set_preferred_address_strategy(preferred_address_strategy);
   crypto_context_ = std::make_unique<QuicCryptoContext>(
 
@@ -2469,7 +2483,14 @@ void QuicSession::SendPendingData() {
     return;
 
   Debug(this, "Sending pending data");
-  if (!application_->SendPendingData()) {
+  bool sent;
+  {
+    // The packet train is flushed when the scope ends, which has to happen
+    // before HandleError() runs JavaScript that may close the socket.
+    QuicSocket::SendBatchScope send_batch(socket());
+    sent = application_->SendPendingData();
+  }
+  if (!sent) {
     Debug(this, "Error sending QUIC application data");
     HandleError();
   }
@@ -1210,6 +1210,11 @@ class QuicSession final : public AsyncWrap,
       ngtcp2_cid* cid,
       size_t cidlen);
 
+  static void ServerIdConnectionIDStrategy(
+      QuicSession* session,
+      ngtcp2_cid* cid,
+      size_t cidlen);
+
   // Initialize the QuicSession as a server
   void InitServer(
       QuicSessionConfig config,
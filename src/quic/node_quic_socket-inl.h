@@ -42,6 +42,14 @@ int QuicEndpoint::Send(
   return ret;
 }
 
+ssize_t QuicEndpoint::TrySendBatch(
+    uv_buf_t* bufs,
+    size_t nbufs,
+    size_t segment_size,
+    const sockaddr* addr) {
+  return udp_->TrySendBatch(bufs, nbufs, segment_size, addr);
+}
+
 int QuicEndpoint::ReceiveStart() {
   return udp_->RecvStart();
 }
@@ -22,6 +22,13 @@
 #include "v8.h"
 
 #include <random>
+#include <unordered_map>
+
+#ifdef __linux__
+#include <linux/filter.h>
+#include <sys/socket.h>
+#include <cerrno>
+#endif
 
 namespace node {
 
@@ -33,6 +40,7 @@ using v8::Context;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
 using v8::HandleScope;
+using v8::Int32;
 using v8::Isolate;
 using v8::Local;
 using v8::Number;
@@ -45,6 +53,53 @@ using v8::Value;
 namespace quic {
 
 namespace {
+#if defined(__linux__) && defined(SO_ATTACH_REUSEPORT_CBPF)
+// The sockets of each SO_REUSEPORT group, keyed by its local address, that
+// packets are steered to by server id. They are kept in the order of the
+// kernel's array of group members: a socket that joins is appended, and when
+// one leaves, the last one takes its place. The BPF program maps each server
+// id to the index of its socket in that order, and is rebuilt whenever it
+// changes, so that closing a socket, e.g. because its Worker crashed, does
+// not send the packets of another socket's sessions to the wrong one.
+struct SteeringMember {
+  QuicEndpoint* endpoint;
+  int fd;
+  uint8_t server_id;
+};
+using SteeringGroup = std::vector<SteeringMember>;
+Mutex steering_groups_mutex;
+std::unordered_map<SocketAddress, SteeringGroup, SocketAddress::Hash>
+    steering_groups;
+
+// Attaches a classic BPF program to the group. Short header packets are
+// delivered to the socket whose server id is the first byte of the
+// destination connection ID. Long header packets, and server ids that no
+// socket has, fall back to the default hash of the address 4-tuple.
+int AttachSteeringProgram(const SteeringGroup& group) {
+  std::vector<sock_filter> code = {
+    // A = first byte of the UDP payload
+    BPF_STMT(BPF_LD | BPF_B | BPF_ABS, 0),
+    // Long header packets have the most significant bit set.
+    BPF_JUMP(BPF_JMP | BPF_JSET | BPF_K, 0x80, 0, 1),
+    BPF_STMT(BPF_RET | BPF_K, 0xffffffff),
+    // A = first byte of the short header destination connection ID
+    BPF_STMT(BPF_LD | BPF_B | BPF_ABS, 1),
+  };
+  for (size_t n = 0; n < group.size(); n++) {
+    code.push_back(BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K,
+                            group[n].server_id, 0, 1));
+    code.push_back(BPF_STMT(BPF_RET | BPF_K, static_cast<uint32_t>(n)));
+  }
+  code.push_back(BPF_STMT(BPF_RET | BPF_K, 0xffffffff));
+  sock_fprog prog = { static_cast<uint16_t>(code.size()), code.data() };
+  if (setsockopt(group[0].fd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF,
+                 &prog, sizeof(prog)) != 0) {
+    return -errno;
+  }
+  return 0;
+}
+#endif  // defined(__linux__) && defined(SO_ATTACH_REUSEPORT_CBPF)
+
 // The reserved version is a mechanism QUIC endpoints
 // can use to ensure correct handling of version
 // negotiation. It is defined by the QUIC spec in
@@ -91,6 +146,53 @@ QuicPacket::QuicPacket(const char* diagnostic_label, size_t len)
   CHECK_LE(len, MAX_PKTLEN);
 }
 
+namespace {
+// QuicPackets are created and freed for every packet that is sent, always
+// on the thread that owns the QuicSocket. Keeping the memory of freed
+// packets around avoids most of those allocations.
+class QuicPacketFreeList final {
+ public:
+  // Enough for a few full packet trains, about 1.2 MB.
+  static constexpr size_t kMaxLength = 1024;
+
+  ~QuicPacketFreeList() {
+    for (void* ptr : packets_)
+      ::operator delete(ptr);
+  }
+
+  void* Pop() {
+    if (packets_.empty())
+      return nullptr;
+    void* ptr = packets_.back();
+    packets_.pop_back();
+    return ptr;
+  }
+
+  bool Push(void* ptr) {
+    if (packets_.size() >= kMaxLength)
+      return false;
+    packets_.push_back(ptr);
+    return true;
+  }
+
+ private:
+  std::vector<void*> packets_;
+};
+
+thread_local QuicPacketFreeList packet_free_list;
+}  // namespace
+
+void* QuicPacket::operator new(size_t size) {
+  CHECK_EQ(size, sizeof(QuicPacket));
+  void* ptr = packet_free_list.Pop();
+  return ptr != nullptr ? ptr : ::operator new(size);
+}
+
+void QuicPacket::operator delete(void* ptr) {
+  if (!packet_free_list.Push(ptr))
+    ::operator delete(ptr);
+}
+
 QuicPacket::QuicPacket(const QuicPacket& other) :
   QuicPacket(other.diagnostic_label_, other.len_) {
   memcpy(&data_, &other.data_, other.len_);
@@ -187,19 +289,44 @@ QuicEndpoint::QuicEndpoint(
 }
 
 QuicEndpoint::~QuicEndpoint() {
+  StopSteering();
   udp_->set_listener(nullptr);
 }
 
 uv_buf_t QuicEndpoint::OnAlloc(size_t suggested_size) {
-  return AllocatedBuffer::AllocateManaged(env(), suggested_size).release();
+  // If the underlying UDP handle reads multiple datagrams at once, it needs
+  // room for all of them.
+  const size_t size = suggested_size * udp_->GetRecvBatchSize();
+  // Reading more data while the previous read is still being processed can
+  // only happen with a JS-backed UDP handle. Use a separate buffer then.
+  if (UNLIKELY(recv_buffer_in_use_))
+    return AllocatedBuffer::AllocateManaged(env(), size).release();
+  if (recv_buffer_size_ < size) {
+    recv_buffer_.reset(new char[size]);
+    recv_buffer_size_ = size;
+  }
+  recv_buffer_in_use_ = true;
+  return uv_buf_init(recv_buffer_.get(), size);
 }
 
 void QuicEndpoint::OnRecv(
     ssize_t nread,
-    const uv_buf_t& buf_,
+    const uv_buf_t& buf,
     const sockaddr* addr,
     unsigned int flags) {
-  AllocatedBuffer buf(env(), buf_);
+  const bool owned = buf.base >= recv_buffer_.get() &&
+                     buf.base < recv_buffer_.get() + recv_buffer_size_;
+  // Datagrams read with recvmmsg() point into the buffer returned by
+  // OnAlloc(), which is released by a final callback without data.
+  const bool last_use = !(flags & UV_UDP_MMSG_CHUNK);
+  AllocatedBuffer allocated;
+  if (!owned && last_use)
+    allocated = AllocatedBuffer(env(), buf);
+
+  auto on_scope_leave = OnScopeLeave([&]() {
+    if (owned && last_use)
+      recv_buffer_in_use_ = false;
+  });
 
   if (nread <= 0) {
     if (nread < 0)
@@ -209,7 +336,7 @@ void QuicEndpoint::OnRecv(
 
   listener_->OnReceive(
       nread,
-      std::move(buf),
+      reinterpret_cast<const uint8_t*>(buf.base),
       local_address(),
       SocketAddress(addr),
       flags);
@@ -226,10 +353,94 @@ void QuicEndpoint::OnSendDone(ReqWrap<uv_udp_send_t>* wrap, int status) {
     listener_->OnEndpointDone(this);
 }
 
+uv_udp_send_t* QuicEndpoint::CreateNativeSendReq(size_t msg_size) {
+  return listener_->OnCreateNativeSendReq(msg_size);
+}
+
+void QuicEndpoint::OnNativeSendDone(uv_udp_send_t* req, int status) {
+  DecrementPendingCallbacks();
+  listener_->OnNativeSendDone(req, status);
+  if (!has_pending_callbacks() && waiting_for_callbacks_)
+    listener_->OnEndpointDone(this);
+}
+
 void QuicEndpoint::OnAfterBind() {
   listener_->OnBind(this);
 }
 
+int QuicEndpoint::OnBindReusePort(int fd,
+                                  const SocketAddress& local_address) {
+  // Steer the packets for the connection IDs that the sessions of the
+  // QuicSocket issue to this socket.
+  if (!listener_ || !listener_->has_server_id())
+    return 0;
+#if defined(__linux__) && defined(SO_ATTACH_REUSEPORT_CBPF)
+  CHECK(!steering_);
+  Mutex::ScopedLock lock(steering_groups_mutex);
+  SteeringGroup& group = steering_groups[local_address];
+  group.push_back(SteeringMember { this, fd, listener_->server_id() });
+  int err = AttachSteeringProgram(group);
+  if (err != 0) {
+    group.pop_back();
+    if (group.empty())
+      steering_groups.erase(local_address);
+    return err;
+  }
+  steering_ = true;
+  steering_address_ = local_address;
+#endif
+  return 0;
+}
+
+void QuicEndpoint::OnBeforeClose() {
+  // The socket leaves its reuseport group when it is closed.
+  StopSteering();
+}
+
+void QuicEndpoint::StopSteering() {
+#if defined(__linux__) && defined(SO_ATTACH_REUSEPORT_CBPF)
+  if (!steering_)
+    return;
+  steering_ = false;
+  Mutex::ScopedLock lock(steering_groups_mutex);
+  auto it = steering_groups.find(steering_address_);
+  CHECK_NE(it, steering_groups.end());
+  SteeringGroup& group = it->second;
+  for (size_t n = 0; n < group.size(); n++) {
+    if (group[n].endpoint == this) {
+      // Same as the kernel does with the array of group members.
+      group[n] = group.back();
+      group.pop_back();
+      break;
+    }
+  }
+  if (group.empty()) {
+    steering_groups.erase(it);
+  } else {
+    // There is nobody to report a failure to. The kernel keeps the previous
+    // program then.
+    USE(AttachSteeringProgram(group));
+  }
+#endif
+}
+
+bool QuicEndpoint::HasSteeringTarget(const SocketAddress& local_address,
+                                     uint8_t server_id) {
+#if defined(__linux__) && defined(SO_ATTACH_REUSEPORT_CBPF)
+  Mutex::ScopedLock lock(steering_groups_mutex);
+  auto it = steering_groups.find(local_address);
+  if (it == steering_groups.end())
+    return true;
+  for (const SteeringMember& member : it->second) {
+    if (member.server_id == server_id)
+      return true;
+  }
+  return false;
+#else
+  return true;
+#endif
+}
+
 template <typename Fn>
 void QuicSocketStatsTraits::ToString(const QuicSocket& ptr, Fn&& add_field) {
 #define V(_n, name, label)                                                     \
@@ -248,7 +459,9 @@ QuicSocket::QuicSocket(
     uint32_t options,
     QlogMode qlog,
     const uint8_t* session_reset_secret,
-    bool disable_stateless_reset)
+    bool disable_stateless_reset,
+    const uint8_t* token_secret,
+    int server_id)
     : AsyncWrap(quic_state->env(), wrap, AsyncWrap::PROVIDER_QUICSOCKET),
       StatsBase(quic_state->env(), wrap),
       alloc_info_(MakeAllocator()),
@@ -268,7 +481,13 @@ QuicSocket::QuicSocket(
 
   Debug(this, "New QuicSocket created");
 
-  EntropySource(token_secret_, kTokenSecretLen);
+  if (token_secret != nullptr)
+    memcpy(token_secret_, token_secret, kTokenSecretLen);
+  else
+    EntropySource(token_secret_, kTokenSecretLen);
+
+  CHECK_LE(server_id, 0xff);
+  server_id_ = server_id;
 
   wrap->DefineOwnProperty(
       env()->context(),
@@ -355,6 +574,38 @@ ReqWrap<uv_udp_send_t>* QuicSocket::OnCreateSendWrap(size_t msg_size) {
   return last_created_send_wrap_ = new SendWrap(quic_state(), obj, msg_size);
 }
 
+uv_udp_send_t* QuicSocket::OnCreateNativeSendReq(size_t msg_size) {
+  // With tracking enabled, the caller falls back to OnCreateSendWrap().
+  if (has_option_track_send_requests())
+    return nullptr;
+  std::unique_ptr<SendRequest> req;
+  if (!free_send_requests_.empty()) {
+    req = std::move(free_send_requests_.back());
+    free_send_requests_.pop_back();
+  } else {
+    req = std::make_unique<SendRequest>();
+  }
+  last_created_send_req_ = req.release();
+  return &last_created_send_req_->req;
+}
+
+// Enough for the packets that are typically in flight at the same time.
+constexpr size_t kMaxFreeSendRequests = 256;
+
+void QuicSocket::RecycleSendRequest(SendRequest* req) {
+  std::unique_ptr<SendRequest> ptr(req);
+  ptr->packet.reset();
+  ptr->session.reset();
+  if (free_send_requests_.size() < kMaxFreeSendRequests)
+    free_send_requests_.emplace_back(std::move(ptr));
+}
+
+void QuicSocket::OnNativeSendDone(uv_udp_send_t* req, int status) {
+  SendRequest* send_req = ContainerOf(&SendRequest::req, req);
+  OnSend(status, send_req->packet.get());
+  RecycleSendRequest(send_req);
+}
+
 void QuicSocket::OnEndpointDone(QuicEndpoint* endpoint) {
   Debug(this, "Endpoint has no pending callbacks");
   listener_->OnEndpointDone(endpoint);
@@ -426,7 +677,7 @@ bool QuicSocket::MaybeStatelessReset(
 // Any packet we choose not to process must be ignored.
 void QuicSocket::OnReceive(
     ssize_t nread,
-    AllocatedBuffer buf,
+    const uint8_t* data,
     const SocketAddress& local_addr,
     const SocketAddress& remote_addr,
     unsigned int flags) {
@@ -447,8 +698,6 @@ void QuicSocket::OnReceive(
 
   IncrementStat(&QuicSocketStats::bytes_received, nread);
 
-  const uint8_t* data = reinterpret_cast<const uint8_t*>(buf.data());
-
   uint32_t pversion;
   const uint8_t* pdcid;
   size_t pdcidlen;
@@ -515,6 +764,27 @@ void QuicSocket::OnReceive(
       return;
     }
 
+    // When several sockets share the port, a short header packet for a
+    // connection ID issued by another socket has been delivered to the
+    // wrong one. The connection is not ours to reset, so just drop it,
+    // unless that socket has been closed along with its sessions. The peer
+    // is then told right away, since all the sockets share the secret
+    // that stateless reset tokens are derived from.
+    if (is_short_header &&
+        has_server_id() &&
+        dcid.length() > 0 &&
+        dcid.data()[0] != server_id()) {
+      if (!QuicEndpoint::HasSteeringTarget(local_addr, dcid.data()[0]) &&
+          SendStatelessReset(dcid, local_addr, remote_addr, nread)) {
+        Debug(this, "Sent stateless reset for a closed server id");
+        IncrementStat(&QuicSocketStats::stateless_reset_count);
+        return;
+      }
+      Debug(this, "Ignoring packet for another server id");
+      IncrementStat(&QuicSocketStats::packets_misrouted);
+      return;
+    }
+
     // AcceptInitialPacket will first validate that the packet can be
     // accepted, then create a new server QuicSession instance if able
     // to do so. If a new instance cannot be created (for any reason),
@@ -902,16 +1172,108 @@ int QuicSocket::SendPacket(
     return 0;
   }
 
+  if (send_batch_depth_ == 0)
+    return Transmit(local_addr, remote_addr, std::move(packet), session);
+
+  if (!CanAppendToPacketTrain(local_addr, remote_addr, *packet, session)) {
+    FlushPacketTrain();
+    packet_train_.local_addr = local_addr;
+    packet_train_.remote_addr = remote_addr;
+    packet_train_.session = session;
+    packet_train_.segment_size = packet->length();
+  }
+  packet_train_.length += packet->length();
+  packet_train_.packets.emplace_back(std::move(packet));
+  return 0;
+}
+
+// The kernel accepts up to 64 segments per send, each of which is a
+// full-sized QUIC packet, as long as the total stays below the maximum
+// size of a single UDP datagram.
+constexpr size_t kMaxPacketTrainPackets = 64;
+constexpr size_t kMaxPacketTrainLength = 65000;
+
+bool QuicSocket::CanAppendToPacketTrain(
+    const SocketAddress& local_addr,
+    const SocketAddress& remote_addr,
+    const QuicPacket& packet,
+    const BaseObjectPtr<QuicSession>& session) const {
+  const PacketTrain& train = packet_train_;
+  if (train.packets.empty())
+    return false;
+  // All packets but the last one must be exactly segment_size bytes long.
+  return train.packets.back()->length() == train.segment_size &&
+         packet.length() <= train.segment_size &&
+         train.packets.size() < kMaxPacketTrainPackets &&
+         train.length + packet.length() <= kMaxPacketTrainLength &&
+         train.session == session &&
+         train.local_addr == local_addr &&
+         train.remote_addr == remote_addr;
+}
+
+void QuicSocket::FlushPacketTrain() {
+  PacketTrain train = std::move(packet_train_);
+  packet_train_ = PacketTrain();
+  const size_t count = train.packets.size();
+  if (count == 0)
+    return;
+
+  size_t sent = 0;
+  if (count > 1) {
+    auto endpoint = bound_endpoints_.find(train.local_addr);
+    CHECK_NE(endpoint, bound_endpoints_.end());
+    MaybeStackBuffer<uv_buf_t, kMaxPacketTrainPackets> bufs(count);
+    for (size_t n = 0; n < count; n++)
+      bufs[n] = train.packets[n]->buf();
+    ssize_t ret = endpoint->second->TrySendBatch(
+        *bufs,
+        count,
+        train.segment_size,
+        train.remote_addr.data());
+    if (ret > 0) {
+      Debug(this, "Sent %" PRId64 " packets (%" PRIu64 " bytes) at once",
+            ret, train.length);
+      sent = ret;
+      IncrementStat(&QuicSocketStats::send_calls);
+    }
+  }
+
+  for (size_t n = 0; n < sent; n++)
+    OnSend(0, train.packets[n].get());
+
+  // Whatever could not be sent at once goes through the regular path,
+  // where libuv queues it until the socket is writable.
+  for (size_t n = sent; n < count; n++) {
+    Transmit(train.local_addr,
+             train.remote_addr,
+             std::move(train.packets[n]),
+             train.session);
+  }
+}
+
+int QuicSocket::Transmit(
+    const SocketAddress& local_addr,
+    const SocketAddress& remote_addr,
+    std::unique_ptr<QuicPacket> packet,
+    BaseObjectPtr<QuicSession> session) {
   last_created_send_wrap_ = nullptr;
+  last_created_send_req_ = nullptr;
   uv_buf_t buf = packet->buf();
 
   auto endpoint = bound_endpoints_.find(local_addr);
   CHECK_NE(endpoint, bound_endpoints_.end());
   int err = endpoint->second->Send(&buf, 1, remote_addr.data());
+  IncrementStat(&QuicSocketStats::send_calls);
 
   if (err != 0) {
     if (err > 0) err = 0;
+    // A native request that could not be dispatched is still ours.
+    if (last_created_send_req_ != nullptr)
+      RecycleSendRequest(last_created_send_req_);
     OnSend(err, packet.get());
+  } else if (last_created_send_req_ != nullptr) {
+    last_created_send_req_->packet = std::move(packet);
+    last_created_send_req_->session = std::move(session);
   } else {
     CHECK_NOT_NULL(last_created_send_wrap_);
     last_created_send_wrap_->set_packet(std::move(packet));
@@ -1041,6 +1403,19 @@ void NewQuicSocket(const FunctionCallbackInfo<Value>& args) {
     session_reset_secret = buf.data();
   }
 
+  const uint8_t* token_secret = nullptr;
+  if (args[8]->IsArrayBufferView()) {
+    ArrayBufferViewContents<uint8_t> buf(args[8].As<ArrayBufferView>());
+    CHECK_EQ(buf.length(), kTokenSecretLen);
+    token_secret = buf.data();
+  }
+
+  int32_t server_id = -1;
+  if (args[9]->IsInt32()) {
+    server_id = args[9].As<Int32>()->Value();
+    CHECK_LE(server_id, 0xff);
+  }
+
   new QuicSocket(
       state,
       args.This(),
@@ -1051,7 +1426,9 @@ void NewQuicSocket(const FunctionCallbackInfo<Value>& args) {
       options,
       args[5]->IsTrue() ? QlogMode::kEnabled : QlogMode::kDisabled,
       session_reset_secret,
-      args[7]->IsTrue());
+      args[7]->IsTrue(),
+      token_secret,
+      server_id);
 }
 
 void QuicSocketAddEndpoint(const FunctionCallbackInfo<Value>& args) {
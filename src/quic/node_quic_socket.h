@@ -39,7 +39,8 @@ constexpr size_t DEFAULT_MAX_SOCKETADDRESS_LRU_SIZE = 1000;
 constexpr size_t DEFAULT_MAX_RETRY_LIMIT = 10;
 
 #define QUICSOCKET_OPTIONS(V)                                                  \
-    V(VALIDATE_ADDRESS, validate_address)
+    V(VALIDATE_ADDRESS, validate_address)                                      \
+    V(TRACK_SEND_REQUESTS, track_send_requests)
 
 #define V(id, _) QUICSOCKET_OPTIONS_##id,
 enum QuicSocketOptions : uint32_t {
@@ -80,7 +81,9 @@ enum QuicSocketStateFields {
   V(SERVER_SESSIONS, server_sessions, "Server Sessions")                       \
   V(CLIENT_SESSIONS, client_sessions, "Client Sessions")                       \
   V(STATELESS_RESET_COUNT, stateless_reset_count, "Stateless Reset Count")     \
-  V(SERVER_BUSY_COUNT, server_busy_count, "Server Busy Count")
+  V(SERVER_BUSY_COUNT, server_busy_count, "Server Busy Count")             \
+  V(SEND_CALLS, send_calls, "Send Calls")                                      \
+  V(PACKETS_MISROUTED, packets_misrouted, "Packets Misrouted")
 
 #define V(name, _, __) IDX_QUIC_SOCKET_STATS_##name,
 enum QuicSocketStatsIdx : int {
@@ -144,7 +147,8 @@ constexpr size_t MAX_PKTLEN =
 // QuicPackets are intended to be transient. They are created,
 // filled with the contents of a serialized packet, and passed
 // off immediately to the QuicSocket to be sent. As soon as
-// the packet is sent, it is freed.
+// the packet is sent, it is freed. The memory of freed packets
+// is kept on a per-thread free list and reused for new ones.
 class QuicPacket : public MemoryRetainer {
  public:
   // Creates a new QuicPacket. By default the packet will be
@@ -184,6 +188,9 @@ class QuicPacket : public MemoryRetainer {
   QuicPacket(const char* diagnostic_label, size_t len);
   QuicPacket(const QuicPacket& other);
 
+  static void* operator new(size_t size);
+  static void operator delete(void* ptr);
+
   uint8_t* data() { return data_; }
 
   size_t length() const { return len_; }
@@ -214,12 +221,14 @@ class QuicEndpointListener {
   virtual void OnError(QuicEndpoint* endpoint, ssize_t error) = 0;
   virtual void OnReceive(
       ssize_t nread,
-      AllocatedBuffer buf,
+      const uint8_t* data,
       const SocketAddress& local_addr,
       const SocketAddress& remote_addr,
       unsigned int flags) = 0;
   virtual ReqWrap<uv_udp_send_t>* OnCreateSendWrap(size_t msg_size) = 0;
   virtual void OnSendDone(ReqWrap<uv_udp_send_t>* wrap, int status) = 0;
+  virtual uv_udp_send_t* OnCreateNativeSendReq(size_t msg_size) = 0;
+  virtual void OnNativeSendDone(uv_udp_send_t* req, int status) = 0;
   virtual void OnBind(QuicEndpoint* endpoint) = 0;
   virtual void OnEndpointDone(QuicEndpoint* endpoint) = 0;
 };
@@ -259,8 +268,23 @@ class QuicEndpoint final : public BaseObject,
 
   void OnSendDone(ReqWrap<uv_udp_send_t>* wrap, int status) override;
 
+  uv_udp_send_t* CreateNativeSendReq(size_t msg_size) override;
+
+  void OnNativeSendDone(uv_udp_send_t* req, int status) override;
+
   void OnAfterBind() override;
 
+  int OnBindReusePort(int fd, const SocketAddress& local_address) override;
+
+  void OnBeforeClose() override;
+
+  // Whether a socket that is still open steers packets for `server_id` to
+  // itself in the reuseport group bound to `local_address`. Also true when
+  // the sockets of that group are not tracked, e.g. on platforms without
+  // steering.
+  static bool HasSteeringTarget(const SocketAddress& local_address,
+                                uint8_t server_id);
+
   inline int ReceiveStart();
 
   inline int ReceiveStop();
@@ -270,6 +294,12 @@ class QuicEndpoint final : public BaseObject,
       size_t len,
       const sockaddr* addr);
 
+  inline ssize_t TrySendBatch(
+      uv_buf_t* bufs,
+      size_t nbufs,
+      size_t segment_size,
+      const sockaddr* addr);
+
   void IncrementPendingCallbacks() { pending_callbacks_++; }
   void DecrementPendingCallbacks() { pending_callbacks_--; }
   bool has_pending_callbacks() const { return pending_callbacks_ > 0; }
@@ -288,6 +318,19 @@ class QuicEndpoint final : public BaseObject,
   size_t pending_callbacks_ = 0;
   bool waiting_for_callbacks_ = false;
   BaseObjectPtr<QuicState> quic_state_;
+  // Removes the socket from the steering of its reuseport group, if it was
+  // added by OnBindReusePort().
+  void StopSteering();
+
+  // The local address of the reuseport group, while packets are steered.
+  bool steering_ = false;
+  SocketAddress steering_address_;
+
+  // Received packets are processed synchronously, so the same buffer is
+  // reused for every read.
+  std::unique_ptr<char[]> recv_buffer_;
+  size_t recv_buffer_size_ = 0;
+  bool recv_buffer_in_use_ = false;
 };
 
 // QuicSocket manages the flow of data from the UDP socket to the
@@ -320,7 +363,14 @@ class QuicSocket : public AsyncWrap,
       uint32_t options = 0,
       QlogMode qlog = QlogMode::kDisabled,
       const uint8_t* session_reset_secret = nullptr,
-      bool disable_session_reset = false);
+      bool disable_session_reset = false,
+      // Sockets that share a UDP port across threads must also share
+      // the secret used to validate retry tokens.
+      const uint8_t* token_secret = nullptr,
+      // When not negative, the first byte of every connection ID that a
+      // session of this socket issues. Used to steer packets to the socket
+      // that owns the connection when several sockets share a port.
+      int server_id = -1);
 
   ~QuicSocket() override;
 
@@ -371,6 +421,28 @@ class QuicSocket : public AsyncWrap,
       std::unique_ptr<QuicPacket> packet,
       BaseObjectPtr<QuicSession> session = BaseObjectPtr<QuicSession>());
 
+  // While a SendBatchScope is active, packets passed to SendPacket() are
+  // collected into packet trains: runs of packets of the same size for the
+  // same destination, which are sent with a single system call (using UDP
+  // segmentation offload where available) when the train is full, when
+  // a packet does not fit, or when the outermost scope ends.
+  class SendBatchScope final {
+   public:
+    explicit SendBatchScope(QuicSocket* socket) : socket_(socket) {
+      socket_->send_batch_depth_++;
+    }
+
+    SendBatchScope(const SendBatchScope& other) = delete;
+
+    ~SendBatchScope() {
+      if (--socket_->send_batch_depth_ == 0)
+        socket_->FlushPacketTrain();
+    }
+
+   private:
+    BaseObjectPtr<QuicSocket> socket_;
+  };
+
 #define V(id, name)                                                            \
   bool has_option_##name() const {                                             \
     return options_ & (1 << QUICSOCKET_OPTIONS_##id); }
@@ -403,19 +475,28 @@ class QuicSocket : public AsyncWrap,
 
   const uint8_t* session_reset_secret() { return reset_token_secret_; }
 
+  bool has_server_id() const { return server_id_ >= 0; }
+  uint8_t server_id() const { return static_cast<uint8_t>(server_id_); }
+
   // Implementation for QuicListener
   ReqWrap<uv_udp_send_t>* OnCreateSendWrap(size_t msg_size) override;
 
   // Implementation for QuicListener
   void OnSendDone(ReqWrap<uv_udp_send_t>* wrap, int status) override;
 
+  // Implementation for QuicListener
+  uv_udp_send_t* OnCreateNativeSendReq(size_t msg_size) override;
+
+  // Implementation for QuicListener
+  void OnNativeSendDone(uv_udp_send_t* req, int status) override;
+
   // Implementation for QuicListener
   void OnBind(QuicEndpoint* endpoint) override;
 
   // Implementation for QuicListener
   void OnReceive(
       ssize_t nread,
-      AllocatedBuffer buf,
+      const uint8_t* data,
       const SocketAddress& local_addr,
       const SocketAddress& remote_addr,
       unsigned int flags) override;
@@ -472,6 +553,20 @@ class QuicSocket : public AsyncWrap,
 
   void OnSend(int status, QuicPacket* packet);
 
+  int Transmit(
+      const SocketAddress& local_addr,
+      const SocketAddress& remote_addr,
+      std::unique_ptr<QuicPacket> packet,
+      BaseObjectPtr<QuicSession> session);
+
+  bool CanAppendToPacketTrain(
+      const SocketAddress& local_addr,
+      const SocketAddress& remote_addr,
+      const QuicPacket& packet,
+      const BaseObjectPtr<QuicSession>& session) const;
+
+  void FlushPacketTrain();
+
   inline void set_validated_address(const SocketAddress& addr);
 
   inline bool is_validated_address(const SocketAddress& addr) const;
@@ -546,6 +641,7 @@ class QuicSocket : public AsyncWrap,
 
   uint8_t token_secret_[kTokenSecretLen];
   uint8_t reset_token_secret_[NGTCP2_STATELESS_RESET_TOKENLEN];
+  int server_id_ = -1;
 
   struct SocketAddressInfo {
     size_t active_connections;
@@ -598,6 +694,33 @@ class QuicSocket : public AsyncWrap,
   SendWrap* last_created_send_wrap_ = nullptr;
   BaseObjectPtr<QuicState> quic_state_;
 
+  // Unless send requests are tracked (see the TRACK_SEND_REQUESTS option),
+  // packets that cannot be sent immediately use a plain libuv request
+  // instead of a SendWrap, which avoids creating a JS object per packet.
+  // Completed requests are kept for reuse.
+  struct SendRequest {
+    uv_udp_send_t req;
+    std::unique_ptr<QuicPacket> packet;
+    BaseObjectPtr<QuicSession> session;
+  };
+
+  void RecycleSendRequest(SendRequest* req);
+
+  std::vector<std::unique_ptr<SendRequest>> free_send_requests_;
+  SendRequest* last_created_send_req_ = nullptr;
+
+  struct PacketTrain {
+    SocketAddress local_addr;
+    SocketAddress remote_addr;
+    BaseObjectPtr<QuicSession> session;
+    std::vector<std::unique_ptr<QuicPacket>> packets;
+    size_t segment_size = 0;
+    size_t length = 0;
+  };
+
+  PacketTrain packet_train_;
+  size_t send_batch_depth_ = 0;
+
   friend class QuicSocketListener;
 };
 
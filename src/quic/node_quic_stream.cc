@@ -5,6 +5,7 @@
 #include "env-inl.h"
 #include "node.h"
 #include "node_buffer.h"
+#include "node_bob-inl.h"
 #include "node_internals.h"
 #include "stream_base-inl.h"
 #include "node_sockaddr-inl.h"
@@ -23,6 +24,7 @@
 namespace node {
 
 using v8::Array;
+using v8::ArrayBufferView;
 using v8::Context;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
@@ -133,6 +135,10 @@ void QuicStream::Destroy(QuicError* error) {
     return;
   destroyed_ = true;
 
+  // JavaScript has to close or release a source that has not ended yet.
+  if (source_)
+    StreamSource::Cancel(std::move(source_));
+
   if (is_writable() || is_readable())
     session()->ShutdownStream(id(), 0);
 
@@ -171,12 +177,75 @@ int QuicStream::DoShutdown(ShutdownWrap* req_wrap) {
   Debug(this, "Shutdown writable side");
   RecordTimestamp(&QuicStreamStats::closing_at);
   state_->write_ended = 1;
-  streambuf_.End();
+  // When pulling from a source, the buffer is ended once it has been
+  // drained, see OnSourceReadable().
+  if (!source_)
+    streambuf_.End();
   session()->ResumeStream(stream_id_);
 
   return 0;
 }
 
+void QuicStream::PullFrom(StreamBase* source) {
+  CHECK(!source_);
+  CHECK(!streambuf_.is_ended());
+  source_ = std::make_unique<StreamSource>(
+      source,
+      [this]() { OnSourceReadable(); });
+  source_->Start();
+}
+
+void QuicStream::SendBody(Local<ArrayBufferView> body) {
+  CHECK(!source_);
+  if (is_destroyed())
+    return;
+  CHECK(!streambuf_.is_ended());
+  ArrayBufferViewSource source(body);
+  PullAvailable(&source);
+}
+
+void QuicStream::OnSourceReadable() {
+  if (is_destroyed() || !source_ || streambuf_.is_ended())
+    return;
+  PullAvailable(source_.get());
+}
+
+void QuicStream::PullAvailable(bob::Source<uv_buf_t>* source) {
+  QuicSession::SendSessionScope send_scope(session());
+
+  int status = bob::Status::STATUS_CONTINUE;
+  while (status == bob::Status::STATUS_CONTINUE) {
+    status = source->Pull(
+        [&](int, const uv_buf_t* bufs, size_t count, bob::Done done) {
+      if (count == 0)
+        return;
+      size_t length = get_length(bufs, count);
+      IncrementStat(&QuicStreamStats::bytes_sent,
+                    static_cast<uint64_t>(length));
+      // As with DoWrite(), the buffers stay in streambuf_ until they have
+      // been acknowledged, which is when the source may reuse the memory.
+      streambuf_.Push(
+          const_cast<uv_buf_t*>(bufs),
+          count,
+          [done = std::move(done)](int status) mutable {
+            std::move(done)(0);
+          });
+    },
+    bob::Options::OPTIONS_SYNC,
+    nullptr,
+    0);
+  }
+
+  // Errors are reported to JavaScript by a StreamSource, which will destroy
+  // the stream.
+  if (status == bob::Status::STATUS_END || status == bob::Status::STATUS_EOS) {
+    RecordTimestamp(&QuicStreamStats::closing_at);
+    streambuf_.End();
+  }
+
+  session()->ResumeStream(stream_id_);
+}
+
 int QuicStream::DoWrite(
     WriteWrap* req_wrap,
     uv_buf_t* bufs,
@@ -277,6 +346,7 @@ void QuicStream::IncrementStats(size_t datalen) {
 
 void QuicStream::MemoryInfo(MemoryTracker* tracker) const {
   tracker->TrackField("buffer", &streambuf_);
+  tracker->TrackField("source", source_);
   StatsBase::StatsMemoryInfo(tracker);
   tracker->TrackField("headers", headers_);
 }
@@ -446,6 +516,22 @@ void QuicStreamDestroy(const FunctionCallbackInfo<Value>& args) {
   stream->Destroy(&error);
 }
 
+void QuicStreamPullFrom(const FunctionCallbackInfo<Value>& args) {
+  QuicStream* stream;
+  ASSIGN_OR_RETURN_UNWRAP(&stream, args.Holder());
+  CHECK(args[0]->IsObject());
+  StreamBase* source = StreamBase::FromObject(args[0].As<Object>());
+  CHECK_NOT_NULL(source);
+  stream->PullFrom(source);
+}
+
+void QuicStreamSendBody(const FunctionCallbackInfo<Value>& args) {
+  QuicStream* stream;
+  ASSIGN_OR_RETURN_UNWRAP(&stream, args.Holder());
+  CHECK(args[0]->IsArrayBufferView());
+  stream->SendBody(args[0].As<ArrayBufferView>());
+}
+
 void QuicStreamReset(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
   QuicStream* stream;
@@ -537,6 +623,8 @@ void QuicStream::Initialize(
   env->SetProtoMethod(stream, "destroy", QuicStreamDestroy);
   env->SetProtoMethod(stream, "resetStream", QuicStreamReset);
   env->SetProtoMethod(stream, "stopSending", QuicStreamStopSending);
+  env->SetProtoMethod(stream, "pullFrom", QuicStreamPullFrom);
+  env->SetProtoMethod(stream, "sendBody", QuicStreamSendBody);
   env->SetProtoMethod(stream, "id", QuicStreamGetID);
   env->SetProtoMethod(stream, "submitInformation", QuicStreamSubmitInformation);
   env->SetProtoMethod(stream, "submitHeaders", QuicStreamSubmitHeaders);
@@ -11,6 +11,7 @@
 #include "node_quic_state.h"
 #include "node_quic_util.h"
 #include "stream_base-inl.h"
+#include "stream_source.h"
 #include "util-inl.h"
 #include "v8.h"
 
@@ -344,6 +345,16 @@ class QuicStream : public AsyncWrap,
 
   AsyncWrap* GetAsyncWrap() override { return this; }
 
+  // Sends the data read from the given stream, e.g. a FileHandle, without
+  // going through the StreamBase write path. The source is read ahead of
+  // the acknowledgements from the peer, and the writable side is ended once
+  // the source has ended.
+  void PullFrom(StreamBase* source);
+
+  // Sends the memory of the given view as the rest of the data of this
+  // stream, without copying it, and ends the writable side.
+  void SendBody(v8::Local<v8::ArrayBufferView> body);
+
   QuicState* quic_state() { return quic_state_.get(); }
 
   // Required for MemoryRetainer
@@ -373,8 +384,15 @@ class QuicStream : public AsyncWrap,
 
   void IncrementStats(size_t datalen);
 
+  // Moves everything the source_ has read into streambuf_.
+  void OnSourceReadable();
+  // Moves everything that can be pulled from the source without blocking
+  // into streambuf_, and ends it once the source has ended.
+  void PullAvailable(bob::Source<uv_buf_t>* source);
+
   BaseObjectWeakPtr<QuicSession> session_;
   QuicBuffer streambuf_;
+  std::unique_ptr<StreamSource> source_;
 
   int64_t stream_id_ = 0;
   int64_t push_id_ = 0;
@@ -0,0 +1,235 @@
+#include "stream_source.h"
+#include "allocated_buffer-inl.h"
+#include "async_wrap-inl.h"
+#include "node_bob-inl.h"
+#include "stream_base-inl.h"
+#include "util-inl.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace node {
+
+// The buffers handed out by a single Pull(). The memory is released, and
+// the source is allowed to read more, once the Batch is destroyed along
+// with the last copy of the bob::Done callback that owns it.
+class StreamSource::Batch final {
+ public:
+  explicit Batch(std::shared_ptr<State> state) : state_(std::move(state)) {}
+
+  ~Batch() {
+    state_->outstanding -= length_;
+    if (state_->source != nullptr)
+      state_->source->MaybeReadStart();
+  }
+
+  void Add(Chunk&& chunk) {
+    length_ += chunk.length;
+    chunks_.emplace_back(std::move(chunk));
+  }
+
+ private:
+  std::shared_ptr<State> state_;
+  std::vector<Chunk> chunks_;
+  size_t length_ = 0;
+};
+
+StreamSource::StreamSource(
+    StreamBase* stream,
+    OnReadable on_readable,
+    size_t high_water_mark)
+    : stream_object_(stream->GetAsyncWrap()),
+      on_readable_(std::move(on_readable)),
+      high_water_mark_(high_water_mark),
+      state_(std::make_shared<State>()) {
+  CHECK_GT(high_water_mark_, 0);
+  state_->source = this;
+  stream->PushStreamListener(this);
+}
+
+StreamSource::~StreamSource() {
+  state_->source = nullptr;
+  state_->outstanding -= queued_length_;
+  if (reading_ && stream() != nullptr)
+    stream()->ReadStop();
+}
+
+void StreamSource::Start() {
+  MaybeReadStart();
+}
+
+void StreamSource::MaybeReadStart() {
+  if (reading_ || eof_ || stream() == nullptr ||
+      state_->outstanding >= high_water_mark_) {
+    return;
+  }
+  reading_ = true;
+  int err = stream()->ReadStart();
+  if (err != 0 && err != UV_EOF) {
+    // Surface the error through the usual read path.
+    OnStreamRead(err, uv_buf_init(nullptr, 0));
+  }
+}
+
+void StreamSource::Cancel(std::unique_ptr<StreamSource> source) {
+  // The consumer must not be called anymore.
+  source->on_readable_ = []() {};
+  if (source->eof_ || source->stream() == nullptr)
+    return;
+
+  source->eof_ = true;
+  source->error_ = UV_ECANCELED;
+  if (source->reading_)
+    source->stream()->ReadStop();
+  source->reading_ = false;
+
+  Environment* env = source->stream_object_->env();
+  env->SetImmediate([source = std::move(source)](Environment* env) {
+    // The stream may have been closed in the meantime.
+    if (source->stream() != nullptr)
+      source->PassReadErrorToPreviousListener(UV_ECANCELED);
+  });
+}
+
+uv_buf_t StreamSource::OnStreamAlloc(size_t suggested_size) {
+  // Allocate the same way the default listener would, in case a read that
+  // is already in flight completes after this listener has been removed.
+  return AllocatedBuffer::AllocateManaged(
+      stream_object_->env(), suggested_size).release();
+}
+
+void StreamSource::OnStreamRead(ssize_t nread, const uv_buf_t& buf_) {
+  AllocatedBuffer buf(stream_object_->env(), buf_);
+
+  if (nread == 0)
+    return;
+
+  if (nread < 0) {
+    eof_ = true;
+    if (nread != UV_EOF)
+      error_ = static_cast<int>(nread);
+    if (reading_ && stream() != nullptr)
+      stream()->ReadStop();
+    reading_ = false;
+    on_readable_();
+    // This is the last thing we do, as the previous listener (usually the
+    // JS handler) may close the stream or destroy the consumer.
+    if (stream() != nullptr)
+      PassReadErrorToPreviousListener(nread);
+    return;
+  }
+
+  queued_length_ += nread;
+  state_->outstanding += nread;
+  queue_.push_back(Chunk { std::move(buf), static_cast<size_t>(nread) });
+
+  if (state_->outstanding >= high_water_mark_) {
+    reading_ = false;
+    stream()->ReadStop();
+  }
+
+  on_readable_();
+}
+
+void StreamSource::OnStreamDestroy() {
+  // The stream is going away without having reported EOF. Whatever has been
+  // read so far can still be pulled, but the body is incomplete.
+  if (!eof_) {
+    eof_ = true;
+    error_ = UV_EPIPE;
+  }
+  reading_ = false;
+  on_readable_();
+}
+
+int StreamSource::DoPull(
+    bob::Next<uv_buf_t> next,
+    int options,
+    uv_buf_t* data,
+    size_t count,
+    size_t max_count_hint) {
+  if (error_ != 0 && queue_.empty()) {
+    std::move(next)(error_, nullptr, 0, [](size_t len) {});
+    return error_;
+  }
+
+  if (queue_.empty()) {
+    if (eof_) {
+      std::move(next)(bob::Status::STATUS_END, nullptr, 0, [](size_t len) {});
+      return bob::Status::STATUS_END;
+    }
+    MaybeReadStart();
+    std::move(next)(bob::Status::STATUS_BLOCK, nullptr, 0, [](size_t len) {});
+    return bob::Status::STATUS_BLOCK;
+  }
+
+  MaybeStackBuffer<uv_buf_t, bob::kMaxCountHint> vecs;
+  if (data == nullptr || count == 0) {
+    count = std::min(queue_.size(), max_count_hint);
+    vecs.AllocateSufficientStorage(count);
+    data = vecs.out();
+  } else {
+    count = std::min(queue_.size(), count);
+  }
+
+  auto batch = std::make_shared<Batch>(state_);
+  for (size_t n = 0; n < count; n++) {
+    Chunk& chunk = queue_.front();
+    data[n] = uv_buf_init(chunk.buffer.data(), chunk.length);
+    queued_length_ -= chunk.length;
+    batch->Add(std::move(chunk));
+    queue_.pop_front();
+  }
+
+  int status = eof_ && queue_.empty() && error_ == 0 ?
+      bob::Status::STATUS_END :
+      bob::Status::STATUS_CONTINUE;
+
+  std::move(next)(
+      status,
+      data,
+      count,
+      [batch = std::move(batch)](size_t len) mutable { batch.reset(); });
+
+  return status;
+}
+
+void StreamSource::MemoryInfo(MemoryTracker* tracker) const {
+  tracker->TrackFieldWithSize("queue", queued_length_);
+}
+
+ArrayBufferViewSource::ArrayBufferViewSource(
+    v8::Local<v8::ArrayBufferView> view)
+    : store_(view->Buffer()->GetBackingStore()),
+      buf_(uv_buf_init(static_cast<char*>(store_->Data()) + view->ByteOffset(),
+                       view->ByteLength())) {}
+
+int ArrayBufferViewSource::DoPull(
+    bob::Next<uv_buf_t> next,
+    int options,
+    uv_buf_t* data,
+    size_t count,
+    size_t max_count_hint) {
+  if (buf_.len == 0) {
+    std::move(next)(bob::Status::STATUS_END, nullptr, 0, [](size_t len) {});
+    return bob::Status::STATUS_END;
+  }
+
+  uv_buf_t buf = buf_;
+  buf_ = uv_buf_init(nullptr, 0);
+  if (data != nullptr && count > 0) {
+    data[0] = buf;
+  } else {
+    data = &buf;
+  }
+
+  std::move(next)(
+      bob::Status::STATUS_END,
+      data,
+      1,
+      [store = std::move(store_)](size_t len) mutable { store.reset(); });
+
+  return bob::Status::STATUS_END;
+}
+
+}  // namespace node
@@ -0,0 +1,141 @@
+#ifndef SRC_STREAM_SOURCE_H_
+#define SRC_STREAM_SOURCE_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include "allocated_buffer.h"
+#include "base_object.h"
+#include "memory_tracker.h"
+#include "node_bob.h"
+#include "stream_base.h"
+#include "util.h"
+
+#include <deque>
+#include <functional>
+#include <memory>
+
+namespace node {
+
+// A StreamSource adapts a readable StreamBase, for instance a FileHandle,
+// into a bob::Source of uv_buf_t that a protocol stream can pull its body
+// from. Data is read ahead until high_water_mark bytes are held, either
+// queued in the source or pulled but not yet released by the consumer.
+//
+// The memory of pulled buffers is owned by the bob::Done callback that
+// accompanies them. The consumer keeps the callback until the data is no
+// longer needed, e.g. until it has been written to the socket or has been
+// acknowledged by the peer, which means that the data is never copied into
+// an intermediate queue of its own. Destroying the callback releases the
+// memory, and lets the source read more.
+//
+// EOF and read errors are passed on to the previous listener of the stream,
+// as StreamPipe does, so that JavaScript can close the underlying resource.
+class StreamSource final : public bob::SourceImpl<uv_buf_t>,
+                           public StreamListener,
+                           public MemoryRetainer {
+ public:
+  // Invoked whenever data can be pulled, or when the source has ended.
+  using OnReadable = std::function<void()>;
+
+  static constexpr size_t kDefaultHighWaterMark = 1024 * 1024;
+
+  StreamSource(
+      StreamBase* stream,
+      OnReadable on_readable,
+      size_t high_water_mark = kDefaultHighWaterMark);
+  ~StreamSource() override;
+
+  // Starts reading from the stream.
+  void Start();
+
+  // Releases a source whose consumer is going away. Unless the stream has
+  // already ended, reading stops and UV_ECANCELED is passed to the previous
+  // listener of the stream from a SetImmediate() callback, so that
+  // JavaScript can close or release the underlying resource, e.g. a file.
+  // Deleting the source directly would not notify JavaScript at all.
+  static void Cancel(std::unique_ptr<StreamSource> source);
+
+  // A negative libuv error code if reading from the stream failed.
+  int error() const { return error_; }
+
+  bool is_ended() const { return eof_ && queue_.empty(); }
+
+  // The number of bytes that are queued or pulled but not yet released.
+  size_t outstanding() const { return state_->outstanding; }
+
+  // StreamListener
+  uv_buf_t OnStreamAlloc(size_t suggested_size) override;
+  void OnStreamRead(ssize_t nread, const uv_buf_t& buf) override;
+  void OnStreamDestroy() override;
+
+  void MemoryInfo(MemoryTracker* tracker) const override;
+  SET_MEMORY_INFO_NAME(StreamSource)
+  SET_SELF_SIZE(StreamSource)
+
+ protected:
+  int DoPull(
+      bob::Next<uv_buf_t> next,
+      int options,
+      uv_buf_t* data,
+      size_t count,
+      size_t max_count_hint) override;
+
+ private:
+  // Shared with the Done callbacks of pulled buffers, which may outlive
+  // the source.
+  struct State {
+    size_t outstanding = 0;
+    StreamSource* source = nullptr;
+  };
+
+  struct Chunk {
+    AllocatedBuffer buffer;
+    size_t length;
+  };
+
+  class Batch;
+
+  void MaybeReadStart();
+
+  BaseObjectPtr<AsyncWrap> stream_object_;
+  OnReadable on_readable_;
+  size_t high_water_mark_;
+  std::shared_ptr<State> state_;
+  std::deque<Chunk> queue_;
+  size_t queued_length_ = 0;
+  int error_ = 0;
+  bool reading_ = false;
+  bool eof_ = false;
+};
+
+// An ArrayBufferViewSource hands out the memory of an ArrayBufferView, e.g.
+// a Buffer that is sent as the whole body of a protocol stream, in a single
+// uv_buf_t. The bob::Done callback that accompanies it holds on to the
+// backing store of the view, so the memory stays valid until the consumer
+// is done with it, even if the ArrayBuffer is detached or collected in the
+// meantime. The data is not copied, so it must not be modified until then.
+//
+// All of the data is available right away, so the source can be pulled
+// from synchronously until it ends, and then be discarded.
+class ArrayBufferViewSource final : public bob::SourceImpl<uv_buf_t> {
+ public:
+  explicit ArrayBufferViewSource(v8::Local<v8::ArrayBufferView> view);
+
+ protected:
+  int DoPull(
+      bob::Next<uv_buf_t> next,
+      int options,
+      uv_buf_t* data,
+      size_t count,
+      size_t max_count_hint) override;
+
+ private:
+  std::shared_ptr<v8::BackingStore> store_;
+  uv_buf_t buf_;
+};
+
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_STREAM_SOURCE_H_
@@ -24,6 +24,7 @@
 
 #include "env-inl.h"
 #include "handle_wrap.h"
+#include "histogram-inl.h"
 #include "node_buffer.h"
 #include "pipe_wrap.h"
 #include "req_wrap-inl.h"
@@ -150,6 +151,7 @@ Local<FunctionTemplate> LibuvStreamWrap::GetConstructorTemplate(
         Local<FunctionTemplate>(),
         static_cast<PropertyAttribute>(ReadOnly | DontDelete));
     env->SetProtoMethod(tmpl, "setBlocking", SetBlocking);
+    env->SetProtoMethod(tmpl, "setFirstByteHistogram", SetFirstByteHistogram);
     StreamBase::AddMethods(env, tmpl);
     env->set_libuv_stream_wrap_ctor_template(tmpl);
   }
@@ -176,6 +178,14 @@ int LibuvStreamWrap::GetFD() {
 }
 
 
+void LibuvStreamWrap::OnAccepted(LibuvStreamWrap* connection) {
+  if (!first_byte_histogram_)
+    return;
+  connection->first_byte_histogram_ = first_byte_histogram_;
+  connection->accept_time_ = uv_hrtime();
+}
+
+
 bool LibuvStreamWrap::IsAlive() {
   return HandleWrap::IsAlive(this);
 }
@@ -259,6 +269,12 @@ void LibuvStreamWrap::OnUvRead(ssize_t nread, const uv_buf_t* buf) {
   CHECK_EQ(persistent().IsEmpty(), false);
 
   if (nread > 0) {
+    if (accept_time_ != 0) {
+      first_byte_histogram_->RecordValue(uv_hrtime() - accept_time_);
+      first_byte_histogram_.reset();
+      accept_time_ = 0;
+    }
+
     MaybeLocal<Object> pending_obj;
 
     if (type == UV_TCP) {
@@ -311,6 +327,16 @@ void LibuvStreamWrap::SetBlocking(const FunctionCallbackInfo<Value>& args) {
   args.GetReturnValue().Set(uv_stream_set_blocking(wrap->stream(), enable));
 }
 
+void LibuvStreamWrap::SetFirstByteHistogram(
+    const FunctionCallbackInfo<Value>& args) {
+  LibuvStreamWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap, args.Holder());
+  CHECK(args[0]->IsObject());
+  HistogramBase* histogram;
+  ASSIGN_OR_RETURN_UNWRAP(&histogram, args[0].As<Object>());
+  wrap->first_byte_histogram_.reset(histogram);
+}
+
 typedef SimpleShutdownWrap<ReqWrap<uv_shutdown_t>> LibuvShutdownWrap;
 typedef SimpleWriteWrap<ReqWrap<uv_write_t>> LibuvWriteWrap;
 
@@ -26,6 +26,7 @@
 
 #include "stream_base.h"
 #include "handle_wrap.h"
+#include "histogram.h"
 #include "v8.h"
 
 namespace node {
@@ -78,6 +79,11 @@ class LibuvStreamWrap : public HandleWrap, public StreamBase {
 
   static LibuvStreamWrap* From(Environment* env, v8::Local<v8::Object> object);
 
+  // Called for each connection accepted by this handle. If a first byte
+  // histogram has been set on this handle, the time until the first byte is
+  // read from the connection is recorded into it.
+  void OnAccepted(LibuvStreamWrap* connection);
+
  protected:
   LibuvStreamWrap(Environment* env,
                   v8::Local<v8::Object> object,
@@ -101,6 +107,8 @@ class LibuvStreamWrap : public HandleWrap, public StreamBase {
   static void GetWriteQueueSize(
       const v8::FunctionCallbackInfo<v8::Value>& info);
   static void SetBlocking(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetFirstByteHistogram(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
 
   // Callbacks for libuv
   void OnUvAlloc(size_t suggested_size, uv_buf_t* buf);
@@ -111,6 +119,11 @@ class LibuvStreamWrap : public HandleWrap, public StreamBase {
 
   uv_stream_t* const stream_;
 
+  // Set by net.Server on its listening handle when the latency histograms
+  // are enabled, and on the accepted connections until their first read.
+  BaseObjectPtr<HistogramBase> first_byte_histogram_;
+  uint64_t accept_time_ = 0;
+
 #ifdef _WIN32
   // We don't always have an FD that we could look up on the stream_
   // object itself on Windows. However, for some cases, we open handles
@@ -0,0 +1,238 @@
+#include "timer_wheel.h"
+#include "util.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace node {
+
+namespace {
+
+// Both functions require `value` to be non-zero.
+inline unsigned MostSignificantBit(uint64_t value) {
+#if defined(_MSC_VER) && defined(_WIN64)
+  unsigned long index;  // NOLINT(runtime/int)
+  _BitScanReverse64(&index, value);
+  return static_cast<unsigned>(index);
+#elif defined(_MSC_VER)
+  unsigned bit = 0;
+  while (value >>= 1) bit++;
+  return bit;
+#else
+  return 63 - __builtin_clzll(value);
+#endif
+}
+
+inline unsigned LeastSignificantBit(uint64_t value) {
+#if defined(_MSC_VER) && defined(_WIN64)
+  unsigned long index;  // NOLINT(runtime/int)
+  _BitScanForward64(&index, value);
+  return static_cast<unsigned>(index);
+#elif defined(_MSC_VER)
+  unsigned bit = 0;
+  while ((value & 1) == 0) {
+    value >>= 1;
+    bit++;
+  }
+  return bit;
+#else
+  return __builtin_ctzll(value);
+#endif
+}
+
+}  // anonymous namespace
+
+constexpr uint64_t TimerWheel::kNever;
+constexpr uint32_t TimerWheel::kNativeTimerFlag;
+
+TimerWheel::TimerWheel(uint64_t now) : now_(now) {}
+
+TimerWheel::Entry& TimerWheel::entry(uint32_t id) {
+  if (IsNativeTimer(id))
+    return native_entries_[id & ~kNativeTimerFlag];
+  if (id >= entries_.size())
+    entries_.resize(id + 1);
+  return entries_[id];
+}
+
+const TimerWheel::Entry* TimerWheel::entry_if_exists(uint32_t id) const {
+  if (IsNativeTimer(id))
+    return &native_entries_[id & ~kNativeTimerFlag];
+  if (id >= entries_.size())
+    return nullptr;
+  return &entries_[id];
+}
+
+uint32_t TimerWheel::AddNativeTimer(Callback callback, void* data) {
+  uint32_t index;
+  if (!free_native_ids_.empty()) {
+    index = free_native_ids_.back();
+    free_native_ids_.pop_back();
+  } else {
+    index = native_timers_.size();
+    CHECK_LT(index, kNativeTimerFlag);
+    native_timers_.emplace_back();
+    native_entries_.emplace_back();
+  }
+  NativeTimer& timer = native_timers_[index];
+  timer.callback = callback;
+  timer.data = data;
+  timer.expired = false;
+  return index | kNativeTimerFlag;
+}
+
+void TimerWheel::RemoveNativeTimer(uint32_t id) {
+  CHECK(IsNativeTimer(id));
+  Cancel(id);
+  uint32_t index = id & ~kNativeTimerFlag;
+  native_timers_[index] = NativeTimer();
+  free_native_ids_.push_back(index);
+}
+
+void TimerWheel::Schedule(uint32_t id, uint64_t expiry) {
+  if (IsScheduled(id))
+    Unlink(id);
+  else
+    size_++;
+  if (IsNativeTimer(id))
+    native_timers_[id & ~kNativeTimerFlag].expired = false;
+  Link(id, expiry > now_ ? expiry : now_ + 1);
+}
+
+void TimerWheel::Cancel(uint32_t id) {
+  if (IsNativeTimer(id))
+    native_timers_[id & ~kNativeTimerFlag].expired = false;
+  if (!IsScheduled(id))
+    return;
+  Unlink(id);
+  size_--;
+}
+
+bool TimerWheel::IsScheduled(uint32_t id) const {
+  const Entry* e = entry_if_exists(id);
+  return e != nullptr && e->slot != kUnscheduled;
+}
+
+void TimerWheel::Link(uint32_t id, uint64_t expiry) {
+  // A timer that expires now can only be linked while its slot is being
+  // cascaded, in which case it ends up in the current slot of the lowest
+  // level, that expires right after the cascade.
+  uint64_t diff = expiry ^ now_;
+  unsigned level = diff == 0 ? 0 : MostSignificantBit(diff) / kBitsPerLevel;
+  unsigned index = SlotIndex(expiry, level);
+  uint16_t slot_index = level * kSlotsPerLevel + index;
+  Slot& slot = slots_[slot_index];
+
+  Entry& e = entry(id);
+  e.expiry = expiry;
+  e.slot = slot_index;
+  e.next = kNone;
+  e.prev = slot.tail;
+  if (slot.tail != kNone)
+    entry(slot.tail).next = id;
+  else
+    slot.head = id;
+  slot.tail = id;
+  occupied_[level] |= uint64_t{1} << index;
+}
+
+void TimerWheel::Unlink(uint32_t id) {
+  Entry& e = entry(id);
+  Slot& slot = slots_[e.slot];
+  if (e.prev != kNone)
+    entry(e.prev).next = e.next;
+  else
+    slot.head = e.next;
+  if (e.next != kNone)
+    entry(e.next).prev = e.prev;
+  else
+    slot.tail = e.prev;
+  if (slot.head == kNone) {
+    occupied_[e.slot / kSlotsPerLevel] &=
+        ~(uint64_t{1} << (e.slot % kSlotsPerLevel));
+  }
+  e.prev = e.next = kNone;
+  e.slot = kUnscheduled;
+}
+
+uint32_t TimerWheel::TakeSlot(unsigned level, unsigned index) {
+  Slot& slot = slots_[level * kSlotsPerLevel + index];
+  uint32_t head = slot.head;
+  slot.head = slot.tail = kNone;
+  occupied_[level] &= ~(uint64_t{1} << index);
+  return head;
+}
+
+uint64_t TimerWheel::NextWakeup() const {
+  if (size_ == 0)
+    return kNever;
+  // Scheduled timers always expire later than the current time, in a slot
+  // that comes after the current one on their level. The slots of the lower
+  // levels are reached before those of the upper levels.
+  for (unsigned level = 0; level < kLevels; level++) {
+    unsigned index = SlotIndex(now_, level);
+    if (index == kSlotsPerLevel - 1)
+      continue;
+    uint64_t later = occupied_[level] & (~uint64_t{0} << (index + 1));
+    if (later == 0)
+      continue;
+    unsigned shift = level * kBitsPerLevel;
+    unsigned upper_shift = shift + kBitsPerLevel;
+    uint64_t base =
+        upper_shift < 64 ? (now_ >> upper_shift) << upper_shift : 0;
+    return base | (uint64_t{LeastSignificantBit(later)} << shift);
+  }
+  UNREACHABLE();
+}
+
+void TimerWheel::Advance(uint64_t now, std::vector<uint32_t>* expired) {
+  while (now_ < now) {
+    uint64_t next = NextWakeup();
+    if (next > now) {
+      now_ = now;
+      break;
+    }
+    now_ = next;
+
+    // Cascade the slots that have been reached on the upper levels, from the
+    // top so that timers can move down more than one level at once.
+    for (unsigned level = kLevels - 1; level > 0; level--) {
+      uint64_t lower_bits = (uint64_t{1} << (level * kBitsPerLevel)) - 1;
+      if ((now_ & lower_bits) != 0)
+        continue;
+      uint32_t id = TakeSlot(level, SlotIndex(now_, level));
+      while (id != kNone) {
+        Entry& e = entry(id);
+        uint32_t next_id = e.next;
+        Link(id, e.expiry);
+        id = next_id;
+      }
+    }
+
+    uint32_t id = TakeSlot(0, SlotIndex(now_, 0));
+    while (id != kNone) {
+      Entry& e = entry(id);
+      DCHECK_EQ(e.expiry, now_);
+      uint32_t next_id = e.next;
+      e.prev = e.next = kNone;
+      e.slot = kUnscheduled;
+      size_--;
+      if (IsNativeTimer(id))
+        native_timers_[id & ~kNativeTimerFlag].expired = true;
+      expired->push_back(id);
+      id = next_id;
+    }
+  }
+}
+
+void TimerWheel::RunNativeTimer(uint32_t id) {
+  CHECK(IsNativeTimer(id));
+  NativeTimer& timer = native_timers_[id & ~kNativeTimerFlag];
+  if (!timer.expired)
+    return;
+  timer.expired = false;
+  timer.callback(timer.data);
+}
+
+}  // namespace node
@@ -0,0 +1,131 @@
+#ifndef SRC_TIMER_WHEEL_H_
+#define SRC_TIMER_WHEEL_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace node {
+
+// A hierarchical timing wheel that stores the timers of an Environment, with
+// a resolution of one millisecond. It is owned by the Environment and shared
+// by the JavaScript timers (setTimeout(), setInterval() and the idle timeouts
+// of sockets) and by native code.
+//
+// Each level of the wheel has 64 slots. A timer is stored on the level given
+// by the most significant bit in which its expiry differs from the current
+// time, in the slot given by the bits of its expiry on that level. When the
+// current time reaches a slot of an upper level, its timers are cascaded down
+// to the levels below, so that timers never expire early nor late, and timers
+// with the same expiry expire in the order in which they were scheduled.
+//
+// Timers are identified by ids. The JavaScript timers use ids that they
+// allocate themselves, starting at 0. Native timers are allocated with
+// AddNativeTimer(), and have kNativeTimerFlag set in their ids. Timers are
+// linked to each other by their ids, so that scheduling, rescheduling and
+// cancelling a timer never allocates memory once its id has been used, and
+// runs in constant time.
+class TimerWheel {
+ public:
+  using Callback = void (*)(void* data);
+
+  static constexpr uint64_t kNever = std::numeric_limits<uint64_t>::max();
+  static constexpr uint32_t kNativeTimerFlag = 1u << 31;
+
+  explicit TimerWheel(uint64_t now = 0);
+  TimerWheel(const TimerWheel&) = delete;
+  TimerWheel& operator=(const TimerWheel&) = delete;
+
+  // Returns the id of a new native timer, that calls `callback` with `data`
+  // when RunNativeTimer() is called after it has expired.
+  uint32_t AddNativeTimer(Callback callback, void* data);
+  // Cancels the native timer and releases its id.
+  void RemoveNativeTimer(uint32_t id);
+  static bool IsNativeTimer(uint32_t id) {
+    return (id & kNativeTimerFlag) != 0;
+  }
+
+  // Schedules the timer to expire at `expiry`, or reschedules it if it is
+  // already scheduled. An expiry that is not later than the current time is
+  // treated as the next millisecond.
+  void Schedule(uint32_t id, uint64_t expiry);
+  void Cancel(uint32_t id);
+  bool IsScheduled(uint32_t id) const;
+
+  // Moves the current time of the wheel forward to `now`, and appends the
+  // ids of the timers that have expired to `expired`, in the order in which
+  // they expired. Expired timers are no longer scheduled.
+  void Advance(uint64_t now, std::vector<uint32_t>* expired);
+  // Calls the callback of a native timer returned by Advance(), unless it
+  // has been rescheduled or removed since.
+  void RunNativeTimer(uint32_t id);
+
+  // Returns the time at which Advance() has to be called next, which is no
+  // later than the earliest expiry of the scheduled timers, or kNever if no
+  // timer is scheduled. Timers that expire more than 64ms from now may
+  // require a few intermediate calls, in which their slot is cascaded.
+  uint64_t NextWakeup() const;
+
+  uint64_t now() const { return now_; }
+  size_t size() const { return size_; }
+
+ private:
+  static constexpr unsigned kBitsPerLevel = 6;
+  static constexpr unsigned kSlotsPerLevel = 1u << kBitsPerLevel;
+  // Enough levels to cover all 64 bits of the time.
+  static constexpr unsigned kLevels = (64 + kBitsPerLevel - 1) / kBitsPerLevel;
+  static constexpr uint32_t kNone = std::numeric_limits<uint32_t>::max();
+  static constexpr uint16_t kUnscheduled = std::numeric_limits<uint16_t>::max();
+
+  struct Entry {
+    uint64_t expiry = 0;
+    uint32_t prev = kNone;
+    uint32_t next = kNone;
+    // The index of the slot the timer is linked into.
+    uint16_t slot = kUnscheduled;
+  };
+
+  struct Slot {
+    uint32_t head = kNone;
+    uint32_t tail = kNone;
+  };
+
+  struct NativeTimer {
+    Callback callback = nullptr;
+    void* data = nullptr;
+    bool expired = false;
+  };
+
+  static unsigned SlotIndex(uint64_t time, unsigned level) {
+    return (time >> (level * kBitsPerLevel)) & (kSlotsPerLevel - 1);
+  }
+
+  inline Entry& entry(uint32_t id);
+  inline const Entry* entry_if_exists(uint32_t id) const;
+
+  void Link(uint32_t id, uint64_t expiry);
+  void Unlink(uint32_t id);
+  // Removes all the timers of a slot and returns the first of them, the
+  // others can be found through their `next` id.
+  uint32_t TakeSlot(unsigned level, unsigned index);
+
+  uint64_t now_;
+  size_t size_ = 0;
+  Slot slots_[kLevels * kSlotsPerLevel];
+  // One bit per slot of each level, set when the slot is not empty.
+  uint64_t occupied_[kLevels] = {};
+
+  std::vector<Entry> entries_;
+  std::vector<Entry> native_entries_;
+  std::vector<NativeTimer> native_timers_;
+  std::vector<uint32_t> free_native_ids_;
+};
+
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_TIMER_WHEEL_H_
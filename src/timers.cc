@@ -12,7 +12,9 @@ using v8::Context;
 using v8::Function;
 using v8::FunctionCallbackInfo;
 using v8::Local;
+using v8::Number;
 using v8::Object;
+using v8::Uint32;
 using v8::Value;
 
 void SetupTimers(const FunctionCallbackInfo<Value>& args) {
@@ -29,9 +31,23 @@ void GetLibuvNow(const FunctionCallbackInfo<Value>& args) {
   args.GetReturnValue().Set(env->GetNow());
 }
 
+// Schedules, or reschedules, the timer with the id args[0] of the timer
+// wheel to expire at the time args[1], as returned by getLibuvNow().
 void ScheduleTimer(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args[0]->IsUint32());
+  CHECK(args[1]->IsNumber());
   auto env = Environment::GetCurrent(args);
-  env->ScheduleTimer(args[0]->IntegerValue(env->context()).FromJust());
+  uint32_t id = args[0].As<Uint32>()->Value();
+  CHECK(!TimerWheel::IsNativeTimer(id));
+  double expiry = args[1].As<Number>()->Value();
+  env->InsertTimer(id, expiry > 0 ? static_cast<uint64_t>(expiry) : 0);
+}
+
+void CancelTimer(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args[0]->IsUint32());
+  uint32_t id = args[0].As<Uint32>()->Value();
+  CHECK(!TimerWheel::IsNativeTimer(id));
+  Environment::GetCurrent(args)->timer_wheel()->Cancel(id);
 }
 
 void ToggleTimerRef(const FunctionCallbackInfo<Value>& args) {
@@ -51,6 +67,7 @@ void Initialize(Local<Object> target,
   env->SetMethod(target, "getLibuvNow", GetLibuvNow);
   env->SetMethod(target, "setupTimers", SetupTimers);
   env->SetMethod(target, "scheduleTimer", ScheduleTimer);
+  env->SetMethod(target, "cancelTimer", CancelTimer);
   env->SetMethod(target, "toggleTimerRef", ToggleTimerRef);
   env->SetMethod(target, "toggleImmediateRef", ToggleImmediateRef);
 
@@ -63,6 +80,7 @@ void RegisterTimerExternalReferences(ExternalReferenceRegistry* registry) {
   registry->Register(GetLibuvNow);
   registry->Register(SetupTimers);
   registry->Register(ScheduleTimer);
+  registry->Register(CancelTimer);
   registry->Register(ToggleTimerRef);
   registry->Register(ToggleImmediateRef);
 }
@@ -3,12 +3,79 @@
 #include <string>
 #include "trace_event.h"
 #include "tracing/node_trace_buffer.h"
+#include "tracing/node_trace_writer.h"
 #include "debug_utils-inl.h"
 #include "env-inl.h"
+#include "node_internals.h"
+
+#include <fcntl.h>  // O_WRONLY, O_CREAT, O_TRUNC
+#include <streambuf>
 
 namespace node {
 namespace tracing {
 
+namespace {
+// Only tries to lock `mutex` if `try_lock` is set, e.g. on fatal errors,
+// where the calling thread may already hold it.
+bool LockMutex(Mutex* mutex, bool try_lock) {
+  if (try_lock)
+    return mutex->TryLock();
+  mutex->Lock();
+  return true;
+}
+
+// Writes the serialized trace events straight to a file descriptor, through
+// a fixed-size buffer, so that dumping the flight recorder does not need
+// memory in proportion to the number of events.
+class FileStreamBuffer : public std::streambuf {
+ public:
+  FileStreamBuffer(uv_file fd, char* buffer, size_t size) : fd_(fd) {
+    setp(buffer, buffer + size);
+  }
+
+  // Returns 0 or the libuv error code of the first write that failed.
+  int error() const { return error_; }
+
+ protected:
+  int_type overflow(int_type c) override {
+    if (!WriteBuffer())
+      return traits_type::eof();
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+      *pptr() = traits_type::to_char_type(c);
+      pbump(1);
+    }
+    return traits_type::not_eof(c);
+  }
+
+  int sync() override {
+    return WriteBuffer() ? 0 : -1;
+  }
+
+ private:
+  bool WriteBuffer() {
+    char* data = pbase();
+    size_t size = pptr() - pbase();
+    while (size > 0 && error_ == 0) {
+      uv_buf_t buf = uv_buf_init(data, size);
+      uv_fs_t req;
+      int written = uv_fs_write(nullptr, &req, fd_, &buf, 1, -1, nullptr);
+      uv_fs_req_cleanup(&req);
+      if (written < 0) {
+        error_ = written;
+      } else {
+        data += written;
+        size -= written;
+      }
+    }
+    setp(pbase(), epptr());
+    return error_ == 0;
+  }
+
+  uv_file fd_;
+  int error_ = 0;
+};
+}  // anonymous namespace
+
 class Agent::ScopedSuspendTracing {
  public:
   ScopedSuspendTracing(TracingController* controller, Agent* agent,
@@ -87,9 +154,16 @@ void Agent::Start() {
   if (started_)
     return;
 
-  NodeTraceBuffer* trace_buffer_ = new NodeTraceBuffer(
-      NodeTraceBuffer::kBufferChunks, this, &tracing_loop_);
-  tracing_controller_->Initialize(trace_buffer_);
+  if (use_flight_recorder_) {
+    Mutex::ScopedLock lock(flight_recorder_mutex_);
+    flight_recorder_ =
+        new FlightRecorderBuffer(NodeTraceBuffer::kBufferChunks, this);
+    tracing_controller_->Initialize(flight_recorder_);
+  } else {
+    NodeTraceBuffer* trace_buffer_ = new NodeTraceBuffer(
+        NodeTraceBuffer::kBufferChunks, this, &tracing_loop_);
+    tracing_controller_->Initialize(trace_buffer_);
+  }
 
   // This thread should be created *after* async handles are created
   // (within NodeTraceWriter and NodeTraceBuffer constructors).
@@ -144,7 +218,11 @@ void Agent::StopTracing() {
   // Perform final Flush on TraceBuffer. We don't want the tracing controller
   // to flush the buffer again on destruction of the V8::Platform.
   tracing_controller_->StopTracing();
-  tracing_controller_->Initialize(nullptr);
+  {
+    Mutex::ScopedLock lock(flight_recorder_mutex_);
+    tracing_controller_->Initialize(nullptr);
+    flight_recorder_ = nullptr;
+  }
   started_ = false;
 
   // Thread should finish when the tracing loop is stopped.
@@ -202,6 +280,75 @@ std::string Agent::GetEnabledCategories() const {
   return categories;
 }
 
+void Agent::UseFlightRecorder(bool proto_format) {
+  CHECK(!started_);
+  use_flight_recorder_ = true;
+  flight_recorder_proto_format_ = proto_format;
+  // Allocated up front, as the flight recorder is also dumped when the heap
+  // is exhausted.
+  flight_recorder_dump_buffer_.reset(new char[kFlightRecorderDumpBufferSize]);
+}
+
+int Agent::DumpFlightRecorder(const std::string& filename,
+                              uint64_t duration_ms,
+                              bool try_lock) {
+  CHECK(use_flight_recorder_);
+  int64_t since_us = 0;
+  if (duration_ms > 0) {
+    since_us = tracing_controller_->CurrentTimestampMicroseconds() -
+               static_cast<int64_t>(duration_ms * 1000);
+  }
+  // The mutex also protects flight_recorder_dump_buffer_.
+  if (!LockMutex(&flight_recorder_mutex_, try_lock))
+    return UV_EBUSY;
+  if (!LockMutex(&metadata_events_mutex_, try_lock)) {
+    flight_recorder_mutex_.Unlock();
+    return UV_EBUSY;
+  }
+
+  uv_fs_t req;
+  // Readable and writable by the owner only, like WriteFileSync(), which was
+  // used before.
+  int fd = uv_fs_open(nullptr,
+                      &req,
+                      filename.c_str(),
+                      O_WRONLY | O_CREAT | O_TRUNC,
+                      0600,
+                      nullptr);
+  uv_fs_req_cleanup(&req);
+  int err = fd < 0 ? fd : 0;
+  if (err == 0) {
+    FileStreamBuffer buffer(fd, flight_recorder_dump_buffer_.get(),
+                            kFlightRecorderDumpBufferSize);
+    std::ostream stream(&buffer);
+    {
+      std::unique_ptr<TraceWriter> writer =
+          NodeTraceWriter::CreateTraceWriter(
+              stream,
+              flight_recorder_proto_format_ ? NodeTraceWriter::kProto :
+                                              NodeTraceWriter::kJSON);
+      for (const auto& event : metadata_events_)
+        writer->AppendTraceEvent(event.get());
+      if (flight_recorder_ != nullptr &&
+          !flight_recorder_->Dump(writer.get(), since_us, try_lock)) {
+        err = UV_EBUSY;
+      }
+      // Destroying the writer ends the JSON document.
+    }
+    stream.flush();
+    if (err == 0)
+      err = buffer.error();
+    int close_err = uv_fs_close(nullptr, &req, fd, nullptr);
+    uv_fs_req_cleanup(&req);
+    if (err == 0)
+      err = close_err;
+  }
+
+  metadata_events_mutex_.Unlock();
+  flight_recorder_mutex_.Unlock();
+  return err;
+}
+
 void Agent::AppendTraceEvent(TraceObject* trace_event) {
   for (const auto& id_writer : writers_)
     id_writer.second->AppendTraceEvent(trace_event);
@@ -23,6 +23,7 @@ using v8::platform::tracing::TraceConfig;
 using v8::platform::tracing::TraceObject;
 
 class Agent;
+class FlightRecorderBuffer;
 
 class AsyncTraceWriter {
  public:
@@ -118,6 +119,20 @@ class Agent {
 
   TraceConfig* CreateTraceConfig() const;
 
+  // Keeps the trace events in memory, in a ring buffer of
+  // NodeTraceBuffer::kBufferChunks chunks, instead of writing them to the
+  // writers. Must be called before tracing starts.
+  void UseFlightRecorder(bool proto_format);
+  bool IsFlightRecorderEnabled() const { return use_flight_recorder_; }
+  // Writes the events of the flight recorder that are at most `duration_ms`
+  // old, or all of them if it is 0, to `filename`. Returns 0 or a libuv
+  // error code. The events are written through a preallocated buffer. If
+  // `try_lock` is set, e.g. on fatal errors, UV_EBUSY is returned instead of
+  // waiting when a lock is held, possibly by the calling thread.
+  int DumpFlightRecorder(const std::string& filename,
+                         uint64_t duration_ms,
+                         bool try_lock = false);
+
  private:
   friend class AgentWriterHandle;
 
@@ -153,6 +168,15 @@ class Agent {
 
   Mutex metadata_events_mutex_;
   std::list<std::unique_ptr<TraceObject>> metadata_events_;
+
+  bool use_flight_recorder_ = false;
+  bool flight_recorder_proto_format_ = false;
+  // Protects flight_recorder_, which is owned by the tracing controller and
+  // only exists while tracing is started.
+  Mutex flight_recorder_mutex_;
+  FlightRecorderBuffer* flight_recorder_ = nullptr;
+  static constexpr size_t kFlightRecorderDumpBufferSize = 64 * 1024;
+  std::unique_ptr<char[]> flight_recorder_dump_buffer_;
 };
 
 void AgentWriterHandle::reset() {
@@ -6,33 +6,128 @@
 namespace node {
 namespace tracing {
 
+namespace {
+std::atomic<uint64_t> next_instance_id{1};
+
+// Only tries to lock `mutex` if `try_lock` is set, e.g. on fatal errors,
+// where the calling thread may already hold it.
+bool LockMutex(Mutex* mutex, bool try_lock) {
+  if (try_lock)
+    return mutex->TryLock();
+  mutex->Lock();
+  return true;
+}
+
+// Marks a chunk as being accessed by the current thread for as long as it
+// is in scope. The counter and the sequence number of the chunk are
+// sequentially consistent, so either Flush() observes the user and waits
+// for it, or the user observes that the chunk has been flushed.
+class ChunkUser {
+ public:
+  explicit ChunkUser(std::atomic<int>* users) : users_(users) {
+    users_->fetch_add(1);
+  }
+  ~ChunkUser() { users_->fetch_sub(1); }
+  ChunkUser(const ChunkUser&) = delete;
+  ChunkUser& operator=(const ChunkUser&) = delete;
+
+ private:
+  std::atomic<int>* users_;
+};
+}  // anonymous namespace
+
+thread_local InternalTraceBuffer::ThreadChunk
+    InternalTraceBuffer::thread_chunks_[kThreadChunkCacheSize];
+
 InternalTraceBuffer::InternalTraceBuffer(size_t max_chunks, uint32_t id,
-                                         Agent* agent)
+                                         Agent* agent, bool ring)
     : flushing_(false), max_chunks_(max_chunks),
-      agent_(agent), id_(id) {
-  chunks_.resize(max_chunks);
-}
+      agent_(agent), slots_(new ChunkSlot[max_chunks]), ring_(ring), id_(id),
+      instance_id_(next_instance_id++) {}
 
 TraceObject* InternalTraceBuffer::AddTraceEvent(uint64_t* handle) {
-  Mutex::ScopedLock scoped_lock(mutex_);
-  // Create new chunk if last chunk is full or there is no chunk.
-  if (total_chunks_ == 0 || chunks_[total_chunks_ - 1]->IsFull()) {
-    auto& chunk = chunks_[total_chunks_++];
-    if (chunk) {
-      chunk->Reset(current_chunk_seq_++);
-    } else {
-      chunk = std::make_unique<TraceBufferChunk>(current_chunk_seq_++);
+  ThreadChunk* thread_chunk =
+      &thread_chunks_[instance_id_ % kThreadChunkCacheSize];
+  if (thread_chunk->buffer == instance_id_) {
+    ChunkSlot& slot = slots_[thread_chunk->chunk_index];
+    ChunkUser user(&slot.users);
+    // Only the thread that the chunk was handed out to adds events to it,
+    // so it can be used without the mutex until it is flushed.
+    if (slot.seq == thread_chunk->seq && !slot.chunk->IsFull()) {
+      size_t event_index;
+      TraceObject* trace_object = slot.chunk->AddTraceEvent(&event_index);
+      *handle = MakeHandle(thread_chunk->chunk_index, thread_chunk->seq,
+                           event_index);
+      return trace_object;
+    }
+  }
+  return AddTraceEventToNewChunk(thread_chunk, handle);
+}
+
+TraceObject* InternalTraceBuffer::AddTraceEventToNewChunk(
+    ThreadChunk* thread_chunk, uint64_t* handle) {
+  size_t chunk_index;
+  uint32_t seq;
+  {
+    Mutex::ScopedLock scoped_lock(mutex_);
+    // The chunks are being read without the mutex. In ring mode, the ones
+    // that have never been handed out can still be used.
+    if (flushing_ && (!ring_ || total_chunks_ == max_chunks_))
+      return nullptr;
+    seq = current_chunk_seq_++;
+    if (seq == 0) seq = current_chunk_seq_++;  // Zero marks flushed chunks.
+    if (total_chunks_ < max_chunks_) {
+      chunk_index = total_chunks_;
+      total_chunks_ = chunk_index + 1;
+      next_chunk_ = (chunk_index + 1) % max_chunks_;
+      ChunkSlot& slot = slots_[chunk_index];
+      if (slot.chunk) {
+        slot.chunk->Reset(seq);
+      } else {
+        slot.chunk = std::make_unique<TraceBufferChunk>(seq);
+      }
+      slot.seq = seq;
+      return AddTraceEventToChunk(thread_chunk, chunk_index, seq, handle);
     }
+    if (!ring_)
+      return nullptr;
+    // Skip the chunks that other threads are still waiting for.
+    chunk_index = next_chunk_;
+    for (size_t i = 1; slots_[chunk_index].reclaiming && i < max_chunks_; ++i)
+      chunk_index = (chunk_index + 1) % max_chunks_;
+    if (slots_[chunk_index].reclaiming)
+      return nullptr;
+    next_chunk_ = (chunk_index + 1) % max_chunks_;
+    slots_[chunk_index].seq = 0;
+    slots_[chunk_index].reclaiming = true;
   }
-  auto& chunk = chunks_[total_chunks_ - 1];
+
+  // The threads that are still using the oldest chunk leave it as soon as
+  // they are done with the current event, and the other threads can get
+  // new chunks meanwhile. Yield in case such a thread has been preempted.
+  ChunkSlot& slot = slots_[chunk_index];
+  while (slot.users != 0)
+    uv_sleep(0);
+  slot.chunk->Reset(seq);
+  slot.seq = seq;
+  TraceObject* trace_object =
+      AddTraceEventToChunk(thread_chunk, chunk_index, seq, handle);
+  slot.reclaiming = false;
+  return trace_object;
+}
+
+TraceObject* InternalTraceBuffer::AddTraceEventToChunk(
+    ThreadChunk* thread_chunk, size_t chunk_index, uint32_t seq,
+    uint64_t* handle) {
+  *thread_chunk = ThreadChunk { instance_id_, chunk_index, seq };
   size_t event_index;
-  TraceObject* trace_object = chunk->AddTraceEvent(&event_index);
-  *handle = MakeHandle(total_chunks_ - 1, chunk->seq(), event_index);
+  TraceObject* trace_object =
+      slots_[chunk_index].chunk->AddTraceEvent(&event_index);
+  *handle = MakeHandle(chunk_index, seq, event_index);
   return trace_object;
 }
 
 TraceObject* InternalTraceBuffer::GetEventByHandle(uint64_t handle) {
-  Mutex::ScopedLock scoped_lock(mutex_);
   if (handle == 0) {
     // A handle value of zero never has a trace event associated with it.
     return nullptr;
@@ -40,44 +135,114 @@ TraceObject* InternalTraceBuffer::GetEventByHandle(uint64_t handle) {
   size_t chunk_index, event_index;
   uint32_t buffer_id, chunk_seq;
   ExtractHandle(handle, &buffer_id, &chunk_index, &chunk_seq, &event_index);
-  if (buffer_id != id_ || chunk_index >= total_chunks_) {
-    // Either the chunk belongs to the other buffer, or is outside the current
-    // range of chunks loaded in memory (the latter being true suggests that
-    // the chunk has already been flushed and is no longer in memory.)
+  if (buffer_id != id_ || chunk_index >= max_chunks_) {
+    // The chunk belongs to the other buffer.
     return nullptr;
   }
-  auto& chunk = chunks_[chunk_index];
-  if (chunk->seq() != chunk_seq) {
-    // Chunk is no longer in memory.
+  ChunkSlot& slot = slots_[chunk_index];
+  ChunkUser user(&slot.users);
+  if (slot.seq != chunk_seq) {
+    // Chunk has already been flushed and is no longer in memory.
     return nullptr;
   }
-  return chunk->GetEventAt(event_index);
+  return slot.chunk->GetEventAt(event_index);
 }
 
 void InternalTraceBuffer::Flush(bool blocking) {
+  CHECK(!ring_);
+  Mutex::ScopedLock flush_lock(flush_mutex_);
+  size_t total_chunks;
   {
     Mutex::ScopedLock scoped_lock(mutex_);
-    if (total_chunks_ > 0) {
+    total_chunks = total_chunks_;
+    if (total_chunks > 0) {
+      // No new chunks are handed out until the flush is done, so the retired
+      // ones can be read without the mutex once their users are gone.
       flushing_ = true;
-      for (size_t i = 0; i < total_chunks_; ++i) {
-        auto& chunk = chunks_[i];
-        for (size_t j = 0; j < chunk->size(); ++j) {
-          TraceObject* trace_event = chunk->GetEventAt(j);
-          // Another thread may have added a trace that is yet to be
-          // initialized. Skip such traces.
-          // https://github.com/nodejs/node/issues/21038.
-          if (trace_event->name()) {
-            agent_->AppendTraceEvent(trace_event);
-          }
+      RetireChunks(total_chunks);
+    }
+  }
+  if (total_chunks > 0) {
+    WaitForChunkUsers(total_chunks);
+    for (size_t i = 0; i < total_chunks; ++i) {
+      auto& chunk = slots_[i].chunk;
+      for (size_t j = 0; j < chunk->size(); ++j) {
+        TraceObject* trace_event = chunk->GetEventAt(j);
+        // Another thread may have added a trace that is yet to be
+        // initialized. Skip such traces.
+        // https://github.com/nodejs/node/issues/21038.
+        if (trace_event->name()) {
+          agent_->AppendTraceEvent(trace_event);
         }
       }
-      total_chunks_ = 0;
-      flushing_ = false;
     }
+    Mutex::ScopedLock scoped_lock(mutex_);
+    total_chunks_ = 0;
+    next_chunk_ = 0;
+    flushing_ = false;
   }
   agent_->Flush(blocking);
 }
 
+bool InternalTraceBuffer::Dump(TraceWriter* writer, int64_t since_us,
+                               bool try_lock) {
+  if (!LockMutex(&flush_mutex_, try_lock))
+    return false;
+  if (!LockMutex(&mutex_, try_lock)) {
+    flush_mutex_.Unlock();
+    return false;
+  }
+  flushing_ = true;
+  size_t total_chunks = total_chunks_;
+  size_t oldest = total_chunks == max_chunks_ ? next_chunk_ : 0;
+  for (size_t i = 0; i < total_chunks; ++i) {
+    ChunkSlot& slot = slots_[i];
+    // A chunk that is being reused has no events worth keeping.
+    slot.dumping = !slot.reclaiming;
+    if (slot.dumping)
+      slot.seq = 0;
+  }
+  mutex_.Unlock();
+
+  // Neither the dumped chunks nor the ones that are being reused are handed
+  // out until the dump is done, so they can be read without the mutex.
+  for (size_t i = 0; i < total_chunks; ++i) {
+    ChunkSlot& slot = slots_[i];
+    while (slot.dumping && slot.users != 0)
+      uv_sleep(0);
+  }
+  for (size_t i = 0; i < total_chunks; ++i) {
+    ChunkSlot& slot = slots_[(oldest + i) % max_chunks_];
+    if (!slot.dumping)
+      continue;
+    for (size_t j = 0; j < slot.chunk->size(); ++j) {
+      TraceObject* trace_event = slot.chunk->GetEventAt(j);
+      if (trace_event->name() && trace_event->ts() >= since_us)
+        writer->AppendTraceEvent(trace_event);
+    }
+  }
+  flushing_ = false;
+  flush_mutex_.Unlock();
+  return true;
+}
+
+void InternalTraceBuffer::RetireChunks(size_t count) {
+  // The threads will ask for a new chunk the next time they add an event.
+  for (size_t i = 0; i < count; ++i)
+    slots_[i].seq = 0;
+}
+
+void InternalTraceBuffer::WaitForChunkUsers(size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    // Threads only keep using a chunk for the duration of a call to
+    // AddTraceEvent() or GetEventByHandle(), so this does not spin for
+    // long. Yield in case that thread has been preempted, e.g. on a single
+    // core.
+    while (slots_[i].users != 0)
+      uv_sleep(0);
+  }
+}
+
 uint64_t InternalTraceBuffer::MakeHandle(
     size_t chunk_index, uint32_t chunk_seq, size_t event_index) const {
   return ((static_cast<uint64_t>(chunk_seq) * Capacity() +
@@ -95,6 +260,17 @@ void InternalTraceBuffer::ExtractHandle(
   *event_index = indices % TraceBufferChunk::kChunkSize;
 }
 
+FlightRecorderBuffer::FlightRecorderBuffer(size_t max_chunks, Agent* agent)
+    : buffer_(max_chunks, 0, agent, true) {}
+
+TraceObject* FlightRecorderBuffer::AddTraceEvent(uint64_t* handle) {
+  return buffer_.AddTraceEvent(handle);
+}
+
+TraceObject* FlightRecorderBuffer::GetEventByHandle(uint64_t handle) {
+  return buffer_.GetEventByHandle(handle);
+}
+
 NodeTraceBuffer::NodeTraceBuffer(size_t max_chunks,
     Agent* agent, uv_loop_t* tracing_loop)
     : tracing_loop_(tracing_loop),
@@ -121,15 +297,21 @@ NodeTraceBuffer::~NodeTraceBuffer() {
 }
 
 TraceObject* NodeTraceBuffer::AddTraceEvent(uint64_t* handle) {
-  // If the buffer is full, attempt to perform a flush.
-  if (!TryLoadAvailableBuffer()) {
-    // Assign a value of zero as the trace event handle.
-    // This is equivalent to calling InternalTraceBuffer::MakeHandle(0, 0, 0),
-    // and will cause GetEventByHandle to return NULL if passed as an argument.
-    *handle = 0;
-    return nullptr;
+  // The current buffer may run out of chunks after it has been loaded, in
+  // which case the other one is tried.
+  for (int attempt = 0; attempt < 2; ++attempt) {
+    // If the buffer is full, attempt to perform a flush.
+    if (!TryLoadAvailableBuffer())
+      break;
+    TraceObject* trace_object = current_buf_.load()->AddTraceEvent(handle);
+    if (trace_object != nullptr)
+      return trace_object;
   }
-  return current_buf_.load()->AddTraceEvent(handle);
+  // Assign a value of zero as the trace event handle.
+  // This is equivalent to calling InternalTraceBuffer::MakeHandle(0, 0, 0),
+  // and will cause GetEventByHandle to return NULL if passed as an argument.
+  *handle = 0;
+  return nullptr;
 }
 
 TraceObject* NodeTraceBuffer::GetEventByHandle(uint64_t handle) {
@@ -147,11 +329,13 @@ bool NodeTraceBuffer::Flush() {
 // method returns false; otherwise it returns true.
 bool NodeTraceBuffer::TryLoadAvailableBuffer() {
   InternalTraceBuffer* prev_buf = current_buf_.load();
-  if (prev_buf->IsFull()) {
-    uv_async_send(&flush_signal_);  // trigger flush on a separate thread
+  // A buffer that is being flushed does not hand out chunks either.
+  if (prev_buf->IsFull() || prev_buf->IsFlushing()) {
+    if (prev_buf->IsFull())
+      uv_async_send(&flush_signal_);  // trigger flush on a separate thread
     InternalTraceBuffer* other_buf = prev_buf == &buffer1_ ?
       &buffer2_ : &buffer1_;
-    if (!other_buf->IsFull()) {
+    if (!other_buf->IsFull() && !other_buf->IsFlushing()) {
       current_buf_.store(other_buf);
     } else {
       return false;
@@ -13,25 +13,86 @@ namespace tracing {
 using v8::platform::tracing::TraceBuffer;
 using v8::platform::tracing::TraceBufferChunk;
 using v8::platform::tracing::TraceObject;
+using v8::platform::tracing::TraceWriter;
 
 // forward declaration
 class NodeTraceBuffer;
 
+// Each thread that adds trace events gets chunks of its own, so that adding
+// an event to a chunk that is not full does not need to take the mutex,
+// which is only used to hand out new chunks and to retire them. Flush()
+// reads the retired chunks without holding it, and no new chunks are handed
+// out in the meantime.
+//
+// In ring mode, the oldest chunk is reused once all of them are in use, so
+// the buffer always holds the most recent events. The thread that reuses a
+// chunk waits for its users without holding the mutex, and Dump() skips the
+// chunks that are being reused.
 class InternalTraceBuffer {
  public:
-  InternalTraceBuffer(size_t max_chunks, uint32_t id, Agent* agent);
+  InternalTraceBuffer(size_t max_chunks, uint32_t id, Agent* agent,
+                      bool ring = false);
 
+  // Returns nullptr if the calling thread needs a new chunk and all of them
+  // are in use.
   TraceObject* AddTraceEvent(uint64_t* handle);
   TraceObject* GetEventByHandle(uint64_t handle);
+  // Not used in ring mode.
   void Flush(bool blocking);
+  // Appends the events that were added at or after `since_us`, oldest chunk
+  // first, to `writer`. The events stay in the buffer. If `try_lock` is set,
+  // nothing is written and false is returned when the mutexes are held by
+  // another thread, or by the calling one.
+  bool Dump(TraceWriter* writer, int64_t since_us, bool try_lock);
   bool IsFull() const {
-    return total_chunks_ == max_chunks_ && chunks_[total_chunks_ - 1]->IsFull();
+    return total_chunks_ == max_chunks_;
   }
   bool IsFlushing() const {
     return flushing_;
   }
 
  private:
+  struct ChunkSlot {
+    std::unique_ptr<TraceBufferChunk> chunk;
+    // The sequence number of the chunk while it is in use by a thread, or
+    // zero once it has been flushed.
+    std::atomic<uint32_t> seq{0};
+    // The number of threads that are accessing the chunk without holding
+    // the mutex. Flush() waits for it to drop to zero before reading the
+    // chunk.
+    std::atomic<int> users{0};
+    // Set while a thread waits for the users to leave in order to reuse the
+    // chunk in ring mode.
+    std::atomic<bool> reclaiming{false};
+    // Whether the current Dump() reads the chunk. Only used by the thread
+    // that holds flush_mutex_.
+    bool dumping = false;
+  };
+
+  // The chunk that the calling thread is adding events to, keyed by the
+  // id of the buffer it belongs to.
+  struct ThreadChunk {
+    uint64_t buffer = 0;
+    size_t chunk_index = 0;
+    uint32_t seq = 0;
+  };
+  static constexpr size_t kThreadChunkCacheSize = 4;
+  static thread_local ThreadChunk thread_chunks_[kThreadChunkCacheSize];
+
+  TraceObject* AddTraceEventToNewChunk(ThreadChunk* thread_chunk,
+                                       uint64_t* handle);
+  // Hands the chunk out to the calling thread and adds the first event to
+  // it.
+  TraceObject* AddTraceEventToChunk(ThreadChunk* thread_chunk,
+                                    size_t chunk_index, uint32_t seq,
+                                    uint64_t* handle);
+  // Takes the chunks away from the threads that are adding events to them.
+  // Must be called with the mutex held.
+  void RetireChunks(size_t count);
+  // Waits for the threads that were still using the retired chunks, after
+  // which they can be read. Does not need the mutex.
+  void WaitForChunkUsers(size_t count);
+
   uint64_t MakeHandle(size_t chunk_index, uint32_t chunk_seq,
                       size_t event_index) const;
   void ExtractHandle(uint64_t handle, uint32_t* buffer_id, size_t* chunk_index,
@@ -39,13 +100,43 @@ class InternalTraceBuffer {
   size_t Capacity() const { return max_chunks_ * TraceBufferChunk::kChunkSize; }
 
   Mutex mutex_;
-  bool flushing_;
+  // Serializes Flush() and Dump().
+  Mutex flush_mutex_;
+  std::atomic<bool> flushing_;
   size_t max_chunks_;
   Agent* agent_;
-  std::vector<std::unique_ptr<TraceBufferChunk>> chunks_;
-  size_t total_chunks_ = 0;
+  std::unique_ptr<ChunkSlot[]> slots_;
+  std::atomic<size_t> total_chunks_{0};
+  bool ring_;
+  // The chunk that is handed out next in ring mode, i.e. the oldest one once
+  // all of them are in use.
+  size_t next_chunk_ = 0;
   uint32_t current_chunk_seq_ = 1;
   uint32_t id_;
+  // Unique across all the buffers ever created, unlike id_, so that the
+  // chunks cached by threads never refer to a buffer that has been deleted.
+  uint64_t instance_id_;
+};
+
+// Keeps the most recent trace events in memory, in a fixed number of chunks,
+// instead of flushing them to the trace writers. They are only written when
+// Dump() is called, e.g. when a diagnostic report is written.
+class FlightRecorderBuffer : public TraceBuffer {
+ public:
+  FlightRecorderBuffer(size_t max_chunks, Agent* agent);
+
+  TraceObject* AddTraceEvent(uint64_t* handle) override;
+  TraceObject* GetEventByHandle(uint64_t handle) override;
+  // Called by the TracingController when tracing stops, or when the enabled
+  // categories change. The events are kept.
+  bool Flush() override { return true; }
+
+  bool Dump(TraceWriter* writer, int64_t since_us, bool try_lock) {
+    return buffer_.Dump(writer, since_us, try_lock);
+  }
+
+ private:
+  InternalTraceBuffer buffer_;
 };
 
 class NodeTraceBuffer : public TraceBuffer {
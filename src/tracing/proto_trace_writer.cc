@@ -0,0 +1,470 @@
+#include "tracing/proto_trace_writer.h"
+
+#include <cstring>
+
+#include "tracing/trace_event_common.h"
+#include "util.h"
+
+namespace node {
+namespace tracing {
+
+using v8::platform::tracing::TracingController;
+
+namespace {
+
+// Field numbers and enum values from the Perfetto protos. Only the ones that
+// are written here are listed.
+enum WireType : uint32_t {
+  kVarInt = 0,
+  kFixed64 = 1,
+  kLengthDelimited = 2,
+};
+
+enum TraceField : uint32_t {
+  kTracePacket = 1,
+};
+
+enum TracePacketField : uint32_t {
+  kPacketClockSnapshot = 6,
+  kPacketTimestamp = 8,
+  kPacketTrustedPacketSequenceId = 10,
+  kPacketTrackEvent = 11,
+  kPacketInternedData = 12,
+  kPacketSequenceFlags = 13,
+  kPacketTimestampClockId = 58,
+  kPacketTracePacketDefaults = 59,
+  kPacketTrackDescriptor = 60,
+};
+
+enum SequenceFlags : uint64_t {
+  kSeqIncrementalStateCleared = 1,
+  kSeqNeedsIncrementalState = 2,
+};
+
+enum ClockField : uint32_t {
+  kClockSnapshotClocks = 1,
+  kClockId = 1,
+  kClockTimestamp = 2,
+  kClockIsIncremental = 3,
+  kClockUnitMultiplierNs = 4,
+};
+
+constexpr uint32_t kBuiltinClockMonotonic = 3;
+
+enum InternedDataField : uint32_t {
+  kInternedEventCategories = 1,
+  kInternedEventNames = 2,
+  kInternedDebugAnnotationNames = 3,
+  kInternedIid = 1,
+  kInternedName = 2,
+};
+
+enum TrackDescriptorField : uint32_t {
+  kTrackUuid = 1,
+  kTrackProcess = 3,
+  kTrackThread = 4,
+  kTrackParentUuid = 5,
+  kProcessPid = 1,
+  kProcessName = 6,
+  kThreadPid = 1,
+  kThreadTid = 2,
+  kThreadName = 5,
+};
+
+enum TrackEventField : uint32_t {
+  kEventCategoryIids = 3,
+  kEventDebugAnnotations = 4,
+  kEventLegacyEvent = 6,
+  kEventType = 9,
+  kEventNameIid = 10,
+  kEventTrackUuid = 11,
+};
+
+enum TrackEventType : uint64_t {
+  kTypeSliceBegin = 1,
+  kTypeSliceEnd = 2,
+  kTypeInstant = 3,
+};
+
+enum LegacyEventField : uint32_t {
+  kLegacyPhase = 2,
+  kLegacyDurationUs = 3,
+  kLegacyThreadDurationUs = 4,
+  kLegacyUnscopedId = 6,
+  kLegacyIdScope = 7,
+  kLegacyBindId = 8,
+  kLegacyLocalId = 10,
+  kLegacyGlobalId = 11,
+  kLegacyBindToEnclosing = 12,
+  kLegacyFlowDirection = 13,
+  kLegacyInstantEventScope = 14,
+};
+
+enum DebugAnnotationField : uint32_t {
+  kAnnotationNameIid = 1,
+  kAnnotationBool = 2,
+  kAnnotationUint = 3,
+  kAnnotationInt = 4,
+  kAnnotationDouble = 5,
+  kAnnotationString = 6,
+  kAnnotationPointer = 7,
+  kAnnotationLegacyJson = 9,
+};
+
+uint64_t ProcessTrackUuid(int pid) {
+  return static_cast<uint32_t>(pid);
+}
+
+// Thread tracks have the highest bit set so that they never collide with
+// process tracks.
+uint64_t ThreadTrackUuid(int pid, int tid) {
+  return (uint64_t{1} << 63) |
+         (static_cast<uint64_t>(static_cast<uint32_t>(pid)) << 32) |
+         static_cast<uint32_t>(tid);
+}
+
+const char* GetStringArg(TraceObject* trace_event, const char* name) {
+  for (int i = 0; i < trace_event->num_args(); ++i) {
+    uint8_t type = trace_event->arg_types()[i];
+    if (strcmp(trace_event->arg_names()[i], name) == 0 &&
+        (type == TRACE_VALUE_TYPE_STRING ||
+         type == TRACE_VALUE_TYPE_COPY_STRING)) {
+      return trace_event->arg_values()[i].as_string;
+    }
+  }
+  return nullptr;
+}
+
+}  // anonymous namespace
+
+void ProtoTraceWriter::Message::AppendRawVarInt(uint64_t value) {
+  while (value >= 0x80) {
+    data_.push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  data_.push_back(static_cast<char>(value));
+}
+
+void ProtoTraceWriter::Message::AppendTag(uint32_t field,
+                                          uint32_t wire_type) {
+  AppendRawVarInt((static_cast<uint64_t>(field) << 3) | wire_type);
+}
+
+void ProtoTraceWriter::Message::AppendVarInt(uint32_t field, uint64_t value) {
+  AppendTag(field, kVarInt);
+  AppendRawVarInt(value);
+}
+
+void ProtoTraceWriter::Message::AppendDouble(uint32_t field, double value) {
+  uint64_t bits;
+  static_assert(sizeof(bits) == sizeof(value), "double must be 64-bit");
+  memcpy(&bits, &value, sizeof(bits));
+  AppendTag(field, kFixed64);
+  for (int i = 0; i < 8; ++i) {
+    data_.push_back(static_cast<char>(bits >> (i * 8)));
+  }
+}
+
+void ProtoTraceWriter::Message::AppendString(uint32_t field,
+                                             const char* value,
+                                             size_t length) {
+  AppendTag(field, kLengthDelimited);
+  AppendRawVarInt(length);
+  data_.append(value, length);
+}
+
+void ProtoTraceWriter::Message::AppendString(uint32_t field,
+                                             const std::string& value) {
+  AppendString(field, value.data(), value.size());
+}
+
+void ProtoTraceWriter::Message::AppendMessage(uint32_t field,
+                                              const Message& message) {
+  AppendString(field, message.data());
+}
+
+ProtoTraceWriter::ProtoTraceWriter(std::ostream& stream) : stream_(stream) {}
+
+void ProtoTraceWriter::WritePacket(const Message& packet) {
+  Message trace;
+  trace.AppendMessage(kTracePacket, packet);
+  stream_ << trace.data();
+}
+
+// The first packet of the sequence clears the incremental state, and defines
+// the incremental clock that the timestamps of the following packets are
+// relative to, in microseconds like the timestamps of the trace events.
+void ProtoTraceWriter::WriteClockSnapshot(int64_t timestamp_us) {
+  Message monotonic;
+  monotonic.AppendVarInt(kClockId, kBuiltinClockMonotonic);
+  monotonic.AppendVarInt(kClockTimestamp, timestamp_us * 1000);
+  Message incremental;
+  incremental.AppendVarInt(kClockId, kIncrementalClockId);
+  incremental.AppendVarInt(kClockTimestamp, timestamp_us);
+  incremental.AppendVarInt(kClockIsIncremental, 1);
+  incremental.AppendVarInt(kClockUnitMultiplierNs, 1000);
+  Message snapshot;
+  snapshot.AppendMessage(kClockSnapshotClocks, monotonic);
+  snapshot.AppendMessage(kClockSnapshotClocks, incremental);
+
+  Message defaults;
+  defaults.AppendVarInt(kPacketTimestampClockId, kIncrementalClockId);
+
+  Message packet;
+  packet.AppendVarInt(kPacketTrustedPacketSequenceId, kSequenceId);
+  packet.AppendVarInt(kPacketSequenceFlags, kSeqIncrementalStateCleared);
+  packet.AppendMessage(kPacketClockSnapshot, snapshot);
+  packet.AppendMessage(kPacketTracePacketDefaults, defaults);
+  packet.AppendVarInt(kPacketTimestampClockId, kBuiltinClockMonotonic);
+  packet.AppendVarInt(kPacketTimestamp, timestamp_us * 1000);
+  WritePacket(packet);
+  last_timestamp_us_ = timestamp_us;
+}
+
+void ProtoTraceWriter::AppendTimestamp(int64_t timestamp_us,
+                                       Message* packet) {
+  if (timestamp_us >= last_timestamp_us_) {
+    packet->AppendVarInt(kPacketTimestamp,
+                         timestamp_us - last_timestamp_us_);
+    last_timestamp_us_ = timestamp_us;
+  } else {
+    // Events are not necessarily flushed in order, as each thread has its
+    // own chunks in the trace buffer. Those that are older than the previous
+    // one use an absolute timestamp instead.
+    packet->AppendVarInt(kPacketTimestampClockId, kBuiltinClockMonotonic);
+    packet->AppendVarInt(kPacketTimestamp, timestamp_us * 1000);
+  }
+}
+
+uint64_t ProtoTraceWriter::Intern(InternTable* table,
+                                  uint32_t field,
+                                  const char* name) {
+  auto it = table->find(name);
+  if (it != table->end()) return it->second;
+  uint64_t iid = table->size() + 1;
+  table->emplace(name, iid);
+  Message entry;
+  entry.AppendVarInt(kInternedIid, iid);
+  entry.AppendString(kInternedName, name, strlen(name));
+  interned_data_.AppendMessage(field, entry);
+  return iid;
+}
+
+void ProtoTraceWriter::WriteProcessDescriptor(int pid,
+                                              const char* process_name) {
+  Message process;
+  process.AppendVarInt(kProcessPid, pid);
+  if (process_name != nullptr)
+    process.AppendString(kProcessName, process_name, strlen(process_name));
+  Message track;
+  track.AppendVarInt(kTrackUuid, ProcessTrackUuid(pid));
+  track.AppendMessage(kTrackProcess, process);
+  Message packet;
+  packet.AppendVarInt(kPacketTrustedPacketSequenceId, kSequenceId);
+  packet.AppendMessage(kPacketTrackDescriptor, track);
+  WritePacket(packet);
+  process_tracks_.insert(pid);
+}
+
+void ProtoTraceWriter::WriteThreadDescriptor(int pid,
+                                             int tid,
+                                             const char* thread_name) {
+  if (process_tracks_.count(pid) == 0)
+    WriteProcessDescriptor(pid, nullptr);
+  Message thread;
+  thread.AppendVarInt(kThreadPid, pid);
+  thread.AppendVarInt(kThreadTid, tid);
+  if (thread_name != nullptr)
+    thread.AppendString(kThreadName, thread_name, strlen(thread_name));
+  Message track;
+  track.AppendVarInt(kTrackUuid, ThreadTrackUuid(pid, tid));
+  track.AppendVarInt(kTrackParentUuid, ProcessTrackUuid(pid));
+  track.AppendMessage(kTrackThread, thread);
+  Message packet;
+  packet.AppendVarInt(kPacketTrustedPacketSequenceId, kSequenceId);
+  packet.AppendMessage(kPacketTrackDescriptor, track);
+  WritePacket(packet);
+  thread_tracks_.insert(ThreadTrackUuid(pid, tid));
+}
+
+uint64_t ProtoTraceWriter::GetThreadTrack(int pid, int tid) {
+  uint64_t uuid = ThreadTrackUuid(pid, tid);
+  if (thread_tracks_.count(uuid) == 0)
+    WriteThreadDescriptor(pid, tid, nullptr);
+  return uuid;
+}
+
+// The process and thread names are written as track descriptors. Other
+// metadata events have no equivalent and are dropped.
+void ProtoTraceWriter::WriteMetadataEvent(TraceObject* trace_event) {
+  const char* name = GetStringArg(trace_event, "name");
+  if (name == nullptr) return;
+  if (strcmp(trace_event->name(), "thread_name") == 0) {
+    WriteThreadDescriptor(trace_event->pid(), trace_event->tid(), name);
+  } else if (strcmp(trace_event->name(), "process_name") == 0) {
+    WriteProcessDescriptor(trace_event->pid(), name);
+  }
+}
+
+void ProtoTraceWriter::AppendLegacyEvent(TraceObject* trace_event,
+                                         Message* event) {
+  unsigned int flags = trace_event->flags();
+  Message legacy;
+  legacy.AppendVarInt(kLegacyPhase, trace_event->phase());
+  if (trace_event->phase() == TRACE_EVENT_PHASE_COMPLETE) {
+    legacy.AppendVarInt(kLegacyDurationUs, trace_event->duration());
+    if (trace_event->cpu_duration() != 0) {
+      legacy.AppendVarInt(kLegacyThreadDurationUs,
+                          trace_event->cpu_duration());
+    }
+  }
+  if (trace_event->phase() == TRACE_EVENT_PHASE_INSTANT) {
+    // Thread scoped instant events are written as TYPE_INSTANT instead.
+    uint64_t scope =
+        (flags & TRACE_EVENT_FLAG_SCOPE_MASK) == TRACE_EVENT_SCOPE_PROCESS ?
+            2 : 1;
+    legacy.AppendVarInt(kLegacyInstantEventScope, scope);
+  }
+  if (flags & TRACE_EVENT_FLAG_HAS_ID) {
+    if (flags & TRACE_EVENT_FLAG_HAS_LOCAL_ID) {
+      legacy.AppendVarInt(kLegacyLocalId, trace_event->id());
+    } else if (flags & TRACE_EVENT_FLAG_HAS_GLOBAL_ID) {
+      legacy.AppendVarInt(kLegacyGlobalId, trace_event->id());
+    } else {
+      legacy.AppendVarInt(kLegacyUnscopedId, trace_event->id());
+    }
+    if (trace_event->scope() != nullptr) {
+      legacy.AppendString(kLegacyIdScope,
+                          trace_event->scope(),
+                          strlen(trace_event->scope()));
+    }
+  }
+  uint64_t flow_direction =
+      ((flags & TRACE_EVENT_FLAG_FLOW_IN) ? 1 : 0) |
+      ((flags & TRACE_EVENT_FLAG_FLOW_OUT) ? 2 : 0);
+  if (flow_direction != 0) {
+    legacy.AppendVarInt(kLegacyBindId, trace_event->bind_id());
+    legacy.AppendVarInt(kLegacyFlowDirection, flow_direction);
+  }
+  if (flags & TRACE_EVENT_FLAG_BIND_TO_ENCLOSING)
+    legacy.AppendVarInt(kLegacyBindToEnclosing, 1);
+  event->AppendMessage(kEventLegacyEvent, legacy);
+}
+
+void ProtoTraceWriter::AppendDebugAnnotations(TraceObject* trace_event,
+                                              Message* event) {
+  const char** arg_names = trace_event->arg_names();
+  const uint8_t* arg_types = trace_event->arg_types();
+  TraceObject::ArgValue* arg_values = trace_event->arg_values();
+  for (int i = 0; i < trace_event->num_args(); ++i) {
+    Message annotation;
+    annotation.AppendVarInt(
+        kAnnotationNameIid,
+        Intern(&annotation_names_, kInternedDebugAnnotationNames,
+               arg_names[i]));
+    const TraceObject::ArgValue& value = arg_values[i];
+    switch (arg_types[i]) {
+      case TRACE_VALUE_TYPE_BOOL:
+        annotation.AppendVarInt(kAnnotationBool, value.as_uint ? 1 : 0);
+        break;
+      case TRACE_VALUE_TYPE_UINT:
+        annotation.AppendVarInt(kAnnotationUint, value.as_uint);
+        break;
+      case TRACE_VALUE_TYPE_INT:
+        annotation.AppendVarInt(kAnnotationInt,
+                                static_cast<uint64_t>(value.as_int));
+        break;
+      case TRACE_VALUE_TYPE_DOUBLE:
+        annotation.AppendDouble(kAnnotationDouble, value.as_double);
+        break;
+      case TRACE_VALUE_TYPE_POINTER:
+        annotation.AppendVarInt(
+            kAnnotationPointer,
+            static_cast<uint64_t>(
+                reinterpret_cast<uintptr_t>(value.as_pointer)));
+        break;
+      case TRACE_VALUE_TYPE_STRING:
+      case TRACE_VALUE_TYPE_COPY_STRING:
+        if (value.as_string == nullptr) {
+          annotation.AppendString(kAnnotationString, "", 0);
+        } else {
+          annotation.AppendString(kAnnotationString, value.as_string,
+                                  strlen(value.as_string));
+        }
+        break;
+      case TRACE_VALUE_TYPE_CONVERTABLE: {
+        std::string json;
+        trace_event->arg_convertables()[i]->AppendAsTraceFormat(&json);
+        annotation.AppendString(kAnnotationLegacyJson, json);
+        break;
+      }
+      default:
+        UNREACHABLE();
+    }
+    event->AppendMessage(kEventDebugAnnotations, annotation);
+  }
+}
+
+void ProtoTraceWriter::AppendTraceEvent(TraceObject* trace_event) {
+  if (!started_) {
+    WriteClockSnapshot(trace_event->ts());
+    started_ = true;
+  }
+
+  if (trace_event->phase() == TRACE_EVENT_PHASE_METADATA) {
+    WriteMetadataEvent(trace_event);
+    return;
+  }
+
+  Message event;
+  event.AppendVarInt(kEventTrackUuid,
+                     GetThreadTrack(trace_event->pid(), trace_event->tid()));
+  event.AppendVarInt(
+      kEventCategoryIids,
+      Intern(&categories_, kInternedEventCategories,
+             TracingController::GetCategoryGroupName(
+                 trace_event->category_enabled_flag())));
+  event.AppendVarInt(kEventNameIid,
+                     Intern(&names_, kInternedEventNames,
+                            trace_event->name()));
+
+  switch (trace_event->phase()) {
+    case TRACE_EVENT_PHASE_BEGIN:
+      event.AppendVarInt(kEventType, kTypeSliceBegin);
+      break;
+    case TRACE_EVENT_PHASE_END:
+      event.AppendVarInt(kEventType, kTypeSliceEnd);
+      break;
+    case TRACE_EVENT_PHASE_MARK:
+      event.AppendVarInt(kEventType, kTypeInstant);
+      break;
+    case TRACE_EVENT_PHASE_INSTANT:
+      if ((trace_event->flags() & TRACE_EVENT_FLAG_SCOPE_MASK) ==
+          TRACE_EVENT_SCOPE_THREAD) {
+        event.AppendVarInt(kEventType, kTypeInstant);
+        break;
+      }
+      AppendLegacyEvent(trace_event, &event);
+      break;
+    default:
+      AppendLegacyEvent(trace_event, &event);
+      break;
+  }
+  AppendDebugAnnotations(trace_event, &event);
+
+  Message packet;
+  packet.AppendVarInt(kPacketTrustedPacketSequenceId, kSequenceId);
+  packet.AppendVarInt(kPacketSequenceFlags, kSeqNeedsIncrementalState);
+  AppendTimestamp(trace_event->ts(), &packet);
+  if (!interned_data_.empty()) {
+    packet.AppendMessage(kPacketInternedData, interned_data_);
+    interned_data_ = Message();
+  }
+  packet.AppendMessage(kPacketTrackEvent, event);
+  WritePacket(packet);
+}
+
+void ProtoTraceWriter::Flush() {}
+
+}  // namespace tracing
+}  // namespace node
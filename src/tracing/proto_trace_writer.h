@@ -0,0 +1,89 @@
+#ifndef SRC_TRACING_PROTO_TRACE_WRITER_H_
+#define SRC_TRACING_PROTO_TRACE_WRITER_H_
+
+#include <cinttypes>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "libplatform/v8-tracing.h"
+
+namespace node {
+namespace tracing {
+
+using v8::platform::tracing::TraceObject;
+using v8::platform::tracing::TraceWriter;
+
+// Serializes trace events in the protobuf format of Perfetto, which can be
+// loaded into ui.perfetto.dev and trace_processor, as an alternative to the
+// JSON format. See https://perfetto.dev/docs/reference/trace-packet-proto.
+//
+// All the events written to the stream form a single packet sequence, which
+// starts with a clock snapshot. Category, event and argument names are
+// interned, i.e. only written the first time they are used, and the
+// timestamps of the events are written as deltas on an incremental clock.
+// Events are put on one track per thread. The events that have no direct
+// equivalent are written as legacy events, which keep the phase, ids and
+// durations of the JSON format.
+class ProtoTraceWriter : public TraceWriter {
+ public:
+  explicit ProtoTraceWriter(std::ostream& stream);
+
+  void AppendTraceEvent(TraceObject* trace_event) override;
+  void Flush() override;
+
+  // The clock that the timestamps of the events are deltas on.
+  static constexpr uint32_t kIncrementalClockId = 64;
+  static constexpr uint32_t kSequenceId = 1;
+
+ private:
+  // A protobuf message that is being serialized.
+  class Message {
+   public:
+    void AppendVarInt(uint32_t field, uint64_t value);
+    void AppendDouble(uint32_t field, double value);
+    void AppendString(uint32_t field, const char* value, size_t length);
+    void AppendString(uint32_t field, const std::string& value);
+    void AppendMessage(uint32_t field, const Message& message);
+
+    const std::string& data() const { return data_; }
+    bool empty() const { return data_.empty(); }
+
+   private:
+    void AppendTag(uint32_t field, uint32_t wire_type);
+    void AppendRawVarInt(uint64_t value);
+
+    std::string data_;
+  };
+
+  using InternTable = std::unordered_map<std::string, uint64_t>;
+
+  void WritePacket(const Message& packet);
+  void WriteClockSnapshot(int64_t timestamp_us);
+  void WriteProcessDescriptor(int pid, const char* process_name);
+  void WriteThreadDescriptor(int pid, int tid, const char* thread_name);
+  void WriteMetadataEvent(TraceObject* trace_event);
+  uint64_t GetThreadTrack(int pid, int tid);
+  // Returns the id of `name` in `table`. If it is new, it is added to the
+  // interned data of the packet that is being written.
+  uint64_t Intern(InternTable* table, uint32_t field, const char* name);
+  void AppendLegacyEvent(TraceObject* trace_event, Message* event);
+  void AppendDebugAnnotations(TraceObject* trace_event, Message* event);
+  void AppendTimestamp(int64_t timestamp_us, Message* packet);
+
+  std::ostream& stream_;
+  bool started_ = false;
+  int64_t last_timestamp_us_ = 0;
+  InternTable categories_;
+  InternTable names_;
+  InternTable annotation_names_;
+  Message interned_data_;
+  std::unordered_set<uint64_t> thread_tracks_;
+  std::unordered_set<int> process_tracks_;
+};
+
+}  // namespace tracing
+}  // namespace node
+
+#endif  // SRC_TRACING_PROTO_TRACE_WRITER_H_
@@ -28,6 +28,18 @@
 #include "req_wrap-inl.h"
 #include "util-inl.h"
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+#ifdef __linux__
+#include <netinet/udp.h>
+#endif
+
 namespace node {
 
 using v8::Array;
@@ -48,6 +60,10 @@ using v8::Uint32;
 using v8::Undefined;
 using v8::Value;
 
+// A bind() flag of our own, outside of the range used by libuv. It asks for
+// the socket to be created with SO_REUSEPORT, see BindReusePort().
+static constexpr uint32_t UDP_REUSEPORT = 1 << 16;
+
 class SendWrap : public ReqWrap<uv_udp_send_t> {
  public:
   SendWrap(Environment* env, Local<Object> req_wrap_obj, bool have_callback);
@@ -89,6 +105,13 @@ UDPListener* UDPWrapBase::listener() const {
   return listener_;
 }
 
+ssize_t UDPWrapBase::TrySendBatch(uv_buf_t* bufs,
+                                  size_t nbufs,
+                                  size_t segment_size,
+                                  const sockaddr* addr) {
+  return 0;
+}
+
 void UDPWrapBase::set_listener(UDPListener* listener) {
   if (listener_ != nullptr)
     listener_->wrap_ = nullptr;
@@ -110,7 +133,7 @@ void UDPWrapBase::AddMethods(Environment* env, Local<FunctionTemplate> t) {
   env->SetProtoMethod(t, "recvStop", RecvStop);
 }
 
-UDPWrap::UDPWrap(Environment* env, Local<Object> object)
+UDPWrap::UDPWrap(Environment* env, Local<Object> object, unsigned int flags)
     : HandleWrap(env,
                  object,
                  reinterpret_cast<uv_handle_t*>(&handle_),
@@ -118,7 +141,7 @@ UDPWrap::UDPWrap(Environment* env, Local<Object> object)
   object->SetAlignedPointerInInternalField(
       UDPWrapBase::kUDPWrapBaseField, static_cast<UDPWrapBase*>(this));
 
-  int r = uv_udp_init(env->event_loop(), &handle_);
+  int r = uv_udp_init_ex(env->event_loop(), &handle_, flags);
   CHECK_EQ(r, 0);  // can't fail anyway
 
   set_listener(this);
@@ -202,6 +225,7 @@ void UDPWrap::Initialize(Local<Object> target,
   Local<Object> constants = Object::New(env->isolate());
   NODE_DEFINE_CONSTANT(constants, UV_UDP_IPV6ONLY);
   NODE_DEFINE_CONSTANT(constants, UV_UDP_REUSEADDR);
+  NODE_DEFINE_CONSTANT(constants, UDP_REUSEPORT);
   target->Set(context,
               env->constants_string(),
               constants).Check();
@@ -211,7 +235,8 @@ void UDPWrap::Initialize(Local<Object> target,
 void UDPWrap::New(const FunctionCallbackInfo<Value>& args) {
   CHECK(args.IsConstructCall());
   Environment* env = Environment::GetCurrent(args);
-  new UDPWrap(env, args.This());
+  // new UDP([recvmmsg])
+  new UDPWrap(env, args.This(), args[0]->IsTrue() ? UV_UDP_RECVMMSG : 0);
 }
 
 
@@ -225,6 +250,65 @@ void UDPWrap::GetFD(const FunctionCallbackInfo<Value>& args) {
   args.GetReturnValue().Set(fd);
 }
 
+// Serializes the sockets of the process that join and leave SO_REUSEPORT
+// groups, see UDPListener::OnBindReusePort().
+static Mutex reuse_port_mutex;
+
+// Binds a new socket that has SO_REUSEPORT set. Several sockets, possibly
+// owned by different threads, can then share the same port, and the kernel
+// distributes incoming datagrams among them. libuv has no flag for this, so
+// the socket is created here and handed to libuv afterwards.
+int UDPWrap::BindReusePort(const sockaddr* addr, unsigned int flags) {
+#if defined(_WIN32) || !defined(SO_REUSEPORT)
+  return UV_ENOTSUP;
+#else
+  uv_os_fd_t existing;
+  if (uv_fileno(reinterpret_cast<uv_handle_t*>(&handle_), &existing) == 0)
+    return UV_EINVAL;
+
+  int fd = socket(addr->sa_family, SOCK_DGRAM, 0);
+  if (fd == -1)
+    return -errno;
+
+  const socklen_t addrlen = addr->sa_family == AF_INET6 ?
+      sizeof(sockaddr_in6) : sizeof(sockaddr_in);
+  int on = 1;
+  int err = 0;
+  if (fcntl(fd, F_SETFD, FD_CLOEXEC) != 0 ||
+      setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) != 0 ||
+      ((flags & UV_UDP_REUSEADDR) &&
+       setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) != 0) ||
+      ((flags & UV_UDP_IPV6ONLY) &&
+       setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &on, sizeof(on)) != 0)) {
+    err = -errno;
+  }
+
+  Mutex::ScopedLock lock(reuse_port_mutex);
+  if (err == 0 && bind(fd, addr, addrlen) != 0)
+    err = -errno;
+  if (err == 0) {
+    sockaddr_storage local_storage;
+    socklen_t local_len = sizeof(local_storage);
+    sockaddr* local = reinterpret_cast<sockaddr*>(&local_storage);
+    if (getsockname(fd, local, &local_len) != 0)
+      err = -errno;
+    else
+      err = listener()->OnBindReusePort(fd, SocketAddress(local));
+  }
+  if (err == 0) {
+    err = uv_udp_open(&handle_, fd);
+    if (err != 0)
+      listener()->OnBeforeClose();
+  }
+  if (err != 0) {
+    close(fd);
+    return err;
+  }
+  reuse_port_ = true;
+  return 0;
+#endif
+}
+
 int sockaddr_for_family(int address_family,
                         const char* address,
                         const unsigned short port,
@@ -257,9 +341,15 @@ void UDPWrap::DoBind(const FunctionCallbackInfo<Value>& args, int family) {
   struct sockaddr_storage addr_storage;
   int err = sockaddr_for_family(family, address.out(), port, &addr_storage);
   if (err == 0) {
-    err = uv_udp_bind(&wrap->handle_,
-                      reinterpret_cast<const sockaddr*>(&addr_storage),
-                      flags);
+    if (flags & UDP_REUSEPORT) {
+      err = wrap->BindReusePort(
+          reinterpret_cast<const sockaddr*>(&addr_storage),
+          flags & ~UDP_REUSEPORT);
+    } else {
+      err = uv_udp_bind(&wrap->handle_,
+                        reinterpret_cast<const sockaddr*>(&addr_storage),
+                        flags);
+    }
   }
 
   if (err == 0)
@@ -585,6 +675,22 @@ ssize_t UDPWrap::Send(uv_buf_t* bufs_ptr,
     }
   }
 
+  if (err == 0) {
+    uv_udp_send_t* req = listener()->CreateNativeSendReq(msg_size);
+    if (req != nullptr) {
+      return uv_udp_send(
+          req,
+          &handle_,
+          bufs_ptr,
+          count,
+          addr,
+          [](uv_udp_send_t* req, int status) {
+            UDPWrap* self = ContainerOf(&UDPWrap::handle_, req->handle);
+            self->listener()->OnNativeSendDone(req, status);
+          });
+    }
+  }
+
   if (err == 0) {
     AsyncHooks::DefaultTriggerAsyncIdScope trigger_scope(this);
     ReqWrap<uv_udp_send_t>* req_wrap = listener()->CreateSendWrap(msg_size);
@@ -609,6 +715,124 @@ ssize_t UDPWrap::Send(uv_buf_t* bufs_ptr,
 }
 
 
+#ifdef __linux__
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+
+// The kernel refuses to split a datagram into more segments than this.
+static constexpr size_t kMaxGSOSegments = 64;
+
+// Sends all of |bufs| with a single sendmsg() call, and lets the kernel
+// (or the NIC) split the payload into datagrams of |segment_size| bytes.
+// Returns the number of datagrams sent, or a negative errno value.
+static ssize_t SendWithGSO(int fd,
+                           uv_buf_t* bufs,
+                           size_t nbufs,
+                           size_t segment_size,
+                           const sockaddr* addr) {
+  msghdr msg = {};
+  msg.msg_name = const_cast<sockaddr*>(addr);
+  msg.msg_namelen = addr != nullptr ? SocketAddress::GetLength(addr) : 0;
+  // uv_buf_t has the same layout as iovec on Unix.
+  msg.msg_iov = reinterpret_cast<iovec*>(bufs);
+  msg.msg_iovlen = nbufs;
+
+  char control[CMSG_SPACE(sizeof(uint16_t))] = {};
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+  cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_UDP;
+  cmsg->cmsg_type = UDP_SEGMENT;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+  const uint16_t segment = segment_size;
+  memcpy(CMSG_DATA(cmsg), &segment, sizeof(segment));
+
+  ssize_t r;
+  do {
+    r = sendmsg(fd, &msg, MSG_DONTWAIT);
+  } while (r == -1 && errno == EINTR);
+  return r == -1 ? -errno : static_cast<ssize_t>(nbufs);
+}
+
+// Sends each of |bufs| as its own datagram with a single sendmmsg() call.
+// Returns the number of datagrams sent, or a negative errno value.
+static ssize_t SendWithMmsg(int fd,
+                            uv_buf_t* bufs,
+                            size_t nbufs,
+                            const sockaddr* addr) {
+  MaybeStackBuffer<mmsghdr, 64> msgs(nbufs);
+  for (size_t i = 0; i < nbufs; i++) {
+    msgs[i] = {};
+    msgs[i].msg_hdr.msg_name = const_cast<sockaddr*>(addr);
+    msgs[i].msg_hdr.msg_namelen =
+        addr != nullptr ? SocketAddress::GetLength(addr) : 0;
+    msgs[i].msg_hdr.msg_iov = reinterpret_cast<iovec*>(&bufs[i]);
+    msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+
+  int r;
+  do {
+    r = sendmmsg(fd, *msgs, nbufs, MSG_DONTWAIT);
+  } while (r == -1 && errno == EINTR);
+  return r == -1 ? -errno : r;
+}
+#endif  // __linux__
+
+ssize_t UDPWrap::TrySendBatch(uv_buf_t* bufs,
+                              size_t nbufs,
+                              size_t segment_size,
+                              const sockaddr* addr) {
+  if (IsHandleClosing()) return UV_EBADF;
+
+  // Datagrams that libuv has queued have to be sent first.
+  if (UNLIKELY(env()->options()->test_udp_no_try_send) ||
+      handle_.send_queue_count > 0) {
+    return 0;
+  }
+
+#ifdef __linux__
+  uv_os_fd_t fd;
+  if (uv_fileno(reinterpret_cast<uv_handle_t*>(&handle_), &fd) != 0)
+    return 0;
+
+  if (gso_enabled_ && nbufs > 1 && nbufs <= kMaxGSOSegments) {
+    ssize_t r = SendWithGSO(fd, bufs, nbufs, segment_size, addr);
+    if (r >= 0)
+      return r;
+    switch (-r) {
+      case EAGAIN:
+#if EAGAIN != EWOULDBLOCK
+      case EWOULDBLOCK:
+#endif
+      case ENOBUFS:
+        // The socket buffer is full, libuv will wait until it is writable.
+        return 0;
+      case EIO:  // The device cannot compute the checksums.
+      case EINVAL:
+      case ENOPROTOOPT:
+      case EOPNOTSUPP:
+        // The kernel or the device do not support segmentation offload.
+        gso_enabled_ = false;
+        break;
+    }
+  }
+
+  ssize_t r = SendWithMmsg(fd, bufs, nbufs, addr);
+  // Errors are reported when the rest is sent through Send().
+  return r < 0 ? 0 : r;
+#else
+  return 0;
+#endif  // __linux__
+}
+
+// Matches the maximum number of messages libuv reads with one recvmmsg().
+static constexpr size_t kMaxRecvMmsgBatchSize = 20;
+
+size_t UDPWrap::GetRecvBatchSize() {
+  return uv_udp_using_recvmmsg(&handle_) == 1 ? kMaxRecvMmsgBatchSize : 1;
+}
+
 ReqWrap<uv_udp_send_t>* UDPWrap::CreateSendWrap(size_t msg_size) {
   SendWrap* req_wrap = new SendWrap(env(),
                                     current_send_req_wrap_,
@@ -632,6 +856,16 @@ AsyncWrap* UDPWrap::GetAsyncWrap() {
   return this;
 }
 
+void UDPWrap::Close(Local<Value> close_callback) {
+  std::unique_ptr<Mutex::ScopedLock> lock;
+  if (reuse_port_)
+    lock = std::make_unique<Mutex::ScopedLock>(reuse_port_mutex);
+  if (IsAlive(this) && !IsHandleClosing() && has_listener())
+    listener()->OnBeforeClose();
+  // libuv closes the socket right away.
+  HandleWrap::Close(close_callback);
+}
+
 SocketAddress UDPWrap::GetPeerName() {
   return SocketAddress::FromPeerName(handle_);
 }
@@ -707,7 +941,15 @@ void UDPWrap::OnRecv(ssize_t nread,
                      const sockaddr* addr,
                      unsigned int flags) {
   Environment* env = this->env();
-  AllocatedBuffer buf(env, buf_);
+  AllocatedBuffer buf;
+  if (flags & UV_UDP_MMSG_CHUNK) {
+    // The datagram is part of a larger buffer, which is released by the
+    // last callback for that read (flagged with UV_UDP_MMSG_FREE).
+    buf = AllocatedBuffer::AllocateManaged(env, nread);
+    memcpy(buf.data(), buf_.base, nread);
+  } else {
+    buf = AllocatedBuffer(env, buf_);
+  }
   if (nread == 0 && addr == nullptr) {
     return;
   }
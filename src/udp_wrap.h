@@ -63,9 +63,34 @@ class UDPListener {
   // error code.
   virtual void OnSendDone(ReqWrap<uv_udp_send_t>* wrap, int status) = 0;
 
+  // Optional alternative to CreateSendWrap() for listeners that need neither
+  // a JS object nor async_hooks events for each send. If this returns a
+  // request, it is used instead of calling CreateSendWrap(), and
+  // OnNativeSendDone() is called once the send has finished. If the send
+  // fails synchronously, the request remains owned by the listener.
+  // Not all UDPWrapBase implementations support this.
+  virtual uv_udp_send_t* CreateNativeSendReq(size_t msg_size) {
+    return nullptr;
+  }
+  virtual void OnNativeSendDone(uv_udp_send_t* req, int status) {}
+
   // Optional callback that is called after the socket has been bound.
   virtual void OnAfterBind() {}
 
+  // Optional callback that is called when a socket has been bound with
+  // SO_REUSEPORT, see UDPWrap::BindReusePort(). No other socket of the
+  // process joins or leaves the group until it returns, so the listener can
+  // keep track of the order of the sockets in the group. If it returns an
+  // error, the socket is closed and bind() fails with it.
+  virtual int OnBindReusePort(int fd, const SocketAddress& local_address) {
+    return 0;
+  }
+
+  // Optional callback that is called right before the socket is closed,
+  // while it can still be used. For SO_REUSEPORT sockets, no other socket of
+  // the process joins or leaves the group until it has been closed.
+  virtual void OnBeforeClose() {}
+
   inline UDPWrapBase* udp() const { return wrap_; }
 
  protected:
@@ -96,6 +121,22 @@ class UDPWrapBase {
                        size_t nbufs,
                        const sockaddr* addr) = 0;
 
+  // Try to send each of the buffers as a separate datagram, using as few
+  // system calls as possible. All buffers except the last one must be
+  // exactly `segment_size` bytes long, the last one may be shorter.
+  // Returns the number of datagrams that have been sent synchronously,
+  // which may be less than `nbufs` (including 0). The caller is responsible
+  // for sending the rest through Send(). No listener callbacks are invoked.
+  virtual ssize_t TrySendBatch(uv_buf_t* bufs,
+                               size_t nbufs,
+                               size_t segment_size,
+                               const sockaddr* addr);
+
+  // The maximum number of datagrams that a single read delivers to the
+  // listener. The buffer returned by OnAlloc() needs to be this many times
+  // larger than the suggested size for all of them to be read at once.
+  virtual size_t GetRecvBatchSize() { return 1; }
+
   virtual SocketAddress GetPeerName() = 0;
   virtual SocketAddress GetSockName() = 0;
 
@@ -104,6 +145,7 @@ class UDPWrapBase {
 
   void set_listener(UDPListener* listener);
   UDPListener* listener() const;
+  bool has_listener() const { return listener_ != nullptr; }
 
   static UDPWrapBase* FromObject(v8::Local<v8::Object> obj);
 
@@ -166,12 +208,21 @@ class UDPWrap final : public HandleWrap,
   ssize_t Send(uv_buf_t* bufs,
                size_t nbufs,
                const sockaddr* addr) override;
+  ssize_t TrySendBatch(uv_buf_t* bufs,
+                       size_t nbufs,
+                       size_t segment_size,
+                       const sockaddr* addr) override;
+  size_t GetRecvBatchSize() override;
 
   SocketAddress GetPeerName() override;
   SocketAddress GetSockName() override;
 
   AsyncWrap* GetAsyncWrap() override;
 
+  // HandleWrap implementation
+  void Close(
+      v8::Local<v8::Value> close_callback = v8::Local<v8::Value>()) override;
+
   static v8::MaybeLocal<v8::Object> Instantiate(Environment* env,
                                                 AsyncWrap* parent,
                                                 SocketType type);
@@ -186,10 +237,12 @@ class UDPWrap final : public HandleWrap,
             int (*F)(const typename T::HandleType*, sockaddr*, int*)>
   friend void GetSockOrPeerName(const v8::FunctionCallbackInfo<v8::Value>&);
 
-  UDPWrap(Environment* env, v8::Local<v8::Object> object);
+  UDPWrap(Environment* env, v8::Local<v8::Object> object, unsigned int flags);
 
   static void DoBind(const v8::FunctionCallbackInfo<v8::Value>& args,
                      int family);
+  int BindReusePort(const sockaddr* addr, unsigned int flags);
+  bool reuse_port_ = false;
   static void DoConnect(const v8::FunctionCallbackInfo<v8::Value>& args,
                      int family);
   static void DoSend(const v8::FunctionCallbackInfo<v8::Value>& args,
@@ -211,6 +264,9 @@ class UDPWrap final : public HandleWrap,
 
   uv_udp_t handle_;
 
+  // Set to false once the kernel has rejected UDP_SEGMENT for this socket.
+  bool gso_enabled_ = true;
+
   bool current_send_has_callback_;
   v8::Local<v8::Object> current_send_req_wrap_;
 };
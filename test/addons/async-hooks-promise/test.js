@@ -21,9 +21,10 @@ assert.strictEqual(
 const emptyHook = async_hooks.createHook({}).enable();
 
 // Check that no PromiseWrap is created when there are no hook callbacks.
+// The internal field only holds the trigger async id of the promise.
 assert.strictEqual(
-  binding.getPromiseField(Promise.resolve(1)),
-  0);
+  typeof binding.getPromiseField(Promise.resolve(1)),
+  'number');
 
 emptyHook.disable();
 
@@ -62,13 +63,13 @@ const hookWithDestroy = async_hooks.createHook({
   }
 }).enable();
 
-// Check that the internal field returns the same PromiseWrap passed to init().
+// Check that no PromiseWrap is created when there is a destroy hook.
 {
   const promise = Promise.resolve(1);
-  const promiseWrap = binding.getPromiseField(promise);
-  assert.strictEqual(lastResource, promiseWrap);
-  assert.strictEqual(lastAsyncId, promiseWrap[async_id_symbol]);
-  assert.strictEqual(lastTriggerAsyncId, promiseWrap[trigger_async_id_symbol]);
+  assert.strictEqual(binding.getPromiseField(promise), 0);
+  assert.strictEqual(lastResource, promise);
+  assert.strictEqual(lastAsyncId, promise[async_id_symbol]);
+  assert.strictEqual(lastTriggerAsyncId, promise[trigger_async_id_symbol]);
 }
 
 hookWithDestroy.disable();
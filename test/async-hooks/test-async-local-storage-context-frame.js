@@ -0,0 +1,99 @@
+// Flags: --experimental-async-context-frame --expose-internals
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const net = require('net');
+const { AsyncLocalStorage, AsyncResource } = require('async_hooks');
+const { internalBinding } = require('internal/test/binding');
+
+const {
+  async_hook_fields,
+  constants: { kTotals },
+} = internalBinding('async_wrap');
+
+const als = new AsyncLocalStorage();
+const other = new AsyncLocalStorage();
+
+function check(expected) {
+  assert.strictEqual(als.getStore(), expected);
+  // The stores are propagated without any async hook.
+  assert.strictEqual(async_hook_fields[kTotals], 0);
+}
+
+als.run('promise', async () => {
+  check('promise');
+  await null;
+  check('promise');
+  await new Promise((resolve) => setTimeout(resolve, 1));
+  check('promise');
+});
+
+als.run('timers', () => {
+  setTimeout(common.mustCall(() => check('timers')), 1);
+  const interval = setInterval(common.mustCall(() => {
+    check('timers');
+    clearInterval(interval);
+  }), 1);
+  setImmediate(common.mustCall(() => check('timers')));
+  process.nextTick(common.mustCall(() => check('timers')));
+  queueMicrotask(common.mustCall(() => check('timers')));
+});
+
+als.run('native', () => {
+  fs.stat(__filename, common.mustCall(() => {
+    check('native');
+    fs.promises.stat(__filename).then(common.mustCall(() => check('native')));
+  }));
+
+  const server = net.createServer(common.mustCall((socket) => {
+    check('native');
+    socket.end();
+  }));
+  server.listen(0, common.mustCall(() => {
+    check('native');
+    const client = net.connect(server.address().port);
+    client.resume();
+    client.on('end', common.mustCall(() => {
+      check('native');
+      server.close();
+    }));
+  }));
+});
+
+// Nested stores of different instances are independent, and every run() is
+// exited when its callback returns.
+als.run('outer', () => {
+  other.run('other', () => {
+    als.run('inner', common.mustCall(() => {
+      setTimeout(common.mustCall(() => {
+        check('inner');
+        assert.strictEqual(other.getStore(), 'other');
+      }), 1);
+    }));
+    check('outer');
+    als.exit(() => check(undefined));
+    check('outer');
+  });
+  assert.strictEqual(other.getStore(), undefined);
+});
+check(undefined);
+
+// AsyncResource keeps the stores of the context it was created in.
+const resource = als.run('resource', () => new AsyncResource('test'));
+als.run('caller', () => {
+  resource.runInAsyncScope(() => check('resource'));
+  check('caller');
+});
+
+// enterWith() and disable() only affect the current execution context.
+setImmediate(common.mustCall(() => {
+  als.enterWith('entered');
+  setTimeout(common.mustCall(() => {
+    check('entered');
+    als.disable();
+    check(undefined);
+  }), 1);
+  setTimeout(common.mustCall(() => check('entered')), 1);
+  check('entered');
+}));
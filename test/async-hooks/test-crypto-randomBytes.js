@@ -16,7 +16,9 @@ const crypto = require('crypto');
 const hooks = initHooks();
 
 hooks.enable();
-crypto.randomBytes(1, common.mustCall(onrandomBytes));
+// Small requests are served from a pool without a RandomBytesJob, so request
+// enough bytes to go through the threadpool.
+crypto.randomBytes(1024, common.mustCall(onrandomBytes));
 
 function onrandomBytes() {
   const as = hooks.activitiesOfTypes('RANDOMBYTESREQUEST');
@@ -0,0 +1,91 @@
+#include "histogram-inl.h"
+#include "base_object-inl.h"
+#include "gtest/gtest.h"
+#include "node_test_fixture.h"
+
+using node::BaseObjectPtr;
+using node::ConcurrentHistogram;
+using node::Environment;
+using node::Histogram;
+using node::HistogramBase;
+
+TEST(ConcurrentHistogram, Snapshot) {
+  ConcurrentHistogram histogram(1, 1000000, 3);
+  for (int64_t i = 1; i <= 100; i++)
+    CHECK(histogram.Record(i));
+  CHECK(!histogram.Record(2000000));
+
+  Histogram snapshot(1, 1000000, 3);
+  CHECK_EQ(histogram.Snapshot(&snapshot, false), 1);
+  CHECK_EQ(snapshot.Count(), 100);
+  CHECK_EQ(snapshot.Min(), 1);
+  CHECK_EQ(snapshot.Max(), 100);
+  CHECK_EQ(snapshot.Percentile(50), 50);
+
+  // The values are still there after a snapshot without reset.
+  Histogram again(1, 1000000, 3);
+  uint64_t version = histogram.Version();
+  CHECK_EQ(histogram.Snapshot(&again, true), 1);
+  CHECK_EQ(again.Count(), 100);
+  CHECK_NE(histogram.Version(), version);
+
+  // With reset, the next snapshot only has the values recorded since.
+  CHECK(histogram.Record(7));
+  Histogram interval(1, 1000000, 3);
+  CHECK_EQ(histogram.Snapshot(&interval, true), 0);
+  CHECK_EQ(interval.Count(), 1);
+  CHECK_EQ(interval.Min(), 7);
+}
+
+TEST(ConcurrentHistogram, RecordFromThreads) {
+  static constexpr int kThreads = 8;
+  static constexpr int64_t kValues = 10000;
+  ConcurrentHistogram histogram(1, 1000000, 3);
+
+  uv_thread_t threads[kThreads];
+  for (uv_thread_t& thread : threads) {
+    CHECK_EQ(0, uv_thread_create(&thread, [](void* arg) {
+      ConcurrentHistogram* histogram = static_cast<ConcurrentHistogram*>(arg);
+      for (int64_t i = 1; i <= kValues; i++)
+        CHECK(histogram->Record(i));
+    }, &histogram));
+  }
+
+  // Take interval snapshots while the threads are recording. Each value
+  // ends up in exactly one of them.
+  int64_t count = 0;
+  Histogram snapshot(1, 1000000, 3);
+  while (count < kThreads * kValues) {
+    snapshot.Reset();
+    histogram.Snapshot(&snapshot, true);
+    count += snapshot.Count();
+  }
+  for (uv_thread_t& thread : threads)
+    CHECK_EQ(0, uv_thread_join(&thread));
+
+  CHECK_EQ(count, kThreads * kValues);
+  snapshot.Reset();
+  histogram.Snapshot(&snapshot, false);
+  CHECK_EQ(snapshot.Count(), 0);
+  CHECK_EQ(histogram.Exceeds(), 0);
+}
+
+class HistogramBaseTest : public EnvironmentTestFixture {};
+
+TEST_F(HistogramBaseTest, RecordValueCountsExceeds) {
+  const v8::HandleScope handle_scope(isolate_);
+  const Argv argv;
+  Env env_{handle_scope, argv};
+  Environment* env = *env_;
+
+  HistogramBase::Initialize(env);
+  BaseObjectPtr<HistogramBase> histogram = HistogramBase::New(env, 1, 1000);
+  CHECK(histogram->RecordValue(10));
+  CHECK(!histogram->RecordValue(2000));
+  CHECK(!histogram->RecordValue(3000));
+  CHECK_EQ(histogram->Count(), 1);
+  CHECK_EQ(histogram->Exceeds(), 2);
+
+  histogram->ResetState();
+  CHECK_EQ(histogram->Exceeds(), 0);
+}
@@ -24,3 +24,41 @@ TEST(JSONUtilsTest, EscapeJsonChars) {
     EXPECT_EQ("a" + expected[i], EscapeJsonChars("a" + input));
   }
 }
+
+TEST(JSONUtilsTest, ScanJsonObject) {
+  using node::ScanJsonObject;
+  const char* const keys[] = { "main", "exports" };
+  std::string values[2];
+  auto scan = [&](const std::string& json) {
+    return ScanJsonObject(json.data(), json.size(), keys, 2, values);
+  };
+
+  EXPECT_TRUE(scan(" { \"name\": \"x\", \"main\" : \"./a.js\" } "));
+  EXPECT_EQ("\"./a.js\"", values[0]);
+  EXPECT_EQ("", values[1]);
+
+  EXPECT_TRUE(scan("{\"exports\":{\".\":[\"./a\",{\"main\":1}]},"
+                   "\"nested\":{\"main\":\"no\"},\"main\":\"1\",\"main\":2}"));
+  EXPECT_EQ("2", values[0]);
+  EXPECT_EQ("{\".\":[\"./a\",{\"main\":1}]}", values[1]);
+
+  EXPECT_TRUE(scan("{\"a\":[-0.5e+10,true,false,null,\"\\u00e9\\n\"]}"));
+  EXPECT_EQ("", values[0]);
+  EXPECT_TRUE(scan("[1, 2]"));
+  EXPECT_TRUE(scan("\"main\""));
+  EXPECT_TRUE(scan("{}"));
+
+  EXPECT_FALSE(scan(""));
+  EXPECT_FALSE(scan("{"));
+  EXPECT_FALSE(scan("{\"main\":1,}"));
+  EXPECT_FALSE(scan("{\"main\":01}"));
+  EXPECT_FALSE(scan("{\"main\":1.}"));
+  EXPECT_FALSE(scan("{\"main\":tru}"));
+  EXPECT_FALSE(scan("{\"main\":\"\\x\"}"));
+  EXPECT_FALSE(scan("{\"main\":\"a\nb\"}"));
+  EXPECT_FALSE(scan("{\"main\":1} {}"));
+  EXPECT_FALSE(scan("{'main':1}"));
+  // Escaped property names are left to a full parser.
+  EXPECT_FALSE(scan("{\"m\\u0061in\":1}"));
+  EXPECT_FALSE(scan(std::string(2000, '[') + std::string(2000, ']')));
+}
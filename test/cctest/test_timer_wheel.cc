@@ -0,0 +1,136 @@
+#include "timer_wheel.h"
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <vector>
+
+using node::TimerWheel;
+
+static std::vector<uint32_t> AdvanceTo(TimerWheel* wheel, uint64_t now) {
+  std::vector<uint32_t> expired;
+  wheel->Advance(now, &expired);
+  return expired;
+}
+
+TEST(TimerWheelTest, ExpiresInOrder) {
+  TimerWheel wheel;
+  wheel.Schedule(0, 10);
+  wheel.Schedule(1, 5);
+  wheel.Schedule(2, 10);
+  wheel.Schedule(3, 70);
+  wheel.Schedule(4, 5000);
+  EXPECT_EQ(wheel.size(), 5u);
+  EXPECT_LE(wheel.NextWakeup(), 5u);
+
+  EXPECT_EQ(AdvanceTo(&wheel, 4), std::vector<uint32_t>());
+  EXPECT_EQ(AdvanceTo(&wheel, 9), std::vector<uint32_t>({1}));
+  EXPECT_EQ(AdvanceTo(&wheel, 10), std::vector<uint32_t>({0, 2}));
+  EXPECT_EQ(AdvanceTo(&wheel, 69), std::vector<uint32_t>());
+  EXPECT_EQ(AdvanceTo(&wheel, 4999), std::vector<uint32_t>({3}));
+  EXPECT_FALSE(wheel.IsScheduled(3));
+  EXPECT_TRUE(wheel.IsScheduled(4));
+  EXPECT_EQ(AdvanceTo(&wheel, 5000), std::vector<uint32_t>({4}));
+  EXPECT_EQ(wheel.size(), 0u);
+  EXPECT_EQ(wheel.NextWakeup(), TimerWheel::kNever);
+}
+
+TEST(TimerWheelTest, RescheduleAndCancel) {
+  TimerWheel wheel(100);
+  wheel.Schedule(0, 200);
+  wheel.Schedule(1, 200);
+  wheel.Schedule(2, 200);
+  // Rescheduling moves a timer behind the others with the same expiry.
+  wheel.Schedule(0, 200);
+  wheel.Cancel(1);
+  wheel.Cancel(1);
+  EXPECT_FALSE(wheel.IsScheduled(1));
+  EXPECT_EQ(wheel.size(), 2u);
+  EXPECT_EQ(AdvanceTo(&wheel, 300), std::vector<uint32_t>({2, 0}));
+
+  // Expiries that are not in the future are moved to the next millisecond.
+  wheel.Schedule(7, 10);
+  EXPECT_EQ(AdvanceTo(&wheel, 300), std::vector<uint32_t>());
+  EXPECT_EQ(wheel.NextWakeup(), 301u);
+  EXPECT_EQ(AdvanceTo(&wheel, 301), std::vector<uint32_t>({7}));
+}
+
+TEST(TimerWheelTest, CascadesAcrossLevels) {
+  // The expiry differs from the current time in its upper bits.
+  uint64_t now = (uint64_t{1} << 32) - 3;
+  TimerWheel wheel(now);
+  wheel.Schedule(0, now + 10);
+  wheel.Schedule(1, now + (uint64_t{1} << 31));
+  EXPECT_EQ(AdvanceTo(&wheel, now + 9), std::vector<uint32_t>());
+  EXPECT_EQ(AdvanceTo(&wheel, now + 10), std::vector<uint32_t>({0}));
+  EXPECT_EQ(AdvanceTo(&wheel, now + (uint64_t{1} << 31) - 1),
+            std::vector<uint32_t>());
+  EXPECT_EQ(AdvanceTo(&wheel, now + (uint64_t{1} << 31)),
+            std::vector<uint32_t>({1}));
+}
+
+TEST(TimerWheelTest, NeverEarlyNorLate) {
+  static constexpr uint32_t kTimers = 10000;
+  TimerWheel wheel;
+  std::vector<uint64_t> expiries(kTimers);
+  uint64_t seed = 42;
+  auto next_random = [&]() {
+    seed = seed * 6364136223846793005u + 1442695040888963407u;
+    return seed >> 33;
+  };
+  for (uint32_t id = 0; id < kTimers; id++) {
+    expiries[id] = 1 + next_random() % 100000;
+    wheel.Schedule(id, expiries[id]);
+  }
+
+  uint64_t now = 0;
+  uint32_t count = 0;
+  while (wheel.size() > 0) {
+    uint64_t previous = now;
+    now += 1 + next_random() % 500;
+    std::vector<uint32_t> expired = AdvanceTo(&wheel, now);
+    for (size_t i = 0; i < expired.size(); i++) {
+      uint64_t expiry = expiries[expired[i]];
+      EXPECT_GT(expiry, previous);
+      EXPECT_LE(expiry, now);
+      if (i > 0) {
+        uint64_t before = expiries[expired[i - 1]];
+        EXPECT_TRUE(before < expiry ||
+                    (before == expiry && expired[i - 1] < expired[i]));
+      }
+    }
+    count += expired.size();
+  }
+  EXPECT_EQ(count, kTimers);
+}
+
+TEST(TimerWheelTest, NativeTimers) {
+  TimerWheel wheel;
+  int calls = 0;
+  auto callback = [](void* data) { (*static_cast<int*>(data))++; };
+  uint32_t first = wheel.AddNativeTimer(callback, &calls);
+  uint32_t second = wheel.AddNativeTimer(callback, &calls);
+  EXPECT_TRUE(TimerWheel::IsNativeTimer(first));
+  EXPECT_NE(first, second);
+
+  // Native timers share the wheel with the JavaScript ones.
+  wheel.Schedule(0, 20);
+  wheel.Schedule(first, 10);
+  wheel.Schedule(second, 20);
+  std::vector<uint32_t> expired = AdvanceTo(&wheel, 20);
+  EXPECT_EQ(expired, std::vector<uint32_t>({first, 0, second}));
+
+  wheel.RunNativeTimer(first);
+  EXPECT_EQ(calls, 1);
+  // A timer that has been rescheduled or removed since it expired does not
+  // run.
+  wheel.Schedule(first, 30);
+  wheel.RunNativeTimer(first);
+  wheel.RemoveNativeTimer(second);
+  wheel.RunNativeTimer(second);
+  EXPECT_EQ(calls, 1);
+
+  // The id is reused.
+  EXPECT_EQ(wheel.AddNativeTimer(callback, &calls), second);
+  wheel.RemoveNativeTimer(first);
+  EXPECT_EQ(AdvanceTo(&wheel, 30), std::vector<uint32_t>());
+}
@@ -34,6 +34,109 @@ function verifyFrames(output, file, suffix) {
   assert.notDeepStrictEqual(frames, []);
 }
 
+// Reads the varint at `offset` in `buffer`, returns it along with the offset
+// that follows it.
+function readVarint(buffer, offset) {
+  let value = 0;
+  let factor = 1;
+  let byte;
+  do {
+    byte = buffer[offset++];
+    value += (byte & 0x7f) * factor;
+    factor *= 128;
+  } while (byte & 0x80);
+  return [value, offset];
+}
+
+// Decodes the fields of a protobuf message into an array of
+// { field, value } objects, where value is a number or a Buffer.
+function decodeMessage(buffer) {
+  const fields = [];
+  let offset = 0;
+  while (offset < buffer.length) {
+    let tag, value;
+    [tag, offset] = readVarint(buffer, offset);
+    switch (tag & 7) {
+      case 0:
+        [value, offset] = readVarint(buffer, offset);
+        break;
+      case 2: {
+        let length;
+        [length, offset] = readVarint(buffer, offset);
+        value = buffer.subarray(offset, offset + length);
+        offset += length;
+        break;
+      }
+      default:
+        assert.fail(`Unexpected wire type in field ${tag >>> 3}`);
+    }
+    fields.push({ field: tag >>> 3, value });
+  }
+  return fields;
+}
+
+function decodePacked(buffer) {
+  const values = [];
+  let offset = 0;
+  while (offset < buffer.length) {
+    let value;
+    [value, offset] = readVarint(buffer, offset);
+    values.push(value);
+  }
+  return values;
+}
+
+// Parses a gzip-compressed pprof profile, as written by the continuous CPU
+// profiler.
+function parsePprof(data) {
+  const { gunzipSync } = require('zlib');
+  const fields = decodeMessage(gunzipSync(data));
+  const get = (field) => fields.filter((f) => f.field === field);
+  const strings = get(6).map((f) => f.value.toString());
+
+  const functions = new Map();
+  for (const { value } of get(5)) {
+    const f = decodeMessage(value);
+    const id = f.find((x) => x.field === 1).value;
+    const name = f.find((x) => x.field === 2);
+    const filename = f.find((x) => x.field === 4);
+    functions.set(id, {
+      name: strings[name ? name.value : 0],
+      filename: strings[filename ? filename.value : 0],
+    });
+  }
+
+  const locations = new Map();
+  for (const { value } of get(4)) {
+    const f = decodeMessage(value);
+    const id = f.find((x) => x.field === 1).value;
+    const line = decodeMessage(f.find((x) => x.field === 4).value);
+    locations.set(id, functions.get(line.find((x) => x.field === 1).value));
+  }
+
+  const samples = get(2).map(({ value }) => {
+    const f = decodeMessage(value);
+    const labels = {};
+    for (const label of f.filter((x) => x.field === 3)) {
+      const l = decodeMessage(label.value);
+      labels[strings[l.find((x) => x.field === 1).value]] =
+        strings[l.find((x) => x.field === 2).value];
+    }
+    const ids = f.find((x) => x.field === 1);
+    return {
+      stack: ids ? decodePacked(ids.value).map((id) => locations.get(id)) : [],
+      values: decodePacked(f.find((x) => x.field === 2).value),
+      labels,
+    };
+  });
+
+  const sampleTypes = get(1).map(({ value }) => {
+    const f = decodeMessage(value);
+    return strings[f.find((x) => x.field === 1).value];
+  });
+  return { sampleTypes, samples, strings };
+}
+
 // We need to set --cpu-interval to a smaller value to make sure we can
 // find our workload in the samples. 50us should be a small enough sampling
 // interval for this.
@@ -48,5 +151,6 @@ module.exports = {
   kCpuProfInterval,
   env,
   getFrames,
+  parsePprof,
   verifyFrames
 };
@@ -0,0 +1,9 @@
+'use strict';
+
+let count = 0;
+
+module.exports = {
+  increment() {
+    return ++count;
+  }
+};
@@ -0,0 +1,40 @@
+'use strict';
+
+const fs = require('fs');
+const path = require('path');
+const assert = require('assert');
+const {
+  isBuildingSnapshot,
+  addSerializeCallback,
+  addDeserializeCallback,
+  setDeserializeMainFunction
+} = require('v8').startupSnapshot;
+
+assert(isBuildingSnapshot());
+
+const counter = require('./counter');
+counter.increment();
+
+const storage = {};
+setTimeout(() => {
+  // Pending work is run before the snapshot is taken.
+  storage.fromTimer = counter.increment();
+}, 1);
+
+addSerializeCallback(({ file }) => {
+  storage.text = fs.readFileSync(file, 'utf8');
+}, { file: path.join(__dirname, 'data.txt') });
+
+addDeserializeCallback(() => {
+  storage.deserialized = true;
+});
+
+setDeserializeMainFunction((data) => {
+  assert(!isBuildingSnapshot());
+  console.log(JSON.stringify({
+    ...storage,
+    count: counter.increment(),
+    data,
+    argv: process.argv.slice(1)
+  }));
+}, 'hello');
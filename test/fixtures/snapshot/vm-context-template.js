@@ -0,0 +1,50 @@
+'use strict';
+
+const assert = require('assert');
+const vm = require('vm');
+const {
+  addContextTemplate,
+  setDeserializeMainFunction
+} = require('v8').startupSnapshot;
+
+addContextTemplate('math', `
+  var counter = 0;
+  function square(x) {
+    counter++;
+    return x * x;
+  }
+  Array.prototype.sum = function() {
+    return this.reduce((a, b) => a + b, 0);
+  };
+`);
+
+assert.throws(() => addContextTemplate('math', ''), {
+  code: 'ERR_INVALID_ARG_VALUE'
+});
+// Errors thrown by the setup code are thrown to the caller.
+assert.throws(() => addContextTemplate('broken', 'throw new Error("boom")'), {
+  message: 'boom'
+});
+// The templates cannot be used until they are deserialized.
+assert.throws(() => vm.createContext({}, { contextTemplate: 'math' }), {
+  code: 'ERR_INVALID_ARG_VALUE'
+});
+
+setDeserializeMainFunction(() => {
+  const results = [];
+  for (let i = 1; i <= 2; i++) {
+    const sandbox = { i };
+    vm.createContext(sandbox, { contextTemplate: 'math' });
+    results.push(vm.runInContext('[square(i), [1, 2, i].sum(), counter]',
+                                 sandbox));
+  }
+  results.push(vm.runInContext('typeof square', vm.createContext({})));
+  for (const contextTemplate of ['broken', 'unknown']) {
+    try {
+      vm.createContext({}, { contextTemplate });
+    } catch (err) {
+      results.push(err.code);
+    }
+  }
+  console.log(JSON.stringify(results));
+});
@@ -0,0 +1,56 @@
+// Flags: --expose-gc --expose-internals
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const async_hooks = require('async_hooks');
+const {
+  async_id_symbol,
+  trigger_async_id_symbol,
+} = require('internal/async_hooks').symbols;
+
+// Without init hooks, the async ids of promises are only assigned once a
+// hook observes them, and chained promises still use their parent as trigger.
+const befores = [];
+const hook = async_hooks.createHook({
+  before(asyncId) {
+    befores.push(asyncId);
+  }
+}).enable();
+
+const parent = Promise.resolve(1);
+assert.strictEqual(parent[async_id_symbol], undefined);
+const child = parent.then(common.mustCall(() => {
+  assert.deepStrictEqual(befores, [child[async_id_symbol]]);
+  assert.strictEqual(async_hooks.executionAsyncId(), child[async_id_symbol]);
+  assert.strictEqual(async_hooks.triggerAsyncId(), parent[async_id_symbol]);
+  assert.strictEqual(child[trigger_async_id_symbol], parent[async_id_symbol]);
+  assert.strictEqual(async_hooks.executionAsyncResource(), child);
+  hook.disable();
+  setImmediate(testDestroy);
+}));
+
+// The destroy hook is emitted for promises without wrapping them.
+function testDestroy() {
+  const ids = [];
+  const destroyed = [];
+  async_hooks.createHook({
+    init(asyncId, type, triggerAsyncId, resource) {
+      if (type === 'PROMISE') {
+        assert(resource instanceof Promise);
+        ids.push(asyncId);
+      }
+    },
+    destroy(asyncId) {
+      destroyed.push(asyncId);
+    }
+  }).enable();
+
+  Promise.resolve();
+  assert.strictEqual(ids.length, 1);
+  setImmediate(() => {
+    global.gc();
+    setImmediate(common.mustCall(() => {
+      assert(destroyed.includes(ids[0]));
+    }));
+  });
+}
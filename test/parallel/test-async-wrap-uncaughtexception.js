@@ -38,8 +38,9 @@ process.on('uncaughtException', common.mustCall(() => {
   call_log[2]++;
 }));
 
-
-require('crypto').randomBytes(1, common.mustCall(() => {
+// Small requests are served from a pool without a RandomBytesJob, so request
+// enough bytes to go through the threadpool.
+require('crypto').randomBytes(1024, common.mustCall(() => {
   assert.strictEqual(call_id, async_hooks.executionAsyncId());
   call_log[1]++;
   throw new Error();
@@ -37,6 +37,7 @@ const expectedModules = new Set([
   'NativeModule fs',
   'NativeModule internal/abort_controller',
   'NativeModule internal/assert',
+  'NativeModule internal/async_context_frame',
   'NativeModule internal/async_hooks',
   'NativeModule internal/bootstrap/pre_execution',
   'NativeModule internal/buffer',
@@ -50,7 +51,6 @@ const expectedModules = new Set([
   'NativeModule internal/fs/dir',
   'NativeModule internal/fs/utils',
   'NativeModule internal/idna',
-  'NativeModule internal/linkedlist',
   'NativeModule internal/modules/run_main',
   'NativeModule internal/modules/package_json_reader',
   'NativeModule internal/modules/cjs/helpers',
@@ -66,7 +66,6 @@ const expectedModules = new Set([
   'NativeModule internal/modules/esm/translators',
   'NativeModule internal/process/esm_loader',
   'NativeModule internal/options',
-  'NativeModule internal/priority_queue',
   'NativeModule internal/process/execution',
   'NativeModule internal/process/per_thread',
   'NativeModule internal/process/promises',
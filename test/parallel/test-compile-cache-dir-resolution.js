@@ -0,0 +1,89 @@
+'use strict';
+
+// Tests that --compile-cache-dir stores the results of the CommonJS module
+// resolution, and that they are not reused once the directories or the
+// package.json files they depend on have changed.
+
+require('../common');
+const assert = require('assert');
+const { spawnSync } = require('child_process');
+const fs = require('fs');
+const path = require('path');
+const tmpdir = require('../common/tmpdir');
+
+tmpdir.refresh();
+const cacheDir = path.join(tmpdir.path, 'cache');
+const app = path.join(tmpdir.path, 'app');
+const main = path.join(app, 'main.js');
+
+function write(file, contents) {
+  fs.mkdirSync(path.dirname(file), { recursive: true });
+  fs.writeFileSync(file, contents);
+}
+
+// Results that depend on recently modified directories are not recorded,
+// as their modification time might not change again on the next update.
+function age(dir) {
+  const past = new Date(Date.now() - 60 * 1000);
+  fs.utimesSync(dir, past, past);
+  for (const entry of fs.readdirSync(dir, { withFileTypes: true })) {
+    const entryPath = path.join(dir, entry.name);
+    if (entry.isDirectory() && entry.name !== 'cache')
+      age(entryPath);
+    else
+      fs.utimesSync(entryPath, past, past);
+  }
+}
+
+function run(expected) {
+  const child = spawnSync(process.execPath,
+                          ['--compile-cache-dir', cacheDir, main], {
+                            cwd: tmpdir.path,
+                            env: {
+                              ...process.env,
+                              NODE_DEBUG_NATIVE: 'COMPILE_CACHE'
+                            },
+                            encoding: 'utf8'
+                          });
+  assert.strictEqual(child.status, 0, child.stderr);
+  assert.strictEqual(child.stdout, `${expected}\n`);
+  return child.stderr;
+}
+
+write(main, "console.log(require('dep'));\n");
+write(path.join(tmpdir.path, 'node_modules', 'dep', 'index.js'),
+      "module.exports = 'outer';\n");
+age(tmpdir.path);
+
+{
+  const stderr = run('outer');
+  assert.match(stderr, /wrote [1-9]\d* resolutions/);
+}
+
+{
+  const stderr = run('outer');
+  assert.match(stderr, /read [1-9]\d* resolutions/);
+  assert.doesNotMatch(stderr, /is outdated/);
+}
+
+// A package that shadows the previous one.
+write(path.join(app, 'node_modules', 'dep', 'index.js'),
+      "module.exports = 'inner';\n");
+{
+  const stderr = run('inner');
+  assert.match(stderr, /resolution of .*index\.js is outdated/);
+}
+
+// A change in the package.json of the package, which does not change the
+// modification time of its directory.
+write(path.join(app, 'node_modules', 'dep', 'lib.js'),
+      "module.exports = 'main';\n");
+write(path.join(app, 'node_modules', 'dep', 'package.json'), '{}\n');
+age(tmpdir.path);
+assert.match(run('inner'), /wrote [1-9]\d* resolutions/);
+fs.writeFileSync(path.join(app, 'node_modules', 'dep', 'package.json'),
+                 '{ "main": "lib.js" }\n');
+{
+  const stderr = run('main');
+  assert.match(stderr, /resolution of .*index\.js is outdated/);
+}
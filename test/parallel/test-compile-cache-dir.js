@@ -0,0 +1,86 @@
+'use strict';
+
+// Tests that --compile-cache-dir caches the code of CommonJS and ES modules
+// on disk, and that the cache is only used when the source is unchanged.
+
+require('../common');
+const assert = require('assert');
+const { spawnSync } = require('child_process');
+const fs = require('fs');
+const path = require('path');
+const tmpdir = require('../common/tmpdir');
+
+tmpdir.refresh();
+const cacheDir = path.join(tmpdir.path, 'cache');
+const cjs = path.join(tmpdir.path, 'dep.js');
+const esm = path.join(tmpdir.path, 'entry.mjs');
+fs.writeFileSync(cjs, 'module.exports = (a, b) => a + b;\n');
+fs.writeFileSync(esm, `
+import { createRequire } from 'module';
+const add = createRequire(import.meta.url)('./dep.js');
+console.log(add(1, 2));
+`);
+
+function run() {
+  const child = spawnSync(process.execPath,
+                          ['--compile-cache-dir', cacheDir, esm], {
+                            cwd: tmpdir.path,
+                            env: {
+                              ...process.env,
+                              NODE_DEBUG_NATIVE: 'COMPILE_CACHE'
+                            },
+                            encoding: 'utf8'
+                          });
+  assert.strictEqual(child.status, 0, child.stderr);
+  assert.strictEqual(child.stdout, '3\n');
+  return child.stderr;
+}
+
+function cacheFiles() {
+  const [subdir] = fs.readdirSync(cacheDir);
+  assert.match(subdir, /^v\d+\.\d+\.\d+/);
+  return fs.readdirSync(path.join(cacheDir, subdir))
+    .map((file) => path.join(cacheDir, subdir, file));
+}
+
+// The first run writes the caches.
+{
+  const stderr = run();
+  assert.match(stderr, /no cache for CommonJS .*dep\.js/);
+  assert.match(stderr, /no cache for ESM .*entry\.mjs/);
+  assert.match(stderr, /wrote cache for CommonJS .*dep\.js/);
+  assert.match(stderr, /wrote cache for ESM .*entry\.mjs/);
+  assert.strictEqual(cacheFiles().length, 2);
+}
+
+// The second run uses them.
+{
+  const stderr = run();
+  assert.match(stderr, /cache for CommonJS .*dep\.js was accepted/);
+  assert.match(stderr, /cache for ESM .*entry\.mjs was accepted/);
+  assert.doesNotMatch(stderr, /wrote cache/);
+}
+
+// Changing the source invalidates the cache.
+{
+  fs.writeFileSync(cjs, 'module.exports = (a, b) => b + a;\n');
+  const stderr = run();
+  assert.match(stderr, /no cache for CommonJS .*dep\.js/);
+  assert.match(stderr, /cache for ESM .*entry\.mjs was accepted/);
+  assert.match(stderr, /wrote cache for CommonJS .*dep\.js/);
+  assert.strictEqual(cacheFiles().length, 3);
+}
+
+// Corrupted caches are ignored and rewritten.
+{
+  for (const file of cacheFiles()) {
+    const data = fs.readFileSync(file);
+    data[data.length - 1] ^= 0xff;
+    fs.writeFileSync(file, data);
+  }
+  const stderr = run();
+  assert.match(stderr, /cache for CommonJS .*dep\.js is corrupted/);
+  assert.match(stderr, /cache for ESM .*entry\.mjs is corrupted/);
+  assert.match(stderr, /wrote cache for ESM .*entry\.mjs/);
+  assert.match(run(), /cache for ESM .*entry\.mjs was accepted/);
+}
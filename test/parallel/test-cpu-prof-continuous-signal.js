@@ -0,0 +1,46 @@
+'use strict';
+
+// Tests that --cpu-prof-continuous-signal starts the continuous CPU profiler
+// and writes its profile when the signal is received.
+
+const common = require('../common');
+
+if (common.isWindows)
+  common.skip('test not supported on Windows');
+
+const assert = require('assert');
+const fs = require('fs');
+const path = require('path');
+
+function spinBeforeSignal() {
+  const start = Date.now();
+  while (Date.now() - start < 200);
+}
+
+if (process.argv[2] === 'child') {
+  spinBeforeSignal();
+  process.kill(process.pid, 'SIGUSR2');
+  (function wait() {
+    if (fs.readdirSync(process.cwd()).length === 0)
+      setImmediate(wait);
+  })();
+} else {
+  const { spawnSync } = require('child_process');
+  const { parsePprof } = require('../common/cpu-prof');
+  const tmpdir = require('../common/tmpdir');
+
+  tmpdir.refresh();
+  const child = spawnSync(process.execPath, [
+    '--cpu-prof-continuous-signal', 'SIGUSR2', __filename, 'child',
+  ], { cwd: tmpdir.path });
+  assert.strictEqual(child.status, 0, child.stderr.toString());
+
+  const files = fs.readdirSync(tmpdir.path);
+  assert.strictEqual(files.length, 1);
+  assert.match(files[0], /^CPU\..+\.pb\.gz$/);
+  const { samples } = parsePprof(
+    fs.readFileSync(path.join(tmpdir.path, files[0])));
+  assert(samples.some(({ stack }) => {
+    return stack.some(({ name }) => name === 'spinBeforeSignal');
+  }));
+}
@@ -0,0 +1,175 @@
+'use strict';
+const common = require('../common');
+if (!common.hasCrypto)
+  common.skip('missing crypto');
+
+const assert = require('assert');
+const crypto = require('crypto');
+const { pipeline, Readable, Writable } = require('stream');
+
+const key = Buffer.alloc(32, 'k');
+const iv = Buffer.alloc(12, 'i');
+const plaintext = Buffer.alloc(100000);
+for (let i = 0; i < plaintext.length; i++)
+  plaintext[i] = i % 251;
+
+function encrypt(algorithm) {
+  const cipher = crypto.createCipheriv(algorithm, key, iv);
+  const ciphertext = Buffer.concat([cipher.update(plaintext), cipher.final()]);
+  return { ciphertext, tag: cipher.getAuthTag() };
+}
+
+// In-place encryption and decryption.
+for (const algorithm of ['aes-256-gcm', 'chacha20-poly1305']) {
+  const { ciphertext, tag } = encrypt(algorithm);
+
+  const data = Buffer.from(plaintext);
+  const cipher = crypto.createCipheriv(algorithm, key, iv);
+  let offset = 0;
+  for (const size of [1, 15, 16, 1000, 65536]) {
+    const chunk = data.subarray(offset, offset + size);
+    assert.strictEqual(cipher.updateInto(chunk, chunk), size);
+    offset += size;
+  }
+  const rest = data.subarray(offset);
+  assert.strictEqual(cipher.updateInto(rest, rest), rest.length);
+  assert.strictEqual(cipher.final().length, 0);
+  assert.deepStrictEqual(data, ciphertext);
+  assert.deepStrictEqual(cipher.getAuthTag(), tag);
+
+  const decipher = crypto.createDecipheriv(algorithm, key, iv);
+  decipher.setAuthTag(tag);
+  assert.strictEqual(decipher.updateInto(data, data), data.length);
+  decipher.final();
+  assert.deepStrictEqual(data, plaintext);
+}
+
+// Writing into a separate buffer, at an offset.
+{
+  const { ciphertext } = encrypt('aes-256-gcm');
+  const cipher = crypto.createCipheriv('aes-256-gcm', key, iv);
+  const output = Buffer.alloc(plaintext.length + 32);
+  assert.strictEqual(cipher.updateInto(plaintext, output, 10),
+                     plaintext.length);
+  assert.deepStrictEqual(output.subarray(10, 10 + plaintext.length),
+                         ciphertext);
+
+  // The output has to be able to hold the input plus one block.
+  const cbc = crypto.createCipheriv('aes-256-cbc', key, Buffer.alloc(16));
+  assert.throws(() => cbc.updateInto(Buffer.alloc(32), Buffer.alloc(40)), {
+    code: 'ERR_OUT_OF_RANGE'
+  });
+  assert.throws(() => cbc.updateInto(Buffer.alloc(32), Buffer.alloc(64), 50), {
+    code: 'ERR_OUT_OF_RANGE'
+  });
+  assert.throws(() => cbc.updateInto(Buffer.alloc(32), Buffer.alloc(64), 65), {
+    code: 'ERR_OUT_OF_RANGE'
+  });
+  assert.throws(() => cbc.updateInto('abc', Buffer.alloc(64)), {
+    code: 'ERR_INVALID_ARG_TYPE'
+  });
+  assert.throws(() => cbc.updateInto(Buffer.alloc(32), 'abc'), {
+    code: 'ERR_INVALID_ARG_TYPE'
+  });
+  // A failed call does not change the state of the cipher.
+  const expected = crypto.createCipheriv('aes-256-cbc', key, Buffer.alloc(16))
+    .update(Buffer.alloc(32));
+  const out = Buffer.alloc(48);
+  assert.strictEqual(cbc.updateInto(Buffer.alloc(32), out), 32);
+  assert.deepStrictEqual(out.subarray(0, 32), expected);
+}
+
+// updateAsync() keeps the order of the updates.
+{
+  const { ciphertext, tag } = encrypt('aes-256-gcm');
+  const cipher = crypto.createCipheriv('aes-256-gcm', key, iv);
+  const results = [];
+  const output = Buffer.alloc(plaintext.length);
+  const chunkSize = 7777;
+  let pending = 0;
+  for (let offset = 0; offset < plaintext.length; offset += chunkSize) {
+    const chunk = plaintext.subarray(offset, offset + chunkSize);
+    const index = results.length;
+    results.push(null);
+    pending++;
+    if (index % 2 === 0) {
+      cipher.updateAsync(chunk, common.mustSucceed((result) => {
+        results[index] = result;
+        done();
+      }));
+    } else {
+      cipher.updateAsync(chunk, output, offset,
+                         common.mustSucceed((written) => {
+                           assert.strictEqual(written, chunk.length);
+                           results[index] =
+                             output.subarray(offset, offset + written);
+                           done();
+                         }));
+    }
+  }
+
+  // The cipher cannot be used synchronously while updates are pending.
+  for (const fn of [
+    () => cipher.update(plaintext),
+    () => cipher.updateInto(plaintext, output),
+    () => cipher.final(),
+    () => cipher.setAAD(Buffer.alloc(1)),
+    () => cipher.setAutoPadding(false),
+  ]) {
+    assert.throws(fn, { code: 'ERR_CRYPTO_INVALID_STATE' });
+  }
+
+  function done() {
+    if (--pending > 0)
+      return;
+    assert.deepStrictEqual(Buffer.concat([...results, cipher.final()]),
+                           ciphertext);
+    assert.deepStrictEqual(cipher.getAuthTag(), tag);
+  }
+}
+
+// Streams that run on the threadpool.
+for (const algorithm of ['aes-256-gcm', 'chacha20-poly1305']) {
+  const { ciphertext, tag } = encrypt(algorithm);
+  const cipher = crypto.createCipheriv(algorithm, key, iv, {
+    threadpool: true
+  });
+  const chunks = [];
+  pipeline(
+    Readable.from((function*() {
+      for (let offset = 0; offset < plaintext.length; offset += 1000)
+        yield plaintext.subarray(offset, offset + 1000);
+    })()),
+    cipher,
+    new Writable({
+      write(chunk, encoding, callback) {
+        chunks.push(chunk);
+        // Consume slowly, so that chunks queue up in the cipher.
+        setImmediate(callback);
+      }
+    }),
+    common.mustSucceed(() => {
+      assert.deepStrictEqual(Buffer.concat(chunks), ciphertext);
+      assert.deepStrictEqual(cipher.getAuthTag(), tag);
+    }));
+}
+
+{
+  const { ciphertext } = encrypt('aes-256-gcm');
+  const decipher = crypto.createDecipheriv('aes-256-gcm', key, iv, {
+    threadpool: true
+  });
+  decipher.setAuthTag(Buffer.alloc(16));
+  decipher.on('data', common.mustCallAtLeast());
+  decipher.on('error', common.mustCall((err) => {
+    assert.match(err.message, /Unsupported state or unable to authenticate/);
+  }));
+  decipher.end(ciphertext);
+}
+
+assert.throws(() => {
+  crypto.createCipheriv('aes-256-gcm', key, iv, { threadpool: 1 });
+}, { code: 'ERR_INVALID_ARG_TYPE' });
+assert.throws(() => {
+  crypto.createCipheriv('aes-256-gcm', key, iv).updateAsync(plaintext);
+}, { code: 'ERR_INVALID_CALLBACK' });
@@ -0,0 +1,141 @@
+'use strict';
+const common = require('../common');
+if (!common.hasCrypto)
+  common.skip('missing crypto');
+
+const assert = require('assert');
+const crypto = require('crypto');
+
+function expected(algorithm, inputs) {
+  return Buffer.concat(inputs.map((input) => {
+    return crypto.createHash(algorithm).update(input).digest();
+  }));
+}
+
+// crypto.hash()
+{
+  for (const algorithm of ['sha1', 'sha256', 'sha512', 'md5']) {
+    for (const input of ['', 'abc', Buffer.alloc(1000, 'x')]) {
+      const hex = crypto.createHash(algorithm).update(input).digest('hex');
+      assert.strictEqual(crypto.hash(algorithm, input), hex);
+      assert.strictEqual(crypto.hash(algorithm, input, 'hex'), hex);
+      assert.deepStrictEqual(crypto.hash(algorithm, input, 'buffer'),
+                             Buffer.from(hex, 'hex'));
+      assert.strictEqual(crypto.hash(algorithm, input, 'base64'),
+                         Buffer.from(hex, 'hex').toString('base64'));
+    }
+  }
+
+  // Strings are hashed as UTF-8.
+  assert.strictEqual(crypto.hash('sha256', 'ü'),
+                     crypto.hash('sha256', Buffer.from('ü', 'utf8')));
+
+  assert.throws(() => crypto.hash('sha256', 123), {
+    code: 'ERR_INVALID_ARG_TYPE'
+  });
+  assert.throws(() => crypto.hash(123, 'abc'), {
+    code: 'ERR_INVALID_ARG_TYPE'
+  });
+  assert.throws(() => crypto.hash('nope', 'abc'), {
+    code: 'ERR_CRYPTO_INVALID_DIGEST'
+  });
+}
+
+const inputs = [
+  '',
+  'a',
+  Buffer.from('hello world'),
+  new Uint8Array(100).fill(7),
+  new DataView(new ArrayBuffer(64)),
+  Buffer.alloc(5000, 'z'),
+];
+
+// crypto.hashBatchSync() with an array of inputs.
+{
+  for (const algorithm of ['sha1', 'sha256', 'sha512']) {
+    assert.deepStrictEqual(crypto.hashBatchSync(algorithm, inputs),
+                           expected(algorithm, inputs));
+  }
+  assert.deepStrictEqual(crypto.hashBatchSync('sha256', []), Buffer.alloc(0));
+}
+
+// crypto.hashBatchSync() with offsets into a single buffer.
+{
+  const data = Buffer.from('the quick brown fox');
+  const offsets = [0, 3, 3, 9, 19];
+  const parts = [];
+  for (let i = 1; i < offsets.length; i++)
+    parts.push(data.subarray(offsets[i - 1], offsets[i]));
+  const want = expected('sha256', parts);
+  assert.deepStrictEqual(
+    crypto.hashBatchSync('sha256', data, { offsets }), want);
+  assert.deepStrictEqual(
+    crypto.hashBatchSync('sha256', data,
+                         { offsets: new Uint32Array(offsets) }), want);
+  // The offsets do not need to start at 0 or cover the whole buffer.
+  assert.deepStrictEqual(
+    crypto.hashBatchSync('sha256', data, { offsets: [4, 9] }),
+    expected('sha256', [data.subarray(4, 9)]));
+  assert.deepStrictEqual(
+    crypto.hashBatchSync('sha256', data, { offsets: [] }), Buffer.alloc(0));
+
+  assert.throws(() => {
+    crypto.hashBatchSync('sha256', data, { offsets: [0, 20] });
+  }, { code: 'ERR_OUT_OF_RANGE' });
+  assert.throws(() => {
+    crypto.hashBatchSync('sha256', data, { offsets: [5, 4] });
+  }, { code: 'ERR_OUT_OF_RANGE' });
+  assert.throws(() => {
+    crypto.hashBatchSync('sha256', data, { offsets: [0, -1] });
+  }, { code: 'ERR_OUT_OF_RANGE' });
+  assert.throws(() => {
+    crypto.hashBatchSync('sha256', data, { offsets: 'abc' });
+  }, { code: 'ERR_INVALID_ARG_TYPE' });
+  assert.throws(() => {
+    crypto.hashBatchSync('sha256', [data], { offsets: [0, 1] });
+  }, { code: 'ERR_INVALID_ARG_TYPE' });
+}
+
+// Invalid arguments.
+{
+  assert.throws(() => crypto.hashBatchSync('sha256', 'abc'), {
+    code: 'ERR_INVALID_ARG_TYPE'
+  });
+  assert.throws(() => crypto.hashBatchSync('sha256', [1, 2]), {
+    code: 'ERR_INVALID_ARG_TYPE'
+  });
+  assert.throws(() => crypto.hashBatchSync('nope', ['abc']), {
+    code: 'ERR_CRYPTO_INVALID_DIGEST'
+  });
+  assert.throws(() => crypto.hashBatch('sha256', ['abc']), {
+    code: 'ERR_INVALID_CALLBACK'
+  });
+}
+
+// crypto.hashBatch()
+{
+  crypto.hashBatch('sha256', inputs, common.mustSucceed((digests) => {
+    assert.deepStrictEqual(digests, expected('sha256', inputs));
+  }));
+
+  const data = Buffer.alloc(1024, 'q');
+  const offsets = [0, 1, 512, 1024];
+  crypto.hashBatch('sha1', data, { offsets }, common.mustSucceed((digests) => {
+    assert.deepStrictEqual(digests, expected('sha1', [
+      data.subarray(0, 1), data.subarray(1, 512), data.subarray(512, 1024),
+    ]));
+  }));
+
+  // The input is copied, so modifying it afterwards has no effect.
+  const mutable = [Buffer.from('abc'), Buffer.from('def')];
+  const want = expected('sha256', mutable);
+  crypto.hashBatch('sha256', mutable, common.mustSucceed((digests) => {
+    assert.deepStrictEqual(digests, want);
+  }));
+  mutable[0].fill(0);
+  mutable[1].fill(0);
+
+  crypto.hashBatch('sha256', [], common.mustSucceed((digests) => {
+    assert.strictEqual(digests.length, 0);
+  }));
+}
@@ -0,0 +1,80 @@
+'use strict';
+const common = require('../common');
+if (!common.hasCrypto)
+  common.skip('missing crypto');
+
+const assert = require('assert');
+const crypto = require('crypto');
+
+// Enough messages of varying lengths to exercise the multi-buffer SHA-256
+// kernel where it is available, including messages whose padding does or
+// does not fit into their last block and lanes that run out of work at
+// different times.
+const messages = [];
+for (let i = 0; i < 200; i++)
+  messages.push(Buffer.alloc(i < 130 ? i : (i * 37) % 5000, i));
+
+function expectedHmac(algorithm, key, inputs) {
+  return Buffer.concat(inputs.map((input) => {
+    return crypto.createHmac(algorithm, key).update(input).digest();
+  }));
+}
+
+function expectedHash(algorithm, inputs) {
+  return Buffer.concat(inputs.map((input) => {
+    return crypto.createHash(algorithm).update(input).digest();
+  }));
+}
+
+for (const algorithm of ['sha256', 'sha1', 'sha512']) {
+  assert.deepStrictEqual(crypto.hashBatchSync(algorithm, messages),
+                         expectedHash(algorithm, messages));
+
+  // Keys that are shorter than, exactly as long as, and longer than a block.
+  for (const length of [0, 1, 32, 64, 65, 200]) {
+    const key = Buffer.alloc(length, 'k');
+    assert.deepStrictEqual(crypto.hmacBatchSync(algorithm, key, messages),
+                           expectedHmac(algorithm, key, messages));
+  }
+}
+
+{
+  const key = 'secret';
+  const keyObject = crypto.createSecretKey(Buffer.from(key));
+  const want = expectedHmac('sha256', key, messages);
+  assert.deepStrictEqual(crypto.hmacBatchSync('sha256', key, messages), want);
+  assert.deepStrictEqual(
+    crypto.hmacBatchSync('sha256', keyObject, messages), want);
+  assert.deepStrictEqual(
+    crypto.hmacBatchSync('sha256', key, ['a', 'b']),
+    expectedHmac('sha256', key, ['a', 'b']));
+
+  const data = Buffer.concat(messages);
+  const offsets = [0];
+  for (const message of messages)
+    offsets.push(offsets[offsets.length - 1] + message.length);
+  assert.deepStrictEqual(
+    crypto.hmacBatchSync('sha256', key, data, { offsets }), want);
+
+  crypto.hmacBatch('sha256', keyObject, messages,
+                   common.mustSucceed((digests) => {
+                     assert.deepStrictEqual(digests, want);
+                   }));
+  crypto.hmacBatch('sha256', key, data, { offsets },
+                   common.mustSucceed((digests) => {
+                     assert.deepStrictEqual(digests, want);
+                   }));
+  crypto.hashBatch('sha256', messages, common.mustSucceed((digests) => {
+    assert.deepStrictEqual(digests, expectedHash('sha256', messages));
+  }));
+}
+
+assert.throws(() => crypto.hmacBatchSync('sha256', 123, ['a']), {
+  code: 'ERR_INVALID_ARG_TYPE'
+});
+assert.throws(() => crypto.hmacBatchSync('nope', 'key', ['a']), {
+  code: 'ERR_CRYPTO_INVALID_DIGEST'
+});
+assert.throws(() => crypto.hmacBatch('sha256', 'key', ['a']), {
+  code: 'ERR_INVALID_CALLBACK'
+});
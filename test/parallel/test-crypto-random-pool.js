@@ -0,0 +1,79 @@
+'use strict';
+// Small random requests are served from a pool of pre-generated bytes. Make
+// sure that the pool hands out fresh bytes to every request and honours
+// offsets and sizes, for both the synchronous and the asynchronous APIs.
+
+const common = require('../common');
+if (!common.hasCrypto)
+  common.skip('missing crypto');
+
+const assert = require('assert');
+const crypto = require('crypto');
+
+function assertUnique(buffers) {
+  const seen = new Set();
+  for (const buf of buffers) {
+    const hex = buf.toString('hex');
+    assert(!seen.has(hex), `duplicate random value ${hex}`);
+    seen.add(hex);
+  }
+}
+
+// Enough requests to exhaust the pool several times, so that it is refilled
+// both synchronously and in the background.
+{
+  const values = [];
+  for (let i = 0; i < 5000; i++) {
+    const buf = crypto.randomBytes(16);
+    assert.strictEqual(buf.length, 16);
+    values.push(buf);
+  }
+  assertUnique(values);
+}
+
+// Requests around the size limit of the pool.
+for (const size of [1, 255, 256, 257, 1024]) {
+  assert.strictEqual(crypto.randomBytes(size).length, size);
+}
+
+// Offsets are relative to the view, not to the underlying ArrayBuffer.
+{
+  const backing = Buffer.alloc(64);
+  const view = backing.subarray(16, 48);
+  crypto.randomFillSync(view, 8, 8);
+  assert(backing.subarray(0, 24).equals(Buffer.alloc(24)));
+  assert(backing.subarray(32).equals(Buffer.alloc(32)));
+  assert(!backing.subarray(24, 32).equals(Buffer.alloc(8)));
+}
+
+{
+  const array = new Uint32Array(8);
+  crypto.randomFillSync(array, 2, 2);
+  assert.deepStrictEqual([...array.subarray(0, 2)], [0, 0]);
+  assert.deepStrictEqual([...array.subarray(4)], [0, 0, 0, 0]);
+}
+
+// The asynchronous APIs are served from the pool as well, but still call
+// back asynchronously.
+{
+  const values = [];
+  let sync = true;
+  const count = 1000;
+  for (let i = 0; i < count; i++) {
+    crypto.randomBytes(16, common.mustSucceed((buf) => {
+      assert.strictEqual(sync, false);
+      assert.strictEqual(buf.length, 16);
+      values.push(buf);
+      if (values.length === count)
+        assertUnique(values);
+    }));
+  }
+
+  const buf = Buffer.alloc(32);
+  crypto.randomFill(buf, 4, 8, common.mustSucceed((result) => {
+    assert.strictEqual(result, buf);
+    assert(buf.subarray(0, 4).equals(Buffer.alloc(4)));
+    assert(buf.subarray(12).equals(Buffer.alloc(20)));
+  }));
+  sync = false;
+}
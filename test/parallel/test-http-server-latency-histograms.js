@@ -0,0 +1,52 @@
+'use strict';
+
+const common = require('../common');
+const assert = require('assert');
+const http = require('http');
+const net = require('net');
+
+// The histograms are only created when enabled.
+assert.strictEqual(net.createServer().latencyHistograms, undefined);
+assert.strictEqual(http.createServer().latencyHistograms, undefined);
+[1, 'true', null].forEach((latencyHistograms) => {
+  assert.throws(() => net.createServer({ latencyHistograms }), {
+    code: 'ERR_INVALID_ARG_TYPE'
+  });
+});
+
+{
+  const server = net.createServer({ latencyHistograms: true });
+  assert.deepStrictEqual(Object.keys(server.latencyHistograms),
+                         ['firstByte']);
+}
+
+const server = http.createServer({ latencyHistograms: true },
+                                 common.mustCall((req, res) => {
+                                   setTimeout(() => res.end('ok'), 10);
+                                 }, 3));
+const { firstByte, request } = server.latencyHistograms;
+assert.deepStrictEqual(Object.keys(server.latencyHistograms),
+                       ['firstByte', 'request']);
+assert.strictEqual(request.max, 0);
+
+server.listen(0, common.mustCall(() => {
+  const agent = new http.Agent({ keepAlive: true, maxSockets: 1 });
+  let pending = 3;
+  for (let i = 0; i < 3; i++) {
+    http.get({ port: server.address().port, agent }, common.mustCall((res) => {
+      res.resume();
+      res.on('end', common.mustCall(() => {
+        if (--pending > 0)
+          return;
+        agent.destroy();
+        server.close(common.mustCall(() => {
+          assert(firstByte.min > 0);
+          // The responses are sent after 10 ms.
+          assert(request.min >= 9e6, `${request.min}`);
+          assert(request.max < 3.6e12);
+          assert.strictEqual(request.exceeds, 0);
+        }));
+      }));
+    }));
+  }
+}));
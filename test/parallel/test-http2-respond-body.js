@@ -0,0 +1,69 @@
+'use strict';
+
+const common = require('../common');
+if (!common.hasCrypto)
+  common.skip('missing crypto');
+const http2 = require('http2');
+const assert = require('assert');
+
+// The body option of respond() is sent as the whole payload.
+
+const body = Buffer.alloc(64 * 1024);
+for (let i = 0; i < body.length; i++)
+  body[i] = i % 251;
+
+const server = http2.createServer();
+server.on('stream', common.mustCall((stream, headers) => {
+  switch (headers[':path']) {
+    case '/invalid':
+      assert.throws(() => stream.respond({}, { body: 'hello' }), {
+        code: 'ERR_INVALID_ARG_TYPE',
+        name: 'TypeError'
+      });
+      stream.respond({ ':status': 404 });
+      stream.end();
+      break;
+    case '/forbidden':
+      assert.throws(() => stream.respond({ ':status': 204 }, { body }), {
+        code: 'ERR_HTTP2_PAYLOAD_FORBIDDEN',
+        name: 'Error'
+      });
+      stream.respond({ ':status': 204 });
+      break;
+    default:
+      stream.on('finish', common.mustCall());
+      stream.respond({ ':status': 200 }, { body, endStream: false });
+      assert.strictEqual(stream.writableEnded, true);
+  }
+}, 3));
+
+server.listen(0, common.mustCall(() => {
+  const client = http2.connect(`http://localhost:${server.address().port}`);
+  let pending = 3;
+  function done() {
+    if (--pending === 0) {
+      client.close();
+      server.close();
+    }
+  }
+
+  const req = client.request();
+  const chunks = [];
+  req.on('response', common.mustCall((headers) => {
+    assert.strictEqual(headers[':status'], 200);
+  }));
+  req.on('data', (chunk) => chunks.push(chunk));
+  req.on('end', common.mustCall(() => {
+    assert.deepStrictEqual(Buffer.concat(chunks), body);
+    done();
+  }));
+
+  for (const [path, status] of [['/invalid', 404], ['/forbidden', 204]]) {
+    const req = client.request({ ':path': path });
+    req.on('response', common.mustCall((headers) => {
+      assert.strictEqual(headers[':status'], status);
+    }));
+    req.resume();
+    req.on('end', common.mustCall(done));
+  }
+}));
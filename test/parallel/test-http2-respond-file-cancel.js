@@ -0,0 +1,72 @@
+// Flags: --expose-gc
+'use strict';
+
+// When a stream is reset in the middle of a file, the file is closed if the
+// stream owns it, and released otherwise.
+
+const common = require('../common');
+if (!common.hasCrypto)
+  common.skip('missing crypto');
+
+const assert = require('assert');
+const async_hooks = require('async_hooks');
+const fs = require('fs');
+const http2 = require('http2');
+const path = require('path');
+const tmpdir = require('../common/tmpdir');
+
+tmpdir.refresh();
+const filename = path.join(tmpdir.path, 'large-file');
+fs.writeFileSync(filename, Buffer.alloc(8 * 1024 * 1024));
+const fd = fs.openSync(filename, 'r');
+
+// The FileHandle of respondWithFile() is closed asynchronously, rather than
+// when it is garbage collected.
+let closeRequests = 0;
+async_hooks.createHook({
+  init(id, type) {
+    if (type === 'FILEHANDLECLOSEREQ')
+      closeRequests++;
+  }
+}).enable();
+process.on('exit', () => {
+  assert.strictEqual(closeRequests, 1);
+});
+
+const server = http2.createServer();
+server.on('stream', common.mustCall((stream, headers) => {
+  if (headers[':path'] === '/file') {
+    stream.respondWithFile(filename);
+  } else {
+    stream.respondWithFD(fd);
+  }
+  stream.on('close', common.mustCall());
+}, 2));
+
+function request(client, url) {
+  return new Promise((resolve) => {
+    const req = client.request({ ':path': url });
+    req.once('data', common.mustCall(() => {
+      req.close(http2.constants.NGHTTP2_CANCEL);
+    }));
+    req.on('close', resolve);
+  });
+}
+
+server.listen(0, common.mustCall(async () => {
+  const client = http2.connect(`http://localhost:${server.address().port}`);
+  await request(client, '/fd');
+  await request(client, '/file');
+  client.close();
+  server.close();
+
+  setTimeout(common.mustCall(() => {
+    // The FileHandle that wrapped `fd` must not close it when it is
+    // garbage collected.
+    global.gc();
+    setImmediate(common.mustCall(() => {
+      assert.strictEqual(fs.fstatSync(fd).size, 8 * 1024 * 1024);
+      fs.closeSync(fd);
+    }));
+  }), 100);
+}));
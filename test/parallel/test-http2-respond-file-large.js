@@ -0,0 +1,52 @@
+'use strict';
+
+// A file that spans many reads and DATA frames arrives intact.
+
+const common = require('../common');
+if (!common.hasCrypto)
+  common.skip('missing crypto');
+
+const assert = require('assert');
+const { createHash } = require('crypto');
+const fs = require('fs');
+const http2 = require('http2');
+const path = require('path');
+const tmpdir = require('../common/tmpdir');
+
+tmpdir.refresh();
+const filename = path.join(tmpdir.path, 'large-file');
+const data = Buffer.alloc(8 * 1024 * 1024);
+for (let i = 0; i < data.length; i++)
+  data[i] = i % 251;
+fs.writeFileSync(filename, data);
+const digest = createHash('sha256').update(data).digest('hex');
+
+const server = http2.createServer();
+server.on('stream', common.mustCall((stream, headers) => {
+  const offset = Number(headers.offset);
+  stream.respondWithFile(filename, {}, { offset });
+}, 2));
+
+server.listen(0, common.mustCall(() => {
+  const client = http2.connect(`http://localhost:${server.address().port}`);
+  let pending = 2;
+  for (const offset of [0, 100000]) {
+    const req = client.request({ offset });
+    const hash = createHash('sha256');
+    let length = 0;
+    req.on('data', (chunk) => {
+      hash.update(chunk);
+      length += chunk.length;
+    });
+    req.on('end', common.mustCall(() => {
+      assert.strictEqual(length, data.length - offset);
+      const expected = offset === 0 ? digest :
+        createHash('sha256').update(data.subarray(offset)).digest('hex');
+      assert.strictEqual(hash.digest('hex'), expected);
+      if (--pending === 0) {
+        client.close();
+        server.close();
+      }
+    }));
+  }
+}));
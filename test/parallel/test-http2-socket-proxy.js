@@ -38,19 +38,12 @@ server.on('stream', common.mustCall(function(stream, headers) {
 
   // The indentation is corrected depending on the depth.
   let inspectedTimeout = util.inspect(session[kTimeout]);
-  assert(inspectedTimeout.includes('  _idlePrev: [TimersList]'));
-  assert(inspectedTimeout.includes('  _idleNext: [TimersList]'));
-  assert(!inspectedTimeout.includes('   _idleNext: [TimersList]'));
+  assert(inspectedTimeout.includes('  _idleTimeout: 987'));
+  assert(!inspectedTimeout.includes('   _idleTimeout: 987'));
 
   inspectedTimeout = util.inspect([ session[kTimeout] ]);
-  assert(inspectedTimeout.includes('    _idlePrev: [TimersList]'));
-  assert(inspectedTimeout.includes('    _idleNext: [TimersList]'));
-  assert(!inspectedTimeout.includes('     _idleNext: [TimersList]'));
-
-  const inspectedTimersList = util.inspect([[ session[kTimeout]._idlePrev ]]);
-  assert(inspectedTimersList.includes('      _idlePrev: [Timeout]'));
-  assert(inspectedTimersList.includes('      _idleNext: [Timeout]'));
-  assert(!inspectedTimersList.includes('       _idleNext: [Timeout]'));
+  assert(inspectedTimeout.includes('    _idleTimeout: 987'));
+  assert(!inspectedTimeout.includes('     _idleTimeout: 987'));
 
   assert.throws(() => socket.destroy, errMsg);
   assert.throws(() => socket.emit, errMsg);
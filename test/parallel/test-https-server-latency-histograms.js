@@ -0,0 +1,44 @@
+'use strict';
+
+const common = require('../common');
+if (!common.hasCrypto)
+  common.skip('missing crypto');
+
+const assert = require('assert');
+const fixtures = require('../common/fixtures');
+const https = require('https');
+const tls = require('tls');
+
+const options = {
+  key: fixtures.readKey('agent1-key.pem'),
+  cert: fixtures.readKey('agent1-cert.pem'),
+  latencyHistograms: true,
+};
+
+{
+  const server = tls.createServer(options);
+  assert.deepStrictEqual(Object.keys(server.latencyHistograms),
+                         ['firstByte', 'handshake']);
+}
+
+const server = https.createServer(options, common.mustCall((req, res) => {
+  res.end('ok');
+}));
+const { firstByte, handshake, request } = server.latencyHistograms;
+
+server.listen(0, common.mustCall(() => {
+  https.get({
+    port: server.address().port,
+    rejectUnauthorized: false,
+  }, common.mustCall((res) => {
+    res.resume();
+    res.on('end', common.mustCall(() => {
+      server.close(common.mustCall(() => {
+        assert(firstByte.min > 0);
+        assert(handshake.min > 0);
+        assert(request.min > 0);
+        assert.strictEqual(handshake.exceeds, 0);
+      }));
+    }));
+  }));
+}));
@@ -3,9 +3,14 @@
 require('../common');
 const fixtures = require('../common/fixtures');
 const { internalBinding } = require('internal/test/binding');
-const { internalModuleReadJSON } = internalBinding('fs');
-const { readFileSync } = require('fs');
-const { strictEqual } = require('assert');
+const {
+  internalModuleReadJSON,
+  internalModuleReadPackageJSON,
+} = internalBinding('fs');
+const { readFileSync, writeFileSync } = require('fs');
+const { deepStrictEqual, strictEqual } = require('assert');
+const path = require('path');
+const tmpdir = require('../common/tmpdir');
 {
   const [string, containsKeys] = internalModuleReadJSON('nosuchfile');
   strictEqual(string, undefined);
@@ -35,3 +40,39 @@ const { strictEqual } = require('assert');
   strictEqual(string, readFileSync(filename, 'utf8'));
   strictEqual(containsKeys, true);
 }
+
+{
+  strictEqual(internalModuleReadPackageJSON('nosuchfile'), undefined);
+  strictEqual(internalModuleReadPackageJSON(fixtures.path()), undefined);
+}
+{
+  const filename = fixtures.path('require-bin/package.json');
+  const { name, main } = JSON.parse(readFileSync(filename, 'utf8'));
+  deepStrictEqual({ ...internalModuleReadPackageJSON(filename) },
+                  { name, main });
+}
+{
+  tmpdir.refresh();
+  const filename = path.join(tmpdir.path, 'package.json');
+  const pkg = {
+    name: 'pkg',
+    version: '1.0.0',
+    exports: { '.': { import: './a.mjs', require: './a.js' }, './b': null },
+    imports: { '#c': './c.js' },
+    dependencies: { [`dep\u{1F600}`]: '^1.0.0' },
+    type: 'module',
+  };
+  writeFileSync(filename, `\uFEFF${JSON.stringify(pkg, null, 2)}`);
+  deepStrictEqual({ ...internalModuleReadPackageJSON(filename) }, {
+    name: pkg.name,
+    exports: pkg.exports,
+    imports: pkg.imports,
+    type: pkg.type,
+  });
+
+  // The source is returned if the file is not valid JSON, so that the module
+  // loaders can report the error.
+  writeFileSync(filename, '{ "main": "index.js", }');
+  deepStrictEqual(internalModuleReadPackageJSON(filename),
+                  ['{ "main": "index.js", }', true]);
+}
@@ -0,0 +1,104 @@
+'use strict';
+
+const common = require('../common');
+const assert = require('assert');
+const { createHistogram } = require('perf_hooks');
+
+{
+  const h = createHistogram();
+  assert.strictEqual(h.min, 9223372036854776000);
+  assert.strictEqual(h.max, 0);
+  assert.strictEqual(h.exceeds, 0);
+
+  h.record(1);
+  [false, '', {}, undefined, null].forEach((i) => {
+    assert.throws(() => h.record(i), {
+      code: 'ERR_INVALID_ARG_TYPE'
+    });
+  });
+  [0, -1, 1.5].forEach((i) => {
+    assert.throws(() => h.record(i), {
+      code: 'ERR_OUT_OF_RANGE'
+    });
+  });
+
+  assert.strictEqual(h.min, 1);
+  assert.strictEqual(h.max, 1);
+  assert.strictEqual(h.percentile(50), 1);
+
+  h.record(100);
+  assert.strictEqual(h.max, 100);
+  assert.strictEqual(h.percentile(100), 100);
+  assert(h.percentiles.size > 0);
+
+  h.reset();
+  assert.strictEqual(h.max, 0);
+}
+
+{
+  const h = createHistogram({ lowest: 1, highest: 1000, figures: 2 });
+  h.record(10);
+  h.record(5000);
+  assert.strictEqual(h.max, 10);
+  assert.strictEqual(h.exceeds, 1);
+
+  // A snapshot is a copy that does not change with the histogram.
+  const snapshot = h.snapshot();
+  h.record(20);
+  assert.strictEqual(snapshot.max, 10);
+  assert.strictEqual(snapshot.exceeds, 1);
+  assert.strictEqual(h.max, 20);
+  assert.strictEqual(typeof snapshot.record, 'undefined');
+
+  // With reset, each snapshot covers the values recorded since the previous
+  // one.
+  const first = h.snapshot({ reset: true });
+  assert.strictEqual(first.min, 10);
+  assert.strictEqual(first.max, 20);
+  assert.strictEqual(first.exceeds, 1);
+  assert.strictEqual(h.max, 0);
+  assert.strictEqual(h.exceeds, 0);
+
+  h.record(30);
+  const second = h.snapshot({ reset: true });
+  assert.strictEqual(second.min, 30);
+  assert.strictEqual(second.max, 30);
+  assert.strictEqual(second.exceeds, 0);
+  assert.strictEqual(first.max, 20);
+
+  [null, 1, 'reset'].forEach((i) => {
+    assert.throws(() => h.snapshot(i), {
+      code: 'ERR_INVALID_ARG_TYPE'
+    });
+  });
+  assert.throws(() => h.snapshot({ reset: 1 }), {
+    code: 'ERR_INVALID_ARG_TYPE'
+  });
+}
+
+{
+  const h = createHistogram();
+  h.recordDelta();
+  setTimeout(common.mustCall(() => {
+    h.recordDelta();
+    assert(h.min > 0);
+    assert(h.max >= h.min);
+  }), 10);
+}
+
+[null, 1, 'options'].forEach((i) => {
+  assert.throws(() => createHistogram(i), {
+    code: 'ERR_INVALID_ARG_TYPE'
+  });
+});
+[
+  { lowest: 0 },
+  { lowest: 1.5 },
+  { lowest: 10, highest: 15 },
+  { figures: 0 },
+  { figures: 6 },
+].forEach((options) => {
+  assert.throws(() => createHistogram(options), {
+    code: 'ERR_OUT_OF_RANGE'
+  });
+});
@@ -3,7 +3,8 @@ const common = require('../common');
 const assert = require('assert');
 
 const expected_keys = ['ares', 'brotli', 'modules', 'node',
-                       'uv', 'v8', 'zlib', 'nghttp2', 'napi', 'llhttp'];
+                       'uv', 'v8', 'zlib', 'zstd', 'nghttp2', 'napi',
+                       'llhttp'];
 
 if (common.hasCrypto) {
   expected_keys.push('openssl');
@@ -34,6 +35,7 @@ assert(commonTemplate.test(process.versions.llhttp));
 assert(commonTemplate.test(process.versions.node));
 assert(commonTemplate.test(process.versions.uv));
 assert(commonTemplate.test(process.versions.zlib));
+assert(commonTemplate.test(process.versions.zstd));
 
 assert(/^\d+\.\d+\.\d+(?:\.\d+)?-node\.\d+(?: \(candidate\))?$/
   .test(process.versions.v8));
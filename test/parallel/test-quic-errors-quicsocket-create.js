@@ -54,6 +54,13 @@ const { createQuicSocket } = require('net');
   });
 });
 
+// Test invalid QuicSocket reusePort argument option
+[1, NaN, 1n, null, {}, []].forEach((reusePort) => {
+  assert.throws(() => createQuicSocket({ endpoint: { reusePort } }), {
+    code: 'ERR_INVALID_ARG_TYPE'
+  });
+});
+
 // Test invalid QuicSocket lookup argument option
 [1, 1n, {}, [], 'test', true].forEach((lookup) => {
   assert.throws(() => createQuicSocket({ lookup }), {
@@ -68,6 +75,13 @@ const { createQuicSocket } = require('net');
   });
 });
 
+// Test invalid QuicSocket trackSendRequests argument option
+[1, NaN, 1n, null, {}, []].forEach((trackSendRequests) => {
+  assert.throws(() => createQuicSocket({ trackSendRequests }), {
+    code: 'ERR_INVALID_ARG_TYPE'
+  });
+});
+
 // Test invalid QuicSocket qlog argument option
 [1, NaN, 1n, null, {}, []].forEach((qlog) => {
   assert.throws(() => createQuicSocket({ qlog }), {
@@ -153,6 +167,33 @@ const { createQuicSocket } = require('net');
   });
 });
 
+// Test invalid QuicSocket serverId option
+[-1, 256, 1.5, NaN].forEach((serverId) => {
+  assert.throws(() => createQuicSocket({ serverId }), {
+    code: 'ERR_OUT_OF_RANGE'
+  });
+});
+
+['test', null, 1n, {}, [], false].forEach((serverId) => {
+  assert.throws(() => createQuicSocket({ serverId }), {
+    code: 'ERR_INVALID_ARG_TYPE'
+  });
+});
+
+// Test invalid QuicSocket retryTokenSecret option
+[1, 'test', {}, [], false].forEach((retryTokenSecret) => {
+  assert.throws(() => createQuicSocket({ retryTokenSecret }), {
+    code: 'ERR_INVALID_ARG_TYPE'
+  });
+});
+
+[Buffer.alloc(0), Buffer.alloc(15), Buffer.alloc(17)].forEach(
+  (retryTokenSecret) => {
+    assert.throws(() => createQuicSocket({ retryTokenSecret }), {
+      code: 'ERR_INVALID_ARG_VALUE'
+    });
+  });
+
 [1, 1n, false, 'test'].forEach((options) => {
   assert.throws(() => createQuicSocket({ endpoint: options }), {
     code: 'ERR_INVALID_ARG_TYPE'
@@ -0,0 +1,59 @@
+// Flags: --no-warnings
+'use strict';
+
+// Sending a file that is much larger than a single read must not wait for
+// each chunk to be acknowledged before the next one is read.
+
+const common = require('../common');
+if (!common.hasCrypto)
+  common.skip('missing crypto');
+if (!common.hasQuic)
+  common.skip('missing quic');
+
+const assert = require('assert');
+const { createHash } = require('crypto');
+const { createQuicSocket } = require('net');
+const fs = require('fs');
+const path = require('path');
+const { key, cert, ca } = require('../common/quic');
+const tmpdir = require('../common/tmpdir');
+
+tmpdir.refresh();
+const filename = path.join(tmpdir.path, 'large-file');
+const data = Buffer.alloc(8 * 1024 * 1024);
+for (let i = 0; i < data.length; i++)
+  data[i] = i % 251;
+fs.writeFileSync(filename, data);
+const digest = createHash('sha256').update(data).digest('hex');
+
+const options = { key, cert, ca, alpn: 'meow' };
+const server = createQuicSocket({ server: options });
+const client = createQuicSocket({ client: options });
+
+(async function() {
+  server.on('session', common.mustCall(async (session) => {
+    const stream = await session.openStream({ halfOpen: true });
+    stream.on('finish', common.mustCall());
+    stream.sendFile(filename);
+  }));
+
+  await server.listen();
+
+  const req = await client.connect({
+    address: 'localhost',
+    port: server.endpoints[0].address.port
+  });
+
+  req.on('stream', common.mustCall(async (stream) => {
+    const hash = createHash('sha256');
+    let length = 0;
+    for await (const chunk of stream) {
+      hash.update(chunk);
+      length += chunk.length;
+    }
+    assert.strictEqual(length, data.length);
+    assert.strictEqual(hash.digest('hex'), digest);
+    client.close();
+    server.close();
+  }));
+})().then(common.mustCall());
@@ -0,0 +1,102 @@
+// Flags: --no-warnings
+'use strict';
+
+// When a QuicSocket that shares a port with others is closed, the kernel
+// moves the last socket of the SO_REUSEPORT group into its place. Packets
+// for the sessions of the remaining sockets must still be steered to the
+// socket that owns them.
+
+const common = require('../common');
+if (!common.hasCrypto)
+  common.skip('missing crypto');
+if (!common.hasQuic)
+  common.skip('missing quic');
+if (!common.isLinux)
+  common.skip('SO_REUSEPORT steering is only supported on Linux');
+
+const assert = require('assert');
+const { randomBytes } = require('crypto');
+const { createQuicSocket } = require('net');
+const { key, cert, ca } = require('../common/quic');
+
+const options = { key, cert, ca, alpn: 'zzz' };
+// The serverIds are not in bind order on purpose.
+const kServerIds = [4, 1, 7];
+const kMaxClients = 64;
+
+const secrets = {
+  statelessResetSecret: randomBytes(16),
+  retryTokenSecret: randomBytes(16),
+};
+
+async function echo(session) {
+  const stream = await session.openStream();
+  const data = randomBytes(1024);
+  stream.end(data);
+  const chunks = [];
+  for await (const chunk of stream)
+    chunks.push(chunk);
+  assert.deepStrictEqual(Buffer.concat(chunks), data);
+}
+
+(async function() {
+  const servers = new Map();
+  // Maps the port of each client to the serverId of its session.
+  const serverIdOf = new Map();
+  let port = 0;
+  for (const serverId of kServerIds) {
+    const server = createQuicSocket({
+      endpoint: { port, reusePort: true },
+      server: options,
+      serverId,
+      ...secrets,
+    });
+    server.on('session', common.mustCallAtLeast((session) => {
+      serverIdOf.set(session.remoteAddress.port, serverId);
+      session.on('stream', async (stream) => {
+        const chunks = [];
+        for await (const chunk of stream)
+          chunks.push(chunk);
+        stream.end(Buffer.concat(chunks));
+      });
+    }, 0));
+    await server.listen();
+    port = server.endpoints[0].address.port;
+    servers.set(serverId, server);
+  }
+
+  // Connect until every socket has a session, in particular the last one,
+  // which is the socket the kernel moves.
+  const clients = [];
+  for (let i = 0; i < kMaxClients; i++) {
+    const client = createQuicSocket({ client: options });
+    const session = await client.connect({ address: 'localhost', port });
+    await echo(session);
+    clients.push({ client, session });
+    if (new Set(serverIdOf.values()).size === kServerIds.length)
+      break;
+  }
+  assert.strictEqual(new Set(serverIdOf.values()).size, kServerIds.length);
+
+  // Close the first socket that was bound, so that it is not the last
+  // member of the group.
+  const [closedId] = kServerIds;
+  servers.get(closedId).destroy();
+  await new Promise((resolve) => servers.get(closedId).once('close', resolve));
+
+  for (const { client, session } of clients) {
+    if (serverIdOf.get(client.endpoints[0].address.port) === closedId) {
+      client.destroy();
+      continue;
+    }
+    await echo(session);
+    await session.close();
+    await client.close();
+  }
+
+  for (const serverId of kServerIds.slice(1)) {
+    const server = servers.get(serverId);
+    assert.strictEqual(server.packetsMisrouted, 0);
+    await server.close();
+  }
+})().then(common.mustCall());
@@ -0,0 +1,81 @@
+// Flags: --no-warnings
+'use strict';
+
+// Several QuicSockets can share a UDP port when they are bound with the
+// reusePort option. Connection IDs issued by their sessions start with the
+// serverId of the socket, which steers packets to the socket that owns the
+// connection.
+
+const common = require('../common');
+if (!common.hasCrypto)
+  common.skip('missing crypto');
+if (!common.hasQuic)
+  common.skip('missing quic');
+if (!common.isLinux)
+  common.skip('SO_REUSEPORT steering is only supported on Linux');
+
+const assert = require('assert');
+const { randomBytes } = require('crypto');
+const { createQuicSocket } = require('net');
+const { key, cert, ca } = require('../common/quic');
+
+const options = { key, cert, ca, alpn: 'zzz' };
+const kServers = 2;
+const kClients = 8;
+
+const secrets = {
+  statelessResetSecret: randomBytes(16),
+  retryTokenSecret: randomBytes(16),
+};
+
+(async function() {
+  const servers = [];
+  let port = 0;
+  for (let serverId = 0; serverId < kServers; serverId++) {
+    const server = createQuicSocket({
+      endpoint: { port, reusePort: true },
+      server: options,
+      serverId,
+      ...secrets,
+    });
+    server.on('session', common.mustCallAtLeast((session) => {
+      session.on('stream', common.mustCall(async (stream) => {
+        const chunks = [];
+        for await (const chunk of stream)
+          chunks.push(chunk);
+        stream.end(Buffer.concat(chunks));
+      }));
+    }, 0));
+    await server.listen();
+    port = server.endpoints[0].address.port;
+    servers.push(server);
+  }
+  assert.strictEqual(servers[1].endpoints[0].address.port, port);
+
+  const clients = [];
+  await Promise.all(Array.from({ length: kClients }, async (_, i) => {
+    const client = createQuicSocket({ client: options });
+    clients.push(client);
+    const req = await client.connect({ address: 'localhost', port });
+    const stream = await req.openStream();
+    const data = randomBytes(64 * 1024);
+    stream.end(data);
+    const chunks = [];
+    for await (const chunk of stream)
+      chunks.push(chunk);
+    assert.deepStrictEqual(Buffer.concat(chunks), data);
+    await req.close();
+  }));
+
+  let sessions = 0;
+  for (const server of servers) {
+    assert.strictEqual(server.packetsMisrouted, 0);
+    sessions += server.serverSessions;
+  }
+  assert.strictEqual(sessions, kClients);
+
+  for (const client of clients)
+    client.close();
+  for (const server of servers)
+    server.close();
+})().then(common.mustCall());
@@ -0,0 +1,60 @@
+// Flags: --no-warnings
+'use strict';
+
+// Bulk data that a QuicSession sends back-to-back is grouped into packet
+// trains, which may be sent with fewer system calls than packets. Make sure
+// that the data arrives intact, and that the statistics add up.
+
+const common = require('../common');
+if (!common.hasCrypto)
+  common.skip('missing crypto');
+if (!common.hasQuic)
+  common.skip('missing quic');
+
+const assert = require('assert');
+const { createHash } = require('crypto');
+const { createQuicSocket } = require('net');
+const { key, cert, ca } = require('../common/quic');
+
+const options = { key, cert, ca, alpn: 'zzz' };
+
+const client = createQuicSocket({ client: options });
+const server = createQuicSocket({ server: options });
+
+const data = Buffer.alloc(4 * 1024 * 1024);
+for (let i = 0; i < data.length; i++)
+  data[i] = i % 253;
+const digest = createHash('sha256').update(data).digest('hex');
+
+(async function() {
+  server.on('session', common.mustCall((session) => {
+    session.on('stream', common.mustCall(async (stream) => {
+      const hash = createHash('sha256');
+      for await (const chunk of stream)
+        hash.update(chunk);
+      assert.strictEqual(hash.digest('hex'), digest);
+      stream.end();
+    }));
+  }));
+
+  await server.listen();
+
+  const req = await client.connect({
+    address: 'localhost',
+    port: server.endpoints[0].address.port
+  });
+
+  const stream = await req.openStream();
+  stream.resume();
+  stream.end(data);
+  stream.on('close', common.mustCall(async () => {
+    assert(client.sendCalls > 0);
+    assert(client.sendCalls <= client.packetsSent);
+    assert(server.sendCalls > 0);
+    assert(server.sendCalls <= server.packetsSent);
+    assert(server.packetsReceived > 0);
+    await req.close();
+    client.close();
+    server.close();
+  }));
+})().then(common.mustCall());
@@ -0,0 +1,67 @@
+// Flags: --no-warnings
+'use strict';
+
+// By default, a QuicSocket sends packets using recycled native requests
+// that are not visible to async_hooks. The trackSendRequests option brings
+// back one SendWrap per packet, for diagnostics.
+
+const common = require('../common');
+if (!common.hasQuic)
+  common.skip('missing quic');
+
+const assert = require('assert');
+const async_hooks = require('async_hooks');
+const { createQuicSocket } = require('net');
+const { key, cert, ca } = require('../common/quic');
+
+const options = { key, cert, ca, alpn: 'zzz' };
+const data = Buffer.alloc(256 * 1024, 'x');
+
+let sendWraps = 0;
+async_hooks.createHook({
+  init(id, type, triggerAsyncId, resource) {
+    if (type === 'QUICSOCKET' && resource.constructor.name === 'SendWrap')
+      sendWraps++;
+  }
+}).enable();
+
+async function transfer(trackSendRequests) {
+  const client = createQuicSocket({ client: options, trackSendRequests });
+  const server = createQuicSocket({ server: options, trackSendRequests });
+
+  server.on('session', common.mustCall((session) => {
+    session.on('stream', common.mustCall(async (stream) => {
+      let received = 0;
+      for await (const chunk of stream)
+        received += chunk.length;
+      assert.strictEqual(received, data.length);
+      stream.end();
+    }));
+  }));
+
+  await server.listen();
+
+  const req = await client.connect({
+    address: 'localhost',
+    port: server.endpoints[0].address.port
+  });
+
+  const stream = await req.openStream();
+  stream.resume();
+  stream.end(data);
+  await new Promise((resolve) => stream.on('close', resolve));
+  await req.close();
+  const packetsSent = client.packetsSent + server.packetsSent;
+  client.close();
+  server.close();
+  return packetsSent;
+}
+
+(async function() {
+  await transfer(false);
+  assert.strictEqual(sendWraps, 0);
+
+  const packetsSent = await transfer(true);
+  assert(sendWraps > 0);
+  assert(sendWraps <= packetsSent);
+})().then(common.mustCall());
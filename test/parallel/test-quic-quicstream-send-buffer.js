@@ -0,0 +1,53 @@
+// Flags: --no-warnings
+'use strict';
+
+// A buffer passed to sendBuffer() is sent after everything that was
+// written before it, and ends the stream.
+
+const common = require('../common');
+if (!common.hasCrypto)
+  common.skip('missing crypto');
+if (!common.hasQuic)
+  common.skip('missing quic');
+
+const assert = require('assert');
+const { createQuicSocket } = require('net');
+const { key, cert, ca } = require('../common/quic');
+
+const head = Buffer.from('head:');
+const body = Buffer.alloc(256 * 1024);
+for (let i = 0; i < body.length; i++)
+  body[i] = i % 251;
+
+const options = { key, cert, ca, alpn: 'meow' };
+const server = createQuicSocket({ server: options });
+const client = createQuicSocket({ client: options });
+
+(async function() {
+  server.on('session', common.mustCall(async (session) => {
+    const stream = await session.openStream({ halfOpen: true });
+    stream.on('finish', common.mustCall());
+    stream.write(head);
+    stream.sendBuffer(body);
+    assert.throws(() => stream.sendBuffer(body), {
+      code: 'ERR_INVALID_STATE'
+    });
+  }));
+
+  await server.listen();
+
+  const req = await client.connect({
+    address: 'localhost',
+    port: server.endpoints[0].address.port
+  });
+
+  req.on('stream', common.mustCall(async (stream) => {
+    const chunks = [];
+    for await (const chunk of stream)
+      chunks.push(chunk);
+    assert.deepStrictEqual(Buffer.concat(chunks),
+                           Buffer.concat([head, body]));
+    client.close();
+    server.close();
+  }));
+})().then(common.mustCall());
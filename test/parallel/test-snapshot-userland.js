@@ -0,0 +1,74 @@
+'use strict';
+
+// This tests that a user-land snapshot can be built from an entry point and
+// that the state of the application is restored when starting from it.
+
+require('../common');
+const assert = require('assert');
+const { spawnSync } = require('child_process');
+const path = require('path');
+const fs = require('fs');
+const v8 = require('v8');
+const tmpdir = require('../common/tmpdir');
+const fixtures = require('../common/fixtures');
+
+tmpdir.refresh();
+const blobPath = path.join(tmpdir.path, 'snapshot.blob');
+
+{
+  const child = spawnSync(process.execPath, [
+    '--snapshot-blob',
+    blobPath,
+    '--build-snapshot',
+    fixtures.path('snapshot', 'entry.js'),
+  ], { cwd: tmpdir.path });
+  assert.strictEqual(child.status, 0, child.stderr.toString());
+  assert(fs.statSync(blobPath).size > 0);
+}
+
+{
+  const child = spawnSync(process.execPath, [
+    '--snapshot-blob',
+    blobPath,
+    'foo',
+  ], { cwd: tmpdir.path });
+  assert.strictEqual(child.status, 0, child.stderr.toString());
+  assert.deepStrictEqual(JSON.parse(child.stdout.toString()), {
+    fromTimer: 2,
+    text: 'text from the snapshot\n',
+    deserialized: true,
+    count: 3,
+    data: 'hello',
+    argv: ['foo']
+  });
+}
+
+{
+  // --build-snapshot needs an entry point.
+  const child = spawnSync(process.execPath, ['--build-snapshot'], {
+    cwd: tmpdir.path
+  });
+  assert.strictEqual(child.status, 9);
+  assert.match(child.stderr.toString(), /--build-snapshot must be used with/);
+}
+
+{
+  // Files that are not snapshot blobs are rejected.
+  const child = spawnSync(process.execPath, [
+    '--snapshot-blob',
+    fixtures.path('snapshot', 'data.txt'),
+  ], { cwd: tmpdir.path });
+  assert.strictEqual(child.status, 1);
+  assert.match(child.stderr.toString(), /not a snapshot blob/);
+}
+
+// The hooks can only be added while building a snapshot.
+assert.strictEqual(v8.startupSnapshot.isBuildingSnapshot(), false);
+for (const method of ['addSerializeCallback',
+                      'addDeserializeCallback',
+                      'setDeserializeMainFunction',
+                      'addContextTemplate']) {
+  assert.throws(() => v8.startupSnapshot[method](() => {}), {
+    code: 'ERR_NOT_BUILDING_SNAPSHOT'
+  });
+}
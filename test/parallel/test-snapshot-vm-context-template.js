@@ -0,0 +1,48 @@
+'use strict';
+
+// Tests that vm contexts can be deserialized from context templates, whose
+// setup code has been run while building a user-land snapshot.
+
+require('../common');
+const assert = require('assert');
+const { spawnSync } = require('child_process');
+const path = require('path');
+const vm = require('vm');
+const tmpdir = require('../common/tmpdir');
+const fixtures = require('../common/fixtures');
+
+tmpdir.refresh();
+const blobPath = path.join(tmpdir.path, 'snapshot.blob');
+
+{
+  const child = spawnSync(process.execPath, [
+    '--snapshot-blob',
+    blobPath,
+    '--build-snapshot',
+    fixtures.path('snapshot', 'vm-context-template.js'),
+  ], { cwd: tmpdir.path });
+  assert.strictEqual(child.status, 0, child.stderr.toString());
+}
+
+{
+  const child = spawnSync(process.execPath, ['--snapshot-blob', blobPath], {
+    cwd: tmpdir.path
+  });
+  assert.strictEqual(child.status, 0, child.stderr.toString());
+  // Each context starts from the state the setup code left behind.
+  assert.deepStrictEqual(JSON.parse(child.stdout.toString()), [
+    [1, 4, 1],
+    [4, 5, 1],
+    'undefined',
+    'ERR_INVALID_ARG_VALUE',
+    'ERR_INVALID_ARG_VALUE',
+  ]);
+}
+
+// Without a user-land snapshot, there are no context templates.
+assert.throws(() => vm.createContext({}, { contextTemplate: 'math' }), {
+  code: 'ERR_INVALID_ARG_VALUE'
+});
+assert.throws(() => vm.createContext({}, { contextTemplate: 1 }), {
+  code: 'ERR_INVALID_ARG_TYPE'
+});
@@ -0,0 +1,65 @@
+'use strict';
+
+// Timers that expire at the same time are run as a batch. Checks that the
+// timers of a batch can be cleared or rescheduled by the ones that run before
+// them, and that an exception thrown by one of them does not prevent the rest
+// of the batch from running.
+
+const common = require('../common');
+const assert = require('assert');
+
+// Timers that expire at the same time run in the order in which they were
+// scheduled, including those that have been rescheduled.
+{
+  const order = [];
+  const first = setTimeout(() => order.push('first'), 10);
+  setTimeout(() => order.push('second'), 10);
+  first.refresh();
+  setTimeout(common.mustCall(() => {
+    assert.deepStrictEqual(order, ['second', 'first']);
+  }), 10);
+}
+
+// A timer that is cleared by an earlier one does not run.
+{
+  setTimeout(common.mustCall(() => clearTimeout(second)), 1);
+  const second = setTimeout(common.mustNotCall(), 1);
+}
+
+// A timer that is rescheduled by an earlier one runs in a later iteration of
+// the event loop.
+{
+  let ranSecond = false;
+  setTimeout(common.mustCall(() => {
+    second.refresh();
+    setImmediate(common.mustCall(() => assert(!ranSecond)));
+  }), 1);
+  const second = setTimeout(common.mustCall(() => {
+    ranSecond = true;
+  }), 1);
+}
+
+// The timers of the batch that follow a timer that throws still run.
+{
+  const error = new Error('boom');
+  process.once('uncaughtException', common.mustCall((err) => {
+    assert.strictEqual(err, error);
+  }));
+  const order = [];
+  setTimeout(() => {
+    order.push('first');
+    throw error;
+  }, 20);
+  setTimeout(() => order.push('second'), 20);
+  setTimeout(common.mustCall(() => {
+    assert.deepStrictEqual(order, ['first', 'second']);
+  }), 20);
+}
+
+// Timers that are longer than the lower levels of the timer wheel.
+{
+  const start = Date.now();
+  setTimeout(common.mustCall(() => {
+    assert(Date.now() - start >= 299);
+  }), 300);
+}
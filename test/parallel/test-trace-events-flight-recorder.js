@@ -0,0 +1,87 @@
+'use strict';
+
+// Tests that --trace-event-flight-recorder keeps the most recent trace
+// events in memory, and that they are written on demand.
+
+const common = require('../common');
+
+try {
+  require('trace_events');
+} catch {
+  common.skip('missing trace events');
+}
+
+common.skipIfWorker(); // https://github.com/nodejs/node/issues/22767
+
+const assert = require('assert');
+const cp = require('child_process');
+const fs = require('fs');
+const path = require('path');
+const { dumpFlightRecorder } = require('trace_events');
+const tmpdir = require('../common/tmpdir');
+
+assert.throws(() => dumpFlightRecorder(), {
+  code: 'ERR_TRACE_EVENTS_FLIGHT_RECORDER_DISABLED'
+});
+[1, true, null].forEach((filename) => {
+  assert.throws(() => dumpFlightRecorder(filename), {
+    code: 'ERR_INVALID_ARG_TYPE'
+  });
+});
+assert.throws(() => dumpFlightRecorder('file', { duration: -1 }), {
+  code: 'ERR_OUT_OF_RANGE'
+});
+
+tmpdir.refresh();
+
+const CODE = `
+  const { performance } = require('perf_hooks');
+  const { dumpFlightRecorder } = require('trace_events');
+  performance.mark('first');
+  // More events than the flight recorder can hold.
+  for (let i = 0; i < 70000; i++)
+    performance.mark('filler');
+  performance.mark('last');
+  console.log(dumpFlightRecorder('all.log'));
+  console.log(dumpFlightRecorder({ duration: 60 * 1000 }));
+  process.report.directory = 'reports';
+  process.report.writeReport();
+`;
+
+fs.mkdirSync(path.join(tmpdir.path, 'reports'));
+const proc = cp.spawnSync(process.execPath,
+                          [ '--trace-event-categories',
+                            'node.perf.usertiming',
+                            '--trace-event-flight-recorder',
+                            '-e', CODE ],
+                          { cwd: tmpdir.path, encoding: 'utf8' });
+assert.strictEqual(proc.status, 0, proc.stderr);
+
+const [all, generated] = proc.stdout.trim().split('\n');
+assert.strictEqual(all, 'all.log');
+assert.match(generated, /^trace\.\d+\.\d+\.\d+\.\d+\.\d+\.log$/);
+
+// Nothing is written to the default trace file.
+assert(!fs.existsSync(path.join(tmpdir.path, 'node_trace.1.log')));
+
+function readNames(file) {
+  const { traceEvents } = JSON.parse(fs.readFileSync(file, 'utf8'));
+  return traceEvents.map((event) => event.name);
+}
+
+for (const file of [all, generated]) {
+  const names = readNames(path.join(tmpdir.path, file));
+  // The oldest events have been overwritten.
+  assert(!names.includes('first'));
+  assert(names.includes('filler'));
+  assert(names.includes('last'));
+  assert(names.includes('thread_name'));
+}
+
+// Writing a diagnostic report also writes the trace events.
+const reports = fs.readdirSync(path.join(tmpdir.path, 'reports'));
+const traceFile = reports.find((file) => file.startsWith('trace.'));
+assert(traceFile);
+assert(reports.some((file) => file.startsWith('report.')));
+assert(readNames(path.join(tmpdir.path, 'reports', traceFile))
+  .includes('last'));
@@ -0,0 +1,55 @@
+'use strict';
+
+// Tests that the node.loop category records the phases of the event loop.
+
+const common = require('../common');
+const assert = require('assert');
+const cp = require('child_process');
+const fs = require('fs');
+const path = require('path');
+
+const CODE = `
+  setTimeout(() => {
+    Promise.resolve().then(() => {});
+    require('fs').readFile(__filename, () => {
+      setImmediate(() => {});
+    });
+  }, 1);
+`;
+
+const tmpdir = require('../common/tmpdir');
+tmpdir.refresh();
+const FILE_NAME = path.join(tmpdir.path, 'node_trace.1.log');
+
+const proc = cp.spawn(process.execPath,
+                      [ '--trace-event-categories', 'node.loop',
+                        '-e', CODE ],
+                      { cwd: tmpdir.path });
+proc.once('exit', common.mustCall((code) => {
+  assert.strictEqual(code, 0);
+  const traces = JSON.parse(fs.readFileSync(FILE_NAME, 'utf8')).traceEvents
+    .filter((trace) => trace.cat === 'node,node.loop');
+
+  function find(name, ph) {
+    return traces.filter((trace) => trace.name === name && trace.ph === ph);
+  }
+
+  for (const phase of ['Timers', 'Pending', 'Poll', 'Check', 'Close']) {
+    assert(find(phase, 'B').length > 0, `no ${phase} phase`);
+  }
+  for (const phase of ['Timers', 'Poll', 'Check']) {
+    const ends = find(phase, 'E');
+    assert(ends.length > 0, `no end of ${phase} phase`);
+    for (const end of ends)
+      assert.strictEqual(typeof end.args.callbacks, 'number');
+    // The timer, the file system callbacks and the immediate.
+    assert(ends.some((end) => end.args.callbacks > 0),
+           `no callbacks in ${phase} phase`);
+  }
+
+  assert(find('InternalCallbackScope', 'B').length > 0);
+  assert(find('InternalCallbackScope', 'E').length > 0);
+  assert(find('PerformCheckpoint', 'X').length > 0);
+  assert(find('RunAndClearNativeImmediates', 'E').every(
+    (trace) => typeof trace.args.count === 'number'));
+}));
@@ -0,0 +1,141 @@
+'use strict';
+
+// Tests that --trace-event-format=proto writes the trace events as a
+// sequence of Perfetto TracePackets.
+
+require('../common');
+const assert = require('assert');
+const cp = require('child_process');
+const fs = require('fs');
+const path = require('path');
+
+const CODE = `
+  const { performance } = require('perf_hooks');
+  for (let i = 0; i < 3; i++) {
+    performance.mark('A');
+    performance.mark('B');
+    performance.measure('A to B', 'A', 'B');
+  }
+`;
+
+const tmpdir = require('../common/tmpdir');
+tmpdir.refresh();
+const FILE_NAME = path.join(tmpdir.path, 'node_trace.1.log');
+
+// Returns the fields of a protobuf message as [field, value] pairs, where
+// value is a BigInt for varints and fixed64 values, and a Buffer for the
+// length-delimited ones.
+function decode(buffer) {
+  const fields = [];
+  let offset = 0;
+  function readVarInt() {
+    let value = 0n;
+    let shift = 0n;
+    let byte;
+    do {
+      byte = buffer[offset++];
+      value |= BigInt(byte & 0x7f) << shift;
+      shift += 7n;
+    } while (byte & 0x80);
+    return value;
+  }
+  while (offset < buffer.length) {
+    const tag = Number(readVarInt());
+    const field = tag >> 3;
+    switch (tag & 7) {
+      case 0:
+        fields.push([field, readVarInt()]);
+        break;
+      case 1:
+        fields.push([field, buffer.readBigUInt64LE(offset)]);
+        offset += 8;
+        break;
+      case 2: {
+        const length = Number(readVarInt());
+        fields.push([field, buffer.subarray(offset, offset + length)]);
+        offset += length;
+        break;
+      }
+      default:
+        assert.fail(`unexpected wire type in tag ${tag}`);
+    }
+  }
+  assert.strictEqual(offset, buffer.length);
+  return fields;
+}
+
+function get(fields, field) {
+  const entry = fields.find(([f]) => f === field);
+  return entry && entry[1];
+}
+
+function getAll(fields, field) {
+  return fields.filter(([f]) => f === field).map(([, value]) => value);
+}
+
+{
+  const proc = cp.spawnSync(process.execPath,
+                            [ '--trace-event-categories',
+                              'node.perf.usertiming',
+                              '--trace-event-format', 'proto',
+                              '-e', CODE ],
+                            { cwd: tmpdir.path });
+  assert.strictEqual(proc.status, 0, proc.stderr.toString());
+
+  const packets = getAll(decode(fs.readFileSync(FILE_NAME)), 1).map(decode);
+  assert(packets.length > 0);
+
+  // The first packet defines the clocks of the sequence.
+  const first = packets[0];
+  assert.strictEqual(get(first, 13), 1n);
+  const clocks = getAll(decode(get(first, 6)), 1).map(decode);
+  assert.deepStrictEqual(clocks.map((clock) => get(clock, 1)), [3n, 64n]);
+
+  const names = new Map();
+  const threadNames = [];
+  let markCount = 0;
+  let timestamp = get(clocks[1], 2);
+  for (const packet of packets.slice(1)) {
+    assert.strictEqual(get(packet, 10), 1n);
+    const descriptor = get(packet, 60);
+    if (descriptor) {
+      const thread = get(decode(descriptor), 4);
+      const name = thread && get(decode(thread), 5);
+      if (name) threadNames.push(name.toString());
+      continue;
+    }
+
+    assert.strictEqual(get(packet, 13), 2n);
+    const interned = get(packet, 12);
+    if (interned) {
+      for (const entry of getAll(decode(interned), 2).map(decode)) {
+        const iid = get(entry, 1);
+        // Each name is only written once.
+        assert(!names.has(iid));
+        names.set(iid, get(entry, 2).toString());
+      }
+    }
+
+    // Timestamps are deltas on the incremental clock, unless the packet
+    // specifies another clock.
+    if (get(packet, 58) === undefined) {
+      timestamp += get(packet, 8);
+    }
+
+    const event = decode(get(packet, 11));
+    assert(get(event, 11) > 0n);
+    if (names.get(get(event, 10)) === 'A') markCount++;
+  }
+
+  assert.strictEqual(markCount, 3);
+  assert(timestamp > 0n);
+  assert(threadNames.includes('JavaScriptMainThread'));
+}
+
+{
+  const proc = cp.spawnSync(process.execPath,
+                            [ '--trace-event-format', 'xml', '-e', '' ]);
+  assert.notStrictEqual(proc.status, 0);
+  assert.match(proc.stderr.toString(),
+               /--trace-event-format must be "json" or "proto"/);
+}
@@ -0,0 +1,72 @@
+'use strict';
+
+// Tests the continuous CPU profiler, and that the samples taken in the
+// callbacks of an AsyncWrap are labelled with its provider type.
+
+const common = require('../common');
+const { parsePprof } = require('../common/cpu-prof');
+const assert = require('assert');
+const net = require('net');
+const {
+  getContinuousCpuProfile,
+  startContinuousCpuProfiler,
+  stopContinuousCpuProfiler,
+} = require('v8');
+
+assert.throws(() => getContinuousCpuProfile(), {
+  code: 'ERR_INVALID_STATE',
+});
+for (const frequency of [0, 1001, 1.5]) {
+  assert.throws(() => startContinuousCpuProfiler({ frequency }), {
+    code: 'ERR_OUT_OF_RANGE',
+  });
+}
+assert.throws(() => startContinuousCpuProfiler({ windowDuration: '1' }), {
+  code: 'ERR_INVALID_ARG_TYPE',
+});
+
+startContinuousCpuProfiler({ frequency: 1000, windowDuration: 50 });
+assert.throws(() => startContinuousCpuProfiler(), {
+  code: 'ERR_INVALID_STATE',
+});
+
+function spinInConnectionListener() {
+  const start = Date.now();
+  while (Date.now() - start < 300);
+}
+
+const server = net.createServer(common.mustCall((socket) => {
+  spinInConnectionListener();
+  socket.destroy();
+  server.close();
+  // Let a few windows end before the profile is exported.
+  setTimeout(common.mustCall(check), 200);
+}));
+server.listen(0, () => {
+  net.connect(server.address().port).on('error', () => {});
+});
+
+function check() {
+  const { sampleTypes, samples } = parsePprof(getContinuousCpuProfile());
+  assert.deepStrictEqual(sampleTypes, ['samples', 'cpu']);
+
+  const spinning = samples.filter(({ stack }) => {
+    return stack.some(({ name }) => name === 'spinInConnectionListener');
+  });
+  assert(spinning.some(({ labels }) => {
+    return labels.async_resource === 'TCPSERVERWRAP';
+  }));
+  for (const { stack, values } of spinning) {
+    assert.match(stack.find(({ name }) => {
+      return name === 'spinInConnectionListener';
+    }).filename, /test-v8-continuous-cpu-profiler\.js$/);
+    // 1000 Hz, 1ms per sample.
+    assert.strictEqual(values[1], values[0] * 1e6);
+  }
+
+  stopContinuousCpuProfiler();
+  stopContinuousCpuProfiler();
+  assert.throws(() => getContinuousCpuProfile(), {
+    code: 'ERR_INVALID_STATE',
+  });
+}
@@ -0,0 +1,65 @@
+'use strict';
+
+// Tests that the contexts of the vm module, which are deserialized from the
+// snapshot when Node.js is started from one, behave like the ones created
+// from scratch.
+
+require('../common');
+const assert = require('assert');
+const { spawnSync } = require('child_process');
+const fs = require('fs');
+const path = require('path');
+const tmpdir = require('../common/tmpdir');
+
+tmpdir.refresh();
+const blobPath = path.join(tmpdir.path, 'snapshot.blob');
+const entry = path.join(tmpdir.path, 'entry.js');
+
+function check() {
+  const vm = require('vm');
+  const results = [];
+  for (let i = 0; i < 3; i++) {
+    const sandbox = { i, list: [] };
+    const context = vm.createContext(sandbox, { name: `context ${i}` });
+    vm.runInContext(`
+      var declared = i * 2;
+      assigned = typeof Array;
+      list.push(this.i, 1 in [0, 1]);
+      Object.defineProperty(globalThis, 'defined', {
+        value: i,
+        enumerable: true
+      });
+    `, context);
+    assert.strictEqual(vm.runInContext('i + declared', context), i * 3);
+    assert.notStrictEqual(vm.runInContext('Array', context), Array);
+    results.push({ ...sandbox });
+  }
+  return results;
+}
+
+fs.writeFileSync(entry, `
+const v8 = require('v8');
+v8.startupSnapshot.setDeserializeMainFunction(() => {
+  const assert = require('assert');
+  console.log(JSON.stringify((${check})()));
+});
+`);
+
+{
+  const child = spawnSync(process.execPath, [
+    '--snapshot-blob',
+    blobPath,
+    '--build-snapshot',
+    entry,
+  ], { cwd: tmpdir.path });
+  assert.strictEqual(child.status, 0, child.stderr.toString());
+}
+
+{
+  const child = spawnSync(process.execPath, ['--snapshot-blob', blobPath], {
+    cwd: tmpdir.path
+  });
+  assert.strictEqual(child.status, 0, child.stderr.toString());
+  assert.strictEqual(child.stdout.toString().trim(),
+                     JSON.stringify(check()));
+}
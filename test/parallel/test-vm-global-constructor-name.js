@@ -0,0 +1,19 @@
+// Flags: --expose-internals
+'use strict';
+
+// The global objects of all the vm contexts are made from the same template,
+// so they no longer take the constructor name of their sandbox object.
+
+require('../common');
+const assert = require('assert');
+const vm = require('vm');
+const { internalBinding } = require('internal/test/binding');
+const { getConstructorName } = internalBinding('util');
+
+class Sandbox {}
+
+const plainGlobal = vm.runInContext('this', vm.createContext({}));
+const sandboxGlobal = vm.runInContext('this', vm.createContext(new Sandbox()));
+assert.notStrictEqual(getConstructorName(sandboxGlobal), 'Sandbox');
+assert.strictEqual(getConstructorName(sandboxGlobal),
+                   getConstructorName(plainGlobal));
@@ -0,0 +1,67 @@
+'use strict';
+
+// Tests that --max-idle-worker-isolates keeps the isolates of stopped
+// Workers, and that they are only reused by Workers with the same resource
+// limits.
+
+const common = require('../common');
+const assert = require('assert');
+const { spawnSync } = require('child_process');
+const { Worker } = require('worker_threads');
+
+if (process.argv[2] === 'child') {
+  const code = `
+    const { parentPort } = require('worker_threads');
+    const { performance } = require('perf_hooks');
+    // Let the event loop be idle for a while, so that a Worker that reuses
+    // the loop would see this idle time if it was not reset.
+    setTimeout(() => {
+      parentPort.postMessage({
+        leaked: typeof globalThis.leaked,
+        elu: performance.eventLoopUtilization(),
+      });
+      globalThis.leaked = true;
+    }, 50);
+  `;
+  const limits = [undefined, undefined, { maxOldGenerationSizeMb: 64 }];
+  (async function() {
+    for (const resourceLimits of limits) {
+      const worker = new Worker(code, { eval: true, resourceLimits });
+      const [message] = await Promise.all([
+        new Promise((resolve) => worker.once('message', resolve)),
+        new Promise((resolve) => worker.once('exit', resolve)),
+      ]);
+      // Nothing is shared with the previous Worker.
+      assert.strictEqual(message.leaked, 'undefined');
+      const { idle, active, utilization } = message.elu;
+      assert(idle >= 0, `idle: ${idle}`);
+      assert(active >= 0, `active: ${active}`);
+      assert(utilization >= 0 && utilization <= 1,
+             `utilization: ${utilization}`);
+    }
+    // A terminated Worker leaves its isolate behind too, for the next one.
+    const worker = new Worker('setInterval(() => {}, 1000)', { eval: true });
+    worker.on('online', common.mustCall(() => worker.terminate()));
+    await new Promise((resolve) => worker.once('exit', resolve));
+    const next = new Worker('', { eval: true });
+    await new Promise((resolve) => next.once('exit', resolve));
+  })().then(common.mustCall());
+  return;
+}
+
+const child = spawnSync(process.execPath, [
+  '--max-idle-worker-isolates=2',
+  __filename,
+  'child',
+], {
+  env: { ...process.env, NODE_DEBUG_NATIVE: 'WORKER' },
+  encoding: 'utf8'
+});
+assert.strictEqual(child.status, 0, child.stderr);
+const lines = child.stderr.split('\n');
+const creating = lines.filter((line) => /Creating isolate/.test(line));
+const reusing = lines.filter((line) => /Reusing isolate/.test(line));
+// The first Worker, and the one with different resource limits, need new
+// isolates. The last one reuses the isolate of the terminated Worker.
+assert.strictEqual(creating.length, 2, child.stderr);
+assert.strictEqual(reusing.length, 3, child.stderr);
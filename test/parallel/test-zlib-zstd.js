@@ -0,0 +1,167 @@
+'use strict';
+const common = require('../common');
+const fixtures = require('../common/fixtures');
+const assert = require('assert');
+const zlib = require('zlib');
+
+// Test some zstd-specific properties of the zstd streams that can not
+// be easily covered through expanding zlib-only tests.
+
+const sampleBuffer = fixtures.readSync('/pss-vectors.json');
+
+{
+  // Round-trip through the sync and async convenience methods.
+  const compressed = zlib.zstdCompressSync(sampleBuffer);
+  assert(compressed.length < sampleBuffer.length);
+  assert.deepStrictEqual(zlib.zstdDecompressSync(compressed), sampleBuffer);
+
+  zlib.zstdCompress(sampleBuffer, common.mustSucceed((compressed) => {
+    zlib.zstdDecompress(compressed, common.mustSucceed((decompressed) => {
+      assert.deepStrictEqual(decompressed, sampleBuffer);
+    }));
+  }));
+}
+
+{
+  // Test setting the compression level at stream creation:
+  const sizes = [];
+  for (const level of [1, 3, 9, 19]) {
+    const encoded = zlib.zstdCompressSync(sampleBuffer, {
+      params: {
+        [zlib.constants.ZSTD_c_compressionLevel]: level
+      }
+    });
+    assert.deepStrictEqual(zlib.zstdDecompressSync(encoded), sampleBuffer);
+    sizes.push(encoded.length);
+  }
+  assert(sizes[0] > sizes[sizes.length - 1], sizes);
+}
+
+{
+  // Negative levels are valid, and -1 is not mistaken for an unset value.
+  const encoded = zlib.zstdCompressSync(sampleBuffer, {
+    params: {
+      [zlib.constants.ZSTD_c_compressionLevel]: -1
+    }
+  });
+  assert.deepStrictEqual(zlib.zstdDecompressSync(encoded), sampleBuffer);
+  assert.notDeepStrictEqual(encoded, zlib.zstdCompressSync(sampleBuffer));
+}
+
+{
+  // Multithreaded compression produces a regular zstd frame.
+  const input = Buffer.concat(new Array(64).fill(sampleBuffer));
+  const encoded = zlib.zstdCompressSync(input, {
+    params: {
+      [zlib.constants.ZSTD_c_nbWorkers]: 2,
+      [zlib.constants.ZSTD_c_jobSize]: 512 * 1024,
+      [zlib.constants.ZSTD_c_checksumFlag]: true
+    }
+  });
+  assert.deepStrictEqual(zlib.zstdDecompressSync(encoded), input);
+}
+
+{
+  // Dictionaries have to match on both sides.
+  const dictionary = sampleBuffer.slice(0, 4096);
+  const input = sampleBuffer.slice(0, 1024);
+  const encoded = zlib.zstdCompressSync(input, { dictionary });
+  assert(encoded.length < zlib.zstdCompressSync(input).length);
+  assert.deepStrictEqual(zlib.zstdDecompressSync(encoded, { dictionary }),
+                         input);
+  assert.throws(() => zlib.zstdDecompressSync(encoded), {
+    code: /^ZSTD_error_/,
+    name: 'Error',
+  });
+}
+
+{
+  // pledgedSrcSize has to match the actual input size.
+  const encoded = zlib.zstdCompressSync(sampleBuffer, {
+    pledgedSrcSize: sampleBuffer.length
+  });
+  assert.deepStrictEqual(zlib.zstdDecompressSync(encoded), sampleBuffer);
+
+  assert.throws(() => zlib.zstdCompressSync(sampleBuffer, {
+    pledgedSrcSize: 10
+  }), {
+    code: 'ZSTD_error_srcSize_wrong',
+    name: 'Error',
+  });
+
+  assert.throws(() => zlib.createZstdCompress({ pledgedSrcSize: -1 }), {
+    code: 'ERR_OUT_OF_RANGE',
+    name: 'RangeError',
+  });
+}
+
+{
+  // Concatenated frames decompress to the concatenated input.
+  const a = zlib.zstdCompressSync('hello ');
+  const b = zlib.zstdCompressSync('world');
+  assert.strictEqual(
+    zlib.zstdDecompressSync(Buffer.concat([a, b])).toString(), 'hello world');
+}
+
+{
+  // Truncated input is reported like it is for zlib and brotli.
+  const encoded = zlib.zstdCompressSync(sampleBuffer);
+  assert.throws(() => {
+    zlib.zstdDecompressSync(encoded.slice(0, encoded.length - 10));
+  }, {
+    code: 'Z_BUF_ERROR',
+    message: 'unexpected end of file'
+  });
+}
+
+{
+  // Test that setting out-of-bounds option values or keys fails.
+  assert.throws(() => {
+    zlib.createZstdCompress({
+      params: {
+        10000: 0
+      }
+    });
+  }, {
+    code: 'ERR_ZSTD_INVALID_PARAM',
+    name: 'RangeError',
+    message: '10000 is not a valid zstd parameter'
+  });
+
+  // Test that accidentally using duplicate keys fails.
+  assert.throws(() => {
+    zlib.createZstdCompress({
+      params: {
+        '100': 0,
+        '0100': 0
+      }
+    });
+  }, {
+    code: 'ERR_ZSTD_INVALID_PARAM',
+    name: 'RangeError',
+    message: '0100 is not a valid zstd parameter'
+  });
+
+  assert.throws(() => {
+    zlib.createZstdCompress({
+      params: {
+        [zlib.constants.ZSTD_c_strategy]: 1000
+      }
+    });
+  }, {
+    code: 'ERR_ZLIB_INITIALIZATION_FAILED',
+    name: 'Error',
+    message: 'Initialization failed'
+  });
+
+  assert.throws(() => {
+    zlib.createZstdDecompress({
+      params: {
+        [zlib.constants.ZSTD_c_nbWorkers]: 1
+      }
+    });
+  }, {
+    code: 'ERR_ZSTD_INVALID_PARAM',
+    name: 'RangeError',
+  });
+}
@@ -141,7 +141,8 @@ if (common.hasCrypto) { // eslint-disable-line node-core/crypto-check
   });
   crypto.pbkdf2('password', 'salt', 1, 20, 'sha256', mc);
 
-  crypto.randomBytes(1, common.mustCall(function rb() {
+  // Small requests are served from a pool without a RandomBytesJob.
+  crypto.randomBytes(1024, common.mustCall(function rb() {
     testInitialized(this, 'RandomBytesJob');
   }));
 
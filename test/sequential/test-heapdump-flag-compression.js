@@ -0,0 +1,51 @@
+'use strict';
+
+// Tests that --heapsnapshot-signal writes compressed snapshots with
+// --heapsnapshot-compression, even while the main thread is busy running
+// JavaScript code.
+
+const common = require('../common');
+
+if (common.isWindows)
+  common.skip('test not supported on Windows');
+
+const assert = require('assert');
+const fs = require('fs');
+
+if (process.argv[2] === 'child') {
+  process.kill(process.pid, 'SIGUSR2');
+
+  // Never yield to the event loop until the snapshot has been written.
+  let files;
+  do {
+    files = fs.readdirSync(process.cwd());
+  } while (files.length === 0);
+
+  assert.strictEqual(files.length, 1);
+  assert.match(files[0], /^Heap\..+\.heapsnapshot\.zst$/);
+} else {
+  const { spawnSync } = require('child_process');
+  const { zstdDecompressSync } = require('zlib');
+  const path = require('path');
+  const tmpdir = require('../common/tmpdir');
+
+  tmpdir.refresh();
+  const args = [
+    '--heapsnapshot-signal', 'SIGUSR2',
+    '--heapsnapshot-compression', 'zstd',
+    __filename, 'child',
+  ];
+  const child = spawnSync(process.execPath, args, { cwd: tmpdir.path });
+  assert.strictEqual(child.status, 0, child.stderr.toString());
+  assert.strictEqual(child.signal, null);
+
+  const [file] = fs.readdirSync(tmpdir.path);
+  JSON.parse(zstdDecompressSync(fs.readFileSync(path.join(tmpdir.path, file))));
+
+  const invalid = spawnSync(process.execPath, [
+    '--heapsnapshot-compression', 'brotli', '-e', '0',
+  ]);
+  assert.notStrictEqual(invalid.status, 0);
+  assert.match(invalid.stderr.toString(),
+               /invalid value for --heapsnapshot-compression/);
+}
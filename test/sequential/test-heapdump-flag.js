@@ -9,7 +9,8 @@ const assert = require('assert');
 if (process.argv[2] === 'child') {
   const fs = require('fs');
 
-  assert.strictEqual(process.listenerCount('SIGUSR2'), 1);
+  // The signal is watched natively.
+  assert.strictEqual(process.listenerCount('SIGUSR2'), 0);
   process.kill(process.pid, 'SIGUSR2');
   process.kill(process.pid, 'SIGUSR2');
 
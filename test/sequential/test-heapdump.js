@@ -24,6 +24,23 @@ process.chdir(tmpdir.path);
   fs.accessSync(heapdump);
 }
 
+{
+  const { gunzipSync, zstdDecompressSync } = require('zlib');
+  const gzip = writeHeapSnapshot(undefined, { compression: 'gzip' });
+  assert.match(gzip, /\.heapsnapshot\.gz$/);
+  JSON.parse(gunzipSync(fs.readFileSync(gzip)));
+
+  writeHeapSnapshot('my.heapdump.zst', { compression: 'zstd' });
+  JSON.parse(zstdDecompressSync(fs.readFileSync('my.heapdump.zst')));
+}
+
+[1, 'brotli', null].forEach((compression) => {
+  assert.throws(() => writeHeapSnapshot(undefined, { compression }), {
+    code: 'ERR_INVALID_ARG_VALUE',
+    name: 'TypeError',
+  });
+});
+
 [1, true, {}, [], null, Infinity, NaN].forEach((i) => {
   assert.throws(() => writeHeapSnapshot(i), {
     code: 'ERR_INVALID_ARG_TYPE',
@@ -52,6 +52,7 @@ const customTypesMap = {
   'AsyncResource': 'async_hooks.html#async_hooks_class_asyncresource',
 
   'brotli options': 'zlib.html#zlib_class_brotlioptions',
+  'zstd options': 'zlib.html#zlib_class_zstdoptions',
 
   'Buffer': 'buffer.html#buffer_class_buffer',
 
@@ -177,6 +178,8 @@ const customTypesMap = {
     'perf_hooks.html#perf_hooks_class_perf_hooks_performanceobserver',
   'PerformanceObserverEntryList':
     'perf_hooks.html#perf_hooks_class_performanceobserverentrylist',
+  'RecordableHistogram':
+    'perf_hooks.html#perf_hooks_class_recordablehistogram_extends_histogram',
   'QuicEndpoint': 'quic.html#quic_class_quicendpoint',
   'QuicSession': 'quic.html#quic_class_quicserversession_extends_quicsession',
   'QuicSocket': 'quic.html#quic_net_createquicsocket_options',
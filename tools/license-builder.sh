@@ -107,6 +107,9 @@ addlicense "caja" "lib/internal/freeze_intrinsics.js" "$(sed -e '/SPDX-License-I
 # brotli
 addlicense "brotli" "deps/brotli" "$(cat ${rootdir}/deps/brotli/LICENSE)"
 
+# zstd
+addlicense "zstd" "deps/zstd" "$(cat ${rootdir}/deps/zstd/LICENSE)"
+
 addlicense "HdrHistogram" "deps/histogram" "$(cat ${rootdir}/deps/histogram/LICENSE.txt)"
 
 addlicense "highlight.js" "doc/api_assets/highlight.pack.js" \